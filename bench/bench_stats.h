@@ -0,0 +1,88 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+    struct Summary {
+        size_t runs = 0;
+        double min_ms = 0.0;
+        double median_ms = 0.0;
+        double p95_ms = 0.0;
+        double p99_ms = 0.0;
+        double max_ms = 0.0;
+    };
+
+    // Nearest-rank percentile over an already sorted sample.
+    inline double percentile(const std::vector<double>& sorted, double pct) {
+        if (sorted.empty()) return 0.0;
+        size_t rank = static_cast<size_t>(std::ceil(pct / 100.0 * static_cast<double>(sorted.size())));
+        rank = std::clamp<size_t>(rank, 1, sorted.size());
+        return sorted[rank - 1];
+    }
+
+    inline Summary summarize(std::vector<double> samples_ms) {
+        Summary summary;
+        if (samples_ms.empty()) return summary;
+        std::sort(samples_ms.begin(), samples_ms.end());
+        summary.runs = samples_ms.size();
+        summary.min_ms = samples_ms.front();
+        summary.median_ms = percentile(samples_ms, 50.0);
+        summary.p95_ms = percentile(samples_ms, 95.0);
+        summary.p99_ms = percentile(samples_ms, 99.0);
+        summary.max_ms = samples_ms.back();
+        return summary;
+    }
+
+    template <typename Fn>
+    double time_ms(Fn&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Redirects fd 1 to /dev/null for its lifetime: spawned tools and hitpag status lines
+    // write there, and results must stay readable.
+    class StdoutSilencer {
+    public:
+        StdoutSilencer() {
+#ifndef _WIN32
+            std::cout.flush();
+            saved_ = ::dup(STDOUT_FILENO);
+            int devnull = ::open("/dev/null", O_WRONLY);
+            if (devnull >= 0) {
+                ::dup2(devnull, STDOUT_FILENO);
+                ::close(devnull);
+            }
+#endif
+        }
+        ~StdoutSilencer() {
+#ifndef _WIN32
+            std::cout.flush();
+            if (saved_ >= 0) {
+                ::dup2(saved_, STDOUT_FILENO);
+                ::close(saved_);
+            }
+#endif
+        }
+        StdoutSilencer(const StdoutSilencer&) = delete;
+        StdoutSilencer& operator=(const StdoutSilencer&) = delete;
+
+    private:
+        int saved_ = -1;
+    };
+}
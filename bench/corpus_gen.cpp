@@ -0,0 +1,658 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "corpus_gen.h"
+
+#include "include/args.h"
+#include "include/checksum.h"
+#include "include/error.h"
+#include "include/operation.h"
+#include "include/progress.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace corpus {
+    namespace {
+        constexpr size_t BLOCK_SIZE = 4096;
+        constexpr uint64_t FIXED_MTIME = 1704067200;  // 2024-01-01 00:00:00 UTC
+        constexpr double MEMBER_COMPRESSIBILITY = 0.7;
+        const std::string WORDS =
+            "archive entry header stream block folder member listing preview extract compress "
+            "the quick brown fox jumps over the lazy dog while the tape keeps spinning ";
+
+        // Block contents depend only on (seed, block index), so any chunking reproduces them.
+        void fill_block(uint64_t seed, uint64_t block, double compressibility, char* out, size_t length) {
+            Rng rng(seed ^ ((block + 1) * 0xD1B54A32D192ED03ull));
+            size_t text = static_cast<size_t>(std::clamp(compressibility, 0.0, 1.0) * static_cast<double>(length));
+            size_t offset = static_cast<size_t>(rng.below(WORDS.size()));
+            for (size_t i = 0; i < text; ++i) {
+                out[i] = WORDS[(offset + i) % WORDS.size()];
+            }
+            for (size_t i = text; i < length; i += 8) {
+                uint64_t value = rng.next();
+                for (size_t b = 0; b < 8 && i + b < length; ++b) {
+                    out[i + b] = static_cast<char>((value >> (b * 8)) & 0xFF);
+                }
+            }
+        }
+
+        class Digest {
+        public:
+            void add(const void* data, size_t length) {
+                const auto* bytes = static_cast<const unsigned char*>(data);
+                for (size_t i = 0; i < length; ++i) {
+                    value_ = (value_ ^ bytes[i]) * 0x100000001B3ull;
+                }
+            }
+            void add(const std::string& text) { add(text.data(), text.size() + 1); }
+            void add_u64(uint64_t number) { add(&number, sizeof(number)); }
+            uint64_t value() const { return value_; }
+
+        private:
+            uint64_t value_ = 0xCBF29CE484222325ull;
+        };
+
+        // Buffered output that turns long zero runs into holes.
+        class Sink {
+        public:
+            explicit Sink(const std::string& path) : path_(path), out_(path, std::ios::binary | std::ios::trunc) {
+                if (!out_) throw std::runtime_error("cannot write " + path);
+            }
+
+            void write(const void* data, size_t length) {
+                if (hole_pending_) {
+                    out_.seekp(static_cast<std::streamoff>(offset_));
+                    hole_pending_ = false;
+                }
+                out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(length));
+                offset_ += length;
+            }
+            void write(const std::string& data) { write(data.data(), data.size()); }
+
+            void zeros(uint64_t length) {
+                if (length < 64 * 1024) {
+                    static const std::array<char, 64 * 1024> empty{};
+                    write(empty.data(), static_cast<size_t>(length));
+                    return;
+                }
+                out_.flush();
+                offset_ += length;
+                hole_pending_ = true;
+            }
+
+            uint64_t offset() const { return offset_; }
+
+            void close() {
+                out_.close();
+                if (!out_) throw std::runtime_error("write failed: " + path_);
+                // A trailing hole has no write after it to extend the file.
+                if (hole_pending_) fs::resize_file(path_, offset_);
+            }
+
+        private:
+            std::string path_;
+            std::ofstream out_;
+            uint64_t offset_ = 0;
+            bool hole_pending_ = false;
+        };
+
+        template <typename Fn>
+        void for_each_block(const Member& member, double compressibility, Fn&& fn) {
+            std::array<char, BLOCK_SIZE> block{};
+            for (uint64_t offset = 0, index = 0; offset < member.size; offset += BLOCK_SIZE, ++index) {
+                size_t length = static_cast<size_t>(std::min<uint64_t>(BLOCK_SIZE, member.size - offset));
+                fill_block(member.seed, index, compressibility, block.data(), length);
+                fn(block.data(), length);
+            }
+        }
+
+        uint32_t member_crc(const Member& member) {
+            if (member.zero_fill) return checksum::crc32_zeros(0, member.size);
+            uint32_t crc = 0;
+            for_each_block(member, MEMBER_COMPRESSIBILITY, [&](const char* data, size_t length) {
+                crc = checksum::crc32(crc, data, length);
+            });
+            return crc;
+        }
+
+        void write_member_data(Sink& sink, const Member& member) {
+            if (member.zero_fill) {
+                sink.zeros(member.size);
+                return;
+            }
+            for_each_block(member, MEMBER_COMPRESSIBILITY, [&](const char* data, size_t length) {
+                sink.write(data, length);
+            });
+        }
+
+        void put16(std::string& out, uint16_t value) {
+            out += static_cast<char>(value & 0xFF);
+            out += static_cast<char>((value >> 8) & 0xFF);
+        }
+
+        void put32(std::string& out, uint32_t value) {
+            put16(out, static_cast<uint16_t>(value & 0xFFFF));
+            put16(out, static_cast<uint16_t>(value >> 16));
+        }
+
+        void put64(std::string& out, uint64_t value) {
+            put32(out, static_cast<uint32_t>(value & 0xFFFFFFFFu));
+            put32(out, static_cast<uint32_t>(value >> 32));
+        }
+
+        uint32_t clamp32(uint64_t value) {
+            return value >= 0xFFFFFFFFull ? 0xFFFFFFFFu : static_cast<uint32_t>(value);
+        }
+
+        bool is_directory_member(const Member& member) {
+            return !member.path.empty() && member.path.back() == '/';
+        }
+
+        void write_octal(char* field, size_t width, uint64_t value) {
+            std::snprintf(field, width, "%0*llo", static_cast<int>(width - 1), static_cast<unsigned long long>(value));
+        }
+
+        std::array<char, 512> tar_header(const std::string& name, uint64_t size, char type) {
+            std::array<char, 512> header{};
+            std::copy_n(name.begin(), std::min<size_t>(name.size(), 100), header.begin());
+            write_octal(&header[100], 8, type == '5' ? 0755 : 0644);
+            write_octal(&header[108], 8, 0);
+            write_octal(&header[116], 8, 0);
+            if (size < 077777777777ull) {
+                write_octal(&header[124], 12, size);
+            } else {
+                // GNU base-256 size for members of 8 GiB and more.
+                header[124] = static_cast<char>(0x80);
+                for (int i = 0; i < 8; ++i) {
+                    header[135 - i] = static_cast<char>((size >> (i * 8)) & 0xFF);
+                }
+            }
+            write_octal(&header[136], 12, FIXED_MTIME);
+            header[156] = type;
+            std::copy_n("ustar", 6, &header[257]);
+            header[263] = '0';
+            header[264] = '0';
+
+            std::fill_n(&header[148], 8, ' ');
+            unsigned int sum = 0;
+            for (char c : header) sum += static_cast<unsigned char>(c);
+            std::snprintf(&header[148], 7, "%06o", sum);
+            header[155] = ' ';
+            return header;
+        }
+
+        std::string pax_record(const std::string& key, const std::string& value) {
+            std::string body = " " + key + "=" + value + "\n";
+            size_t length = body.size() + 1;
+            while (std::to_string(length).size() + body.size() != length) ++length;
+            return std::to_string(length) + body;
+        }
+
+        void pad_to_block(Sink& sink, uint64_t size) {
+            uint64_t remainder = size % 512;
+            if (remainder != 0) sink.zeros(512 - remainder);
+        }
+
+#ifndef _WIN32
+        // Runs `tool -c` with stdin from input and stdout to output.
+        void run_filter(const std::vector<std::string>& cmd, const std::string& input, const std::string& output) {
+            if (!operation::is_tool_available(cmd.front())) {
+                error::throw_error(error::ErrorCode::TOOL_NOT_FOUND, {{"TOOL_NAME", cmd.front()}});
+            }
+            int in_fd = ::open(input.c_str(), O_RDONLY);
+            int out_fd = ::open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (in_fd < 0 || out_fd < 0) {
+                if (in_fd >= 0) ::close(in_fd);
+                if (out_fd >= 0) ::close(out_fd);
+                throw std::runtime_error("cannot open " + input + " or " + output);
+            }
+
+            std::vector<char*> argv;
+            for (const auto& arg : cmd) argv.push_back(const_cast<char*>(arg.c_str()));
+            argv.push_back(nullptr);
+
+            auto started = std::chrono::steady_clock::now();
+            pid_t pid = ::fork();
+            if (pid == 0) {
+                ::dup2(in_fd, STDIN_FILENO);
+                ::dup2(out_fd, STDOUT_FILENO);
+                ::execvp(argv[0], argv.data());
+                _exit(127);
+            }
+            ::close(in_fd);
+            ::close(out_fd);
+            int status = pid > 0 ? progress::wait_for_child(pid, cmd.front(), started) : -1;
+            if (status < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                throw std::runtime_error(cmd.front() + " failed while writing " + output);
+            }
+        }
+#endif
+
+        std::vector<std::string> tar_filter(file_type::FileType format) {
+            switch (format) {
+                case file_type::FileType::ARCHIVE_TAR_GZ: return {"gzip", "-c"};
+                case file_type::FileType::ARCHIVE_TAR_BZ2: return {"bzip2", "-c"};
+                case file_type::FileType::ARCHIVE_TAR_XZ: return {"xz", "-c", "-T0"};
+                case file_type::FileType::ARCHIVE_TAR_ZSTD: return {"zstd", "-c", "-q", "-T0"};
+                default: return {};
+            }
+        }
+
+        void materialize(const fs::path& root, const std::vector<Member>& members) {
+            for (const auto& member : members) {
+                fs::path path = root / member.path;
+                if (is_directory_member(member)) {
+                    fs::create_directories(path);
+                    continue;
+                }
+                fs::create_directories(path.parent_path());
+                Sink sink(path.string());
+                write_member_data(sink, member);
+                sink.close();
+            }
+        }
+    }
+
+    uint64_t parse_size(const std::string& text) {
+        size_t consumed = 0;
+        double value = std::stod(text, &consumed);
+        std::string suffix = text.substr(consumed);
+        uint64_t unit = 1;
+        if (!suffix.empty()) {
+            switch (std::toupper(static_cast<unsigned char>(suffix[0]))) {
+                case 'K': unit = 1ull << 10; break;
+                case 'M': unit = 1ull << 20; break;
+                case 'G': unit = 1ull << 30; break;
+                case 'T': unit = 1ull << 40; break;
+                case 'B': break;
+                default: throw std::invalid_argument("bad size: " + text);
+            }
+        }
+        if (value < 0) throw std::invalid_argument("bad size: " + text);
+        return static_cast<uint64_t>(value * static_cast<double>(unit));
+    }
+
+    SizeDistribution SizeDistribution::parse(const std::string& spec) {
+        std::vector<std::string> parts;
+        size_t start = 0;
+        while (true) {
+            size_t colon = spec.find(':', start);
+            parts.push_back(spec.substr(start, colon == std::string::npos ? std::string::npos : colon - start));
+            if (colon == std::string::npos) break;
+            start = colon + 1;
+        }
+
+        SizeDistribution dist;
+        if (parts[0] == "fixed" && parts.size() == 2) {
+            dist.kind = Kind::Fixed;
+            dist.first = parse_size(parts[1]);
+        } else if (parts[0] == "uniform" && parts.size() == 3) {
+            dist.kind = Kind::Uniform;
+            dist.first = parse_size(parts[1]);
+            dist.second = parse_size(parts[2]);
+            if (dist.second < dist.first) throw std::invalid_argument("uniform maximum below minimum: " + spec);
+        } else if (parts[0] == "lognormal" && (parts.size() == 2 || parts.size() == 3)) {
+            dist.kind = Kind::LogNormal;
+            dist.first = parse_size(parts[1]);
+            if (parts.size() == 3) dist.sigma = std::stod(parts[2]);
+        } else {
+            throw std::invalid_argument("bad size distribution: " + spec);
+        }
+        return dist;
+    }
+
+    uint64_t SizeDistribution::sample(Rng& rng) const {
+        switch (kind) {
+            case Kind::Fixed:
+                return first;
+            case Kind::Uniform:
+                return first + rng.below(second - first + 1);
+            case Kind::LogNormal: {
+                // Box-Muller; both draws are consumed so the stream stays aligned.
+                double u1 = std::max(rng.uniform(), 1e-12);
+                double u2 = rng.uniform();
+                double normal = std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+                double value = static_cast<double>(first) * std::exp(sigma * normal);
+                return static_cast<uint64_t>(std::min(value, 1e15));
+            }
+        }
+        return first;
+    }
+
+    Summary generate_tree(const std::string& root_path, const TreeOptions& options) {
+        fs::path root(root_path);
+        fs::create_directories(root);
+
+        Summary summary;
+        Digest digest;
+        Rng rng(options.seed);
+        struct Content {
+            uint64_t size;
+            uint64_t seed;
+        };
+        std::vector<Content> written;
+        written.reserve(options.files);
+        const char* extension = options.compressibility >= 0.5 ? ".txt" : ".bin";
+
+        for (size_t i = 0; i < options.files; ++i) {
+            size_t level = options.depth == 0 ? 0 : static_cast<size_t>(rng.below(options.depth + 1));
+            fs::path relative;
+            for (size_t l = 0; l < level; ++l) {
+                relative /= "d" + std::to_string(rng.below(std::max<size_t>(1, options.fanout)));
+            }
+            if (!relative.empty()) {
+                std::error_code ec;
+                fs::path dir = root;
+                for (const auto& part : relative) {
+                    dir /= part;
+                    if (fs::create_directory(dir, ec)) ++summary.directories;
+                }
+            }
+
+            char name[32];
+            std::snprintf(name, sizeof(name), "f%07zu%s", i, extension);
+            relative /= name;
+
+            Content content{};
+            if (!written.empty() && rng.uniform() < options.duplicate_ratio) {
+                content = written[static_cast<size_t>(rng.below(written.size()))];
+            } else {
+                content.size = options.sizes.sample(rng);
+                content.seed = rng.next();
+            }
+            written.push_back(content);
+            bool sparse = rng.uniform() < options.sparse_ratio;
+
+            Sink sink((root / relative).string());
+            std::array<char, BLOCK_SIZE> block{};
+            digest.add(relative.generic_string());
+            digest.add_u64(content.size);
+            for (uint64_t offset = 0, index = 0; offset < content.size; offset += BLOCK_SIZE, ++index) {
+                if (sparse && index > 0) {
+                    sink.zeros(content.size - offset);
+                    digest.add_u64(content.size - offset);
+                    break;
+                }
+                size_t length = static_cast<size_t>(std::min<uint64_t>(BLOCK_SIZE, content.size - offset));
+                fill_block(content.seed, index, options.compressibility, block.data(), length);
+                sink.write(block.data(), length);
+                digest.add(block.data(), length);
+            }
+            sink.close();
+
+            ++summary.files;
+            summary.bytes += content.size;
+        }
+
+        summary.digest = digest.value();
+        return summary;
+    }
+
+    bool parse_pathology(const std::string& text, Pathology& kind) {
+        if (text == "many-entries") kind = Pathology::ManyEntries;
+        else if (text == "huge-member") kind = Pathology::HugeMember;
+        else if (text == "long-names") kind = Pathology::LongNames;
+        else return false;
+        return true;
+    }
+
+    std::vector<Member> pathological_members(const ArchiveOptions& options) {
+        std::vector<Member> members;
+        Rng rng(options.seed);
+
+        switch (options.kind) {
+            case Pathology::ManyEntries: {
+                size_t count = options.entries ? options.entries : 2000000;
+                members.reserve(count);
+                char path[48];
+                for (size_t i = 0; i < count; ++i) {
+                    std::snprintf(path, sizeof(path), "d%04zu/f%07zu.txt", i / 1000, i);
+                    members.push_back({path, options.member_size, rng.next(), false});
+                }
+                break;
+            }
+            case Pathology::HugeMember: {
+                size_t count = options.entries ? options.entries : 1;
+                uint64_t size = options.member_size ? options.member_size : 100ull << 30;
+                for (size_t i = 0; i < count; ++i) {
+                    std::string name = count == 1 ? "huge.bin" : "huge" + std::to_string(i) + ".bin";
+                    members.push_back({name, size, rng.next(), true});
+                }
+                break;
+            }
+            case Pathology::LongNames: {
+                size_t count = options.entries ? options.entries : 100;
+                uint64_t size = options.member_size ? options.member_size : 64;
+                // Components stay under NAME_MAX so 7z/xar can stage the tree on disk.
+                for (size_t i = 0; i < count; ++i) {
+                    std::string leaf = "file" + std::to_string(i) + ".txt";
+                    std::string path;
+                    while (path.size() + leaf.size() < options.name_length) {
+                        size_t room = options.name_length - leaf.size() - path.size();
+                        size_t component = std::min<size_t>(200, room > 1 ? room - 1 : 1);
+                        path += std::string(component, static_cast<char>('a' + (i + path.size()) % 26)) + "/";
+                    }
+                    members.push_back({path + leaf, size, rng.next(), false});
+                }
+                break;
+            }
+        }
+        return members;
+    }
+
+    void write_zip(const std::string& path, const std::vector<Member>& members) {
+        constexpr uint16_t DOS_TIME = 0;
+        constexpr uint16_t DOS_DATE = ((2024 - 1980) << 9) | (1 << 5) | 1;
+        constexpr uint16_t UTF8_FLAG = 0x0800;
+
+        Sink sink(path);
+        std::string central;
+        for (const auto& member : members) {
+            const bool directory = is_directory_member(member);
+            const uint64_t size = directory ? 0 : member.size;
+            const uint32_t crc = directory ? 0 : member_crc(member);
+            const uint64_t offset = sink.offset();
+            const bool big_size = size >= 0xFFFFFFFFull;
+            const bool big_offset = offset >= 0xFFFFFFFFull;
+            const uint16_t needed = (big_size || big_offset) ? 45 : 20;
+
+            std::string local;
+            put32(local, 0x04034B50);
+            put16(local, needed);
+            put16(local, UTF8_FLAG);
+            put16(local, 0);
+            put16(local, DOS_TIME);
+            put16(local, DOS_DATE);
+            put32(local, crc);
+            put32(local, clamp32(size));
+            put32(local, clamp32(size));
+            put16(local, static_cast<uint16_t>(member.path.size()));
+            put16(local, big_size ? 20 : 0);
+            local += member.path;
+            if (big_size) {
+                put16(local, 0x0001);
+                put16(local, 16);
+                put64(local, size);
+                put64(local, size);
+            }
+            sink.write(local);
+            if (!directory) write_member_data(sink, member);
+
+            std::string extra;
+            if (big_size) {
+                put64(extra, size);
+                put64(extra, size);
+            }
+            if (big_offset) put64(extra, offset);
+            if (!extra.empty()) {
+                std::string header;
+                put16(header, 0x0001);
+                put16(header, static_cast<uint16_t>(extra.size()));
+                extra = header + extra;
+            }
+
+            put32(central, 0x02014B50);
+            put16(central, 0x031E);
+            put16(central, needed);
+            put16(central, UTF8_FLAG);
+            put16(central, 0);
+            put16(central, DOS_TIME);
+            put16(central, DOS_DATE);
+            put32(central, crc);
+            put32(central, clamp32(size));
+            put32(central, clamp32(size));
+            put16(central, static_cast<uint16_t>(member.path.size()));
+            put16(central, static_cast<uint16_t>(extra.size()));
+            put16(central, 0);
+            put16(central, 0);
+            put16(central, 0);
+            put32(central, directory ? ((040755u << 16) | 0x10) : (0100644u << 16));
+            put32(central, clamp32(offset));
+            central += member.path;
+            central += extra;
+        }
+
+        const uint64_t cd_start = sink.offset();
+        const uint64_t cd_size = central.size();
+        const uint64_t count = members.size();
+        sink.write(central);
+
+        std::string end;
+        if (count >= 0xFFFF || cd_start >= 0xFFFFFFFFull || cd_size >= 0xFFFFFFFFull) {
+            const uint64_t zip64_end = sink.offset();
+            put32(end, 0x06064B50);
+            put64(end, 44);
+            put16(end, 0x031E);
+            put16(end, 45);
+            put32(end, 0);
+            put32(end, 0);
+            put64(end, count);
+            put64(end, count);
+            put64(end, cd_size);
+            put64(end, cd_start);
+            put32(end, 0x07064B50);
+            put32(end, 0);
+            put64(end, zip64_end);
+            put32(end, 1);
+        }
+        const uint16_t count16 = count >= 0xFFFF ? 0xFFFF : static_cast<uint16_t>(count);
+        put32(end, 0x06054B50);
+        put16(end, 0);
+        put16(end, 0);
+        put16(end, count16);
+        put16(end, count16);
+        put32(end, clamp32(cd_size));
+        put32(end, clamp32(cd_start));
+        put16(end, 0);
+        sink.write(end);
+        sink.close();
+    }
+
+    void write_tar(const std::string& path, const std::vector<Member>& members) {
+        Sink sink(path);
+        for (const auto& member : members) {
+            const bool directory = is_directory_member(member);
+            if (member.path.size() > 100) {
+                std::string records = pax_record("path", member.path);
+                std::string short_name = "PaxHeaders/" + member.path.substr(member.path.size() - std::min<size_t>(member.path.size(), 80));
+                auto pax = tar_header(short_name.substr(0, 100), records.size(), 'x');
+                sink.write(pax.data(), pax.size());
+                sink.write(records);
+                pad_to_block(sink, records.size());
+            }
+            auto header = tar_header(member.path, directory ? 0 : member.size, directory ? '5' : '0');
+            sink.write(header.data(), header.size());
+            if (!directory) {
+                write_member_data(sink, member);
+                pad_to_block(sink, member.size);
+            }
+        }
+        sink.zeros(1024);
+        // Pad to the 10 KiB record size tar itself writes.
+        uint64_t remainder = sink.offset() % 10240;
+        if (remainder != 0) sink.zeros(10240 - remainder);
+        sink.close();
+    }
+
+    Summary generate_archive(const std::string& output, const ArchiveOptions& options) {
+        std::vector<Member> members = pathological_members(options);
+        Summary summary;
+        summary.files = members.size();
+        Digest digest;
+        for (const auto& member : members) {
+            summary.bytes += member.size;
+            digest.add(member.path);
+            digest.add_u64(member.size);
+            digest.add_u64(member.seed);
+        }
+        summary.digest = digest.value();
+
+        using file_type::FileType;
+        const FileType format = options.format;
+        if (format == FileType::ARCHIVE_ZIP) {
+            write_zip(output, members);
+        } else if (format == FileType::ARCHIVE_TAR) {
+            write_tar(output, members);
+        } else if (!tar_filter(format).empty()) {
+#ifndef _WIN32
+            std::string staged = output + ".stage.tar";
+            write_tar(staged, members);
+            try {
+                run_filter(tar_filter(format), staged, output);
+            } catch (...) {
+                fs::remove(staged);
+                throw;
+            }
+            fs::remove(staged);
+#else
+            throw std::runtime_error("compressed tar output needs a POSIX host");
+#endif
+        } else if (format == FileType::ARCHIVE_7Z || format == FileType::ARCHIVE_XAR ||
+                   format == FileType::ARCHIVE_LZ4 || format == FileType::ARCHIVE_ZSTD) {
+            const bool single = format == FileType::ARCHIVE_LZ4 || format == FileType::ARCHIVE_ZSTD;
+            if (single && members.size() != 1) {
+                throw std::runtime_error(file_type::get_format_name(format) + " stores a single file; use --kind=huge-member");
+            }
+            fs::path stage = fs::path(output).concat(".stage");
+            fs::remove_all(stage);
+            materialize(stage, members);
+
+            args::Options compress_options;
+            progress::ProgressTracker tracker;
+            std::vector<operation::CompressionSource> sources;
+            if (single) {
+                sources.push_back({(stage / members.front().path).string(), false});
+            } else {
+                sources.push_back({stage.string(), true});
+            }
+            try {
+                operation::compress(sources, output, format, "", compress_options, tracker);
+            } catch (...) {
+                fs::remove_all(stage);
+                throw;
+            }
+            fs::remove_all(stage);
+        } else {
+            throw std::runtime_error("cannot create " + file_type::get_format_name(format) + " archives");
+        }
+        return summary;
+    }
+}
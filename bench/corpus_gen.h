@@ -0,0 +1,99 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "include/file_type.h"
+
+// Seeded generators for benchmark and stress inputs. The same options and seed always produce
+// the same bytes (and the same digest), independent of platform and of how often they are run.
+namespace corpus {
+    class Rng {
+    public:
+        explicit Rng(uint64_t seed) : state_(seed) {}
+        // splitmix64: tiny, fast and fully specified, unlike the <random> distributions.
+        uint64_t next() {
+            uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+        uint64_t below(uint64_t bound) { return bound == 0 ? 0 : next() % bound; }
+        double uniform() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    private:
+        uint64_t state_;
+    };
+
+    struct SizeDistribution {
+        enum class Kind { Fixed, Uniform, LogNormal };
+        Kind kind = Kind::LogNormal;
+        uint64_t first = 8 * 1024;   // fixed size, uniform minimum, or log-normal median
+        uint64_t second = 0;         // uniform maximum
+        double sigma = 1.5;
+
+        // "fixed:4K", "uniform:0:64K" or "lognormal:8K:1.5"; throws std::invalid_argument.
+        static SizeDistribution parse(const std::string& spec);
+        uint64_t sample(Rng& rng) const;
+    };
+
+    // Parses "4096", "64K", "100G" (binary units).
+    uint64_t parse_size(const std::string& text);
+
+    struct TreeOptions {
+        uint64_t seed = 1;
+        size_t files = 1000;
+        SizeDistribution sizes;
+        double compressibility = 0.5;   // share of each 4 KiB block drawn from repetitive text
+        double duplicate_ratio = 0.0;   // share of files that repeat an earlier file's content
+        double sparse_ratio = 0.0;      // share of files written as one data block plus a hole
+        size_t depth = 3;               // maximum directory nesting
+        size_t fanout = 8;              // subdirectories per level
+    };
+
+    struct Summary {
+        size_t files = 0;
+        size_t directories = 0;
+        uint64_t bytes = 0;
+        uint64_t digest = 0;  // FNV-1a over paths and logical contents
+    };
+
+    Summary generate_tree(const std::string& root, const TreeOptions& options);
+
+    enum class Pathology { ManyEntries, HugeMember, LongNames };
+
+    struct ArchiveOptions {
+        Pathology kind = Pathology::ManyEntries;
+        file_type::FileType format = file_type::FileType::ARCHIVE_ZIP;
+        uint64_t seed = 1;
+        size_t entries = 0;          // 0 = per-kind default (2M, 1, 100)
+        uint64_t member_size = 0;    // 0 = per-kind default (0 B, 100 GiB, 64 B)
+        size_t name_length = 4000;   // long-names: characters per path
+    };
+
+    struct Member {
+        std::string path;
+        uint64_t size = 0;
+        uint64_t seed = 0;
+        bool zero_fill = false;  // written as holes where the format allows it
+    };
+
+    bool parse_pathology(const std::string& text, Pathology& kind);
+    std::vector<Member> pathological_members(const ArchiveOptions& options);
+
+    // Native writers for stored zip (zip64 when needed) and ustar/pax tar; zero-filled members
+    // become holes, so a 100 GiB member costs no disk space or time.
+    void write_zip(const std::string& path, const std::vector<Member>& members);
+    void write_tar(const std::string& path, const std::vector<Member>& members);
+
+    // Writes the members in any format hitpag can create: zip and tar natively, compressed tar
+    // through the compressor tool, and 7z/xar/lz4/zstd from a staged tree via operation::compress.
+    Summary generate_archive(const std::string& output, const ArchiveOptions& options);
+}
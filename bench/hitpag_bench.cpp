@@ -0,0 +1,462 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// hitpag_bench - end-to-end timings for compress, decompress, list, preview and verify
+// across formats, levels and thread counts, with warm and cold page cache.
+
+#include "bench_stats.h"
+#include "corpus_gen.h"
+#include "include/args.h"
+#include "include/error.h"
+#include "include/file_type.h"
+#include "include/operation.h"
+#include "include/progress.h"
+#include "include/tui_archive_ops.h"
+#include "include/util.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    const std::vector<std::string> ALL_OPERATIONS = {"compress", "decompress", "list", "preview", "verify"};
+    // RAR is extract-only, so it cannot take part in a round trip.
+    const std::vector<std::string> ALL_FORMATS = {
+        "tar", "tar.gz", "tar.bz2", "tar.xz", "tar.zst", "zip", "7z", "lz4", "zstd", "xar"
+    };
+
+    struct Config {
+        std::vector<std::string> corpora;
+        std::vector<size_t> generate;
+        uint64_t seed = 1;
+        std::vector<std::string> formats = ALL_FORMATS;
+        std::vector<int> levels = {0};
+        std::vector<int> threads = {1};
+        std::vector<std::string> operations = ALL_OPERATIONS;
+        std::vector<std::string> caches = {"warm", "cold"};
+        int runs = 5;
+        bool json = false;
+        std::string output;
+        std::string work_dir = "/tmp/hitpag_bench";
+    };
+
+    struct Row {
+        std::string corpus;
+        std::string format;
+        int level = 0;
+        int threads = 1;
+        std::string operation;
+        std::string cache;
+        bench::Summary summary;
+        uint64_t bytes_in = 0;
+        uint64_t bytes_out = 0;
+        std::string status = "ok";
+    };
+
+    std::vector<std::string> split_list(const std::string& value) {
+        std::vector<std::string> items;
+        std::stringstream stream(value);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            item = util::trim_copy(item);
+            if (!item.empty()) items.push_back(item);
+        }
+        return items;
+    }
+
+    std::vector<int> split_ints(const std::string& value) {
+        std::vector<int> numbers;
+        for (const auto& item : split_list(value)) numbers.push_back(std::stoi(item));
+        return numbers;
+    }
+
+    void print_usage() {
+        std::cout << "Usage: hitpag_bench [options] [--corpus=PATH ...]\n"
+                  << "  --corpus=PATH        File or directory to archive (repeatable)\n"
+                  << "  --generate=FILES     Add a seeded generated corpus of FILES files (default: 256 when no --corpus)\n"
+                  << "  --seed=N             Seed for generated corpora (default: 1)\n"
+                  << "  --formats=LIST       Comma-separated formats (default: all creatable formats)\n"
+                  << "  --levels=LIST        Compression levels, 0 = tool default (default: 0)\n"
+                  << "  --threads=LIST       Thread counts passed as -t (default: 1)\n"
+                  << "  --operations=LIST    compress,decompress,list,preview,verify (default: all)\n"
+                  << "  --cache=LIST         warm,cold (default: both; cold uses posix_fadvise DONTNEED)\n"
+                  << "  --runs=N             Timed runs per case (default: 5)\n"
+                  << "  --json               Emit JSON instead of CSV\n"
+                  << "  --output=FILE        Write results to FILE instead of stdout\n"
+                  << "  --work-dir=DIR       Scratch directory (default: /tmp/hitpag_bench)\n";
+    }
+
+    bool parse_config(int argc, char* argv[], Config& config) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value_of = [&](const std::string& prefix) { return arg.substr(prefix.size()); };
+            if (arg == "-h" || arg == "--help") {
+                print_usage();
+                return false;
+            } else if (arg.rfind("--corpus=", 0) == 0) {
+                config.corpora.push_back(value_of("--corpus="));
+            } else if (arg.rfind("--generate=", 0) == 0) {
+                config.generate.push_back(static_cast<size_t>(std::stoull(value_of("--generate="))));
+            } else if (arg.rfind("--seed=", 0) == 0) {
+                config.seed = std::stoull(value_of("--seed="));
+            } else if (arg.rfind("--formats=", 0) == 0) {
+                config.formats = split_list(value_of("--formats="));
+            } else if (arg.rfind("--levels=", 0) == 0) {
+                config.levels = split_ints(value_of("--levels="));
+            } else if (arg.rfind("--threads=", 0) == 0) {
+                config.threads = split_ints(value_of("--threads="));
+            } else if (arg.rfind("--operations=", 0) == 0) {
+                config.operations = split_list(value_of("--operations="));
+            } else if (arg.rfind("--cache=", 0) == 0) {
+                config.caches = split_list(value_of("--cache="));
+            } else if (arg.rfind("--runs=", 0) == 0) {
+                config.runs = std::max(1, std::stoi(value_of("--runs=")));
+            } else if (arg == "--json") {
+                config.json = true;
+            } else if (arg.rfind("--output=", 0) == 0) {
+                config.output = value_of("--output=");
+            } else if (arg.rfind("--work-dir=", 0) == 0) {
+                config.work_dir = value_of("--work-dir=");
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                print_usage();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint64_t path_size(const fs::path& path) {
+        std::error_code ec;
+        if (fs::is_regular_file(path, ec)) return fs::file_size(path, ec);
+        uint64_t total = 0;
+        for (fs::recursive_directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+            std::error_code entry_ec;
+            if (it->is_regular_file(entry_ec)) total += it->file_size(entry_ec);
+        }
+        return total;
+    }
+
+    // Flushes and evicts the file (or every file under a directory) from the page cache.
+    void drop_page_cache(const fs::path& path) {
+#ifndef _WIN32
+        auto drop_file = [](const fs::path& file) {
+            int fd = ::open(file.c_str(), O_RDONLY);
+            if (fd < 0) return;
+            ::fdatasync(fd);
+            ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            ::close(fd);
+        };
+        std::error_code ec;
+        if (fs::is_regular_file(path, ec)) {
+            drop_file(path);
+            return;
+        }
+        for (fs::recursive_directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+            std::error_code entry_ec;
+            if (it->is_regular_file(entry_ec)) drop_file(it->path());
+        }
+#else
+        (void)path;
+#endif
+    }
+
+    std::string archive_extension(const std::string& format) {
+        return format == "zstd" ? "zst" : format;
+    }
+
+    bool is_single_file_format(file_type::FileType type) {
+        return type == file_type::FileType::ARCHIVE_LZ4 || type == file_type::FileType::ARCHIVE_ZSTD;
+    }
+
+    // Seeded corpus from the generator, reused across invocations once complete.
+    fs::path ensure_generated_corpus(const fs::path& work_dir, size_t files, uint64_t seed) {
+        const std::string name = "gen-" + std::to_string(files) + "-s" + std::to_string(seed);
+        fs::path root = work_dir / name;
+        fs::path marker = work_dir / (name + ".complete");
+        if (fs::exists(marker)) return root;
+        fs::remove_all(root);
+
+        corpus::TreeOptions options;
+        options.seed = seed;
+        options.files = files;
+        options.compressibility = 0.7;
+        options.duplicate_ratio = 0.1;
+        corpus::generate_tree(root.string(), options);
+        std::ofstream(marker).put('\n');
+        return root;
+    }
+
+    class Runner {
+    public:
+        explicit Runner(const Config& config) : config_(config) {}
+
+        std::vector<Row> run() {
+            fs::create_directories(config_.work_dir);
+            std::vector<std::string> corpora = config_.corpora;
+            std::vector<size_t> generate = config_.generate;
+            if (corpora.empty() && generate.empty()) generate.push_back(256);
+            for (size_t files : generate) {
+                corpora.push_back(ensure_generated_corpus(config_.work_dir, files, config_.seed).string());
+            }
+
+            for (const auto& corpus : corpora) {
+                for (const auto& format : config_.formats) {
+                    for (int level : config_.levels) {
+                        for (int threads : config_.threads) {
+                            run_case(corpus, format, level, threads);
+                        }
+                    }
+                }
+            }
+            return rows_;
+        }
+
+    private:
+        const Config& config_;
+        std::vector<Row> rows_;
+
+        bool wants(const std::string& operation) const {
+            return std::find(config_.operations.begin(), config_.operations.end(), operation) != config_.operations.end();
+        }
+
+        Row base_row(const std::string& corpus, const std::string& format, int level, int threads) const {
+            Row row;
+            row.corpus = fs::path(corpus).filename().string();
+            if (row.corpus.empty()) row.corpus = corpus;
+            row.format = format;
+            row.level = level;
+            row.threads = threads;
+            return row;
+        }
+
+        // Times op() once per run; prepare() runs untimed before each run, after any cache drop.
+        template <typename Prepare, typename Op>
+        void measure(Row row, const std::string& operation, const fs::path& cold_input, Prepare prepare, Op op) {
+            row.operation = operation;
+            for (const auto& cache : config_.caches) {
+                Row result = row;
+                result.cache = cache;
+                std::vector<double> samples;
+                try {
+                    for (int run = 0; run < config_.runs; ++run) {
+                        prepare();
+                        if (cache == "cold") drop_page_cache(cold_input);
+                        bench::StdoutSilencer silence;
+                        samples.push_back(bench::time_ms(op));
+                    }
+                } catch (const std::exception& ex) {
+                    result.status = std::string("error: ") + ex.what();
+                }
+                result.summary = bench::summarize(samples);
+                rows_.push_back(result);
+            }
+        }
+
+        void skip(Row row, const std::string& status) {
+            for (const auto& operation : config_.operations) {
+                row.operation = operation;
+                row.status = status;
+                rows_.push_back(row);
+            }
+        }
+
+        void run_case(const std::string& corpus, const std::string& format, int level, int threads) {
+            Row row = base_row(corpus, format, level, threads);
+            file_type::FileType type = file_type::parse_format_string(format);
+            if (type == file_type::FileType::UNKNOWN) {
+                skip(row, "unknown format");
+                return;
+            }
+            if (is_single_file_format(type) && fs::is_directory(corpus)) {
+                skip(row, "unsupported: single-file format with directory corpus");
+                return;
+            }
+
+            args::Options options;
+            options.compression_level = level;
+            options.thread_count = threads;
+            progress::ProgressTracker tracker;
+
+            fs::path archive = fs::path(config_.work_dir) /
+                (row.corpus + "-l" + std::to_string(level) + "-t" + std::to_string(threads) + "." + archive_extension(format));
+            const uint64_t corpus_bytes = path_size(corpus);
+
+            auto compress_once = [&]() {
+                operation::compress(corpus, archive.string(), type, "", options, tracker);
+            };
+            auto remove_archive = [&]() {
+                std::error_code ec;
+                fs::remove(archive, ec);
+            };
+
+            // Build the archive once up front so later operations have input even when compress is not benchmarked.
+            try {
+                remove_archive();
+                bench::StdoutSilencer silence;
+                compress_once();
+            } catch (const error::HitpagException& ex) {
+                skip(row, ex.code() == error::ErrorCode::TOOL_NOT_FOUND ? "skipped: tool not available" : std::string("error: ") + ex.what());
+                return;
+            }
+
+            if (wants("compress")) {
+                Row compress_row = row;
+                compress_row.bytes_in = corpus_bytes;
+                measure(compress_row, "compress", corpus, remove_archive, compress_once);
+                const uint64_t compressed = path_size(archive);
+                for (size_t i = rows_.size() - config_.caches.size(); i < rows_.size(); ++i) rows_[i].bytes_out = compressed;
+            }
+            const uint64_t archive_bytes = path_size(archive);
+
+            if (wants("decompress")) {
+                fs::path out_dir = fs::path(config_.work_dir) / "extract";
+                Row decompress_row = row;
+                decompress_row.bytes_in = archive_bytes;
+                measure(decompress_row, "decompress", archive,
+                    [&]() { fs::remove_all(out_dir); },
+                    [&]() { operation::decompress(archive.string(), out_dir.string(), type, "", options, tracker); });
+                uint64_t extracted = path_size(out_dir);
+                for (size_t i = rows_.size() - config_.caches.size(); i < rows_.size(); ++i) rows_[i].bytes_out = extracted;
+                fs::remove_all(out_dir);
+            }
+
+            std::vector<tui::archive_ops::ArchiveEntry> entries;
+            if (wants("list") || wants("preview")) {
+                entries = tui::archive_ops::list_archive(archive.string(), type);
+            }
+
+            if (wants("list")) {
+                Row list_row = row;
+                list_row.bytes_in = archive_bytes;
+                list_row.bytes_out = entries.size();
+                measure(list_row, "list", archive, []() {},
+                    [&]() { tui::archive_ops::list_archive(archive.string(), type); });
+            }
+
+            if (wants("preview")) {
+                auto file_entry = std::find_if(entries.begin(), entries.end(),
+                    [](const tui::archive_ops::ArchiveEntry& entry) { return !entry.is_directory; });
+                Row preview_row = row;
+                preview_row.bytes_in = archive_bytes;
+                if (file_entry == entries.end()) {
+                    preview_row.operation = "preview";
+                    preview_row.status = "skipped: no file entries";
+                    rows_.push_back(preview_row);
+                } else {
+                    preview_row.bytes_out = file_entry->size;
+                    const std::string entry_path = file_entry->path;
+                    measure(preview_row, "preview", archive, []() {},
+                        [&]() { tui::archive_ops::extract_text(archive.string(), entry_path, type); });
+                }
+            }
+
+            if (wants("verify")) {
+                Row verify_row = row;
+                verify_row.bytes_in = archive_bytes;
+                measure(verify_row, "verify", archive, []() {},
+                    [&]() {
+                        if (!operation::verify_archive(archive.string(), type)) {
+                            throw std::runtime_error("verification failed");
+                        }
+                    });
+            }
+        }
+    };
+
+    std::string format_ms(double value) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3) << value;
+        return out.str();
+    }
+
+    std::string csv_field(const std::string& value) {
+        if (value.find_first_of(",\"\n") == std::string::npos) return value;
+        std::string quoted = "\"";
+        for (char c : value) {
+            if (c == '"') quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    std::string render_csv(const std::vector<Row>& rows) {
+        std::ostringstream out;
+        out << "corpus,format,level,threads,operation,cache,runs,min_ms,median_ms,p95_ms,max_ms,bytes_in,bytes_out,status\n";
+        for (const auto& row : rows) {
+            out << csv_field(row.corpus) << ',' << row.format << ',' << row.level << ',' << row.threads << ','
+                << row.operation << ',' << row.cache << ',' << row.summary.runs << ','
+                << format_ms(row.summary.min_ms) << ',' << format_ms(row.summary.median_ms) << ','
+                << format_ms(row.summary.p95_ms) << ',' << format_ms(row.summary.max_ms) << ','
+                << row.bytes_in << ',' << row.bytes_out << ',' << csv_field(row.status) << '\n';
+        }
+        return out.str();
+    }
+
+    std::string render_json(const std::vector<Row>& rows) {
+        std::ostringstream out;
+        out << "[\n";
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const Row& row = rows[i];
+            out << "  {\"corpus\":" << util::json_quote(row.corpus)
+                << ",\"format\":" << util::json_quote(row.format)
+                << ",\"level\":" << row.level
+                << ",\"threads\":" << row.threads
+                << ",\"operation\":" << util::json_quote(row.operation)
+                << ",\"cache\":" << util::json_quote(row.cache)
+                << ",\"runs\":" << row.summary.runs
+                << ",\"min_ms\":" << format_ms(row.summary.min_ms)
+                << ",\"median_ms\":" << format_ms(row.summary.median_ms)
+                << ",\"p95_ms\":" << format_ms(row.summary.p95_ms)
+                << ",\"max_ms\":" << format_ms(row.summary.max_ms)
+                << ",\"bytes_in\":" << row.bytes_in
+                << ",\"bytes_out\":" << row.bytes_out
+                << ",\"status\":" << util::json_quote(row.status) << '}'
+                << (i + 1 < rows.size() ? ",\n" : "\n");
+        }
+        out << "]\n";
+        return out.str();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Config config;
+    try {
+        if (!parse_config(argc, argv, config)) return 1;
+    } catch (const std::exception& ex) {
+        std::cerr << "Invalid option value: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    std::vector<Row> rows = Runner(config).run();
+    const std::string report = config.json ? render_json(rows) : render_csv(rows);
+
+    if (config.output.empty()) {
+        std::cout << report;
+    } else {
+        std::ofstream out(config.output, std::ios::trunc);
+        if (!out) {
+            std::cerr << "Cannot write " << config.output << std::endl;
+            return 1;
+        }
+        out << report;
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// hitpag_corpus - deterministic benchmark corpora and pathological archives.
+
+#include "corpus_gen.h"
+#include "include/error.h"
+#include "include/file_type.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+namespace {
+    void print_usage() {
+        std::cout
+            << "Usage:\n"
+            << "  hitpag_corpus tree DIR [options]\n"
+            << "      --seed=N               Generator seed (default 1)\n"
+            << "      --files=N              Number of files (default 1000)\n"
+            << "      --sizes=SPEC           fixed:SIZE | uniform:MIN:MAX | lognormal:MEDIAN[:SIGMA] (default lognormal:8K:1.5)\n"
+            << "      --compressibility=F    0 = random bytes, 1 = repetitive text (default 0.5)\n"
+            << "      --duplicates=F         Share of files repeating earlier content (default 0)\n"
+            << "      --sparse=F             Share of files written as one block plus a hole (default 0)\n"
+            << "      --depth=N              Maximum directory nesting (default 3)\n"
+            << "      --fanout=N             Subdirectories per level (default 8)\n"
+            << "  hitpag_corpus archive FILE --kind=KIND [options]\n"
+            << "      --kind=KIND            many-entries (2M) | huge-member (100G) | long-names\n"
+            << "      --format=FMT           zip, tar, tar.gz, tar.bz2, tar.xz, tar.zst, 7z, xar, lz4, zstd (default: from FILE's extension)\n"
+            << "      --entries=N            Override the member count\n"
+            << "      --member-size=SIZE     Override the member size (e.g. 100G)\n"
+            << "      --name-length=N        long-names: characters per path (default 4000)\n"
+            << "      --seed=N               Generator seed (default 1)\n"
+            << "Prints files, directories, bytes and a content digest; equal seeds give equal digests.\n";
+    }
+
+    bool take(const std::string& arg, const char* prefix, std::string& value) {
+        std::string p(prefix);
+        if (arg.rfind(p, 0) != 0) return false;
+        value = arg.substr(p.size());
+        return true;
+    }
+
+    void print_summary(const corpus::Summary& summary) {
+        std::printf("files=%zu directories=%zu bytes=%" PRIu64 " digest=%016" PRIx64 "\n",
+            summary.files, summary.directories, summary.bytes, summary.digest);
+    }
+
+    int run_tree(const std::string& root, int argc, char* argv[]) {
+        corpus::TreeOptions options;
+        for (int i = 3; i < argc; ++i) {
+            std::string arg = argv[i];
+            std::string value;
+            if (take(arg, "--seed=", value)) options.seed = std::stoull(value);
+            else if (take(arg, "--files=", value)) options.files = std::stoull(value);
+            else if (take(arg, "--sizes=", value)) options.sizes = corpus::SizeDistribution::parse(value);
+            else if (take(arg, "--compressibility=", value)) options.compressibility = std::stod(value);
+            else if (take(arg, "--duplicates=", value)) options.duplicate_ratio = std::stod(value);
+            else if (take(arg, "--sparse=", value)) options.sparse_ratio = std::stod(value);
+            else if (take(arg, "--depth=", value)) options.depth = std::stoull(value);
+            else if (take(arg, "--fanout=", value)) options.fanout = std::stoull(value);
+            else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                return 1;
+            }
+        }
+        print_summary(corpus::generate_tree(root, options));
+        return 0;
+    }
+
+    int run_archive(const std::string& output, int argc, char* argv[]) {
+        corpus::ArchiveOptions options;
+        options.format = file_type::recognize_by_extension(output);
+        bool have_kind = false;
+        for (int i = 3; i < argc; ++i) {
+            std::string arg = argv[i];
+            std::string value;
+            if (take(arg, "--kind=", value)) {
+                if (!corpus::parse_pathology(value, options.kind)) {
+                    std::cerr << "Unknown kind: " << value << std::endl;
+                    return 1;
+                }
+                have_kind = true;
+            } else if (take(arg, "--format=", value)) {
+                options.format = file_type::parse_format_string(value);
+                if (options.format == file_type::FileType::UNKNOWN) {
+                    std::cerr << "Unknown format: " << value << std::endl;
+                    return 1;
+                }
+            } else if (take(arg, "--entries=", value)) {
+                options.entries = std::stoull(value);
+            } else if (take(arg, "--member-size=", value)) {
+                options.member_size = corpus::parse_size(value);
+            } else if (take(arg, "--name-length=", value)) {
+                options.name_length = std::stoull(value);
+            } else if (take(arg, "--seed=", value)) {
+                options.seed = std::stoull(value);
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                return 1;
+            }
+        }
+        if (!have_kind) {
+            std::cerr << "archive requires --kind" << std::endl;
+            return 1;
+        }
+        if (options.format == file_type::FileType::UNKNOWN) {
+            std::cerr << "Cannot tell the format from " << output << "; pass --format" << std::endl;
+            return 1;
+        }
+        print_summary(corpus::generate_archive(output, options));
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        print_usage();
+        return argc == 2 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help") ? 0 : 1;
+    }
+
+    const std::string mode = argv[1];
+    try {
+        if (mode == "tree") return run_tree(argv[2], argc, argv);
+        if (mode == "archive") return run_archive(argv[2], argc, argv);
+    } catch (const error::HitpagException& ex) {
+        std::cerr << ex.what() << std::endl;
+        return 2;
+    } catch (const std::exception& ex) {
+        std::cerr << "hitpag_corpus: " << ex.what() << std::endl;
+        return 2;
+    }
+
+    print_usage();
+    return 1;
+}
@@ -0,0 +1,309 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// hitpag_microbench - per-entry hot paths on synthetic inputs, with no external tools or terminal.
+// Exits non-zero when a routine's per-entry cost grows by more than --max-ratio between the
+// smallest and largest size, which is how accidental quadratic behaviour shows up in ctest.
+
+#include "bench_stats.h"
+#include "include/file_filter.h"
+#include "include/file_type.h"
+#include "include/tui_archive_list.h"
+#include "include/tui_archive_ops.h"
+#include "include/tui_preview.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using tui::archive_ops::ArchiveEntry;
+
+namespace {
+    struct Config {
+        std::vector<size_t> sizes = {1000, 100000, 2000000};
+        int reps = 3;
+        double max_ratio = 25.0;
+    };
+
+    struct Routine {
+        std::string name;
+        // Builds the input for n entries (untimed) and returns the operation to time.
+        std::function<std::function<void()>(size_t n)> prepare;
+    };
+
+    struct Measurement {
+        std::string routine;
+        size_t entries = 0;
+        bench::Summary summary;
+
+        double ns_per_entry() const {
+            return entries == 0 ? 0.0 : summary.median_ms * 1e6 / static_cast<double>(entries);
+        }
+    };
+
+    std::string entry_path(size_t i) {
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "src%02zu/mod%02zu/file%07zu.txt", i % 64, (i / 64) % 32, i);
+        return buffer;
+    }
+
+    std::vector<ArchiveEntry> make_entries(size_t n) {
+        std::vector<ArchiveEntry> entries;
+        entries.reserve(n + 64);
+        for (size_t dir = 0; dir < std::min<size_t>(64, n); ++dir) {
+            ArchiveEntry entry;
+            char buffer[16];
+            std::snprintf(buffer, sizeof(buffer), "src%02zu", dir);
+            entry.path = buffer;
+            entry.is_directory = true;
+            entries.push_back(entry);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            ArchiveEntry entry;
+            entry.path = entry_path(i);
+            entry.size = (i * 7919) % 100000;
+            entries.push_back(std::move(entry));
+        }
+        return entries;
+    }
+
+    std::string make_tar_listing(size_t n) {
+        std::string output;
+        output.reserve(n * 32);
+        for (size_t i = 0; i < n; ++i) {
+            output += entry_path(i);
+            output += '\n';
+        }
+        return output;
+    }
+
+    std::string make_7z_listing(size_t n) {
+        std::string output = "\n7-Zip 16.02\n\nListing archive: bench.7z\n\n--\nPath = bench.7z\nType = 7z\n\n----------\n";
+        output.reserve(n * 150);
+        for (size_t i = 0; i < n; ++i) {
+            char buffer[256];
+            std::snprintf(buffer, sizeof(buffer),
+                "Path = %s\nSize = %zu\nPacked Size = %zu\nModified = 2024-01-01 12:00:00\n"
+                "Attributes = A\nCRC = %08zX\nEncrypted = -\nMethod = LZMA2:24\nBlock = 0\n\n",
+                entry_path(i).c_str(), (i * 7919) % 100000, (i * 3571) % 50000, (i * 2654435761u) & 0xffffffffu);
+            output += buffer;
+        }
+        return output;
+    }
+
+    std::string make_unzip_listing(size_t n) {
+        std::string output =
+            "Archive:  bench.zip\n"
+            " Length   Method    Size  Cmpr    Date    Time   CRC-32   Name\n"
+            "--------  ------  ------- ---- ---------- ----- --------  ----\n";
+        output.reserve(n * 90);
+        for (size_t i = 0; i < n; ++i) {
+            char buffer[256];
+            std::snprintf(buffer, sizeof(buffer), "%8zu  Defl:N %8zu  50%% 2024-01-01 12:00 %08zx  %s\n",
+                (i * 7919) % 100000, (i * 3571) % 50000, (i * 2654435761u) & 0xffffffffu, entry_path(i).c_str());
+            output += buffer;
+        }
+        output += "--------          -------  ---                            -------\n";
+        return output;
+    }
+
+    std::string make_text(size_t bytes) {
+        static const std::string words = "the quick brown fox jumps over the lazy dog while archives are listed ";
+        std::string text;
+        text.reserve(bytes);
+        size_t column = 0;
+        while (text.size() < bytes) {
+            text += words[text.size() % words.size()];
+            if (++column == 150) {
+                text += '\n';
+                column = 0;
+            }
+        }
+        return text;
+    }
+
+    // A handful of headers recognize_by_header distinguishes, cycled through n times.
+    std::vector<std::string> make_header_samples(const fs::path& dir) {
+        fs::create_directories(dir);
+        const std::vector<std::pair<std::string, std::string>> samples = {
+            {"sample.zip", std::string("PK\x03\x04\x14\x00\x00\x00", 8)},
+            {"sample.gz", std::string("\x1f\x8b\x08\x00\x00\x00\x00\x00", 8)},
+            {"sample.7z", std::string("7z\xbc\xaf\x27\x1c\x00\x04", 8)},
+            {"sample.xz", std::string("\xfd" "7zXZ\x00\x00\x04", 8)},
+            {"sample.bz2", "BZh91AY&SY"},
+            {"sample.rar", std::string("Rar!\x1a\x07\x01\x00", 8)},
+            {"sample.txt", "plain text\nwith lines\n"},
+            {"sample.bin", std::string("\x00\x01\x02\x03\x04\x05\x06\x07", 8)},
+        };
+        std::vector<std::string> paths;
+        for (const auto& [name, header] : samples) {
+            fs::path path = dir / name;
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out << header << std::string(512, '\0');
+            paths.push_back(path.string());
+        }
+        return paths;
+    }
+
+    std::vector<Routine> make_routines(const fs::path& work_dir) {
+        std::vector<Routine> routines;
+
+        routines.push_back({"apply_filter/search", [](size_t n) -> std::function<void()> {
+            auto list = std::make_shared<tui::ArchiveList>();
+            list->set_entries("bench.zip", file_type::FileType::ARCHIVE_ZIP, make_entries(n));
+            return [list]() { list->set_search_query("file00042"); };
+        }});
+
+        routines.push_back({"apply_filter/browse", [](size_t n) -> std::function<void()> {
+            auto list = std::make_shared<tui::ArchiveList>();
+            list->set_entries("bench.zip", file_type::FileType::ARCHIVE_ZIP, make_entries(n));
+            return [list]() { list->set_search_query(""); };
+        }});
+
+        // The selected row at the root is a directory, so selected_entry() sums its subtree.
+        routines.push_back({"calculate_directory_size", [](size_t n) -> std::function<void()> {
+            auto list = std::make_shared<tui::ArchiveList>();
+            list->set_entries("bench.zip", file_type::FileType::ARCHIVE_ZIP, make_entries(n));
+            return [list]() { list->selected_entry(); };
+        }});
+
+        routines.push_back({"parse_tar_listing", [](size_t n) -> std::function<void()> {
+            auto output = std::make_shared<std::string>(make_tar_listing(n));
+            return [output]() { tui::archive_ops::parse_tar_listing(*output); };
+        }});
+
+        routines.push_back({"parse_7z_listing", [](size_t n) -> std::function<void()> {
+            auto output = std::make_shared<std::string>(make_7z_listing(n));
+            return [output]() { tui::archive_ops::parse_7z_listing(*output); };
+        }});
+
+        routines.push_back({"parse_unzip_listing", [](size_t n) -> std::function<void()> {
+            auto output = std::make_shared<std::string>(make_unzip_listing(n));
+            return [output]() { tui::archive_ops::parse_unzip_listing(*output); };
+        }});
+
+        routines.push_back({"recognize_by_header", [work_dir](size_t n) -> std::function<void()> {
+            auto samples = std::make_shared<std::vector<std::string>>(make_header_samples(work_dir / "headers"));
+            return [samples, n]() {
+                for (size_t i = 0; i < n; ++i) file_type::recognize_by_header((*samples)[i % samples->size()]);
+            };
+        }});
+
+        routines.push_back({"is_text_content", [](size_t n) -> std::function<void()> {
+            auto content = std::make_shared<std::string>(make_text(n));
+            return [content]() { tui::archive_ops::is_text_content(*content); };
+        }});
+
+        routines.push_back({"matches_pattern", [](size_t n) -> std::function<void()> {
+            auto names = std::make_shared<std::vector<std::string>>();
+            names->reserve(n);
+            for (size_t i = 0; i < n; ++i) names->push_back(entry_path(i));
+            return [names]() {
+                for (const auto& name : *names) file_filter::matches_pattern(name, ".*\\.txt");
+            };
+        }});
+
+        routines.push_back({"preview_wrap", [](size_t n) -> std::function<void()> {
+            auto panel = std::make_shared<tui::PreviewPanel>();
+            auto content = std::make_shared<std::string>(make_text(n));
+            return [panel, content]() {
+                panel->show_content("bench.txt", *content);
+                panel->wrapped_line_count();
+            };
+        }});
+
+        return routines;
+    }
+
+    std::vector<size_t> parse_sizes(const std::string& value) {
+        std::vector<size_t> sizes;
+        std::stringstream stream(value);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            if (!item.empty()) sizes.push_back(static_cast<size_t>(std::stoull(item)));
+        }
+        std::sort(sizes.begin(), sizes.end());
+        return sizes;
+    }
+
+    bool parse_config(int argc, char* argv[], Config& config, std::string& only) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind("--sizes=", 0) == 0) {
+                config.sizes = parse_sizes(arg.substr(8));
+            } else if (arg.rfind("--reps=", 0) == 0) {
+                config.reps = std::max(1, std::stoi(arg.substr(7)));
+            } else if (arg.rfind("--max-ratio=", 0) == 0) {
+                config.max_ratio = std::stod(arg.substr(12));
+            } else if (arg.rfind("--only=", 0) == 0) {
+                only = arg.substr(7);
+            } else {
+                std::cerr << "Usage: hitpag_microbench [--sizes=1000,100000,2000000] [--reps=N] [--max-ratio=X] [--only=ROUTINE]\n";
+                return false;
+            }
+        }
+        return !config.sizes.empty();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Config config;
+    std::string only;
+    try {
+        if (!parse_config(argc, argv, config, only)) return 1;
+    } catch (const std::exception& ex) {
+        std::cerr << "Invalid option value: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    fs::path work_dir = fs::temp_directory_path() / "hitpag_microbench";
+
+    std::cout << std::left << std::setw(28) << "routine" << std::right << std::setw(10) << "entries"
+              << std::setw(14) << "median_ms" << std::setw(14) << "p95_ms" << std::setw(14) << "ns/entry" << '\n';
+
+    bool regression = false;
+    for (const auto& routine : make_routines(work_dir)) {
+        if (!only.empty() && routine.name != only) continue;
+
+        std::vector<Measurement> series;
+        for (size_t n : config.sizes) {
+            std::function<void()> op = routine.prepare(n);
+            op();  // warm-up: first-touch allocations and i18n tables
+            std::vector<double> samples;
+            for (int rep = 0; rep < config.reps; ++rep) samples.push_back(bench::time_ms(op));
+
+            Measurement m{routine.name, n, bench::summarize(samples)};
+            std::cout << std::left << std::setw(28) << m.routine << std::right << std::setw(10) << n
+                      << std::fixed << std::setprecision(3)
+                      << std::setw(14) << m.summary.median_ms << std::setw(14) << m.summary.p95_ms
+                      << std::setprecision(1) << std::setw(14) << m.ns_per_entry() << '\n';
+            series.push_back(m);
+        }
+
+        if (series.size() >= 2 && series.front().ns_per_entry() > 0.0) {
+            double ratio = series.back().ns_per_entry() / series.front().ns_per_entry();
+            if (ratio > config.max_ratio) {
+                std::cout << "SCALING REGRESSION: " << routine.name << " per-entry cost grew "
+                          << std::setprecision(1) << ratio << "x from " << series.front().entries
+                          << " to " << series.back().entries << " entries (limit " << config.max_ratio << "x)\n";
+                regression = true;
+            }
+        }
+    }
+
+    std::error_code ec;
+    fs::remove_all(work_dir, ec);
+    return regression ? 1 : 0;
+}
@@ -0,0 +1,452 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// hitpag_tui_bench - replays a keystroke script against the TUI models without a terminal.
+// Every event is handled the way tui::run handles it in browse, search and preview focus, then
+// a full frame is rendered to an off-screen ftxui::Screen and serialized; the latency of that
+// whole step is one sample for the event's kind.
+
+#include "bench_stats.h"
+#include "corpus_gen.h"
+#include "include/error.h"
+#include "include/file_type.h"
+#include "include/i18n.h"
+#include "include/operation.h"
+#include "include/tui_archive_list.h"
+#include "include/tui_archive_ops.h"
+#include "include/tui_details.h"
+#include "include/tui_preview_model.h"
+#include "include/util.h"
+
+#include <ftxui/component/component.hpp>
+#include <ftxui/component/event.hpp>
+#include <ftxui/dom/elements.hpp>
+#include <ftxui/screen/screen.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace ftxui;
+using tui::ArchiveList;
+using tui::DetailsPanel;
+using tui::PreviewModel;
+using tui::PreviewPanel;
+
+namespace {
+    constexpr int kFileListWidth = 44;
+
+    const char* const DEFAULT_SCRIPT =
+        "down*5 enter down*50 pgdn*10 x enter down*20 enter pgup*3 left "
+        "/f00012 down*10 enter / pgdn*5 end home left";
+
+    struct Config {
+        std::string archive;
+        size_t generate = 20000;
+        std::string script = DEFAULT_SCRIPT;
+        std::string work_dir = "/tmp/hitpag_tui_bench";
+        int width = 160;
+        int height = 48;
+        bool json = false;
+    };
+
+    // One scripted keystroke; kind groups the samples in the report.
+    struct Step {
+        Event event;
+        std::string kind;
+    };
+
+    void print_usage() {
+        std::cout << "Usage: hitpag_tui_bench [ARCHIVE] [options]\n"
+                  << "  --generate=N         Without ARCHIVE, list a generated N-entry zip (default 20000)\n"
+                  << "  --script=KEYS        Keystroke script (default: a browse/search/extract tour)\n"
+                  << "  --script-file=PATH   Read the script from a file\n"
+                  << "  --size=WxH           Off-screen terminal size (default 160x48)\n"
+                  << "  --work-dir=DIR       Scratch directory (default /tmp/hitpag_tui_bench)\n"
+                  << "  --json               Emit JSON instead of a table\n"
+                  << "Script tokens, optionally repeated with *N: up down pgup pgdn home end enter left\n"
+                  << "right tab, /TEXT (open search, type TEXT, apply; \"/\" alone clears), x (extract).\n";
+    }
+
+    bool take(const std::string& arg, const char* prefix, std::string& value) {
+        std::string p(prefix);
+        if (arg.rfind(p, 0) != 0) return false;
+        value = arg.substr(p.size());
+        return true;
+    }
+
+    bool parse_args(int argc, char* argv[], Config& config) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            std::string value;
+            if (arg == "-h" || arg == "--help") {
+                print_usage();
+                std::exit(0);
+            } else if (take(arg, "--generate=", value)) {
+                config.generate = std::stoull(value);
+            } else if (take(arg, "--script=", value)) {
+                config.script = value;
+            } else if (take(arg, "--script-file=", value)) {
+                std::ifstream input(value);
+                if (!input) {
+                    std::cerr << "Cannot read script: " << value << std::endl;
+                    return false;
+                }
+                std::ostringstream text;
+                text << input.rdbuf();
+                config.script = text.str();
+            } else if (take(arg, "--size=", value)) {
+                if (std::sscanf(value.c_str(), "%dx%d", &config.width, &config.height) != 2 ||
+                    config.width < 40 || config.height < 10) {
+                    std::cerr << "Invalid size: " << value << std::endl;
+                    return false;
+                }
+            } else if (take(arg, "--work-dir=", value)) {
+                config.work_dir = value;
+            } else if (arg == "--json") {
+                config.json = true;
+            } else if (!arg.empty() && arg[0] != '-' && config.archive.empty()) {
+                config.archive = arg;
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool parse_script(const std::string& script, std::vector<Step>& steps) {
+        static const std::map<std::string, Event> keys = {
+            {"up", Event::ArrowUp}, {"down", Event::ArrowDown},
+            {"left", Event::ArrowLeft}, {"right", Event::ArrowRight},
+            {"pgup", Event::PageUp}, {"pgdn", Event::PageDown},
+            {"home", Event::Home}, {"end", Event::End},
+            {"enter", Event::Return}, {"tab", Event::Tab},
+        };
+
+        std::istringstream tokens(script);
+        std::string token;
+        while (tokens >> token) {
+            size_t repeat = 1;
+            size_t star = token.rfind('*');
+            if (star != std::string::npos && star > 0 && token[0] != '/') {
+                try {
+                    repeat = std::stoull(token.substr(star + 1));
+                } catch (const std::exception&) {
+                    std::cerr << "Invalid repeat count: " << token << std::endl;
+                    return false;
+                }
+                token.resize(star);
+            }
+
+            for (size_t r = 0; r < repeat; ++r) {
+                if (token[0] == '/') {
+                    steps.push_back({Event::Character('/'), "search_open"});
+                    for (size_t i = 1; i < token.size(); ++i) {
+                        steps.push_back({Event::Character(token[i]), "search_type"});
+                    }
+                    steps.push_back({Event::Return, "search_apply"});
+                } else if (token == "x") {
+                    steps.push_back({Event::Character('x'), "extract_open"});
+                    steps.push_back({Event::Return, "extract_run"});
+                } else if (keys.count(token)) {
+                    steps.push_back({keys.at(token), token});
+                } else {
+                    std::cerr << "Unknown script token: " << token << std::endl;
+                    return false;
+                }
+            }
+        }
+        return !steps.empty();
+    }
+
+    // The subset of tui::run that the script can reach: no modals, editor or quit keys.
+    class Session {
+    public:
+        Session(const std::string& archive_path, file_type::FileType type, const std::string& extract_dir)
+            : archive_path_(archive_path), type_(type), extract_dir_(extract_dir) {
+            search_input_comp_ = Input(&search_input_, "");
+        }
+
+        ArchiveList& list() { return list_; }
+
+        void sync_preview() {
+            preview_model_.sync_selection(list_.selected_entry(), list_.entries(), archive_path_, type_, "");
+        }
+
+        void handle(const Event& event) {
+            PreviewPanel& preview = preview_model_.panel();
+
+            if (mode_ == Mode::Search) {
+                if (event == Event::Escape) {
+                    mode_ = Mode::Browse;
+                    list_.set_search_query("");
+                    sync_preview();
+                } else if (event == Event::Return) {
+                    list_.set_search_query(search_input_);
+                    mode_ = Mode::Browse;
+                    sync_preview();
+                } else {
+                    search_input_comp_->OnEvent(event);
+                }
+                return;
+            }
+
+            if (mode_ == Mode::ExtractDialog) {
+                if (event == Event::Return) {
+                    mode_ = Mode::Browse;
+                    bench::StdoutSilencer silence;
+                    fs::create_directories(extract_dir_);
+                    tui::archive_ops::extract_single(archive_path_, extract_entry_, extract_dir_, type_, "");
+                } else if (event == Event::Escape) {
+                    mode_ = Mode::Browse;
+                }
+                return;
+            }
+
+            if (preview_focus_ && !preview.is_directory_view()) {
+                if (event == Event::Return || event == Event::ArrowLeft) preview_focus_ = false;
+                else if (event == Event::ArrowUp) preview.scroll_up();
+                else if (event == Event::ArrowDown) preview.scroll_down();
+                else if (event == Event::PageUp) preview.page_up();
+                else if (event == Event::ArrowRight || event == Event::PageDown) preview.page_down();
+                else if (event == Event::Home) preview.scroll_to_top();
+                else if (event == Event::End) preview.scroll_to_bottom();
+                return;
+            }
+            preview_focus_ = false;
+
+            if (event == Event::Character('/')) {
+                mode_ = Mode::Search;
+                search_input_ = list_.search_query();
+                return;
+            }
+            if (event == Event::Tab) {
+                preview_focus_ = true;
+                return;
+            }
+            if (event == Event::Character('x')) {
+                const auto* entry = list_.selected_entry();
+                if (entry && !entry->is_directory) {
+                    extract_entry_ = entry->path;
+                    mode_ = Mode::ExtractDialog;
+                }
+                return;
+            }
+            if (event == Event::ArrowRight || event == Event::Return) {
+                const auto* entry = list_.selected_entry();
+                if (entry && entry->is_directory && list_.enter_selected()) {
+                    sync_preview();
+                    return;
+                }
+                if (entry && !entry->is_directory) {
+                    preview_focus_ = true;
+                    return;
+                }
+            }
+            if (event == Event::ArrowLeft || event == Event::Backspace) {
+                if (list_.go_parent()) {
+                    sync_preview();
+                    return;
+                }
+            }
+            if (list_.component()->OnEvent(event)) {
+                sync_preview();
+            }
+        }
+
+        // Mirrors main_renderer's layout so the element tree has the same shape and cost.
+        Element frame() {
+            Elements left_panel;
+            std::string left_title = i18n::get("tui_file_list");
+            if (!list_.current_directory().empty()) {
+                left_title += ": /" + list_.current_directory();
+            }
+            left_panel.push_back(text(left_title) | bold | color(Color::Blue));
+            left_panel.push_back(separator() | color(Color::Blue));
+            left_panel.push_back(list_.component()->Render() | flex);
+
+            Elements right_panel;
+            const auto* entry = list_.selected_entry();
+            if (entry) {
+                details_.set_entry(entry);
+                right_panel.push_back(details_.render());
+                right_panel.push_back(separator() | color(Color::White));
+                right_panel.push_back(text(i18n::get("tui_preview")) | bold | color(Color::White));
+                right_panel.push_back(preview_model_.panel().render() | flex);
+            } else {
+                right_panel.push_back((text(i18n::get("tui_no_file_selected")) | dim | border) | flex);
+            }
+
+            Elements status_items;
+            if (mode_ == Mode::Search) {
+                status_items.push_back(hbox({text(i18n::get("tui_search_prompt") + " ") | bold, search_input_comp_->Render()}));
+            } else {
+                status_items.push_back(text(i18n::get("tui_list_shortcut_hint")) | dim);
+            }
+            status_items.push_back(separator());
+            status_items.push_back(hbox({
+                text(i18n::get("tui_title")) | bold | bgcolor(Color::Blue),
+                filler() | bgcolor(Color::Blue),
+                text(archive_path_) | dim | bgcolor(Color::Blue),
+            }));
+
+            return vbox({
+                hbox({
+                    vbox(left_panel) | size(WIDTH, EQUAL, kFileListWidth) | (preview_focus_ ? borderLight : border),
+                    vbox(right_panel) | flex | (preview_focus_ ? border : borderLight),
+                }) | flex,
+                vbox(status_items),
+            });
+        }
+
+    private:
+        enum class Mode { Browse, Search, ExtractDialog };
+
+        std::string archive_path_;
+        file_type::FileType type_;
+        fs::path extract_dir_;
+        ArchiveList list_;
+        PreviewModel preview_model_;
+        DetailsPanel details_;
+        std::string search_input_;
+        Component search_input_comp_;
+        std::string extract_entry_;
+        Mode mode_ = Mode::Browse;
+        bool preview_focus_ = false;
+    };
+
+    struct Row {
+        std::string kind;
+        bench::Summary summary;
+    };
+
+    void print_table(const std::string& archive, size_t entries, double load_ms, const std::vector<Row>& rows) {
+        std::cout << "archive: " << archive << " (" << entries << " entries, listed in "
+                  << std::fixed << std::setprecision(1) << load_ms << " ms)\n";
+        std::cout << std::left << std::setw(14) << "event" << std::right
+                  << std::setw(8) << "count" << std::setw(12) << "p50_ms"
+                  << std::setw(12) << "p99_ms" << std::setw(12) << "max_ms" << "\n";
+        std::cout << std::setprecision(3);
+        for (const auto& row : rows) {
+            std::cout << std::left << std::setw(14) << row.kind << std::right
+                      << std::setw(8) << row.summary.runs
+                      << std::setw(12) << row.summary.median_ms
+                      << std::setw(12) << row.summary.p99_ms
+                      << std::setw(12) << row.summary.max_ms << "\n";
+        }
+    }
+
+    void print_json(const std::string& archive, size_t entries, double load_ms, const std::vector<Row>& rows) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3);
+        out << "{\"archive\":" << util::json_quote(archive)
+            << ",\"entries\":" << entries
+            << ",\"load_ms\":" << load_ms
+            << ",\"events\":[\n";
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const auto& row = rows[i];
+            out << "  {\"kind\":" << util::json_quote(row.kind)
+                << ",\"count\":" << row.summary.runs
+                << ",\"p50_ms\":" << row.summary.median_ms
+                << ",\"p99_ms\":" << row.summary.p99_ms
+                << ",\"max_ms\":" << row.summary.max_ms << '}'
+                << (i + 1 < rows.size() ? ",\n" : "\n");
+        }
+        out << "]}\n";
+        std::cout << out.str();
+    }
+
+    int run(const Config& config) {
+        std::vector<Step> steps;
+        if (!parse_script(config.script, steps)) {
+            std::cerr << "Empty or invalid script" << std::endl;
+            return 1;
+        }
+
+        fs::create_directories(config.work_dir);
+        std::string archive = config.archive;
+        if (archive.empty()) {
+            if (!operation::is_tool_available("unzip")) {
+                std::cout << "skipped: unzip not available" << std::endl;
+                return 0;
+            }
+            corpus::ArchiveOptions options;
+            options.kind = corpus::Pathology::ManyEntries;
+            options.format = file_type::FileType::ARCHIVE_ZIP;
+            options.entries = config.generate;
+            options.member_size = 4096;
+            archive = (fs::path(config.work_dir) / ("tui-" + std::to_string(config.generate) + ".zip")).string();
+            if (!fs::exists(archive)) corpus::generate_archive(archive, options);
+        }
+
+        file_type::FileType type = file_type::recognize_by_header(archive);
+        if (type == file_type::FileType::UNKNOWN) type = file_type::recognize_by_extension(archive);
+
+        Session session(archive, type, (fs::path(config.work_dir) / "extract").string());
+        double load_ms = bench::time_ms([&]() {
+            session.list().load(archive, type);
+            session.sync_preview();
+        });
+
+        auto screen = Screen::Create(Dimension::Fixed(config.width), Dimension::Fixed(config.height));
+        auto draw = [&]() {
+            Render(screen, session.frame());
+            return screen.ToString().size();
+        };
+        draw();
+
+        std::map<std::string, std::vector<double>> samples;
+        std::vector<std::string> order;
+        std::vector<double> all;
+        for (const auto& step : steps) {
+            double ms = bench::time_ms([&]() {
+                session.handle(step.event);
+                draw();
+            });
+            if (!samples.count(step.kind)) order.push_back(step.kind);
+            samples[step.kind].push_back(ms);
+            all.push_back(ms);
+        }
+
+        std::vector<Row> rows;
+        for (const auto& kind : order) rows.push_back({kind, bench::summarize(samples[kind])});
+        rows.push_back({"all", bench::summarize(all)});
+
+        size_t entries = session.list().entries().size();
+        if (config.json) print_json(archive, entries, load_ms, rows);
+        else print_table(archive, entries, load_ms, rows);
+
+        std::error_code ec;
+        fs::remove_all(fs::path(config.work_dir) / "extract", ec);
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Config config;
+    if (!parse_args(argc, argv, config)) {
+        print_usage();
+        return 1;
+    }
+
+    try {
+        return run(config);
+    } catch (const error::HitpagException& ex) {
+        std::cerr << ex.what() << std::endl;
+        return 2;
+    } catch (const std::exception& ex) {
+        std::cerr << "hitpag_tui_bench: " << ex.what() << std::endl;
+        return 2;
+    }
+}
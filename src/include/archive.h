@@ -0,0 +1,106 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include "include/archive_entry.h"
+#include "include/file_type.h"
+#include "include/progress.h"
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// In-process archive API of hitpag_core. Nothing here writes to stdout or stderr; failures are
+// reported as error::HitpagException and progress through progress::Callback.
+namespace archive {
+    class ArchiveReader {
+    public:
+        // Detects the format from the file header, then the extension.
+        explicit ArchiveReader(const std::string& path, const std::string& password = "");
+        ArchiveReader(const std::string& path, file_type::FileType type, const std::string& password = "");
+
+        const std::string& path() const { return path_; }
+        file_type::FileType type() const { return type_; }
+
+        // Listed on first use and kept for the reader's lifetime.
+        const std::vector<Entry>& entries();
+        const Entry* find(const std::string& entry_path);
+        // Stops early when visit returns false.
+        void for_each(const std::function<bool(const Entry&)>& visit);
+
+        std::string read(const std::string& entry_path);
+        // Copies up to size bytes starting at offset; returns the number of bytes copied. Seeks
+        // straight to offset when a backend supports it, otherwise decodes and skips.
+        size_t read(const std::string& entry_path, uint64_t offset, char* buffer, size_t size);
+        void read_stream(const std::string& entry_path, const StreamSink& sink);
+
+        void extract(const std::string& entry_path, const std::string& output_dir);
+        void extract_all(const std::string& output_dir, const progress::Callback& on_progress = {});
+        bool verify();
+
+    private:
+        std::string path_;
+        file_type::FileType type_;
+        std::string password_;
+        std::vector<Entry> entries_;
+        bool listed_ = false;
+    };
+
+    struct WriterOptions {
+        int compression_level = 0;
+        int thread_count = 0;
+        std::string password;
+        bool verify = false;
+    };
+
+    // A staging shim rather than a streaming writer: every entry is hard-linked or copied at full
+    // size into a private directory under temp_directory_path(), and finish() hands that tree to
+    // the same compression path as the CLI. Callers need that much free temporary space.
+    class ArchiveWriter {
+    public:
+        class EntryStream {
+        public:
+            void write(const char* data, size_t size);
+            void write(const std::string& data) { write(data.data(), data.size()); }
+            void close();
+
+        private:
+            friend class ArchiveWriter;
+            EntryStream(std::string path, std::ofstream output) : path_(std::move(path)), output_(std::move(output)) {}
+
+            std::string path_;
+            std::ofstream output_;
+        };
+
+        // The format comes from the target's extension unless given.
+        explicit ArchiveWriter(const std::string& path, WriterOptions options = {});
+        ArchiveWriter(const std::string& path, file_type::FileType format, WriterOptions options = {});
+        ~ArchiveWriter();
+
+        ArchiveWriter(const ArchiveWriter&) = delete;
+        ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+
+        void add_file(const std::string& source_path, const std::string& entry_path);
+        void add_directory(const std::string& source_path, const std::string& entry_path);
+        void add_data(const std::string& entry_path, const std::string& data);
+        EntryStream open_entry(const std::string& entry_path);
+
+        void finish(const progress::Callback& on_progress = {});
+
+    private:
+        std::string staged_path(const std::string& entry_path) const;
+
+        std::string path_;
+        file_type::FileType format_;
+        WriterOptions options_;
+        std::string staging_dir_;
+        bool finished_ = false;
+    };
+}
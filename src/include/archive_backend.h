@@ -0,0 +1,165 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include "include/file_type.h"
+#include "include/tui_archive_ops.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Every format operation goes through an ArchiveBackend. Backends declare which operations
+// they cover for which formats and what a call is expected to cost; the registry picks the
+// cheapest available one and corrects its estimates with the times it observes.
+namespace backend {
+    using tui::archive_ops::ArchiveEntry;
+    using tui::archive_ops::StreamSink;
+
+    enum class Operation {
+        List,
+        ReadEntry,
+        // Reading an entry from an offset without decoding what precedes it.
+        Seek,
+        ExtractEntry,
+        Extract,
+        Create,
+        Verify,
+    };
+
+    const char* operation_name(Operation op);
+
+    // Expected wall time of one call: fixed start-up plus a rate over the archive's bytes.
+    struct Cost {
+        double startup_ms = 0.0;
+        double ms_per_mib = 0.0;
+
+        double estimate(uint64_t bytes) const;
+    };
+
+    struct Capability {
+        Operation operation;
+        file_type::FileType format;
+        Cost cost;
+    };
+
+    struct Archive {
+        std::string path;
+        file_type::FileType format = file_type::FileType::UNKNOWN;
+        std::string password;
+    };
+
+    // Runs an external tool for whole-archive jobs so the caller can attach live progress
+    // and trace spans; returns the exit code.
+    using ToolRunner = std::function<int(const std::string& tool, const std::vector<std::string>& args, const std::string& working_dir)>;
+
+    struct JobContext {
+        ToolRunner run_tool;
+        std::function<void(const std::string&)> report;
+        // Bytes read and written by backends that decode in-process, for live progress.
+        std::function<void(uint64_t in, uint64_t out)> advance;
+        bool verbose = false;
+        int compression_level = 0;
+        // Threads an in-process backend may use; 0 lets it use the whole executor.
+        int thread_count = 0;
+    };
+
+    struct CreateJob {
+        std::string target;
+        std::string working_dir;
+        // Paths relative to working_dir, as they should appear in the archive.
+        std::vector<std::string> items;
+        // Absolute paths of the same sources, for single-file formats.
+        std::vector<std::string> sources;
+    };
+
+    // Operations a backend does not declare are never dispatched to it; the defaults fail.
+    class ArchiveBackend {
+    public:
+        virtual ~ArchiveBackend() = default;
+
+        virtual std::string name() const = 0;
+        virtual std::vector<Capability> capabilities() const = 0;
+        // False while a tool the backend needs is not installed.
+        virtual bool available() const { return true; }
+        // Lets a backend turn down individual archives of a format it declares.
+        virtual bool accepts(Operation, const Archive&) const { return true; }
+
+        virtual std::vector<ArchiveEntry> list(const Archive& archive);
+        // An empty list() is also what a failure returns; this confirms the archive is intact
+        // and really holds no entries.
+        virtual bool empty(const Archive& archive);
+        virtual bool read_entry(const Archive& archive, const std::string& entry, const StreamSink& sink);
+        virtual bool read_at(const Archive& archive, const std::string& entry, uint64_t offset, char* buffer, size_t size, size_t& copied);
+        virtual bool extract_entry(const Archive& archive, const std::string& entry, const std::string& output_dir);
+        virtual int extract(const Archive& archive, const std::string& target_dir, const JobContext& context);
+        virtual int create(const Archive& target, const CreateJob& job, const JobContext& context);
+        virtual int verify(const Archive& archive, const JobContext& context);
+    };
+
+    class Registry {
+    public:
+        void add(std::unique_ptr<ArchiveBackend> backend);
+
+        // Available backends declaring op for the archive's format, cheapest first.
+        std::vector<ArchiveBackend*> candidates(Operation op, const Archive& archive) const;
+        ArchiveBackend* select(Operation op, const Archive& archive) const;
+        // Like select, but throws TOOL_NOT_FOUND naming the first declaring backend when
+        // none is available, and UNKNOWN_FORMAT when none declares the format at all.
+        ArchiveBackend& require(Operation op, const Archive& archive) const;
+        bool declares(Operation op, file_type::FileType format) const;
+
+        // Estimated cost of op on the archive, preferring measurements over the declaration.
+        double estimate_ms(const ArchiveBackend& backend, Operation op, const Archive& archive) const;
+        void record(const ArchiveBackend& backend, Operation op, const Archive& archive, double elapsed_ms);
+
+        template <typename Call>
+        auto timed(const ArchiveBackend& backend, Operation op, const Archive& archive, Call&& call) {
+            auto started = std::chrono::steady_clock::now();
+            auto result = call();
+            record(backend, op, archive, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count());
+            return result;
+        }
+
+        // Dispatch with fallback: the next candidate is tried while nothing was produced.
+        std::vector<ArchiveEntry> list(const Archive& archive);
+        // True when some listing backend confirms the archive has no entries at all.
+        bool empty(const Archive& archive);
+        bool read_entry(const Archive& archive, const std::string& entry, const StreamSink& sink);
+        // Uses a seekable backend when there is one, otherwise streams and skips to offset.
+        bool read_at(const Archive& archive, const std::string& entry, uint64_t offset, char* buffer, size_t size, size_t& copied);
+        bool extract_entry(const Archive& archive, const std::string& entry, const std::string& output_dir);
+
+    private:
+        using CostKey = std::tuple<const ArchiveBackend*, Operation, file_type::FileType>;
+
+        const Capability* find_capability(const ArchiveBackend& backend, Operation op, file_type::FileType format) const;
+
+        std::vector<std::unique_ptr<ArchiveBackend>> backends_;
+        std::vector<std::vector<Capability>> capabilities_;
+        mutable std::mutex measured_mutex_;
+        // Moving average of observed milliseconds per MiB (archives under 1 MiB count as 1).
+        std::map<CostKey, double> measured_;
+    };
+
+    // Process-wide registry holding the built-in native and external-tool backends.
+    Registry& registry();
+
+    std::unique_ptr<ArchiveBackend> make_native_tar_backend();
+    std::unique_ptr<ArchiveBackend> make_native_zip_backend();
+    std::unique_ptr<ArchiveBackend> make_native_7z_backend();
+    std::unique_ptr<ArchiveBackend> make_native_rar_backend();
+    std::unique_ptr<ArchiveBackend> make_native_xar_backend();
+    // One backend per external tool: tar, zip/unzip, 7z, unrar, xar, lz4, zstd.
+    std::vector<std::unique_ptr<ArchiveBackend>> make_tool_backends();
+}
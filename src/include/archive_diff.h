@@ -0,0 +1,49 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "include/args.h"
+#include "include/file_type.h"
+#include "include/progress.h"
+#include "include/tui_archive_ops.h"
+
+namespace archive_diff {
+    enum class ChangeKind { Added, Removed, Changed };
+
+    struct Change {
+        ChangeKind kind = ChangeKind::Changed;
+        std::string path;
+        bool is_directory = false;
+        uint64_t old_size = 0;
+        uint64_t new_size = 0;
+        std::string old_method;
+        std::string new_method;
+    };
+
+    struct DiffResult {
+        std::vector<Change> changes;
+        size_t unchanged = 0;
+        bool used_content_hashes = false;
+    };
+
+    // Listing plus checksums for every file entry. Tar archives are streamed once and
+    // hashed in-process; other formats only hash entries whose listing lacks a CRC.
+    std::vector<tui::archive_ops::ArchiveEntry> checksummed_listing(const std::string& archive_path,
+                                                                   file_type::FileType type,
+                                                                   const std::string& password,
+                                                                   int thread_count,
+                                                                   bool* used_content_hashes = nullptr);
+
+    DiffResult diff(const std::string& old_path, file_type::FileType old_type,
+                    const std::string& new_path, file_type::FileType new_type,
+                    const std::string& password, int thread_count);
+
+    void run(const args::Options& options, progress::ProgressTracker& tracker);
+}
@@ -0,0 +1,28 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace archive {
+    struct Entry {
+        std::string path;
+        bool is_directory = false;
+        uint64_t size = 0;
+        uint64_t compressed_size = 0;
+        std::string modified;
+        std::string method;
+        uint32_t crc = 0;
+        bool has_crc = false;
+    };
+
+    // Receives entry data chunks as they arrive; return false to stop early.
+    using StreamSink = std::function<bool(const char* data, size_t size)>;
+}
@@ -0,0 +1,63 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "include/args.h"
+#include "include/file_type.h"
+#include "include/progress.h"
+
+namespace archive_scan {
+    enum class Status { Ok, Failed, Cached, ToolMissing };
+
+    struct ScanRecord {
+        std::string path;
+        file_type::FileType type = file_type::FileType::UNKNOWN;
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        Status status = Status::Failed;
+        double seconds = 0.0;
+    };
+
+    struct ScanOptions {
+        int thread_count = 0;
+        // Records from a previous report; archives whose size and mtime still match an
+        // ok/cached record there are not verified again.
+        std::map<std::string, ScanRecord> previous;
+    };
+
+    std::vector<ScanRecord> scan(const std::string& root, const ScanOptions& scan_options);
+
+    // Reports are TSV: status, format, size, mtime, seconds, path (with \t, \n and \\ escaped).
+    std::map<std::string, ScanRecord> read_report(const std::string& report_path);
+    bool write_report(const std::string& report_path, const std::vector<ScanRecord>& records);
+    std::string status_name(Status status);
+
+    void run(const args::Options& options, progress::ProgressTracker& tracker);
+
+    struct IdentifyRecord {
+        std::string path;
+        file_type::FileType type = file_type::FileType::UNKNOWN;
+        // False when the file could not be opened or read.
+        bool readable = false;
+    };
+
+    // Recognizes each path by content on the shared executor, in batches of consecutive paths
+    // so workers touch the loop counter once per batch. A file costs an open and one read of
+    // file_type::HEADER_READ_SIZE bytes into a buffer its worker reuses.
+    std::vector<IdentifyRecord> identify(const std::vector<std::string>& paths, int thread_count);
+    // TSV "format<TAB>path" (path escaped as in reports) or one JSON object; unreadable files
+    // report the format "error".
+    std::string identify_line(const IdentifyRecord& record, bool json);
+
+    // --identify: files under the positional paths, or the paths read from stdin, streamed
+    // to stdout in input order as each chunk is recognized.
+    void run_identify(const args::Options& options);
+}
@@ -6,9 +6,14 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
 #include <vector>
 
+namespace progress {
+    struct Update;
+}
+
 namespace args {
     struct Options {
         bool interactive_mode = false;
@@ -24,10 +29,28 @@ namespace args {
         int thread_count = 0;
         bool verbose = false;
         bool benchmark = false;
+        bool benchmark_json = false;
+        bool progress = false;
+        bool progress_json = false;
         bool verify = false;
+        bool diff_mode = false;
+        bool scan_mode = false;
+        bool incremental = false;
+        bool identify_mode = false;
+        bool identify_json = false;
         std::vector<std::string> exclude_patterns;
         std::vector<std::string> include_patterns;
         std::string force_format;
+        std::string trace_path;
+        std::string serve_socket;
+        // One of list, stat, cat or extract; its archive, entry and output directory follow.
+        std::string query_command;
+        std::vector<std::string> query_args;
+        std::string socket_path;
+        // Set by library callers: no status lines or tool output on stdout, progress reported
+        // through the callback instead of the terminal.
+        bool quiet = false;
+        std::function<void(const progress::Update&)> progress_callback;
     };
 
     Options parse(int argc, char* argv[]);
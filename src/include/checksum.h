@@ -0,0 +1,18 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace checksum {
+    // IEEE CRC-32 as stored by zip, 7z, rar and gzip. Pass the previous return
+    // value as `crc` to continue a running checksum across chunks.
+    uint32_t crc32(uint32_t crc, const void* data, size_t length);
+    // Continues `crc` over `length` zero bytes in O(log length), for sparse members.
+    uint32_t crc32_zeros(uint32_t crc, uint64_t length);
+}
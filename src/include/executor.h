@@ -0,0 +1,104 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Process-wide work-stealing thread pool. Every parallel subsystem schedules through global()
+// so that together they stay within the -t budget instead of each starting its own threads.
+namespace executor {
+    // Workers always take the most urgent runnable task; a running task is never interrupted.
+    enum class Priority { Interactive = 0, Normal = 1, Background = 2 };
+    constexpr size_t kPriorityCount = 3;
+
+    struct Stats {
+        size_t workers = 0;
+        size_t queue_depth = 0;
+        size_t peak_queue_depth = 0;
+        uint64_t executed = 0;
+        uint64_t stolen = 0;
+    };
+
+    class Executor {
+    public:
+        explicit Executor(size_t workers);
+        ~Executor();
+
+        Executor(const Executor&) = delete;
+        Executor& operator=(const Executor&) = delete;
+
+        // Tasks submitted from a worker go to that worker's own deque; others are spread round-robin.
+        void submit(std::function<void()> task, Priority priority = Priority::Normal);
+
+        // Runs body(0..count-1) on the calling thread plus up to max_threads - 1 workers
+        // (0 = all workers). The first exception is rethrown after every started iteration ends.
+        void parallel_for(size_t count, int max_threads, const std::function<void(size_t)>& body,
+                          Priority priority = Priority::Normal);
+
+        size_t worker_count() const { return workers_.size(); }
+        // Tasks submitted but not yet started.
+        size_t queue_depth() const { return queued_.load(std::memory_order_relaxed); }
+        Stats stats() const;
+
+    private:
+        struct Worker {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks[kPriorityCount];
+        };
+
+        bool take(size_t self, std::function<void()>& task);
+        void run_worker(size_t self);
+
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::vector<std::thread> threads_;
+        std::atomic<size_t> next_worker_{0};
+        std::atomic<size_t> queued_{0};
+        std::atomic<size_t> peak_queued_{0};
+        std::atomic<uint64_t> executed_{0};
+        std::atomic<uint64_t> stolen_{0};
+
+        std::mutex idle_mutex_;
+        std::condition_variable idle_;
+        bool stopping_ = false;
+    };
+
+    // Tracks a set of submitted tasks so the caller can wait for all of them.
+    class TaskGroup {
+    public:
+        explicit TaskGroup(Executor& executor) : executor_(executor) {}
+        ~TaskGroup() { wait(); }
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        void submit(std::function<void()> task, Priority priority = Priority::Normal);
+        void wait();
+
+    private:
+        Executor& executor_;
+        std::mutex mutex_;
+        std::condition_variable done_;
+        size_t pending_ = 0;
+    };
+
+    // Threads this process may use: the CPU affinity mask, capped by a cgroup CPU quota.
+    size_t available_parallelism();
+
+    // Sizes the global executor; only the first call before global() is first used takes effect.
+    // thread_count <= 0 means available_parallelism().
+    void configure(int thread_count);
+    Executor& global();
+}
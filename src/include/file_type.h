@@ -6,8 +6,11 @@
 
 #pragma once
 
-#include <string>
+#include <cstddef>
+#include <functional>
 #include <map>
+#include <string>
+#include <vector>
 
 namespace file_type {
     enum class FileType {
@@ -27,8 +30,17 @@ namespace file_type {
     bool is_split_zip_extension(const std::string& ext_lower);
     FileType recognize_by_extension(const std::string& path_str);
     FileType recognize_by_header(const std::string& path);
+    // Bytes read from the start of a file before recognizing it; enough for every signature.
+    constexpr size_t HEADER_READ_SIZE = 4096;
+    // Fills out with the file's next bytes and returns how many were read, 0 at the end.
+    using ReadMore = std::function<size_t(char* out, size_t capacity)>;
+    // Recognizes from the first bytes of a file already in memory. read_more is asked for the
+    // following bytes only when a compressed stream needs them before it yields a tar block.
+    FileType recognize_header_bytes(std::vector<char>& head, const ReadMore& read_more = {});
     FileType recognize_source_type(const std::string& source_path_str);
     RecognitionResult recognize(const std::string& source_path_str, const std::string& target_path_str);
     std::string get_file_type_string(FileType type);
+    // Short name accepted by --format (e.g. "tar.gz"); "file", "directory" or "unknown" otherwise.
+    std::string get_format_name(FileType type);
     FileType parse_format_string(const std::string& format_str);
 }
@@ -0,0 +1,46 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Reads the files an archive is built from, ahead of the writer, and hands their bytes over in
+// manifest order. On Linux an io_uring engine keeps the opens and first reads of up to
+// kQueueDepth files in flight, reading into one registered buffer; elsewhere, or when the
+// kernel refuses io_uring, files are read one after another. HITPAG_IO=sync forces the latter.
+namespace ingest {
+    constexpr size_t kQueueDepth = 128;
+    // Bytes read ahead per file; the rest of a larger file is read when its turn comes.
+    constexpr size_t kSlotSize = 64 * 1024;
+
+    enum class Engine { Sync, Uring };
+
+    struct File {
+        std::string path;
+        // Bytes to read at most, normally the size the manifest recorded.
+        uint64_t size = 0;
+    };
+
+    // For each file in order: data zero or more times with its bytes, then done once with 0 or
+    // the errno that ended the read early. Either returning false stops read_files.
+    struct Sink {
+        std::function<bool(size_t index, const char* data, size_t size)> data;
+        std::function<bool(size_t index, int error)> done;
+    };
+
+    // Chosen once per process: io_uring when it can be set up and supports the needed opcodes.
+    Engine engine();
+    const char* engine_name(Engine engine);
+
+    // False when a sink callback stopped it or the ring failed; per-file failures only reach
+    // done. Asking for Uring where it is unavailable reads synchronously.
+    bool read_files(const std::vector<File>& files, const Sink& sink, Engine engine = ingest::engine());
+}
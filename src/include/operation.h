@@ -23,6 +23,9 @@ namespace operation {
     std::string find_split_zip_main(const std::string& any_part_path);
     bool is_split_zip(const std::string& zip_path);
 
+    // Tests archive integrity without extracting; true for formats no backend can verify.
+    bool verify_archive(const std::string& archive_path, file_type::FileType format, bool quiet = false);
+
     void compress(const std::vector<CompressionSource>& sources,
                   const std::string& target_path_str,
                   file_type::FileType target_format,
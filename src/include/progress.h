@@ -6,15 +6,123 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
 #include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
 
 namespace progress {
+    struct ResourceUsage {
+        double user_seconds = 0.0;
+        double system_seconds = 0.0;
+        int64_t max_rss_kb = 0;
+    };
+
+    struct ChildUsage {
+        std::string tool;
+        int exit_code = -1;
+        double wall_seconds = 0.0;
+        ResourceUsage usage;
+    };
+
+    // Child accounting is off by default so long TUI sessions do not accumulate records.
+    void set_child_accounting(bool enabled);
+    bool child_accounting_enabled();
+    void record_child(const ChildUsage& child);
+    std::vector<ChildUsage> recorded_children();
+    ResourceUsage self_usage();
+
+#ifndef _WIN32
+    // waitpid() replacement that also records the child's rusage when accounting is on.
+    // Returns the raw wait status, or -1 if waiting failed.
+    int wait_for_child(pid_t pid, const std::string& tool, std::chrono::steady_clock::time_point started);
+#endif
+
+    struct Update {
+        uint64_t bytes_in = 0;
+        uint64_t bytes_out = 0;
+        uint64_t total_bytes = 0;
+        double elapsed_seconds = 0.0;
+        bool final = false;
+    };
+
+    using Callback = std::function<void(const Update&)>;
+
+    // Periodic bytes/rate/ratio/ETA reporting while an operation runs. External tools are sampled
+    // from /proc (input file position via fdinfo, else the tool's read/write counters); native
+    // code reports through add_input()/add_output().
+    class LiveProgress {
+    public:
+        enum class Mode { Off, Line, Json, Callback };
+
+        LiveProgress(Mode mode, std::string operation, bool compressing, uint64_t total_bytes,
+                     std::chrono::milliseconds interval = std::chrono::milliseconds(500),
+                     Callback callback = {});
+        ~LiveProgress();
+
+        LiveProgress(const LiveProgress&) = delete;
+        LiveProgress& operator=(const LiveProgress&) = delete;
+
+        bool enabled() const { return mode_ != Mode::Off; }
+        // Files whose read position / size measure a watched tool's progress. Either may be empty:
+        // no input falls back to the tool's read counter, no output to its write counter.
+        void set_watch_paths(const std::string& input_path, const std::string& output_path);
+#ifndef _WIN32
+        void watch_process(pid_t pid);
+        void unwatch_process();
+#endif
+        void add_input(uint64_t bytes) { bytes_in_.fetch_add(bytes, std::memory_order_relaxed); }
+        void add_output(uint64_t bytes) { bytes_out_.fetch_add(bytes, std::memory_order_relaxed); }
+        // Stops sampling and prints the final report; non-zero totals replace the sampled values.
+        void finish(uint64_t final_in = 0, uint64_t final_out = 0);
+
+        static std::string format_line(uint64_t bytes_in, uint64_t bytes_out, uint64_t total_bytes,
+                                       bool compressing, double elapsed_seconds);
+
+    private:
+        void loop();
+        void stop_worker();
+        void sample();
+        void emit(bool final);
+
+        Mode mode_;
+        std::string operation_;
+        bool compressing_;
+        uint64_t total_bytes_;
+        std::chrono::milliseconds interval_;
+        Callback callback_;
+        std::chrono::steady_clock::time_point started_;
+        std::atomic<uint64_t> bytes_in_{0};
+        std::atomic<uint64_t> bytes_out_{0};
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        bool stopping_ = false;
+        bool finished_ = false;
+        long watched_pid_ = 0;
+        std::string input_path_;
+        std::string output_path_;
+        uint64_t sampled_in_ = 0;
+        uint64_t sampled_out_ = 0;
+        size_t last_line_width_ = 0;
+        std::thread worker_;
+    };
+
     class ProgressTracker {
     public:
         struct Stats {
-            size_t original_size = 0;
-            size_t compressed_size = 0;
+            uint64_t original_size = 0;
+            uint64_t compressed_size = 0;
             double compression_time = 0.0;
             int thread_count = 1;
 
@@ -22,22 +130,43 @@ namespace progress {
                 return original_size > 0 ? (1.0 - static_cast<double>(compressed_size) / original_size) * 100.0 : 0.0;
             }
 
-            size_t get_saved_bytes() const {
+            uint64_t get_saved_bytes() const {
                 return original_size > compressed_size ? original_size - compressed_size : 0;
             }
         };
 
+        struct Phase {
+            std::string name;
+            std::string backend;
+            double wall_seconds = 0.0;
+            ResourceUsage self;
+            uint64_t bytes_in = 0;
+            uint64_t bytes_out = 0;
+            size_t first_child = 0;
+            size_t child_count = 0;
+        };
+
         void start_operation();
         void end_operation();
+        void begin_phase(const std::string& name, const std::string& backend);
+        void end_phase(uint64_t bytes_in, uint64_t bytes_out);
         void set_thread_count(int threads);
-        void set_original_size(size_t size);
-        void set_compressed_size(size_t size);
+        void set_original_size(uint64_t size);
+        void set_compressed_size(uint64_t size);
+        void set_json_output(bool json) { json_output_ = json; }
         void print_stats(bool verbose, bool benchmark) const;
-        size_t calculate_directory_size(const std::string& path) const;
+        void print_json(std::ostream& out) const;
+        uint64_t calculate_directory_size(const std::string& path) const;
         const Stats& stats() const { return stats_; }
+        const std::vector<Phase>& phases() const { return phases_; }
 
     private:
         Stats stats_;
-        std::chrono::high_resolution_clock::time_point start_time_;
+        std::chrono::steady_clock::time_point start_time_;
+        std::vector<Phase> phases_;
+        std::chrono::steady_clock::time_point phase_start_;
+        ResourceUsage phase_self_start_;
+        bool phase_open_ = false;
+        bool json_output_ = false;
     };
 }
@@ -0,0 +1,51 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Header walker for RAR 1.5-4.x and RAR5 archives. Only block headers are read; file data is
+// skipped by seeking, and decompression stays with unrar.
+namespace rar {
+    struct Member {
+        std::string path;
+        bool is_directory = false;
+        uint64_t size = 0;
+        // Summed over every volume the member is split across.
+        uint64_t packed_size = 0;
+        bool has_crc = false;
+        uint32_t crc = 0;
+        bool has_mtime = false;
+        int64_t mtime = 0;  // Unix seconds
+        bool solid = false;
+        bool encrypted = false;
+        int method = 0;           // 0 (store) to 5 (best)
+        int dictionary_log = 0;   // log2 of the dictionary size
+    };
+
+    struct Index {
+        std::vector<Member> members;
+        int version = 0;  // 4 or 5
+        bool solid = false;
+        bool multi_volume = false;
+        size_t volumes = 0;
+        bool valid = false;
+        // Headers are encrypted, so listing needs the password and unrar.
+        bool needs_tool = false;
+        // A later volume is missing or damaged: members from it on are not listed, and a
+        // member split across it has only the packed size of its earlier parts.
+        bool truncated = false;
+    };
+
+    bool has_signature(const std::string& path);
+    // Follows the volume chain from path when the archive is multi-volume.
+    Index read_index(const std::string& path);
+    // Method as `7z l` prints it for RAR, e.g. "m3:22".
+    std::string method_name(const Member& member);
+}
@@ -0,0 +1,133 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include "include/args.h"
+#include "include/error.h"
+#include "include/file_type.h"
+#include "include/tui_archive_ops.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Archive query service: `hitpag --serve SOCKET` keeps listings and recently read entries in
+// memory and answers list/stat/cat/extract requests over a Unix socket. Query commands use
+// the daemon named by --socket or $HITPAG_SOCKET and fall back to answering in-process.
+namespace service {
+    enum class Command { List, Stat, Cat, Extract };
+
+    struct Request {
+        Command command = Command::List;
+        // Absolute paths; the daemon does not share the client's working directory.
+        std::string archive;
+        std::string entry;
+        std::string output_dir;
+        std::string password;
+    };
+
+    struct Response {
+        error::ErrorCode code = error::ErrorCode::SUCCESS;
+        // Command output, or the error message when code is not SUCCESS.
+        std::string payload;
+    };
+
+    bool parse_command(const std::string& name, Command& command);
+    const char* command_name(Command command);
+
+    // Request handler with the caches; safe to call from several threads.
+    class Service {
+    public:
+        explicit Service(size_t content_cache_bytes = 64 * 1024 * 1024);
+
+        Response handle(const Request& request);
+
+        size_t cached_archives() const;
+        size_t cached_content_bytes() const;
+
+    private:
+        struct Listing {
+            std::mutex mutex;
+            bool complete = false;
+            std::vector<tui::archive_ops::ArchiveEntry> entries;
+            std::unordered_map<std::string, size_t> by_path;
+        };
+
+        struct ArchiveState {
+            std::string path;
+            uint64_t size = 0;
+            std::filesystem::file_time_type mtime{};
+            file_type::FileType type = file_type::FileType::UNKNOWN;
+            // Distinguishes content cached for an earlier version of the same path.
+            uint64_t generation = 0;
+            // One listing per password: encrypted archives may list differently, or not at
+            // all, without the right one. Failed listings are dropped so they are retried.
+            std::mutex listings_mutex;
+            std::map<std::string, std::shared_ptr<Listing>> listings;
+        };
+
+        std::shared_ptr<ArchiveState> archive_state(const std::string& path);
+        std::shared_ptr<const Listing> listing(ArchiveState& state, const std::string& password);
+        const tui::archive_ops::ArchiveEntry& find_entry(const ArchiveState& state, const Listing& listing, const std::string& entry);
+        std::shared_ptr<const std::string> read_entry(ArchiveState& state, const Request& request);
+
+        std::string list(const Request& request);
+        std::string stat(const Request& request);
+        std::string cat(const Request& request);
+        std::string extract(const Request& request);
+
+        mutable std::mutex archives_mutex_;
+        std::map<std::string, std::shared_ptr<ArchiveState>> archives_;
+        uint64_t next_generation_ = 1;
+
+        // Least recently read entries are evicted first once the byte budget is exceeded.
+        using ContentList = std::list<std::pair<std::string, std::shared_ptr<const std::string>>>;
+        mutable std::mutex content_mutex_;
+        size_t content_budget_;
+        size_t content_bytes_ = 0;
+        ContentList content_lru_;
+        std::unordered_map<std::string, ContentList::iterator> content_index_;
+    };
+
+    class Server {
+    public:
+        // The thread in run() reads and writes every connection; only complete requests are
+        // handed to executor::global() as interactive tasks, so idle clients hold no worker.
+        Server(std::string socket_path, Service& service);
+        ~Server();
+
+        Server(const Server&) = delete;
+        Server& operator=(const Server&) = delete;
+
+        // Binds the socket; throws when it is in use by a live daemon or cannot be created.
+        void listen();
+        // Accepts connections until stop() is called.
+        void run();
+        void stop();
+
+    private:
+        std::string socket_path_;
+        Service& service_;
+        int listen_fd_ = -1;
+        std::atomic<bool> stopping_{false};
+    };
+
+    // Sends one request to the daemon at socket_path; false when no daemon answers there.
+    bool call(const std::string& socket_path, const Request& request, Response& response);
+
+    // --serve
+    void serve(const args::Options& options);
+    // --list, --stat, --cat and --extract-entry; returns the process exit code.
+    int run_query(const args::Options& options);
+}
@@ -0,0 +1,79 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Reader for the 7z container: the signature header, the (possibly LZMA-packed) end header,
+// and the folder layout that maps files onto solid blocks. Decoding covers the coders
+// liblzma implements (Copy, LZMA, LZMA2, Delta and the BCJ filters); anything else, and
+// encrypted headers, is left to the 7z tool.
+namespace sevenzip {
+    constexpr size_t kNoFolder = static_cast<size_t>(-1);
+
+    struct Coder {
+        std::vector<uint8_t> id;
+        std::vector<uint8_t> properties;
+        uint64_t in_streams = 1;
+        uint64_t out_streams = 1;
+    };
+
+    // A folder is one solid block: a coder chain over packed streams producing one output.
+    struct Folder {
+        std::vector<Coder> coders;
+        std::vector<std::pair<uint64_t, uint64_t>> bind_pairs;  // (in index, out index)
+        std::vector<uint64_t> packed_streams;
+        std::vector<uint64_t> unpack_sizes;                     // one per coder output
+        uint64_t pack_offset = 0;                               // file offset of the first packed stream
+        std::vector<uint64_t> packed_sizes;
+        bool has_crc = false;
+        uint32_t crc = 0;
+        size_t first_file = 0;
+        size_t file_count = 0;
+
+        uint64_t unpack_size() const;
+        uint64_t packed_size() const;
+    };
+
+    struct File {
+        std::string path;
+        bool is_directory = false;
+        bool has_stream = false;
+        bool is_anti = false;
+        uint64_t size = 0;
+        bool has_crc = false;
+        uint32_t crc = 0;
+        bool has_mtime = false;
+        uint64_t mtime = 0;  // Windows FILETIME
+        uint32_t attributes = 0;
+        size_t folder = kNoFolder;
+        uint64_t folder_offset = 0;  // start of this file in the folder's decoded output
+    };
+
+    struct Index {
+        std::vector<Folder> folders;
+        std::vector<File> files;
+        bool valid = false;
+        // The header itself is encrypted or uses a coder this reader cannot decode.
+        bool needs_tool = false;
+    };
+
+    bool has_signature(const std::string& path);
+    Index read_index(const std::string& path);
+
+    // Decoder method chain as 7-Zip prints it, e.g. "LZMA2:24" or "BCJ LZMA:23".
+    std::string method_name(const Folder& folder);
+    // True when decode_folder() supports every coder in the folder.
+    bool can_decode(const Folder& folder);
+
+    // Streams the decoded output of a folder; the sink returns false to stop early.
+    bool decode_folder(const std::string& path, const Folder& folder, const std::function<bool(const char*, size_t)>& sink);
+}
@@ -0,0 +1,46 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Byte-crunching kernels with runtime CPU dispatch. The binary is built for the baseline ISA;
+// the vector variants are compiled with per-function target attributes and chosen once at
+// startup from what the CPU reports, capped by $HITPAG_SIMD (scalar, sse4.2, avx2, avx512).
+namespace simd {
+    enum class Level { Scalar = 0, SSE42 = 1, AVX2 = 2, AVX512 = 3 };
+
+    struct CpuFeatures {
+        bool sse42 = false;
+        bool pclmul = false;
+        bool avx2 = false;
+        bool avx512bw = false;
+    };
+
+    const CpuFeatures& cpu_features();
+    const char* level_name(Level level);
+    // Highest level both the CPU and $HITPAG_SIMD allow.
+    Level best_level();
+    Level active_level();
+    // Switches every kernel to `level`, lowered to what the CPU supports; returns the level used.
+    Level select(Level level);
+    // Kernel names in use, e.g. "crc32=pclmul search=avx2 newline=avx2 classify=avx2".
+    std::string describe();
+
+    constexpr size_t npos = static_cast<size_t>(-1);
+
+    // IEEE CRC-32 (zip, gzip, 7z), continuing from `crc`.
+    uint32_t crc32(uint32_t crc, const void* data, size_t length);
+    // Index of the first `byte`, or `length` when there is none.
+    size_t find_byte(const char* data, size_t length, char byte);
+    // Index of `needle` in `haystack` ignoring ASCII case, or npos. `needle` must be lower-case.
+    size_t find_ascii_nocase(const char* haystack, size_t length, const char* needle, size_t needle_length);
+    // Control bytes other than tab, newline and carriage return: the binary-content signal.
+    size_t count_control(const char* data, size_t length);
+}
@@ -0,0 +1,35 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include "include/file_type.h"
+
+#include <cstdint>
+#include <string>
+
+// Uncompressed sizes of single-stream formats, read from frame headers, trailers and indexes
+// without decoding any data.
+namespace stream_probe {
+    struct Probe {
+        bool valid = false;
+        // False when some frame does not record its content size.
+        bool size_known = false;
+        uint64_t content_size = 0;
+        uint64_t frames = 0;  // zstd/lz4 frames, xz streams, gzip members seen
+    };
+
+    // Walks every frame, stepping over skippable frames and, for zstd, block headers.
+    Probe zstd(const std::string& path);
+    Probe lz4(const std::string& path);
+    // ISIZE trailer: the last member's size modulo 2^32, as `gzip -l` reports it.
+    Probe gzip(const std::string& path);
+    // Sums the index of every concatenated stream, walking back from the end.
+    Probe xz(const std::string& path);
+
+    // The probe matching a single-stream format or compressed tar; invalid for anything else.
+    Probe probe(const std::string& path, file_type::FileType format);
+}
@@ -0,0 +1,111 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Field decoding for 512-byte ustar/GNU/pax headers, shared by the tar readers.
+namespace tar_header {
+    constexpr size_t kBlockSize = 512;
+
+    // Octal (space or NUL padded) or GNU base-256 numeric field.
+    inline uint64_t parse_number(const char* field, size_t length) {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(field);
+        uint64_t value = 0;
+        if (bytes[0] & 0x80) {
+            value = bytes[0] & 0x7F;
+            for (size_t i = 1; i < length; ++i) value = (value << 8) | bytes[i];
+            return value;
+        }
+        size_t i = 0;
+        while (i < length && (field[i] == ' ' || field[i] == '\0')) ++i;
+        for (; i < length && field[i] >= '0' && field[i] <= '7'; ++i) {
+            value = (value << 3) | static_cast<uint64_t>(field[i] - '0');
+        }
+        return value;
+    }
+
+    inline std::string field_string(const char* field, size_t length) {
+        size_t end = 0;
+        while (end < length && field[end] != '\0') ++end;
+        return std::string(field, end);
+    }
+
+    // The stored checksum counts the checksum field itself as eight spaces; old writers
+    // summed signed chars, so either sum is accepted.
+    inline bool checksum_valid(const char* block) {
+        uint64_t stored = parse_number(block + 148, 8);
+        uint64_t unsigned_sum = 0;
+        int64_t signed_sum = 0;
+        for (size_t i = 0; i < kBlockSize; ++i) {
+            bool in_field = i >= 148 && i < 156;
+            unsigned char u = in_field ? ' ' : static_cast<unsigned char>(block[i]);
+            signed char s = in_field ? ' ' : static_cast<signed char>(block[i]);
+            unsigned_sum += u;
+            signed_sum += s;
+        }
+        return stored == unsigned_sum || static_cast<int64_t>(stored) == signed_sum;
+    }
+
+    inline bool is_zero_block(const char* block) {
+        for (size_t i = 0; i < kBlockSize; ++i) {
+            if (block[i] != '\0') return false;
+        }
+        return true;
+    }
+
+    // Member name including the ustar prefix field.
+    inline std::string member_name(const char* block) {
+        std::string name = field_string(block, 100);
+        if (std::string(block + 257, 5) == "ustar") {
+            std::string prefix = field_string(block + 345, 155);
+            if (!prefix.empty()) name = prefix + "/" + name;
+        }
+        return name;
+    }
+
+    // Overrides carried by a pax extended header ('x') for the member that follows it.
+    struct PaxOverrides {
+        std::string path;
+        bool has_size = false;
+        uint64_t size = 0;
+    };
+
+    inline PaxOverrides parse_pax(const std::string& records) {
+        PaxOverrides overrides;
+        size_t pos = 0;
+        while (pos < records.size()) {
+            size_t space = records.find(' ', pos);
+            if (space == std::string::npos) break;
+            uint64_t record_length = 0;
+            try { record_length = std::stoull(records.substr(pos, space - pos)); } catch (...) { break; }
+            if (record_length == 0 || pos + record_length > records.size()) break;
+            std::string record = records.substr(space + 1, pos + record_length - space - 2);
+            size_t eq = record.find('=');
+            if (eq != std::string::npos) {
+                std::string key = record.substr(0, eq);
+                std::string value = record.substr(eq + 1);
+                if (key == "path") {
+                    overrides.path = value;
+                } else if (key == "size") {
+                    try {
+                        overrides.size = std::stoull(value);
+                        overrides.has_size = true;
+                    } catch (...) {}
+                }
+            }
+            pos += record_length;
+        }
+        return overrides;
+    }
+
+    inline uint64_t padded_size(uint64_t size) {
+        return (size + kBlockSize - 1) / kBlockSize * kBlockSize;
+    }
+}
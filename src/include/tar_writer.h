@@ -0,0 +1,33 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include "include/ingest.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Native writer for plain tar archives. Members are laid out as tar would create them from the
+// same items, with directories recursed in name order and hard links stored once; names, link
+// targets and sizes that do not fit the ustar fields get a pax extended header. File contents
+// are read ahead through ingest::read_files while headers are serialized in manifest order.
+namespace tar_writer {
+    struct Options {
+        // Problems that do not stop the archive: unreadable or vanished files, sockets.
+        std::function<void(const std::string&)> report;
+        std::function<void(uint64_t in, uint64_t out)> advance;
+        ingest::Engine engine = ingest::engine();
+    };
+
+    // Items are paths relative to working_dir. Returns 0, 1 when a file shrank while it was
+    // read, or 2 when some item could not be archived or the target could not be written;
+    // as with tar, the archive still holds everything else.
+    int write(const std::string& target, const std::string& working_dir, const std::vector<std::string>& items,
+              const Options& options);
+}
@@ -0,0 +1,54 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Chrome trace event recorder (chrome://tracing, Perfetto). Events are kept in a fixed-size
+// ring buffer per thread and written out by stop(); when tracing is off a Span costs one
+// relaxed atomic load.
+namespace trace {
+    extern std::atomic<bool> g_enabled;
+
+    inline bool enabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+    // Starts recording; the file is created immediately so a bad path fails early.
+    bool start(const std::string& output_path);
+    // Writes all buffered events to the file given to start() and stops recording.
+    bool stop();
+
+    uint64_t now_us();
+    // Joins argv for a span argument with password arguments (-pSECRET, -P SECRET) masked.
+    std::string redacted_command(const std::vector<std::string>& argv);
+    void complete(const char* name, const char* category, uint64_t start_us, uint64_t duration_us, std::string args = {});
+
+    class Span {
+    public:
+        Span(const char* name, const char* category)
+            : active_(enabled()), name_(name), category_(category), start_us_(active_ ? now_us() : 0) {}
+        ~Span() {
+            if (active_) complete(name_, category_, start_us_, now_us() - start_us_, std::move(args_));
+        }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+        bool active() const { return active_; }
+        void arg(const char* key, const std::string& value);
+        void arg(const char* key, int64_t value);
+
+    private:
+        bool active_;
+        const char* name_;
+        const char* category_;
+        uint64_t start_us_;
+        std::string args_;
+    };
+}
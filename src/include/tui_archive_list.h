@@ -22,6 +22,8 @@ namespace tui {
     class ArchiveList {
     public:
         void load(const std::string& archive_path, file_type::FileType type, const std::string& password = "");
+        // Installs an already listed archive, e.g. from a cache or a benchmark.
+        void set_entries(const std::string& archive_path, file_type::FileType type, std::vector<archive_ops::ArchiveEntry> entries);
         bool loaded() const { return !archive_path_.empty(); }
 
         ftxui::Component component();
@@ -44,6 +46,12 @@ namespace tui {
         bool go_parent();
         void select_path(const std::string& path);
 
+        // Figures for the performance overlay.
+        double load_ms() const { return load_ms_; }
+        double last_filter_ms() const { return last_filter_ms_; }
+        size_t visible_count() const { return visible_entries_.size(); }
+        size_t entry_table_bytes() const { return entry_table_bytes_; }
+
     private:
         struct VisibleEntry {
             std::string display_name;
@@ -63,6 +71,9 @@ namespace tui {
         std::string search_query_;
         ftxui::Component component_;
         mutable archive_ops::ArchiveEntry synthetic_entry_;
+        double load_ms_ = 0.0;
+        double last_filter_ms_ = 0.0;
+        size_t entry_table_bytes_ = 0;
 
         void apply_filter();
         void clamp_selection();
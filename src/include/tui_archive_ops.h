@@ -9,36 +9,50 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <functional>
+#include "include/archive_entry.h"
 #include "include/file_type.h"
 
 namespace tui::archive_ops {
-    struct ArchiveEntry {
-        std::string path;
-        bool is_directory = false;
-        uint64_t size = 0;
-        uint64_t compressed_size = 0;
-        std::string modified;
-        std::string method;
-        uint32_t crc = 0;
-    };
+    using ArchiveEntry = archive::Entry;
 
     struct TextExtractionResult {
         bool success = false;
         bool empty_file = false;
+        // Decoding stopped at the requested limit.
+        bool truncated = false;
         std::string content;
+        double spawn_ms = 0.0;
+        double decode_ms = 0.0;
     };
 
     struct CommandResult {
         int exit_code = -1;
         std::string stdout_output;
+        // Time until the child's first output (process start-up and seek), then the rest until exit.
+        double spawn_ms = 0.0;
+        double decode_ms = 0.0;
     };
 
+    // Receives stdout chunks as they arrive; return false to stop the child early.
+    using StreamSink = archive::StreamSink;
+
     CommandResult run_command_capture(const std::vector<std::string>& cmd);
     int run_command_status(const std::vector<std::string>& cmd);
+    int run_command_stream(const std::vector<std::string>& cmd, const StreamSink& sink);
+
+    // Parsers for `tar -tf`, `7z l -slt` and `unzip -v` output.
+    std::vector<ArchiveEntry> parse_tar_listing(const std::string& output);
+    std::vector<ArchiveEntry> parse_7z_listing(const std::string& output);
+    std::vector<ArchiveEntry> parse_unzip_listing(const std::string& output);
 
+    // Dispatched through backend::registry(), which picks the cheapest installed backend.
     std::vector<ArchiveEntry> list_archive(const std::string& archive_path, file_type::FileType type, const std::string& password = "");
-    TextExtractionResult extract_text(const std::string& archive_path, const std::string& entry_path, file_type::FileType type, const std::string& password = "");
+    // With a limit, decoding stops once that many bytes have arrived.
+    TextExtractionResult extract_text(const std::string& archive_path, const std::string& entry_path, file_type::FileType type, const std::string& password = "", size_t limit = 0);
     std::string extract_to_string(const std::string& archive_path, const std::string& entry_path, file_type::FileType type, const std::string& password = "");
+    // Streams one entry through sink; a sink that returns false stops the tool early.
+    bool stream_entry(const std::string& archive_path, const std::string& entry_path, file_type::FileType type, const std::string& password, const StreamSink& sink);
     bool extract_single(const std::string& archive_path, const std::string& entry_path, const std::string& output_dir, file_type::FileType type, const std::string& password = "");
     bool is_text_content(const std::string& content);
 }
@@ -17,14 +17,28 @@
 #include <ftxui/screen/box.hpp>
 
 namespace tui {
+    // Cost of the last preview: tool start-up until first output, the rest of the extraction,
+    // and the last re-wrap; lookups/hits count how often the wrapped lines could be reused.
+    struct PreviewTimings {
+        double spawn_ms = 0.0;
+        double decode_ms = 0.0;
+        double wrap_ms = 0.0;
+        size_t wrap_lookups = 0;
+        size_t wrap_hits = 0;
+    };
+
     class PreviewPanel {
     public:
         void load(const std::string& archive_path, const std::string& entry_path, file_type::FileType type, const std::string& password = "");
+        // Shows already extracted entry content (text check, truncation, line split).
+        void show_content(const std::string& entry_path, std::string content);
         void load_directory(const std::string& dir_path, const std::vector<archive_ops::ArchiveEntry>& entries);
         void clear();
         ftxui::Element render() const;
         bool has_content() const { return !lines_.empty() || !status_message_.empty(); }
         const std::string& loaded_entry_path() const { return loaded_entry_path_; }
+        size_t wrapped_line_count() const;
+        const PreviewTimings& timings() const { return timings_; }
 
         void scroll_up();
         void scroll_down();
@@ -63,6 +77,7 @@ namespace tui {
         std::string loaded_entry_path_;
         int scroll_offset_ = 0;
         mutable int wrapped_width_ = 0;
+        mutable PreviewTimings timings_;
         mutable ftxui::Box box_;
         bool is_directory_view_ = false;
         int selected_dir_entry_ = -1;
@@ -25,10 +25,14 @@ namespace tui {
         PreviewPanel& panel() { return panel_; }
         const PreviewPanel& panel() const { return panel_; }
         const std::string& loaded_entry_path() const { return loaded_entry_path_; }
+        size_t selection_lookups() const { return selection_lookups_; }
+        size_t selection_hits() const { return selection_hits_; }
 
     private:
         PreviewPanel panel_;
         std::string loaded_entry_path_;
         bool loaded_directory_ = false;
+        size_t selection_lookups_ = 0;
+        size_t selection_hits_ = 0;
     };
 }
@@ -38,6 +38,7 @@ namespace tui {
         UiMode mode = UiMode::Browse;
         UiMode return_mode = UiMode::Browse;
         bool quit = false;
+        bool show_perf_overlay = false;
         std::string status_message;
         AlertState alert;
         ExtractState extract;
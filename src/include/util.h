@@ -10,4 +10,7 @@
 
 namespace util {
     std::string trim_copy(const std::string& value);
+
+    // Returns value as a double-quoted JSON string literal.
+    std::string json_quote(const std::string& value);
 }
@@ -0,0 +1,56 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Reader for xar archives: a binary header, a zlib-compressed XML table of contents, then
+// the heap holding each member's data at the offset the TOC records.
+namespace xar {
+    enum class Encoding {
+        None,
+        Gzip,
+        Bzip2,
+        Xz,
+        Unsupported,
+    };
+
+    struct Member {
+        // Joined from the nested <file> names.
+        std::string path;
+        std::string type;  // "file", "directory", "symlink", "hardlink", ...
+        bool is_directory = false;
+        bool is_symlink = false;
+        std::string link_target;
+        bool has_data = false;
+        uint64_t size = 0;    // extracted bytes
+        uint64_t length = 0;  // archived bytes on the heap
+        uint64_t offset = 0;  // relative to the heap start
+        Encoding encoding = Encoding::None;
+        uint32_t mode = 0;
+        bool has_mtime = false;
+        int64_t mtime = 0;  // Unix seconds
+    };
+
+    struct Index {
+        std::vector<Member> members;
+        uint64_t heap_offset = 0;
+        bool valid = false;
+    };
+
+    bool has_signature(const std::string& path);
+    Index read_index(const std::string& path);
+    const char* encoding_name(Encoding encoding);
+    bool can_decode(const Member& member);
+    // Streams the member's extracted bytes; stops early when sink returns false. Fails when the
+    // data is corrupt or its extracted size does not match the TOC.
+    bool decode_member(const std::string& path, const Index& index, const Member& member,
+                       const std::function<bool(const char*, size_t)>& sink);
+}
@@ -0,0 +1,269 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "include/archive.h"
+#include "include/archive_backend.h"
+#include "include/args.h"
+#include "include/error.h"
+#include "include/operation.h"
+#include "include/tui_archive_ops.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace archive {
+    namespace {
+        bool is_archive_type(file_type::FileType type) {
+            return type != file_type::FileType::UNKNOWN &&
+                   type != file_type::FileType::REGULAR_FILE &&
+                   type != file_type::FileType::DIRECTORY;
+        }
+
+        bool is_single_file_format(file_type::FileType type) {
+            return type == file_type::FileType::ARCHIVE_LZ4 || type == file_type::FileType::ARCHIVE_ZSTD;
+        }
+
+        args::Options library_options(const std::string& password, const progress::Callback& on_progress) {
+            args::Options options;
+            options.quiet = true;
+            options.password = password;
+            options.progress_callback = on_progress;
+            return options;
+        }
+
+        fs::path make_staging_dir() {
+            static std::atomic<unsigned> counter{0};
+#ifdef _WIN32
+            int process_id = _getpid();
+#else
+            int process_id = static_cast<int>(::getpid());
+#endif
+            fs::path base = fs::temp_directory_path();
+            for (int attempt = 0; attempt < 100; ++attempt) {
+                fs::path candidate = base / ("hitpag-writer-" + std::to_string(process_id) + "-" + std::to_string(counter++));
+                std::error_code ec;
+                if (fs::create_directories(candidate, ec)) return candidate;
+            }
+            error::throw_error(error::ErrorCode::INVALID_TARGET, {{"PATH", base.string()}, {"REASON", "cannot create a staging directory"}});
+            return {};
+        }
+
+        // A staged file may be a hard link to the caller's source, so an entry added again is
+        // unlinked first; writing through the old name would change the source itself.
+        void unstage(const fs::path& target) {
+            std::error_code ec;
+            if (!fs::is_directory(fs::symlink_status(target, ec))) fs::remove(target, ec);
+        }
+
+        // Hard links cost nothing when source and staging share a filesystem.
+        void stage_file(const fs::path& source, const fs::path& target) {
+            unstage(target);
+            std::error_code ec;
+            fs::create_hard_link(source, target, ec);
+            if (!ec) return;
+            fs::copy_file(source, target, ec);
+            if (ec) {
+                error::throw_error(error::ErrorCode::INVALID_SOURCE, {{"PATH", source.string()}, {"REASON", ec.message()}});
+            }
+        }
+    }
+
+    ArchiveReader::ArchiveReader(const std::string& path, const std::string& password)
+        : ArchiveReader(path, file_type::recognize_source_type(path), password) {}
+
+    ArchiveReader::ArchiveReader(const std::string& path, file_type::FileType type, const std::string& password)
+        : path_(path), type_(type), password_(password) {
+        if (!fs::exists(path_)) {
+            error::throw_error(error::ErrorCode::INVALID_SOURCE, {{"PATH", path_}});
+        }
+        if (!is_archive_type(type_)) {
+            error::throw_error(error::ErrorCode::UNKNOWN_FORMAT, {{"INFO", path_}});
+        }
+    }
+
+    const std::vector<Entry>& ArchiveReader::entries() {
+        if (!listed_) {
+            entries_ = tui::archive_ops::list_archive(path_, type_, password_);
+            listed_ = true;
+        }
+        return entries_;
+    }
+
+    const Entry* ArchiveReader::find(const std::string& entry_path) {
+        for (const auto& entry : entries()) {
+            if (entry.path == entry_path) return &entry;
+        }
+        return nullptr;
+    }
+
+    void ArchiveReader::for_each(const std::function<bool(const Entry&)>& visit) {
+        for (const auto& entry : entries()) {
+            if (!visit(entry)) return;
+        }
+    }
+
+    void ArchiveReader::read_stream(const std::string& entry_path, const StreamSink& sink) {
+        backend::Archive archive{path_, type_, password_};
+        backend::ArchiveBackend& preferred = backend::registry().require(backend::Operation::ReadEntry, archive);
+        if (!backend::registry().read_entry(archive, entry_path, sink)) {
+            error::throw_error(error::ErrorCode::OPERATION_FAILED, {{"COMMAND", preferred.name() + " read " + entry_path}, {"EXIT_CODE", "-1"}});
+        }
+    }
+
+    std::string ArchiveReader::read(const std::string& entry_path) {
+        std::string content;
+        read_stream(entry_path, [&](const char* data, size_t size) {
+            content.append(data, size);
+            return true;
+        });
+        return content;
+    }
+
+    size_t ArchiveReader::read(const std::string& entry_path, uint64_t offset, char* buffer, size_t size) {
+        backend::Archive archive{path_, type_, password_};
+        backend::ArchiveBackend& preferred = backend::registry().require(backend::Operation::ReadEntry, archive);
+        size_t copied = 0;
+        if (!backend::registry().read_at(archive, entry_path, offset, buffer, size, copied)) {
+            error::throw_error(error::ErrorCode::OPERATION_FAILED, {{"COMMAND", preferred.name() + " read " + entry_path}, {"EXIT_CODE", "-1"}});
+        }
+        return copied;
+    }
+
+    void ArchiveReader::extract(const std::string& entry_path, const std::string& output_dir) {
+        std::error_code ec;
+        fs::create_directories(output_dir, ec);
+        if (ec) {
+            error::throw_error(error::ErrorCode::INVALID_TARGET, {{"PATH", output_dir}, {"REASON", ec.message()}});
+        }
+        if (!tui::archive_ops::extract_single(path_, entry_path, output_dir, type_, password_)) {
+            error::throw_error(error::ErrorCode::OPERATION_FAILED, {{"COMMAND", "extract " + entry_path}, {"EXIT_CODE", "-1"}});
+        }
+    }
+
+    void ArchiveReader::extract_all(const std::string& output_dir, const progress::Callback& on_progress) {
+        progress::ProgressTracker tracker;
+        operation::decompress(path_, output_dir, type_, password_, library_options(password_, on_progress), tracker);
+    }
+
+    bool ArchiveReader::verify() {
+        return operation::verify_archive(path_, type_, true);
+    }
+
+    void ArchiveWriter::EntryStream::write(const char* data, size_t size) {
+        output_.write(data, static_cast<std::streamsize>(size));
+        if (!output_) {
+            error::throw_error(error::ErrorCode::INVALID_TARGET, {{"PATH", path_}, {"REASON", "write failed"}});
+        }
+    }
+
+    void ArchiveWriter::EntryStream::close() {
+        output_.close();
+    }
+
+    ArchiveWriter::ArchiveWriter(const std::string& path, WriterOptions options)
+        : ArchiveWriter(path, file_type::recognize_by_extension(path), std::move(options)) {}
+
+    ArchiveWriter::ArchiveWriter(const std::string& path, file_type::FileType format, WriterOptions options)
+        : path_(path), format_(format), options_(std::move(options)) {
+        if (!is_archive_type(format_)) {
+            error::throw_error(error::ErrorCode::UNKNOWN_FORMAT, {{"INFO", path_}});
+        }
+        staging_dir_ = make_staging_dir().string();
+    }
+
+    ArchiveWriter::~ArchiveWriter() {
+        std::error_code ec;
+        fs::remove_all(staging_dir_, ec);
+    }
+
+    std::string ArchiveWriter::staged_path(const std::string& entry_path) const {
+        fs::path relative = fs::path(entry_path).lexically_normal();
+        if (relative.empty() || relative.is_absolute() || *relative.begin() == "..") {
+            error::throw_error(error::ErrorCode::INVALID_TARGET, {{"PATH", entry_path}, {"REASON", "entry paths must stay inside the archive"}});
+        }
+        fs::path staged = fs::path(staging_dir_) / relative;
+        fs::create_directories(staged.parent_path());
+        return staged.string();
+    }
+
+    void ArchiveWriter::add_file(const std::string& source_path, const std::string& entry_path) {
+        stage_file(source_path, staged_path(entry_path));
+    }
+
+    void ArchiveWriter::add_directory(const std::string& source_path, const std::string& entry_path) {
+        fs::path root = staged_path(entry_path);
+        fs::create_directories(root);
+        for (const auto& item : fs::recursive_directory_iterator(source_path)) {
+            fs::path target = root / fs::relative(item.path(), source_path);
+            if (item.is_symlink()) {
+                unstage(target);
+                fs::copy_symlink(item.path(), target);
+            } else if (item.is_directory()) {
+                fs::create_directories(target);
+            } else {
+                stage_file(item.path(), target);
+            }
+        }
+    }
+
+    void ArchiveWriter::add_data(const std::string& entry_path, const std::string& data) {
+        EntryStream stream = open_entry(entry_path);
+        stream.write(data);
+        stream.close();
+    }
+
+    ArchiveWriter::EntryStream ArchiveWriter::open_entry(const std::string& entry_path) {
+        std::string path = staged_path(entry_path);
+        unstage(path);
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        if (!output) {
+            error::throw_error(error::ErrorCode::INVALID_TARGET, {{"PATH", path}, {"REASON", "cannot create entry"}});
+        }
+        return EntryStream(path, std::move(output));
+    }
+
+    void ArchiveWriter::finish(const progress::Callback& on_progress) {
+        if (finished_) return;
+
+        // Top-level entries are passed one by one so member names carry no "./" prefix.
+        std::vector<operation::CompressionSource> sources;
+        for (const auto& item : fs::directory_iterator(staging_dir_)) {
+            sources.push_back({item.path().string(), false});
+        }
+        std::sort(sources.begin(), sources.end(), [](const auto& a, const auto& b) { return a.path < b.path; });
+        if (sources.empty()) {
+            error::throw_error(error::ErrorCode::INVALID_SOURCE, {{"PATH", path_}, {"REASON", "no entries were added"}});
+        }
+        if (is_single_file_format(format_) && (sources.size() != 1 || !fs::is_regular_file(sources.front().path))) {
+            error::throw_error(error::ErrorCode::INVALID_SOURCE, {{"PATH", path_}, {"REASON", "single-file formats hold exactly one entry"}});
+        }
+
+        // Tools such as zip append to an existing archive; a writer always starts fresh.
+        std::error_code ec;
+        fs::remove(path_, ec);
+
+        args::Options options = library_options(options_.password, on_progress);
+        options.compression_level = options_.compression_level;
+        options.thread_count = options_.thread_count;
+        progress::ProgressTracker tracker;
+        operation::compress(sources, path_, format_, options_.password, options, tracker);
+
+        if (options_.verify && !operation::verify_archive(path_, format_, true)) {
+            error::throw_error(error::ErrorCode::OPERATION_FAILED, {{"COMMAND", "verify " + path_}, {"EXIT_CODE", "1"}});
+        }
+        finished_ = true;
+        fs::remove_all(staging_dir_, ec);
+    }
+}
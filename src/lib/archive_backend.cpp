@@ -0,0 +1,217 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "include/archive_backend.h"
+#include "include/error.h"
+
+#include <algorithm>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace backend {
+    namespace {
+        constexpr double kBytesPerMiB = 1024.0 * 1024.0;
+        // Weight of a new observation in the moving average.
+        constexpr double kMeasuredWeight = 0.3;
+
+        double archive_mib(const Archive& archive) {
+            std::error_code ec;
+            uint64_t bytes = fs::file_size(archive.path, ec);
+            return ec ? 1.0 : std::max(1.0, static_cast<double>(bytes) / kBytesPerMiB);
+        }
+    }
+
+    const char* operation_name(Operation op) {
+        switch (op) {
+            case Operation::List: return "list";
+            case Operation::ReadEntry: return "read";
+            case Operation::Seek: return "seek";
+            case Operation::ExtractEntry: return "extract-entry";
+            case Operation::Extract: return "extract";
+            case Operation::Create: return "create";
+            case Operation::Verify: return "verify";
+        }
+        return "unknown";
+    }
+
+    double Cost::estimate(uint64_t bytes) const {
+        return startup_ms + ms_per_mib * static_cast<double>(bytes) / kBytesPerMiB;
+    }
+
+    std::vector<ArchiveEntry> ArchiveBackend::list(const Archive&) { return {}; }
+
+    bool ArchiveBackend::empty(const Archive&) { return false; }
+
+    bool ArchiveBackend::read_entry(const Archive&, const std::string&, const StreamSink&) { return false; }
+
+    bool ArchiveBackend::read_at(const Archive&, const std::string&, uint64_t, char*, size_t, size_t& copied) {
+        copied = 0;
+        return false;
+    }
+
+    bool ArchiveBackend::extract_entry(const Archive&, const std::string&, const std::string&) { return false; }
+
+    int ArchiveBackend::extract(const Archive&, const std::string&, const JobContext&) { return -1; }
+
+    int ArchiveBackend::create(const Archive&, const CreateJob&, const JobContext&) { return -1; }
+
+    int ArchiveBackend::verify(const Archive&, const JobContext&) { return -1; }
+
+    void Registry::add(std::unique_ptr<ArchiveBackend> backend) {
+        capabilities_.push_back(backend->capabilities());
+        backends_.push_back(std::move(backend));
+    }
+
+    const Capability* Registry::find_capability(const ArchiveBackend& backend, Operation op, file_type::FileType format) const {
+        for (size_t i = 0; i < backends_.size(); ++i) {
+            if (backends_[i].get() != &backend) continue;
+            for (const auto& capability : capabilities_[i]) {
+                if (capability.operation == op && capability.format == format) return &capability;
+            }
+        }
+        return nullptr;
+    }
+
+    bool Registry::declares(Operation op, file_type::FileType format) const {
+        for (const auto& backend : backends_) {
+            if (find_capability(*backend, op, format)) return true;
+        }
+        return false;
+    }
+
+    double Registry::estimate_ms(const ArchiveBackend& backend, Operation op, const Archive& archive) const {
+        {
+            std::lock_guard<std::mutex> lock(measured_mutex_);
+            auto it = measured_.find(CostKey{&backend, op, archive.format});
+            if (it != measured_.end()) return it->second * archive_mib(archive);
+        }
+        const Capability* capability = find_capability(backend, op, archive.format);
+        if (!capability) return -1.0;
+        std::error_code ec;
+        uint64_t bytes = fs::file_size(archive.path, ec);
+        return capability->cost.estimate(ec ? 0 : bytes);
+    }
+
+    void Registry::record(const ArchiveBackend& backend, Operation op, const Archive& archive, double elapsed_ms) {
+        double per_mib = elapsed_ms / archive_mib(archive);
+        std::lock_guard<std::mutex> lock(measured_mutex_);
+        auto inserted = measured_.emplace(CostKey{&backend, op, archive.format}, per_mib);
+        if (!inserted.second) {
+            inserted.first->second += kMeasuredWeight * (per_mib - inserted.first->second);
+        }
+    }
+
+    std::vector<ArchiveBackend*> Registry::candidates(Operation op, const Archive& archive) const {
+        std::vector<std::pair<double, ArchiveBackend*>> ranked;
+        for (const auto& backend : backends_) {
+            if (!find_capability(*backend, op, archive.format)) continue;
+            if (!backend->available() || !backend->accepts(op, archive)) continue;
+            ranked.emplace_back(estimate_ms(*backend, op, archive), backend.get());
+        }
+        // Stable so that equal estimates keep registration order.
+        std::stable_sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        std::vector<ArchiveBackend*> result;
+        result.reserve(ranked.size());
+        for (const auto& item : ranked) result.push_back(item.second);
+        return result;
+    }
+
+    ArchiveBackend* Registry::select(Operation op, const Archive& archive) const {
+        std::vector<ArchiveBackend*> ranked = candidates(op, archive);
+        return ranked.empty() ? nullptr : ranked.front();
+    }
+
+    ArchiveBackend& Registry::require(Operation op, const Archive& archive) const {
+        ArchiveBackend* selected = select(op, archive);
+        if (!selected) {
+            for (const auto& backend : backends_) {
+                if (find_capability(*backend, op, archive.format)) {
+                    error::throw_error(error::ErrorCode::TOOL_NOT_FOUND, {{"TOOL_NAME", backend->name()}});
+                }
+            }
+            error::throw_error(error::ErrorCode::UNKNOWN_FORMAT,
+                {{"INFO", std::string("No backend can ") + operation_name(op) + " " + file_type::get_file_type_string(archive.format)}});
+        }
+        return *selected;
+    }
+
+    std::vector<ArchiveEntry> Registry::list(const Archive& archive) {
+        for (ArchiveBackend* backend : candidates(Operation::List, archive)) {
+            std::vector<ArchiveEntry> entries = timed(*backend, Operation::List, archive, [&]() { return backend->list(archive); });
+            if (!entries.empty()) return entries;
+        }
+        return {};
+    }
+
+    bool Registry::empty(const Archive& archive) {
+        for (ArchiveBackend* backend : candidates(Operation::List, archive)) {
+            if (backend->empty(archive)) return true;
+        }
+        return false;
+    }
+
+    bool Registry::read_entry(const Archive& archive, const std::string& entry, const StreamSink& sink) {
+        for (ArchiveBackend* backend : candidates(Operation::ReadEntry, archive)) {
+            bool delivered = false;
+            bool ok = timed(*backend, Operation::ReadEntry, archive, [&]() {
+                return backend->read_entry(archive, entry, [&](const char* data, size_t size) {
+                    delivered = true;
+                    return sink(data, size);
+                });
+            });
+            // Output already handed to the sink cannot be taken back, so only a silent failure falls through.
+            if (ok || delivered) return ok;
+        }
+        return false;
+    }
+
+    bool Registry::read_at(const Archive& archive, const std::string& entry, uint64_t offset, char* buffer, size_t size, size_t& copied) {
+        copied = 0;
+        for (ArchiveBackend* backend : candidates(Operation::Seek, archive)) {
+            if (backend->read_at(archive, entry, offset, buffer, size, copied)) return true;
+        }
+        if (size == 0) return true;
+
+        uint64_t position = 0;
+        return read_entry(archive, entry, [&](const char* data, size_t length) {
+            uint64_t chunk_end = position + length;
+            if (chunk_end > offset) {
+                size_t skip = position < offset ? static_cast<size_t>(offset - position) : 0;
+                size_t take = std::min(length - skip, size - copied);
+                std::copy(data + skip, data + skip + take, buffer + copied);
+                copied += take;
+            }
+            position = chunk_end;
+            return copied < size;
+        });
+    }
+
+    bool Registry::extract_entry(const Archive& archive, const std::string& entry, const std::string& output_dir) {
+        for (ArchiveBackend* backend : candidates(Operation::ExtractEntry, archive)) {
+            if (timed(*backend, Operation::ExtractEntry, archive, [&]() { return backend->extract_entry(archive, entry, output_dir); })) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Registry& registry() {
+        static Registry instance;
+        static const bool populated = []() {
+            instance.add(make_native_tar_backend());
+            instance.add(make_native_zip_backend());
+            instance.add(make_native_7z_backend());
+            instance.add(make_native_rar_backend());
+            instance.add(make_native_xar_backend());
+            for (auto& tool : make_tool_backends()) instance.add(std::move(tool));
+            return true;
+        }();
+        (void)populated;
+        return instance;
+    }
+}
@@ -0,0 +1,388 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "include/archive_diff.h"
+#include "include/archive_backend.h"
+#include "include/checksum.h"
+#include "include/error.h"
+#include "include/executor.h"
+#include "include/i18n.h"
+#include "include/operation.h"
+#include "include/tar_header.h"
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+namespace archive_diff {
+    using tui::archive_ops::ArchiveEntry;
+
+    namespace {
+        bool is_tar_family(file_type::FileType type) {
+            return type == file_type::FileType::ARCHIVE_TAR ||
+                   type == file_type::FileType::ARCHIVE_TAR_GZ ||
+                   type == file_type::FileType::ARCHIVE_TAR_BZ2 ||
+                   type == file_type::FileType::ARCHIVE_TAR_XZ ||
+                   type == file_type::FileType::ARCHIVE_TAR_ZSTD;
+        }
+
+        std::string normalize_path(std::string path) {
+            while (path.rfind("./", 0) == 0) path.erase(0, 2);
+            while (!path.empty() && path.back() == '/') path.pop_back();
+            return path;
+        }
+
+        // Incremental ustar/GNU/pax parser that CRCs member data as the stream passes by.
+        class TarChecksumScanner {
+        public:
+            bool feed(const char* data, size_t size) {
+                while (size > 0 && !finished_) {
+                    if (state_ == State::Header) {
+                        size_t take = std::min(size, header_.size() - header_fill_);
+                        std::copy(data, data + take, header_.begin() + header_fill_);
+                        header_fill_ += take;
+                        data += take;
+                        size -= take;
+                        if (header_fill_ == header_.size()) {
+                            header_fill_ = 0;
+                            parse_header();
+                        }
+                        continue;
+                    }
+
+                    size_t take = static_cast<size_t>(std::min<uint64_t>(size, remaining_));
+                    if (state_ == State::Data) {
+                        ArchiveEntry& entry = entries_.back();
+                        entry.crc = checksum::crc32(entry.crc, data, take);
+                    } else if (state_ == State::Meta) {
+                        meta_.append(data, take);
+                    }
+                    data += take;
+                    size -= take;
+                    remaining_ -= take;
+                    if (remaining_ == 0) finish_member();
+                }
+                return !finished_;
+            }
+
+            std::vector<ArchiveEntry> take_entries() { return std::move(entries_); }
+
+        private:
+            enum class State { Header, Data, Meta, Skip };
+
+            std::array<char, 512> header_{};
+            size_t header_fill_ = 0;
+            State state_ = State::Header;
+            uint64_t remaining_ = 0;
+            uint64_t padding_ = 0;
+            char meta_type_ = 0;
+            std::string meta_;
+            std::string pending_path_;
+            bool has_pending_size_ = false;
+            uint64_t pending_size_ = 0;
+            int zero_blocks_ = 0;
+            bool finished_ = false;
+            std::vector<ArchiveEntry> entries_;
+
+            void parse_header() {
+                if (std::all_of(header_.begin(), header_.end(), [](char c) { return c == '\0'; })) {
+                    if (++zero_blocks_ >= 2) finished_ = true;
+                    return;
+                }
+                zero_blocks_ = 0;
+
+                const char* h = header_.data();
+                uint64_t size = tar_header::parse_number(h + 124, 12);
+                char type = h[156];
+
+                if (type == 'L' || type == 'x' || type == 'g' || type == 'K') {
+                    meta_type_ = type;
+                    meta_.clear();
+                    begin_payload(State::Meta, size);
+                    return;
+                }
+
+                std::string name = tar_header::member_name(h);
+                if (!pending_path_.empty()) name = pending_path_;
+                if (has_pending_size_) size = pending_size_;
+                pending_path_.clear();
+                has_pending_size_ = false;
+
+                bool data_member = (type == '0' || type == '\0' || type == '7');
+                bool header_only = (type >= '1' && type <= '6');
+                name = normalize_path(name);
+                if (name.empty() || name == "." || (!data_member && !header_only)) {
+                    begin_payload(State::Skip, header_only ? 0 : size);
+                    return;
+                }
+
+                ArchiveEntry entry;
+                entry.path = name;
+                entry.is_directory = (type == '5');
+                entry.has_crc = !entry.is_directory;
+                if (type == '1' || type == '2') {
+                    std::string link = tar_header::field_string(h + 157, 100);
+                    entry.method = (type == '1') ? "hardlink" : "symlink";
+                    entry.crc = checksum::crc32(0, link.data(), link.size());
+                }
+                if (data_member) entry.size = size;
+                entries_.push_back(std::move(entry));
+
+                begin_payload(data_member ? State::Data : State::Skip, data_member ? size : 0);
+            }
+
+            void begin_payload(State state, uint64_t size) {
+                state_ = state;
+                remaining_ = size;
+                padding_ = (512 - size % 512) % 512;
+                if (remaining_ == 0) finish_member();
+            }
+
+            void finish_member() {
+                if (state_ == State::Meta) apply_meta();
+                if (padding_ > 0) {
+                    remaining_ = padding_;
+                    padding_ = 0;
+                    state_ = State::Skip;
+                    return;
+                }
+                state_ = State::Header;
+            }
+
+            void apply_meta() {
+                if (meta_type_ == 'L') {
+                    pending_path_ = tar_header::field_string(meta_.data(), meta_.size());
+                } else if (meta_type_ == 'x') {
+                    tar_header::PaxOverrides overrides = tar_header::parse_pax(meta_);
+                    if (!overrides.path.empty()) pending_path_ = overrides.path;
+                    if (overrides.has_size) {
+                        pending_size_ = overrides.size;
+                        has_pending_size_ = true;
+                    }
+                }
+                meta_.clear();
+            }
+        };
+
+        std::vector<std::string> tar_decompress_command(const std::string& archive_path, file_type::FileType type) {
+            switch (type) {
+                case file_type::FileType::ARCHIVE_TAR_GZ: return {"gzip", "-dc", archive_path};
+                case file_type::FileType::ARCHIVE_TAR_BZ2: return {"bzip2", "-dc", archive_path};
+                case file_type::FileType::ARCHIVE_TAR_XZ: return {"xz", "-dc", archive_path};
+                case file_type::FileType::ARCHIVE_TAR_ZSTD: return {"zstd", "-dc", archive_path};
+                default: return {};
+            }
+        }
+
+        std::vector<ArchiveEntry> scan_tar(const std::string& archive_path, file_type::FileType type) {
+            TarChecksumScanner scanner;
+            std::vector<std::string> cmd = tar_decompress_command(archive_path, type);
+            if (cmd.empty()) {
+                std::ifstream input(archive_path, std::ios::binary);
+                if (!input) {
+                    error::throw_error(error::ErrorCode::INVALID_SOURCE, {{"PATH", archive_path}});
+                }
+                std::vector<char> buffer(256 * 1024);
+                while (input) {
+                    input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                    if (input.gcount() <= 0 || !scanner.feed(buffer.data(), static_cast<size_t>(input.gcount()))) break;
+                }
+            } else {
+                if (!operation::is_tool_available(cmd.front())) {
+                    error::throw_error(error::ErrorCode::TOOL_NOT_FOUND, {{"TOOL_NAME", cmd.front()}});
+                }
+                int status = tui::archive_ops::run_command_stream(cmd, [&](const char* data, size_t size) {
+                    return scanner.feed(data, size);
+                });
+                if (status != 0) {
+                    error::throw_error(error::ErrorCode::OPERATION_FAILED, {{"COMMAND", cmd.front()}, {"EXIT_CODE", std::to_string(status)}});
+                }
+            }
+            return scanner.take_entries();
+        }
+
+        bool same_method_family(file_type::FileType a, file_type::FileType b) {
+            return a == b || (is_tar_family(a) && is_tar_family(b));
+        }
+    }
+
+    std::vector<ArchiveEntry> checksummed_listing(const std::string& archive_path,
+                                                  file_type::FileType type,
+                                                  const std::string& password,
+                                                  int thread_count,
+                                                  bool* used_content_hashes) {
+        std::vector<ArchiveEntry> entries;
+        if (is_tar_family(type)) {
+            entries = scan_tar(archive_path, type);
+            if (used_content_hashes) *used_content_hashes = true;
+        } else {
+            entries = tui::archive_ops::list_archive(archive_path, type, password);
+            if (entries.empty() && !backend::registry().empty({archive_path, type, password})) {
+                error::throw_error(error::ErrorCode::OPERATION_FAILED,
+                    {{"COMMAND", i18n::get("diff_list_command", {{"PATH", archive_path}})}, {"EXIT_CODE", "-"}});
+            }
+
+            std::vector<size_t> missing;
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (!entries[i].is_directory && !entries[i].has_crc) missing.push_back(i);
+            }
+            if (!missing.empty() && used_content_hashes) *used_content_hashes = true;
+
+            executor::global().parallel_for(missing.size(), thread_count, [&](size_t i) {
+                ArchiveEntry& entry = entries[missing[i]];
+                uint64_t size = 0;
+                uint32_t crc = 0;
+                bool read = tui::archive_ops::stream_entry(archive_path, entry.path, type, password, [&](const char* data, size_t length) {
+                    crc = checksum::crc32(crc, data, length);
+                    size += length;
+                    return true;
+                });
+                // A member that cannot be read must not pass for an empty one.
+                if (!read) {
+                    error::throw_error(error::ErrorCode::OPERATION_FAILED,
+                        {{"COMMAND", i18n::get("diff_read_command", {{"PATH", archive_path}, {"ENTRY", entry.path}})}, {"EXIT_CODE", "-"}});
+                }
+                entry.size = size;
+                entry.crc = crc;
+                entry.has_crc = true;
+            });
+        }
+
+        for (auto& entry : entries) {
+            entry.path = normalize_path(entry.path);
+        }
+        return entries;
+    }
+
+    DiffResult diff(const std::string& old_path, file_type::FileType old_type,
+                    const std::string& new_path, file_type::FileType new_type,
+                    const std::string& password, int thread_count) {
+        std::array<std::vector<ArchiveEntry>, 2> listings;
+        std::array<bool, 2> hashed{false, false};
+        executor::global().parallel_for(2, 2, [&](size_t side) {
+            bool used = false;
+            listings[side] = side == 0
+                ? checksummed_listing(old_path, old_type, password, thread_count, &used)
+                : checksummed_listing(new_path, new_type, password, thread_count, &used);
+            hashed[side] = used;
+        });
+
+        std::map<std::string, const ArchiveEntry*> old_index;
+        std::map<std::string, const ArchiveEntry*> new_index;
+        for (const auto& entry : listings[0]) if (!entry.path.empty()) old_index[entry.path] = &entry;
+        for (const auto& entry : listings[1]) if (!entry.path.empty()) new_index[entry.path] = &entry;
+
+        bool compare_methods = same_method_family(old_type, new_type);
+        DiffResult result;
+        result.used_content_hashes = hashed[0] || hashed[1];
+
+        auto old_it = old_index.begin();
+        auto new_it = new_index.begin();
+        while (old_it != old_index.end() || new_it != new_index.end()) {
+            if (new_it == new_index.end() || (old_it != old_index.end() && old_it->first < new_it->first)) {
+                const ArchiveEntry& entry = *old_it->second;
+                result.changes.push_back({ChangeKind::Removed, entry.path, entry.is_directory, entry.size, 0, entry.method, ""});
+                ++old_it;
+                continue;
+            }
+            if (old_it == old_index.end() || new_it->first < old_it->first) {
+                const ArchiveEntry& entry = *new_it->second;
+                result.changes.push_back({ChangeKind::Added, entry.path, entry.is_directory, 0, entry.size, "", entry.method});
+                ++new_it;
+                continue;
+            }
+
+            const ArchiveEntry& before = *old_it->second;
+            const ArchiveEntry& after = *new_it->second;
+            bool changed = before.is_directory != after.is_directory;
+            if (!changed && !before.is_directory) {
+                changed = before.size != after.size ||
+                          (before.has_crc && after.has_crc && before.crc != after.crc) ||
+                          (compare_methods && !before.method.empty() && !after.method.empty() && before.method != after.method);
+            }
+            if (changed) {
+                result.changes.push_back({ChangeKind::Changed, after.path, after.is_directory, before.size, after.size, before.method, after.method});
+            } else {
+                ++result.unchanged;
+            }
+            ++old_it;
+            ++new_it;
+        }
+
+        return result;
+    }
+
+    void run(const args::Options& options, progress::ProgressTracker& tracker) {
+        const std::string& old_path = options.source_path;
+        const std::string& new_path = options.target_path;
+
+        auto resolve_type = [&](const std::string& path) {
+            file_type::FileType type = file_type::recognize_source_type(path);
+            if (!options.force_format.empty()) {
+                type = file_type::parse_format_string(options.force_format);
+            }
+            if (type == file_type::FileType::UNKNOWN || type == file_type::FileType::REGULAR_FILE ||
+                type == file_type::FileType::DIRECTORY) {
+                error::throw_error(error::ErrorCode::UNKNOWN_FORMAT, {{"INFO", path}});
+            }
+            return type;
+        };
+
+        file_type::FileType old_type = resolve_type(old_path);
+        file_type::FileType new_type = resolve_type(new_path);
+
+        if (options.benchmark) {
+            tracker.start_operation();
+            tracker.begin_phase("list", file_type::get_format_name(old_type) + "," + file_type::get_format_name(new_type));
+        }
+        DiffResult result = diff(old_path, old_type, new_path, new_type, options.password, options.thread_count);
+        if (options.benchmark) {
+            tracker.end_operation();
+            std::error_code ec_old, ec_new;
+            uint64_t old_size = std::filesystem::file_size(old_path, ec_old);
+            uint64_t new_size = std::filesystem::file_size(new_path, ec_new);
+            tracker.end_phase((ec_old ? 0 : old_size) + (ec_new ? 0 : new_size), 0);
+        }
+
+        size_t added = 0, removed = 0, changed = 0;
+        for (const auto& change : result.changes) {
+            char marker = 'M';
+            if (change.kind == ChangeKind::Added) { marker = 'A'; ++added; }
+            else if (change.kind == ChangeKind::Removed) { marker = 'D'; ++removed; }
+            else { ++changed; }
+
+            std::cout << marker << '\t' << change.path << (change.is_directory ? "/" : "");
+            if (options.verbose && !change.is_directory) {
+                if (change.kind == ChangeKind::Changed) {
+                    std::cout << '\t' << change.old_size << " -> " << change.new_size;
+                    if (change.old_method != change.new_method) {
+                        std::cout << '\t' << change.old_method << " -> " << change.new_method;
+                    }
+                } else {
+                    std::cout << '\t' << (change.kind == ChangeKind::Added ? change.new_size : change.old_size);
+                }
+            }
+            std::cout << '\n';
+        }
+
+        std::cout << i18n::get("diff_summary", {
+            {"ADDED", std::to_string(added)},
+            {"REMOVED", std::to_string(removed)},
+            {"CHANGED", std::to_string(changed)},
+            {"UNCHANGED", std::to_string(result.unchanged)}
+        }) << std::endl;
+
+        if (options.verbose && result.used_content_hashes) {
+            std::cout << i18n::get("diff_used_hashes") << std::endl;
+        }
+        if (options.benchmark) {
+            tracker.print_stats(options.verbose, options.benchmark);
+        }
+    }
+}
@@ -0,0 +1,407 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "include/archive_scan.h"
+#include "include/archive_backend.h"
+#include "include/error.h"
+#include "include/executor.h"
+#include "include/i18n.h"
+#include "include/trace.h"
+#include "include/util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace archive_scan {
+    namespace {
+        struct Candidate {
+            std::string path;
+            uint64_t size = 0;
+            int64_t mtime = 0;
+        };
+
+        bool is_archive_type(file_type::FileType type) {
+            return type != file_type::FileType::UNKNOWN &&
+                   type != file_type::FileType::REGULAR_FILE &&
+                   type != file_type::FileType::DIRECTORY;
+        }
+
+        std::string escape_field(const std::string& value) {
+            std::string escaped;
+            escaped.reserve(value.size());
+            for (char c : value) {
+                if (c == '\\') escaped += "\\\\";
+                else if (c == '\t') escaped += "\\t";
+                else if (c == '\n') escaped += "\\n";
+                else escaped += c;
+            }
+            return escaped;
+        }
+
+        std::string unescape_field(const std::string& value) {
+            std::string plain;
+            plain.reserve(value.size());
+            for (size_t i = 0; i < value.size(); ++i) {
+                if (value[i] == '\\' && i + 1 < value.size()) {
+                    char next = value[++i];
+                    plain += next == 't' ? '\t' : next == 'n' ? '\n' : next;
+                } else {
+                    plain += value[i];
+                }
+            }
+            return plain;
+        }
+
+        bool parse_status(const std::string& name, Status& status) {
+            if (name == "ok") status = Status::Ok;
+            else if (name == "failed") status = Status::Failed;
+            else if (name == "cached") status = Status::Cached;
+            else if (name == "missing-tool") status = Status::ToolMissing;
+            else return false;
+            return true;
+        }
+
+        // Nanoseconds since the Unix epoch where available, so reports stay meaningful to other tools.
+        int64_t modification_time(const fs::directory_entry& entry, std::error_code& ec) {
+#ifndef _WIN32
+            struct stat info {};
+            if (::stat(entry.path().c_str(), &info) == 0) {
+                return static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000LL + info.st_mtim.tv_nsec;
+            }
+#endif
+            return static_cast<int64_t>(entry.last_write_time(ec).time_since_epoch().count());
+        }
+
+        std::vector<Candidate> walk(const std::string& root) {
+            trace::Span span("walk_directory", "fs");
+            span.arg("path", root);
+            std::vector<Candidate> candidates;
+            std::error_code ec;
+            fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec);
+            if (ec) {
+                error::throw_error(error::ErrorCode::INVALID_SOURCE, {{"PATH", root}, {"REASON", ec.message()}});
+            }
+            for (; it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (ec) break;
+                std::error_code entry_ec;
+                if (!it->is_regular_file(entry_ec)) continue;
+                Candidate candidate;
+                candidate.path = it->path().string();
+                candidate.size = it->file_size(entry_ec);
+                if (entry_ec) continue;
+                candidate.mtime = modification_time(*it, entry_ec);
+                candidates.push_back(std::move(candidate));
+            }
+            return candidates;
+        }
+
+        // Paths per parallel_for index, and paths gathered before each parallel pass.
+        constexpr size_t kIdentifyBatch = 64;
+        constexpr size_t kIdentifyChunk = 4096;
+
+        void identify_file(IdentifyRecord& record, std::vector<char>& head) {
+#ifndef _WIN32
+            // Non-blocking so a FIFO in the input cannot stall the worker in open().
+            int fd = ::open(record.path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+            if (fd < 0) return;
+            struct stat info {};
+            if (::fstat(fd, &info) == 0) {
+                record.readable = true;
+                if (S_ISDIR(info.st_mode)) {
+                    record.type = file_type::FileType::DIRECTORY;
+                } else if (S_ISREG(info.st_mode)) {
+                    head.resize(file_type::HEADER_READ_SIZE);
+                    ssize_t got = ::pread(fd, head.data(), head.size(), 0);
+                    if (got < 0) {
+                        record.readable = false;
+                    } else {
+                        head.resize(static_cast<size_t>(got));
+                        off_t offset = got;
+                        record.type = file_type::recognize_header_bytes(head, [&](char* out, size_t capacity) -> size_t {
+                            ssize_t more = ::pread(fd, out, capacity, offset);
+                            if (more <= 0) return 0;
+                            offset += more;
+                            return static_cast<size_t>(more);
+                        });
+                    }
+                }
+            }
+            ::close(fd);
+#else
+            (void)head;
+            std::error_code ec;
+            fs::file_status status = fs::status(record.path, ec);
+            if (ec) return;
+            record.readable = true;
+            if (fs::is_directory(status)) record.type = file_type::FileType::DIRECTORY;
+            else if (fs::is_regular_file(status)) record.type = file_type::recognize_by_header(record.path);
+#endif
+        }
+    }
+
+    std::string status_name(Status status) {
+        switch (status) {
+            case Status::Ok: return "ok";
+            case Status::Failed: return "failed";
+            case Status::Cached: return "cached";
+            case Status::ToolMissing: return "missing-tool";
+        }
+        return "failed";
+    }
+
+    std::vector<ScanRecord> scan(const std::string& root, const ScanOptions& scan_options) {
+        std::vector<Candidate> candidates = walk(root);
+
+        std::vector<file_type::FileType> types(candidates.size(), file_type::FileType::UNKNOWN);
+        executor::global().parallel_for(candidates.size(), scan_options.thread_count, [&](size_t i) {
+            trace::Span span("recognize", "scan");
+            file_type::FileType type = file_type::recognize_by_header(candidates[i].path);
+            if (!is_archive_type(type)) type = file_type::recognize_by_extension(candidates[i].path);
+            types[i] = type;
+        });
+
+        std::vector<ScanRecord> records;
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (!is_archive_type(types[i])) continue;
+            ScanRecord record;
+            record.path = candidates[i].path;
+            record.type = types[i];
+            record.size = candidates[i].size;
+            record.mtime = candidates[i].mtime;
+            records.push_back(std::move(record));
+        }
+
+        // Largest archives first so a single huge file does not start last and set the tail.
+        std::sort(records.begin(), records.end(), [](const ScanRecord& a, const ScanRecord& b) {
+            if (a.size != b.size) return a.size > b.size;
+            return a.path < b.path;
+        });
+
+        executor::global().parallel_for(records.size(), scan_options.thread_count, [&](size_t i) {
+            ScanRecord& record = records[i];
+            auto previous = scan_options.previous.find(record.path);
+            if (previous != scan_options.previous.end() &&
+                (previous->second.status == Status::Ok || previous->second.status == Status::Cached) &&
+                previous->second.size == record.size && previous->second.mtime == record.mtime) {
+                record.status = Status::Cached;
+                return;
+            }
+
+            backend::Archive archive{record.path, record.type, ""};
+            backend::ArchiveBackend* verifier = backend::registry().select(backend::Operation::Verify, archive);
+            if (!verifier) {
+                record.status = Status::ToolMissing;
+                return;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            int exit_code = backend::registry().timed(*verifier, backend::Operation::Verify, archive,
+                [&]() { return verifier->verify(archive, backend::JobContext{}); });
+            record.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            record.status = exit_code == 0 ? Status::Ok : Status::Failed;
+        });
+
+        return records;
+    }
+
+    std::map<std::string, ScanRecord> read_report(const std::string& report_path) {
+        std::map<std::string, ScanRecord> records;
+        std::ifstream input(report_path);
+        std::string line;
+        while (std::getline(input, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::vector<std::string> fields;
+            size_t start = 0;
+            for (int i = 0; i < 5; ++i) {
+                size_t tab = line.find('\t', start);
+                if (tab == std::string::npos) break;
+                fields.push_back(line.substr(start, tab - start));
+                start = tab + 1;
+            }
+            if (fields.size() != 5) continue;
+
+            ScanRecord record;
+            if (!parse_status(fields[0], record.status)) continue;
+            record.type = file_type::parse_format_string(fields[1]);
+            try {
+                record.size = std::stoull(fields[2]);
+                record.mtime = std::stoll(fields[3]);
+                record.seconds = std::stod(fields[4]);
+            } catch (...) {
+                continue;
+            }
+            record.path = unescape_field(line.substr(start));
+            records[record.path] = std::move(record);
+        }
+        return records;
+    }
+
+    bool write_report(const std::string& report_path, const std::vector<ScanRecord>& records) {
+        fs::path final_path(report_path);
+        fs::path temp_path = final_path;
+        temp_path += ".tmp";
+        {
+            std::ofstream output(temp_path, std::ios::trunc);
+            if (!output) return false;
+            output << "# status\tformat\tsize\tmtime\tseconds\tpath\n";
+            for (const auto& record : records) {
+                output << status_name(record.status) << '\t'
+                       << file_type::get_format_name(record.type) << '\t'
+                       << record.size << '\t'
+                       << record.mtime << '\t'
+                       << std::fixed << std::setprecision(3) << record.seconds << '\t'
+                       << escape_field(record.path) << '\n';
+            }
+            if (!output.good()) return false;
+        }
+        std::error_code ec;
+        fs::rename(temp_path, final_path, ec);
+        return !ec;
+    }
+
+    void run(const args::Options& options, progress::ProgressTracker& tracker) {
+        const std::string& root = options.source_path;
+        const std::string& report_path = options.target_path;
+        if (!fs::is_directory(root)) {
+            error::throw_error(error::ErrorCode::INVALID_SOURCE, {{"PATH", root}, {"REASON", "--scan expects a directory"}});
+        }
+
+        ScanOptions scan_options;
+        scan_options.thread_count = options.thread_count;
+        if (options.incremental && fs::exists(report_path)) {
+            scan_options.previous = read_report(report_path);
+        }
+
+        if (options.benchmark) {
+            tracker.set_thread_count(options.thread_count > 0 ? options.thread_count : 1);
+            tracker.start_operation();
+            tracker.begin_phase("verify", "scan");
+        }
+        std::vector<ScanRecord> records = scan(root, scan_options);
+        if (options.benchmark) {
+            tracker.end_operation();
+            uint64_t verified_bytes = 0;
+            for (const auto& record : records) {
+                if (record.status == Status::Ok || record.status == Status::Failed) verified_bytes += record.size;
+            }
+            tracker.end_phase(verified_bytes, 0);
+        }
+
+        if (!write_report(report_path, records)) {
+            error::throw_error(error::ErrorCode::INVALID_TARGET, {{"PATH", report_path}, {"REASON", "cannot write report"}});
+        }
+
+        size_t ok = 0, failed = 0, cached = 0, missing = 0;
+        for (const auto& record : records) {
+            switch (record.status) {
+                case Status::Ok: ++ok; break;
+                case Status::Cached: ++cached; break;
+                case Status::ToolMissing: ++missing; break;
+                case Status::Failed:
+                    ++failed;
+                    if (options.verbose) std::cout << "failed\t" << record.path << std::endl;
+                    break;
+            }
+        }
+
+        std::cout << i18n::get("scan_summary", {
+            {"TOTAL", std::to_string(records.size())},
+            {"OK", std::to_string(ok)},
+            {"FAILED", std::to_string(failed)},
+            {"CACHED", std::to_string(cached)},
+            {"MISSING", std::to_string(missing)}
+        }) << std::endl;
+
+        if (options.benchmark) {
+            tracker.print_stats(options.verbose, options.benchmark);
+        }
+
+        if (failed > 0) {
+            throw error::HitpagException(error::ErrorCode::OPERATION_FAILED,
+                i18n::get("scan_failed", {{"COUNT", std::to_string(failed)}, {"PATH", report_path}}));
+        }
+    }
+
+    std::vector<IdentifyRecord> identify(const std::vector<std::string>& paths, int thread_count) {
+        trace::Span span("identify", "scan");
+        span.arg("files", static_cast<int64_t>(paths.size()));
+        std::vector<IdentifyRecord> records(paths.size());
+        size_t batches = (paths.size() + kIdentifyBatch - 1) / kIdentifyBatch;
+        executor::global().parallel_for(batches, thread_count, [&](size_t batch) {
+            std::vector<char> head;
+            head.reserve(file_type::HEADER_READ_SIZE);
+            size_t end = std::min(paths.size(), (batch + 1) * kIdentifyBatch);
+            for (size_t i = batch * kIdentifyBatch; i < end; ++i) {
+                records[i].path = paths[i];
+                identify_file(records[i], head);
+            }
+        });
+        return records;
+    }
+
+    std::string identify_line(const IdentifyRecord& record, bool json) {
+        std::string format = record.readable ? file_type::get_format_name(record.type) : "error";
+        if (json) return "{\"path\":" + util::json_quote(record.path) + ",\"format\":" + util::json_quote(format) + "}";
+        return format + '\t' + escape_field(record.path);
+    }
+
+    void run_identify(const args::Options& options) {
+        std::vector<std::string> chunk;
+        chunk.reserve(kIdentifyChunk);
+        auto flush = [&]() {
+            std::string output;
+            for (const auto& record : identify(chunk, options.thread_count)) {
+                output += identify_line(record, options.identify_json);
+                output += '\n';
+            }
+            std::cout << output << std::flush;
+            chunk.clear();
+        };
+        auto add = [&](std::string path) {
+            chunk.push_back(std::move(path));
+            if (chunk.size() == kIdentifyChunk) flush();
+        };
+
+        std::vector<std::string> sources = options.source_paths;
+        if (sources.empty()) sources.push_back("-");
+        for (const auto& source : sources) {
+            if (source == "-") {
+                std::string line;
+                while (std::getline(std::cin, line)) {
+                    if (!line.empty()) add(std::move(line));
+                }
+                continue;
+            }
+            std::error_code ec;
+            if (!fs::is_directory(source, ec)) {
+                add(source);
+                continue;
+            }
+            fs::recursive_directory_iterator it(source, fs::directory_options::skip_permission_denied, ec);
+            if (ec) {
+                error::throw_error(error::ErrorCode::INVALID_SOURCE, {{"PATH", source}, {"REASON", ec.message()}});
+            }
+            for (; it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (ec) break;
+                std::error_code entry_ec;
+                if (it->is_regular_file(entry_ec)) add(it->path().string());
+            }
+        }
+        flush();
+    }
+}
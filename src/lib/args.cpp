@@ -97,15 +97,81 @@ namespace args {
             } else if (opt == "--benchmark") {
                 options.benchmark = true;
                 i++;
+            } else if (opt.rfind("--benchmark=", 0) == 0) {
+                if (opt.substr(12) != "json") {
+                    error::throw_error(error::ErrorCode::MISSING_ARGS, {{"ADDITIONAL_INFO", "--benchmark only supports the json output format"}});
+                }
+                options.benchmark = true;
+                options.benchmark_json = true;
+                i++;
+            } else if (opt == "--progress") {
+                options.progress = true;
+                i++;
+            } else if (opt.rfind("--progress=", 0) == 0) {
+                if (opt.substr(11) != "json") {
+                    error::throw_error(error::ErrorCode::MISSING_ARGS, {{"ADDITIONAL_INFO", "--progress only supports the json output format"}});
+                }
+                options.progress = true;
+                options.progress_json = true;
+                i++;
             } else if (opt == "--verify") {
                 options.verify = true;
                 i++;
+            } else if (opt == "--diff") {
+                options.diff_mode = true;
+                i++;
+            } else if (opt == "--scan") {
+                options.scan_mode = true;
+                i++;
+            } else if (opt == "--identify" || opt.rfind("--identify=", 0) == 0) {
+                std::string output = opt == "--identify" ? "tsv" : opt.substr(11);
+                if (output != "tsv" && output != "json") {
+                    error::throw_error(error::ErrorCode::MISSING_ARGS, {{"ADDITIONAL_INFO", "--identify supports the tsv and json output formats"}});
+                }
+                options.identify_mode = true;
+                options.identify_json = output == "json";
+                i++;
+            } else if (opt == "--incremental") {
+                options.incremental = true;
+                i++;
             } else if (opt.rfind("--exclude=", 0) == 0) {
                 options.exclude_patterns.push_back(opt.substr(10));
                 i++;
             } else if (opt.rfind("--include=", 0) == 0) {
                 options.include_patterns.push_back(opt.substr(10));
                 i++;
+            } else if (opt == "--trace" || opt.rfind("--trace=", 0) == 0) {
+                if (opt == "--trace") {
+                    if (i + 1 >= args_vec.size()) {
+                        error::throw_error(error::ErrorCode::MISSING_ARGS, {{"ADDITIONAL_INFO", "--trace requires a file path"}});
+                    }
+                    options.trace_path = args_vec[++i];
+                } else {
+                    options.trace_path = opt.substr(8);
+                }
+                if (options.trace_path.empty()) {
+                    error::throw_error(error::ErrorCode::MISSING_ARGS, {{"ADDITIONAL_INFO", "--trace requires a file path"}});
+                }
+                i++;
+            } else if (opt == "--serve" || opt.rfind("--serve=", 0) == 0) {
+                if (opt == "--serve") {
+                    if (i + 1 >= args_vec.size()) {
+                        error::throw_error(error::ErrorCode::MISSING_ARGS, {{"ADDITIONAL_INFO", "--serve requires a socket path"}});
+                    }
+                    options.serve_socket = args_vec[++i];
+                } else {
+                    options.serve_socket = opt.substr(8);
+                }
+                if (options.serve_socket.empty()) {
+                    error::throw_error(error::ErrorCode::MISSING_ARGS, {{"ADDITIONAL_INFO", "--serve requires a socket path"}});
+                }
+                i++;
+            } else if (opt.rfind("--socket=", 0) == 0) {
+                options.socket_path = opt.substr(9);
+                i++;
+            } else if (opt == "--list" || opt == "--stat" || opt == "--cat" || opt == "--extract-entry") {
+                options.query_command = opt == "--extract-entry" ? "extract" : opt.substr(2);
+                i++;
             } else if (opt.rfind("--format=", 0) == 0) {
                 std::string format_value = opt.substr(9);
                 if (format_value.empty()) {
@@ -123,6 +189,42 @@ namespace args {
             positional_args.push_back(args_vec[i++]);
         }
 
+        if (options.diff_mode && positional_args.size() != 2) {
+            error::throw_error(error::ErrorCode::MISSING_ARGS, {{"ADDITIONAL_INFO", "--diff requires exactly two archive paths"}});
+        }
+        if (options.scan_mode && positional_args.size() != 2) {
+            error::throw_error(error::ErrorCode::MISSING_ARGS, {{"ADDITIONAL_INFO", "--scan requires a directory and a report path"}});
+        }
+        if (!options.query_command.empty()) {
+            size_t expected = 2;
+            std::string usage = "--" + options.query_command + " requires an archive and an entry path";
+            if (options.query_command == "list") {
+                expected = 1;
+                usage = "--list requires exactly one archive path";
+            } else if (options.query_command == "extract") {
+                expected = 3;
+                usage = "--extract-entry requires an archive, an entry and an output directory";
+            }
+            if (positional_args.size() != expected) {
+                error::throw_error(error::ErrorCode::MISSING_ARGS, {{"ADDITIONAL_INFO", usage}});
+            }
+            options.query_args = positional_args;
+            return options;
+        }
+        if (!options.serve_socket.empty()) {
+            if (!positional_args.empty()) {
+                error::throw_error(error::ErrorCode::MISSING_ARGS, {{"ADDITIONAL_INFO", "--serve takes no positional arguments"}});
+            }
+            return options;
+        }
+        if (options.identify_mode) {
+            options.source_paths = positional_args;
+            return options;
+        }
+        if (options.incremental && !options.scan_mode) {
+            error::throw_error(error::ErrorCode::MISSING_ARGS, {{"ADDITIONAL_INFO", "--incremental is only valid with --scan"}});
+        }
+
         if (options.tui_mode) {
             if (positional_args.size() > 1) {
                 error::throw_error(error::ErrorCode::MISSING_ARGS, {{"ADDITIONAL_INFO", "--tui accepts at most one positional argument"}});
@@ -162,15 +264,19 @@ namespace args {
         const std::vector<HelpOption> help_options = {
             {"-i", "help_i"}, {"--tui", "help_tui"}, {"-p", "help_p"}, {"-l", "help_l"}, {"-t", "help_t"},
             {"--verbose", "help_verbose"}, {"--exclude", "help_exclude"},
-            {"--include", "help_include"}, {"--benchmark", "help_benchmark"},
-            {"--verify", "help_verify"}, {"--format", "help_format"}, {"-h", "help_h"}, {"-v", "help_v"}
+            {"--include", "help_include"}, {"--benchmark", "help_benchmark"}, {"--progress", "help_progress"},
+            {"--verify", "help_verify"}, {"--diff", "help_diff"},
+            {"--scan", "help_scan"}, {"--incremental", "help_incremental"}, {"--identify", "help_identify"}, {"--format", "help_format"},
+            {"--trace", "help_trace"}, {"--serve", "help_serve"}, {"--list", "help_query"},
+            {"--socket", "help_socket"}, {"-h", "help_h"}, {"-v", "help_v"}
         };
         for (const auto& opt : help_options) std::cout << i18n::get(opt.key) << std::endl;
 
         std::cout << std::endl << i18n::get("help_examples") << std::endl;
         const std::vector<std::string> example_keys = {
             "help_example1", "help_example2", "help_example_new_path", "help_example3",
-            "help_example4", "help_example5", "help_example6", "help_example7", "help_example8", "help_example9"
+            "help_example4", "help_example5", "help_example6", "help_example7", "help_example8", "help_example9",
+            "help_example_diff", "help_example_scan", "help_example_identify", "help_example_serve", "help_example_query"
         };
         for (const auto& key : example_keys) std::cout << i18n::get(key) << std::endl;
     }
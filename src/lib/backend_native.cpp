@@ -0,0 +1,1323 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "include/archive_backend.h"
+#include "include/checksum.h"
+#include "include/executor.h"
+#include "include/i18n.h"
+#include "include/operation.h"
+#include "include/rar.h"
+#include "include/sevenzip.h"
+#include "include/tar_header.h"
+#include "include/tar_writer.h"
+#include "include/trace.h"
+#include "include/xar.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <map>
+#include <unordered_map>
+
+#include <zlib.h>
+
+namespace fs = std::filesystem;
+
+namespace backend {
+    namespace {
+        using file_type::FileType;
+
+        std::string format_time(std::time_t seconds) {
+            std::tm local{};
+#ifdef _WIN32
+            localtime_s(&local, &seconds);
+#else
+            localtime_r(&seconds, &local);
+#endif
+            char buffer[32];
+            std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local);
+            return buffer;
+        }
+
+        // Member of an uncompressed tar, located by the offset of its data.
+        struct TarMember {
+            std::string name;
+            char type = '0';
+            uint64_t data_offset = 0;
+            uint64_t size = 0;
+            uint64_t mtime = 0;
+        };
+
+        struct TarIndex {
+            std::vector<TarMember> members;
+            bool valid = false;
+        };
+
+        // Walks the headers of a plain tar, seeking over member data instead of reading it.
+        TarIndex index_tar(const std::string& path) {
+            trace::Span span("index_tar", "native");
+            TarIndex index;
+            std::ifstream input(path, std::ios::binary);
+            if (!input) return index;
+            std::error_code ec;
+            uint64_t file_size = fs::file_size(path, ec);
+            if (ec) return index;
+
+            std::array<char, tar_header::kBlockSize> block{};
+            uint64_t offset = 0;
+            std::string pending_path;
+            bool has_pending_size = false;
+            uint64_t pending_size = 0;
+
+            while (offset + tar_header::kBlockSize <= file_size) {
+                input.seekg(static_cast<std::streamoff>(offset));
+                if (!input.read(block.data(), block.size())) return index;
+                offset += tar_header::kBlockSize;
+
+                if (tar_header::is_zero_block(block.data())) {
+                    index.valid = true;
+                    break;
+                }
+                if (!tar_header::checksum_valid(block.data())) return index;
+
+                uint64_t size = tar_header::parse_number(block.data() + 124, 12);
+                char type = block[156];
+                if (type == 'L' || type == 'x') {
+                    if (size > (64u << 20) || offset + size > file_size) return index;
+                    std::string payload(static_cast<size_t>(size), '\0');
+                    if (!input.read(&payload[0], static_cast<std::streamsize>(size))) return index;
+                    if (type == 'L') {
+                        pending_path = tar_header::field_string(payload.data(), payload.size());
+                    } else {
+                        tar_header::PaxOverrides overrides = tar_header::parse_pax(payload);
+                        if (!overrides.path.empty()) pending_path = overrides.path;
+                        if (overrides.has_size) {
+                            pending_size = overrides.size;
+                            has_pending_size = true;
+                        }
+                    }
+                    offset += tar_header::padded_size(size);
+                    continue;
+                }
+                if (type == 'g' || type == 'K') {
+                    offset += tar_header::padded_size(size);
+                    continue;
+                }
+
+                TarMember member;
+                member.name = pending_path.empty() ? tar_header::member_name(block.data()) : pending_path;
+                member.type = type == '\0' ? '0' : type;
+                member.size = has_pending_size ? pending_size : size;
+                member.mtime = tar_header::parse_number(block.data() + 136, 12);
+                member.data_offset = offset;
+                pending_path.clear();
+                has_pending_size = false;
+
+                // Links, devices, directories and fifos carry no data whatever their size field says.
+                bool header_only = member.type >= '1' && member.type <= '6';
+                uint64_t stored = header_only ? 0 : member.size;
+                if (header_only) member.size = 0;
+                if (offset + stored > file_size) return index;
+                offset += tar_header::padded_size(stored);
+                index.members.push_back(std::move(member));
+            }
+            // GNU tar tolerates a missing end-of-archive marker when the file stops on a block boundary.
+            if (!index.valid && offset == file_size) index.valid = true;
+            span.arg("members", static_cast<int64_t>(index.members.size()));
+            return index;
+        }
+
+        class NativeTar : public ArchiveBackend {
+        public:
+            std::string name() const override { return "native-tar"; }
+
+            std::vector<Capability> capabilities() const override {
+                // Only headers are touched, so cost barely grows with the archive.
+                return {
+                    {Operation::List, FileType::ARCHIVE_TAR, Cost{0.05, 0.05}},
+                    {Operation::ReadEntry, FileType::ARCHIVE_TAR, Cost{0.05, 0.05}},
+                    {Operation::Seek, FileType::ARCHIVE_TAR, Cost{0.05, 0.05}},
+                    {Operation::Verify, FileType::ARCHIVE_TAR, Cost{0.05, 0.05}},
+                    // Bound by reading the sources, not by spawning tar.
+                    {Operation::Create, FileType::ARCHIVE_TAR, Cost{0.05, 1.0}},
+                };
+            }
+
+            std::vector<ArchiveEntry> list(const Archive& archive) override {
+                std::shared_ptr<const TarIndex> index = cached_index(archive.path);
+                std::vector<ArchiveEntry> entries;
+                if (!index->valid) return entries;
+                entries.reserve(index->members.size());
+                for (const auto& member : index->members) {
+                    ArchiveEntry entry;
+                    entry.path = member.name;
+                    entry.is_directory = member.type == '5' || (!entry.path.empty() && entry.path.back() == '/');
+                    while (entry.path.size() > 1 && entry.path.back() == '/') entry.path.pop_back();
+                    entry.size = member.size;
+                    entry.modified = format_time(static_cast<std::time_t>(member.mtime));
+                    entries.push_back(std::move(entry));
+                }
+                return entries;
+            }
+
+            bool empty(const Archive& archive) override {
+                std::shared_ptr<const TarIndex> index = cached_index(archive.path);
+                return index->valid && index->members.empty();
+            }
+
+            bool read_entry(const Archive& archive, const std::string& entry, const StreamSink& sink) override {
+                const TarMember* member = nullptr;
+                std::shared_ptr<const TarIndex> index = cached_index(archive.path);
+                if (!find_member(*index, entry, member)) return false;
+
+                std::ifstream input(archive.path, std::ios::binary);
+                if (!input) return false;
+                input.seekg(static_cast<std::streamoff>(member->data_offset));
+                std::vector<char> buffer(256 * 1024);
+                uint64_t remaining = member->size;
+                while (remaining > 0) {
+                    size_t want = static_cast<size_t>(std::min<uint64_t>(remaining, buffer.size()));
+                    if (!input.read(buffer.data(), static_cast<std::streamsize>(want))) return false;
+                    remaining -= want;
+                    if (!sink(buffer.data(), want)) break;
+                }
+                return true;
+            }
+
+            bool read_at(const Archive& archive, const std::string& entry, uint64_t offset, char* buffer, size_t size, size_t& copied) override {
+                copied = 0;
+                const TarMember* member = nullptr;
+                std::shared_ptr<const TarIndex> index = cached_index(archive.path);
+                if (!find_member(*index, entry, member)) return false;
+                if (offset >= member->size || size == 0) return true;
+
+                std::ifstream input(archive.path, std::ios::binary);
+                if (!input) return false;
+                size_t want = static_cast<size_t>(std::min<uint64_t>(size, member->size - offset));
+                input.seekg(static_cast<std::streamoff>(member->data_offset + offset));
+                if (!input.read(buffer, static_cast<std::streamsize>(want))) return false;
+                copied = want;
+                return true;
+            }
+
+            int create(const Archive& target, const CreateJob& job, const JobContext& context) override {
+                if (!target.password.empty() && context.report) context.report(i18n::get("warning_tar_password"));
+                tar_writer::Options options;
+                options.report = context.report;
+                options.advance = context.advance;
+                if (context.verbose && context.report) {
+                    context.report(i18n::get("ingest_engine", {{"ENGINE", ingest::engine_name(options.engine)}}));
+                }
+                return tar_writer::write(fs::absolute(target.path).string(), job.working_dir, job.items, options);
+            }
+
+            int verify(const Archive& archive, const JobContext&) override {
+                return index_tar(archive.path).valid ? 0 : 1;
+            }
+
+        private:
+            // A browsing session reads many entries of the same archive; keep the last index
+            // while the file's size and mtime are unchanged.
+            std::shared_ptr<const TarIndex> cached_index(const std::string& path) {
+                std::error_code ec;
+                uint64_t size = fs::file_size(path, ec);
+                auto mtime = fs::last_write_time(path, ec);
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!cached_ || cached_path_ != path || cached_size_ != size || cached_mtime_ != mtime) {
+                    cached_ = std::make_shared<const TarIndex>(index_tar(path));
+                    cached_path_ = path;
+                    cached_size_ = size;
+                    cached_mtime_ = mtime;
+                }
+                return cached_;
+            }
+
+            // Exact member names, as tar matches them; the last copy of a name wins, as on extraction.
+            static bool find_member(const TarIndex& index, const std::string& entry, const TarMember*& found) {
+                if (!index.valid) return false;
+                for (auto it = index.members.rbegin(); it != index.members.rend(); ++it) {
+                    if (it->name == entry && (it->type == '0' || it->type == '7')) {
+                        found = &*it;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            std::mutex mutex_;
+            std::shared_ptr<const TarIndex> cached_;
+            std::string cached_path_;
+            uint64_t cached_size_ = 0;
+            fs::file_time_type cached_mtime_{};
+        };
+
+        uint16_t le16(const unsigned char* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+        uint32_t le32(const unsigned char* p) { return le16(p) | (static_cast<uint32_t>(le16(p + 2)) << 16); }
+        uint64_t le64(const unsigned char* p) { return le32(p) | (static_cast<uint64_t>(le32(p + 4)) << 32); }
+
+        // Method names as printed by `unzip -v`, so listings look the same whichever backend ran.
+        std::string zip_method_name(uint16_t method, uint16_t flags) {
+            switch (method) {
+                case 0: return "Stored";
+                case 8: {
+                    static const char* levels[] = {"Defl:N", "Defl:X", "Defl:F", "Defl:S"};
+                    return levels[(flags >> 1) & 3];
+                }
+                case 9: return "Def64";
+                case 12: return "BZip2";
+                case 14: return "LZMA";
+                case 93: return "Zstd";
+                case 95: return "XZ";
+                default: return "Unk:" + std::to_string(method);
+            }
+        }
+
+        std::string dos_time(uint16_t time, uint16_t date) {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d %02d:%02d",
+                1980 + (date >> 9), (date >> 5) & 0x0F, date & 0x1F, time >> 11, (time >> 5) & 0x3F);
+            return buffer;
+        }
+
+        // Entry paths from the archive end up under output_dir; absolute paths and ".." are refused.
+        bool safe_relative(const std::string& path) {
+            if (path.empty() || path.front() == '/') return false;
+            for (const auto& part : fs::path(path)) {
+                if (part == "..") return false;
+            }
+            return true;
+        }
+
+        // An entry as a native extraction writes it; `source` indexes the format's own records.
+        struct OutputEntry {
+            std::string path;
+            size_t source = 0;
+            bool is_directory = false;
+            bool is_symlink = false;
+            uint32_t mode = 0;  // Unix permission bits, 0 when the archive has none
+            bool has_mtime = false;
+            std::time_t mtime = 0;
+        };
+
+        // Where a native extraction lands. Directories are created up front in archive order so
+        // that units decoding in parallel only ever create files; symlinks and directory times
+        // are applied by finish() once every unit is done, so no unit writes through a link
+        // another unit created.
+        class OutputTree {
+        public:
+            explicit OutputTree(std::string root) : root_(std::move(root)) {}
+
+            fs::path path_of(const OutputEntry& entry) const { return fs::path(root_) / entry.path; }
+
+            bool prepare(const std::vector<OutputEntry>& entries) {
+                std::error_code ec;
+                for (const auto& entry : entries) {
+                    fs::create_directories(entry.is_directory ? path_of(entry) : path_of(entry).parent_path(), ec);
+                    if (ec) return false;
+                }
+                return true;
+            }
+
+            void defer_symlink(const OutputEntry& entry, std::string target) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                symlinks_.emplace_back(&entry, std::move(target));
+            }
+
+            static void apply_metadata(const fs::path& target, const OutputEntry& entry) {
+                std::error_code ec;
+                if (entry.has_mtime) {
+                    auto since = std::chrono::system_clock::from_time_t(entry.mtime) - std::chrono::system_clock::now();
+                    fs::last_write_time(target, fs::file_time_type::clock::now() + std::chrono::duration_cast<fs::file_time_type::duration>(since), ec);
+                }
+                if (entry.mode != 0 && !entry.is_directory) fs::permissions(target, static_cast<fs::perms>(entry.mode & 0777), ec);
+            }
+
+            bool finish(const std::vector<OutputEntry>& entries) {
+                std::error_code ec;
+                for (const auto& link : symlinks_) {
+                    fs::path target = path_of(*link.first);
+                    fs::remove(target, ec);
+                    fs::create_symlink(link.second, target, ec);
+                    if (ec) return false;
+                }
+                // Deepest first, so setting a child's time does not disturb its parent's.
+                for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+                    if (it->is_directory) apply_metadata(path_of(*it), *it);
+                }
+                return true;
+            }
+
+        private:
+            std::string root_;
+            std::mutex mutex_;
+            std::vector<std::pair<const OutputEntry*, std::string>> symlinks_;
+        };
+
+        // Receives one entry's bytes during extraction and checks them against the stored CRC.
+        class EntryWriter {
+        public:
+            EntryWriter(OutputTree& tree, const OutputEntry& entry) : tree_(tree), entry_(entry) {
+                if (entry.is_symlink) return;
+                // Never write through a link left in the target by an earlier extraction.
+                std::error_code ec;
+                fs::path target = tree.path_of(entry);
+                if (fs::is_symlink(target, ec)) fs::remove(target, ec);
+                output_.open(target, std::ios::binary | std::ios::trunc);
+            }
+
+            bool write(const char* data, size_t size) {
+                crc_ = checksum::crc32(crc_, data, size);
+                written_ += size;
+                if (entry_.is_symlink) {
+                    link_.append(data, size);
+                    return link_.size() <= 4096;
+                }
+                return static_cast<bool>(output_.write(data, static_cast<std::streamsize>(size)));
+            }
+
+            bool close(uint64_t expected_size, bool has_crc, uint32_t expected_crc) {
+                if (written_ != expected_size || (has_crc && crc_ != expected_crc)) return false;
+                if (entry_.is_symlink) {
+                    tree_.defer_symlink(entry_, std::move(link_));
+                    return true;
+                }
+                output_.close();
+                if (!output_) return false;
+                OutputTree::apply_metadata(tree_.path_of(entry_), entry_);
+                return true;
+            }
+
+            bool ok() const { return entry_.is_symlink || static_cast<bool>(output_); }
+
+        private:
+            OutputTree& tree_;
+            const OutputEntry& entry_;
+            std::ofstream output_;
+            std::string link_;
+            uint32_t crc_ = 0;
+            uint64_t written_ = 0;
+        };
+
+        // Thread budget of an extraction: -t when given, else the whole pool.
+        int extraction_threads(const JobContext& context) {
+            return context.thread_count > 0 ? context.thread_count : static_cast<int>(executor::global().worker_count() + 1);
+        }
+
+        // Keeps the last entry of each path, as sequential extraction would leave it.
+        template <typename Path>
+        std::vector<size_t> last_of_each_path(const std::vector<size_t>& selected, Path&& path_of) {
+            std::unordered_map<std::string, size_t> last;
+            for (size_t i : selected) last[path_of(i)] = i;
+            std::vector<size_t> kept;
+            for (size_t i : selected) {
+                if (last[path_of(i)] == i) kept.push_back(i);
+            }
+            return kept;
+        }
+
+        // Runs of neighbouring entries with similar uncompressed totals, a few per thread so
+        // that one large entry does not leave the others idle at the end.
+        template <typename Size>
+        std::vector<std::pair<size_t, size_t>> balanced_runs(const std::vector<OutputEntry>& outputs, int threads, Size&& size_of) {
+            uint64_t total = 0;
+            for (const auto& out : outputs) {
+                if (!out.is_directory) total += size_of(out);
+            }
+            uint64_t per_unit = std::max<uint64_t>(total / (static_cast<uint64_t>(threads) * 4) + 1, 1u << 20);
+            std::vector<std::pair<size_t, size_t>> units;
+            uint64_t run = 0;
+            size_t start = 0;
+            for (size_t i = 0; i < outputs.size(); ++i) {
+                if (!outputs[i].is_directory) run += size_of(outputs[i]) + 512;
+                if (run >= per_unit || i + 1 == outputs.size()) {
+                    units.emplace_back(start, i + 1);
+                    start = i + 1;
+                    run = 0;
+                }
+            }
+            return units;
+        }
+
+        struct ZipMember {
+            ArchiveEntry entry;
+            uint16_t method = 0;
+            uint16_t flags = 0;
+            uint64_t local_offset = 0;
+            uint32_t mode = 0;
+            bool has_unix_time = false;
+            uint32_t unix_time = 0;
+        };
+
+        struct ZipIndex {
+            std::vector<ZipMember> members;
+            bool valid = false;
+        };
+
+        bool read_zip64_end(std::ifstream& input, uint64_t file_size, const std::vector<unsigned char>& tail,
+                            size_t eocd, uint64_t& count, uint64_t& cd_size, uint64_t& cd_offset) {
+            if (eocd < 20 || le32(&tail[eocd - 20]) != 0x07064b50) return false;
+            uint64_t record_offset = le64(&tail[eocd - 20 + 8]);
+            if (record_offset + 56 > file_size) return false;
+            std::array<unsigned char, 56> record{};
+            input.seekg(static_cast<std::streamoff>(record_offset));
+            if (!input.read(reinterpret_cast<char*>(record.data()), record.size())) return false;
+            if (le32(record.data()) != 0x06064b50) return false;
+            count = le64(&record[32]);
+            cd_size = le64(&record[40]);
+            cd_offset = le64(&record[48]);
+            return true;
+        }
+
+        // Zip64 extra field: each value saturated in the fixed header follows in order. The
+        // extended timestamp field carries the Unix mtime that unzip restores.
+        void apply_extra_fields(const unsigned char* extra, size_t length, ZipMember& member) {
+            size_t pos = 0;
+            while (pos + 4 <= length) {
+                uint16_t id = le16(extra + pos);
+                uint16_t size = le16(extra + pos + 2);
+                if (pos + 4 + size > length) return;
+                const unsigned char* field = extra + pos + 4;
+                if (id == 0x0001) {
+                    size_t used = 0;
+                    if (member.entry.size == 0xFFFFFFFF && used + 8 <= size) { member.entry.size = le64(field + used); used += 8; }
+                    if (member.entry.compressed_size == 0xFFFFFFFF && used + 8 <= size) { member.entry.compressed_size = le64(field + used); used += 8; }
+                    if (member.local_offset == 0xFFFFFFFF && used + 8 <= size) { member.local_offset = le64(field + used); used += 8; }
+                } else if (id == 0x5455 && size >= 5 && (field[0] & 1)) {
+                    member.has_unix_time = true;
+                    member.unix_time = le32(field + 1);
+                }
+                pos += 4 + size;
+            }
+        }
+
+        // Reads the central directory at the end of the file; member data is never touched.
+        ZipIndex index_zip(const std::string& path) {
+            trace::Span span("native_zip_list", "native");
+            ZipIndex index;
+            std::ifstream input(path, std::ios::binary);
+            std::error_code ec;
+            uint64_t file_size = fs::file_size(path, ec);
+            if (!input || ec || file_size < 22) return index;
+
+            // End of central directory record: 22 bytes plus a comment of up to 64 KiB.
+            uint64_t tail_size = std::min<uint64_t>(file_size, 22 + 0xFFFF);
+            std::vector<unsigned char> tail(static_cast<size_t>(tail_size));
+            input.seekg(static_cast<std::streamoff>(file_size - tail_size));
+            if (!input.read(reinterpret_cast<char*>(tail.data()), static_cast<std::streamsize>(tail.size()))) return index;
+
+            size_t eocd = tail.size();
+            for (size_t i = tail.size() - 22 + 1; i-- > 0;) {
+                if (le32(&tail[i]) == 0x06054b50) {
+                    eocd = i;
+                    break;
+                }
+            }
+            if (eocd == tail.size()) return index;
+
+            uint64_t count = le16(&tail[eocd + 10]);
+            uint64_t cd_size = le32(&tail[eocd + 12]);
+            uint64_t cd_offset = le32(&tail[eocd + 16]);
+            if (count == 0xFFFF || cd_size == 0xFFFFFFFF || cd_offset == 0xFFFFFFFF) {
+                if (!read_zip64_end(input, file_size, tail, eocd, count, cd_size, cd_offset)) return index;
+            }
+            if (cd_offset + cd_size > file_size) return index;
+
+            std::vector<unsigned char> cd(static_cast<size_t>(cd_size));
+            input.seekg(static_cast<std::streamoff>(cd_offset));
+            if (!input.read(reinterpret_cast<char*>(cd.data()), static_cast<std::streamsize>(cd.size()))) return index;
+
+            index.members.reserve(static_cast<size_t>(std::min<uint64_t>(count, cd_size / 46)));
+            size_t pos = 0;
+            while (pos + 46 <= cd.size() && le32(&cd[pos]) == 0x02014b50) {
+                const unsigned char* h = &cd[pos];
+                uint16_t name_length = le16(h + 28);
+                uint16_t extra_length = le16(h + 30);
+                uint16_t comment_length = le16(h + 32);
+                if (pos + 46 + name_length + extra_length + comment_length > cd.size()) {
+                    index.members.clear();
+                    return index;
+                }
+
+                ZipMember member;
+                ArchiveEntry& entry = member.entry;
+                entry.path.assign(reinterpret_cast<const char*>(h + 46), name_length);
+                member.flags = le16(h + 8);
+                member.method = le16(h + 10);
+                entry.method = zip_method_name(member.method, member.flags);
+                entry.modified = dos_time(le16(h + 12), le16(h + 14));
+                entry.crc = le32(h + 16);
+                entry.has_crc = true;
+                entry.compressed_size = le32(h + 20);
+                entry.size = le32(h + 24);
+                member.local_offset = le32(h + 42);
+                // Made on Unix: the mode sits in the high half of the external attributes.
+                if ((le16(h + 4) >> 8) == 3) member.mode = le32(h + 38) >> 16;
+                apply_extra_fields(h + 46 + name_length, extra_length, member);
+                if (!entry.path.empty() && entry.path.back() == '/') {
+                    entry.is_directory = true;
+                    entry.path.pop_back();
+                }
+                index.members.push_back(std::move(member));
+                pos += 46 + name_length + extra_length + comment_length;
+            }
+            index.valid = true;
+            span.arg("entries", static_cast<int64_t>(index.members.size()));
+            return index;
+        }
+
+        // Copies or inflates one member's data into out.
+        bool extract_zip_member(std::ifstream& input, const ZipMember& member, EntryWriter& out) {
+            std::array<unsigned char, 30> local{};
+            input.seekg(static_cast<std::streamoff>(member.local_offset));
+            if (!input.read(reinterpret_cast<char*>(local.data()), local.size()) || le32(local.data()) != 0x04034b50) return false;
+            input.seekg(static_cast<std::streamoff>(member.local_offset + 30 + le16(&local[26]) + le16(&local[28])));
+
+            std::vector<char> in_buffer(256 * 1024);
+            uint64_t remaining = member.entry.compressed_size;
+            if (member.method == 0) {
+                while (remaining > 0) {
+                    size_t want = static_cast<size_t>(std::min<uint64_t>(remaining, in_buffer.size()));
+                    if (!input.read(in_buffer.data(), static_cast<std::streamsize>(want)) || !out.write(in_buffer.data(), want)) return false;
+                    remaining -= want;
+                }
+                return true;
+            }
+
+            z_stream stream{};
+            if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) return false;
+            std::vector<char> out_buffer(256 * 1024);
+            int status = Z_OK;
+            bool ok = true;
+            while (ok && status != Z_STREAM_END) {
+                if (stream.avail_in == 0) {
+                    if (remaining == 0) {
+                        ok = false;
+                        break;
+                    }
+                    size_t want = static_cast<size_t>(std::min<uint64_t>(remaining, in_buffer.size()));
+                    if (!input.read(in_buffer.data(), static_cast<std::streamsize>(want))) {
+                        ok = false;
+                        break;
+                    }
+                    remaining -= want;
+                    stream.next_in = reinterpret_cast<Bytef*>(in_buffer.data());
+                    stream.avail_in = static_cast<uInt>(want);
+                }
+                stream.next_out = reinterpret_cast<Bytef*>(out_buffer.data());
+                stream.avail_out = static_cast<uInt>(out_buffer.size());
+                status = inflate(&stream, Z_NO_FLUSH);
+                if (status != Z_OK && status != Z_STREAM_END) ok = false;
+                size_t produced = out_buffer.size() - stream.avail_out;
+                if (ok && produced > 0) ok = out.write(out_buffer.data(), produced);
+            }
+            inflateEnd(&stream);
+            return ok;
+        }
+
+        // Lists zips from the central directory and extracts stored and deflated members with
+        // zlib, spreading runs of members over the shared executor. Encrypted members, other
+        // methods and split sets are left to unzip and 7z.
+        class NativeZip : public ArchiveBackend {
+        public:
+            std::string name() const override { return "native-zip"; }
+
+            std::vector<Capability> capabilities() const override {
+                return {
+                    {Operation::List, FileType::ARCHIVE_ZIP, Cost{0.05, 0.01}},
+                    {Operation::Extract, FileType::ARCHIVE_ZIP, Cost{0.05, 3.0}},
+                };
+            }
+
+            // In a split set the central directory may start in an earlier part.
+            bool accepts(Operation op, const Archive& archive) const override {
+                if (operation::is_split_zip(archive.path)) return false;
+                if (op != Operation::Extract) return true;
+                std::shared_ptr<const ZipIndex> index = cached_index(archive.path);
+                if (!index->valid || index->members.empty()) return false;
+                return std::all_of(index->members.begin(), index->members.end(), [](const ZipMember& member) {
+                    return (member.method == 0 || member.method == 8) && (member.flags & 1) == 0 && safe_relative(member.entry.path);
+                });
+            }
+
+            std::vector<ArchiveEntry> list(const Archive& archive) override {
+                std::shared_ptr<const ZipIndex> index = cached_index(archive.path);
+                std::vector<ArchiveEntry> entries;
+                entries.reserve(index->members.size());
+                for (const auto& member : index->members) entries.push_back(member.entry);
+                return entries;
+            }
+
+            bool empty(const Archive& archive) override {
+                std::shared_ptr<const ZipIndex> index = cached_index(archive.path);
+                return index->valid && index->members.empty();
+            }
+
+            int extract(const Archive& archive, const std::string& target_dir, const JobContext& context) override {
+                trace::Span span("native_zip_extract", "native");
+                std::shared_ptr<const ZipIndex> index = cached_index(archive.path);
+                if (!index->valid) return 1;
+                std::vector<size_t> all(index->members.size());
+                for (size_t i = 0; i < all.size(); ++i) all[i] = i;
+                std::vector<size_t> kept = last_of_each_path(all, [&](size_t i) { return index->members[i].entry.path; });
+
+                std::vector<OutputEntry> outputs;
+                for (size_t i : kept) {
+                    const ZipMember& member = index->members[i];
+                    OutputEntry out;
+                    out.path = member.entry.path;
+                    out.source = i;
+                    out.is_directory = member.entry.is_directory;
+                    out.mode = member.mode & 07777;
+                    out.is_symlink = (member.mode & 0170000) == 0120000;
+                    out.has_mtime = true;
+                    out.mtime = member.has_unix_time ? static_cast<std::time_t>(member.unix_time) : local_time(member.entry.modified);
+                    outputs.push_back(std::move(out));
+                }
+                OutputTree tree(target_dir);
+                if (!tree.prepare(outputs)) return 1;
+
+                int threads = extraction_threads(context);
+                std::vector<std::pair<size_t, size_t>> units = balanced_runs(outputs, threads, [&](const OutputEntry& out) {
+                    return index->members[out.source].entry.size;
+                });
+
+                std::atomic<bool> failed{false};
+                executor::global().parallel_for(units.size(), threads, [&](size_t u) {
+                    std::ifstream input(archive.path, std::ios::binary);
+                    for (size_t i = units[u].first; i < units[u].second && !failed.load(); ++i) {
+                        const OutputEntry& out = outputs[i];
+                        if (out.is_directory) continue;
+                        const ZipMember& member = index->members[out.source];
+                        EntryWriter writer(tree, out);
+                        if (!input || !writer.ok() || !extract_zip_member(input, member, writer) ||
+                            !writer.close(member.entry.size, member.entry.has_crc, member.entry.crc)) {
+                            failed = true;
+                            break;
+                        }
+                        if (context.advance) context.advance(member.entry.compressed_size, member.entry.size);
+                    }
+                });
+                span.arg("units", static_cast<int64_t>(units.size()));
+                if (failed) return 1;
+                return tree.finish(outputs) ? 0 : 1;
+            }
+
+        private:
+            // DOS times are local wall-clock times.
+            static std::time_t local_time(const std::string& modified) {
+                std::tm parts{};
+                if (std::sscanf(modified.c_str(), "%d-%d-%d %d:%d", &parts.tm_year, &parts.tm_mon, &parts.tm_mday, &parts.tm_hour, &parts.tm_min) != 5) return 0;
+                parts.tm_year -= 1900;
+                parts.tm_mon -= 1;
+                parts.tm_isdst = -1;
+                return std::mktime(&parts);
+            }
+
+            std::shared_ptr<const ZipIndex> cached_index(const std::string& path) const {
+                std::error_code ec;
+                uint64_t size = fs::file_size(path, ec);
+                auto mtime = fs::last_write_time(path, ec);
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!cached_ || cached_path_ != path || cached_size_ != size || cached_mtime_ != mtime) {
+                    cached_ = std::make_shared<const ZipIndex>(index_zip(path));
+                    cached_path_ = path;
+                    cached_size_ = size;
+                    cached_mtime_ = mtime;
+                }
+                return cached_;
+            }
+
+            mutable std::mutex mutex_;
+            mutable std::shared_ptr<const ZipIndex> cached_;
+            mutable std::string cached_path_;
+            mutable uint64_t cached_size_ = 0;
+            mutable fs::file_time_type cached_mtime_{};
+        };
+
+        // Decoded 7z solid blocks, evicted least recently used first once their total size
+        // passes the capacity. Sibling entries of a solid archive are then served from memory
+        // instead of decoding the block again from its start.
+        class BlockCache {
+        public:
+            explicit BlockCache(uint64_t capacity) : capacity_(capacity) {}
+
+            uint64_t max_block() const { return capacity_ / 2; }
+
+            std::shared_ptr<const std::string> find(const std::string& key) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto found = index_.find(key);
+                if (found == index_.end()) return nullptr;
+                order_.splice(order_.begin(), order_, found->second);
+                return found->second->second;
+            }
+
+            void insert(const std::string& key, std::shared_ptr<const std::string> block) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (index_.count(key)) return;
+                bytes_ += block->size();
+                order_.emplace_front(key, std::move(block));
+                index_[key] = order_.begin();
+                while (bytes_ > capacity_ && order_.size() > 1) {
+                    bytes_ -= order_.back().second->size();
+                    index_.erase(order_.back().first);
+                    order_.pop_back();
+                }
+            }
+
+        private:
+            using Slot = std::pair<std::string, std::shared_ptr<const std::string>>;
+
+            std::mutex mutex_;
+            uint64_t capacity_;
+            uint64_t bytes_ = 0;
+            std::list<Slot> order_;
+            std::unordered_map<std::string, std::list<Slot>::iterator> index_;
+        };
+
+        // Lists 7z archives from the end header and reads entries by decoding their solid block
+        // (folder) with liblzma. The 7z tool remains the fallback for encrypted headers, coders
+        // liblzma lacks, and anything else read_index() gives up on.
+        class NativeSevenZip : public ArchiveBackend {
+        public:
+            std::string name() const override { return "native-7z"; }
+
+            std::vector<Capability> capabilities() const override {
+                return {
+                    {Operation::List, FileType::ARCHIVE_7Z, Cost{0.05, 0.01}},
+                    {Operation::ReadEntry, FileType::ARCHIVE_7Z, Cost{0.05, 1.0}},
+                    {Operation::Seek, FileType::ARCHIVE_7Z, Cost{0.05, 1.0}},
+                    {Operation::ExtractEntry, FileType::ARCHIVE_7Z, Cost{0.05, 1.0}},
+                    {Operation::Extract, FileType::ARCHIVE_7Z, Cost{0.05, 3.0}},
+                };
+            }
+
+            // Whole-archive extraction cannot fall back halfway, so it is only taken on when
+            // every folder decodes natively.
+            bool accepts(Operation op, const Archive& archive) const override {
+                if (op != Operation::Extract) return true;
+                std::shared_ptr<const sevenzip::Index> index = cached_index(archive.path);
+                return index->valid && !index->files.empty() &&
+                       std::all_of(index->folders.begin(), index->folders.end(), [](const sevenzip::Folder& folder) { return sevenzip::can_decode(folder); }) &&
+                       std::all_of(index->files.begin(), index->files.end(), [](const sevenzip::File& file) { return safe_relative(file.path); });
+            }
+
+            std::vector<ArchiveEntry> list(const Archive& archive) override {
+                std::shared_ptr<const sevenzip::Index> index = cached_index(archive.path);
+                std::vector<ArchiveEntry> entries;
+                if (!index->valid) return entries;
+                entries.reserve(index->files.size());
+                for (size_t i = 0; i < index->files.size(); ++i) {
+                    const sevenzip::File& file = index->files[i];
+                    ArchiveEntry entry;
+                    entry.path = file.path;
+                    entry.is_directory = file.is_directory;
+                    entry.size = file.size;
+                    entry.crc = file.crc;
+                    entry.has_crc = file.has_crc;
+                    if (file.has_mtime) entry.modified = format_time(unix_time(file.mtime));
+                    if (file.folder != sevenzip::kNoFolder) {
+                        const sevenzip::Folder& folder = index->folders[file.folder];
+                        entry.method = sevenzip::method_name(folder);
+                        // Like `7z l`, a solid block's packed size is reported on its first file.
+                        if (folder.first_file == i) entry.compressed_size = folder.packed_size();
+                    }
+                    entries.push_back(std::move(entry));
+                }
+                return entries;
+            }
+
+            bool empty(const Archive& archive) override {
+                std::shared_ptr<const sevenzip::Index> index = cached_index(archive.path);
+                return index->valid && !index->needs_tool && index->files.empty();
+            }
+
+            bool read_entry(const Archive& archive, const std::string& entry, const StreamSink& sink) override {
+                std::shared_ptr<const sevenzip::Index> index = cached_index(archive.path);
+                const sevenzip::File* file = find_file(*index, entry);
+                if (!file || file->is_directory) return false;
+                if (!file->has_stream) return true;
+
+                const sevenzip::Folder& folder = index->folders[file->folder];
+                if (!sevenzip::can_decode(folder)) return false;
+                std::shared_ptr<const std::string> block = cached_block(archive.path, *index, file->folder, file->folder_offset + file->size);
+                if (block) {
+                    const char* data = block->data() + file->folder_offset;
+                    size_t size = static_cast<size_t>(file->size);
+                    if (file->has_crc && checksum::crc32(0, data, size) != file->crc) return false;
+                    sink(data, size);
+                    return true;
+                }
+
+                // Past what the cache keeps: decode from the block start and stop after this entry.
+                uint64_t position = 0;
+                uint64_t end = file->folder_offset + file->size;
+                uint32_t crc = 0;
+                bool stopped = false;
+                bool decoded = sevenzip::decode_folder(archive.path, folder, [&](const char* data, size_t length) {
+                    uint64_t chunk_end = position + length;
+                    if (chunk_end > file->folder_offset && !stopped) {
+                        size_t skip = position < file->folder_offset ? static_cast<size_t>(file->folder_offset - position) : 0;
+                        size_t take = static_cast<size_t>(std::min<uint64_t>(chunk_end, end) - position) - skip;
+                        crc = checksum::crc32(crc, data + skip, take);
+                        stopped = !sink(data + skip, take);
+                    }
+                    position = chunk_end;
+                    return !stopped && position < end;
+                });
+                return decoded && (stopped || position >= end) && (stopped || !file->has_crc || crc == file->crc);
+            }
+
+            bool read_at(const Archive& archive, const std::string& entry, uint64_t offset, char* buffer, size_t size, size_t& copied) override {
+                copied = 0;
+                std::shared_ptr<const sevenzip::Index> index = cached_index(archive.path);
+                const sevenzip::File* file = find_file(*index, entry);
+                if (!file || file->is_directory) return false;
+                if (!file->has_stream || offset >= file->size || size == 0) return true;
+                if (!sevenzip::can_decode(index->folders[file->folder])) return false;
+                std::shared_ptr<const std::string> block = cached_block(archive.path, *index, file->folder, file->folder_offset + file->size);
+                if (!block) return false;
+                copied = static_cast<size_t>(std::min<uint64_t>(size, file->size - offset));
+                std::memcpy(buffer, block->data() + file->folder_offset + offset, copied);
+                return true;
+            }
+
+            // Extracts the entry and, for a directory, everything below it.
+            bool extract_entry(const Archive& archive, const std::string& entry, const std::string& output_dir) override {
+                std::shared_ptr<const sevenzip::Index> index = cached_index(archive.path);
+                if (!index->valid) return false;
+                std::string prefix = entry;
+                while (!prefix.empty() && prefix.back() == '/') prefix.pop_back();
+
+                std::vector<size_t> selected;
+                for (size_t i = 0; i < index->files.size(); ++i) {
+                    const sevenzip::File& file = index->files[i];
+                    if (file.path != prefix && file.path.compare(0, prefix.size() + 1, prefix + "/") != 0) continue;
+                    if (!safe_relative(file.path)) return false;
+                    if (file.has_stream && !sevenzip::can_decode(index->folders[file.folder])) return false;
+                    selected.push_back(i);
+                }
+                if (selected.empty()) return false;
+                return extract_files(archive.path, *index, selected, output_dir, JobContext{});
+            }
+
+            int extract(const Archive& archive, const std::string& target_dir, const JobContext& context) override {
+                std::shared_ptr<const sevenzip::Index> index = cached_index(archive.path);
+                if (!index->valid) return 1;
+                std::vector<size_t> all(index->files.size());
+                for (size_t i = 0; i < all.size(); ++i) all[i] = i;
+                return extract_files(archive.path, *index, all, target_dir, context) ? 0 : 1;
+            }
+
+        private:
+            static std::time_t unix_time(uint64_t filetime) {
+                // FILETIME counts 100 ns ticks from 1601.
+                return static_cast<std::time_t>(filetime / 10000000 - 11644473600ull);
+            }
+
+            // Folders are independent, so each is one unit on the executor, largest first; within
+            // a folder, files are written in offset order and the block is decoded at most once.
+            bool extract_files(const std::string& path, const sevenzip::Index& index, const std::vector<size_t>& selected,
+                               const std::string& output_dir, const JobContext& context) {
+                trace::Span span("native_7z_extract", "native");
+                std::vector<size_t> kept = last_of_each_path(selected, [&](size_t i) { return index.files[i].path; });
+                std::vector<OutputEntry> outputs;
+                for (size_t i : kept) {
+                    const sevenzip::File& file = index.files[i];
+                    if (file.is_anti) continue;
+                    OutputEntry out;
+                    out.path = file.path;
+                    out.source = i;
+                    out.is_directory = file.is_directory;
+                    // p7zip and bsdtar keep the Unix mode in the high 16 bits, flagged by 0x8000.
+                    if (file.attributes & 0x8000) {
+                        uint32_t mode = file.attributes >> 16;
+                        out.mode = mode & 07777;
+                        out.is_symlink = (mode & 0170000) == 0120000;
+                    }
+                    out.has_mtime = file.has_mtime;
+                    out.mtime = unix_time(file.mtime);
+                    outputs.push_back(std::move(out));
+                }
+                OutputTree tree(output_dir);
+                if (!tree.prepare(outputs)) return false;
+
+                std::map<size_t, std::vector<const OutputEntry*>> by_folder;
+                for (const auto& out : outputs) {
+                    const sevenzip::File& file = index.files[out.source];
+                    if (out.is_directory) continue;
+                    if (file.has_stream) {
+                        by_folder[file.folder].push_back(&out);
+                        continue;
+                    }
+                    EntryWriter writer(tree, out);
+                    if (!writer.ok() || !writer.close(0, false, 0)) return false;
+                }
+                std::vector<std::pair<size_t, std::vector<const OutputEntry*>>> units(by_folder.begin(), by_folder.end());
+                std::sort(units.begin(), units.end(), [&](const auto& a, const auto& b) {
+                    return index.folders[a.first].unpack_size() > index.folders[b.first].unpack_size();
+                });
+
+                std::atomic<bool> failed{false};
+                executor::global().parallel_for(units.size(), extraction_threads(context), [&](size_t u) {
+                    if (failed.load()) return;
+                    auto& files = units[u].second;
+                    std::sort(files.begin(), files.end(), [&](const OutputEntry* a, const OutputEntry* b) {
+                        return index.files[a->source].folder_offset < index.files[b->source].folder_offset;
+                    });
+                    if (!extract_folder(path, index, units[u].first, files, tree)) {
+                        failed = true;
+                        return;
+                    }
+                    if (context.advance) context.advance(index.folders[units[u].first].packed_size(), index.folders[units[u].first].unpack_size());
+                });
+                span.arg("entries", static_cast<int64_t>(outputs.size()));
+                span.arg("folders", static_cast<int64_t>(units.size()));
+                return !failed && tree.finish(outputs);
+            }
+
+            bool extract_folder(const std::string& path, const sevenzip::Index& index, size_t folder_index,
+                                const std::vector<const OutputEntry*>& files, OutputTree& tree) {
+                std::vector<std::unique_ptr<EntryWriter>> writers;
+                for (const OutputEntry* out : files) {
+                    writers.push_back(std::make_unique<EntryWriter>(tree, *out));
+                    if (!writers.back()->ok()) return false;
+                }
+
+                size_t next = 0;
+                uint64_t position = 0;
+                bool failed = false;
+                // Chunks may straddle several small files, and solid blocks may hold files nobody asked for.
+                auto consume = [&](const char* data, size_t length) {
+                    uint64_t chunk_end = position + length;
+                    while (next < files.size() && !failed) {
+                        const sevenzip::File& file = index.files[files[next]->source];
+                        uint64_t end = file.folder_offset + file.size;
+                        if (file.folder_offset >= chunk_end) break;
+                        uint64_t from = std::max(position, file.folder_offset);
+                        uint64_t to = std::min(chunk_end, end);
+                        if (to > from) failed = !writers[next]->write(data + (from - position), static_cast<size_t>(to - from));
+                        if (to < end) break;
+                        failed = failed || !writers[next]->close(file.size, file.has_crc, file.crc);
+                        ++next;
+                    }
+                    position = chunk_end;
+                    return !failed && next < files.size();
+                };
+
+                const sevenzip::File& last = index.files[files.back()->source];
+                std::shared_ptr<const std::string> block = block_cache_.find(block_key(path, folder_index));
+                if (block && block->size() < last.folder_offset + last.size) block = nullptr;
+                bool decoded = block ? (consume(block->data(), block->size()), true)
+                                     : sevenzip::decode_folder(path, index.folders[folder_index], consume);
+                return decoded && !failed && next == files.size();
+            }
+
+            static const sevenzip::File* find_file(const sevenzip::Index& index, const std::string& entry) {
+                if (!index.valid) return nullptr;
+                // Later copies of a name win, as they do on extraction.
+                for (auto it = index.files.rbegin(); it != index.files.rend(); ++it) {
+                    if (it->path == entry && !it->is_anti) return &*it;
+                }
+                return nullptr;
+            }
+
+            // Size and mtime in the key keep a rewritten archive from hitting blocks of its old contents.
+            static std::string block_key(const std::string& path, size_t folder) {
+                std::error_code ec;
+                uint64_t size = fs::file_size(path, ec);
+                auto mtime = fs::last_write_time(path, ec);
+                return path + '\n' + std::to_string(size) + '\n' + std::to_string(mtime.time_since_epoch().count()) + '\n' + std::to_string(folder);
+            }
+
+            // Decoded start of a block covering at least `needed` bytes, decoding and caching it
+            // on a miss. Blocks larger than the cache allows keep only their first max_block()
+            // bytes; null when `needed` lies beyond that.
+            std::shared_ptr<const std::string> cached_block(const std::string& path, const sevenzip::Index& index, size_t folder_index, uint64_t needed) {
+                trace::Span span("block_cache", "native");
+                std::string key = block_key(path, folder_index);
+                std::shared_ptr<const std::string> block = block_cache_.find(key);
+                span.arg("hit", block && block->size() >= needed ? 1 : 0);
+                if (block && block->size() >= needed) return block;
+
+                const sevenzip::Folder& folder = index.folders[folder_index];
+                uint64_t limit = std::min(folder.unpack_size(), block_cache_.max_block());
+                if (needed > limit) return nullptr;
+                auto decoded = std::make_shared<std::string>();
+                decoded->reserve(static_cast<size_t>(limit));
+                bool ok = sevenzip::decode_folder(path, folder, [&](const char* data, size_t size) {
+                    decoded->append(data, static_cast<size_t>(std::min<uint64_t>(size, limit - decoded->size())));
+                    return decoded->size() < limit;
+                });
+                if (!ok || decoded->size() != limit) return nullptr;
+                block_cache_.insert(key, decoded);
+                return decoded;
+            }
+
+            std::shared_ptr<const sevenzip::Index> cached_index(const std::string& path) const {
+                std::error_code ec;
+                uint64_t size = fs::file_size(path, ec);
+                auto mtime = fs::last_write_time(path, ec);
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!cached_ || cached_path_ != path || cached_size_ != size || cached_mtime_ != mtime) {
+                    cached_ = std::make_shared<const sevenzip::Index>(sevenzip::read_index(path));
+                    cached_path_ = path;
+                    cached_size_ = size;
+                    cached_mtime_ = mtime;
+                }
+                return cached_;
+            }
+
+            mutable std::mutex mutex_;
+            mutable std::shared_ptr<const sevenzip::Index> cached_;
+            mutable std::string cached_path_;
+            mutable uint64_t cached_size_ = 0;
+            mutable fs::file_time_type cached_mtime_{};
+            BlockCache block_cache_{128ull << 20};
+        };
+        // Listing only: the headers are walked in-process, anything else stays with unrar.
+        // Encrypted headers, damaged archives and broken volume chains produce no entries so
+        // the tools take over or report the error.
+        class NativeRar : public ArchiveBackend {
+        public:
+            std::string name() const override { return "native-rar"; }
+
+            std::vector<Capability> capabilities() const override {
+                return {{Operation::List, FileType::ARCHIVE_RAR, Cost{0.05, 0.01}}};
+            }
+
+            std::vector<ArchiveEntry> list(const Archive& archive) override {
+                rar::Index index = rar::read_index(archive.path);
+                std::vector<ArchiveEntry> entries;
+                if (!index.valid || index.needs_tool || index.truncated) return entries;
+                entries.reserve(index.members.size());
+                for (const rar::Member& member : index.members) {
+                    ArchiveEntry entry;
+                    entry.path = member.path;
+                    entry.is_directory = member.is_directory;
+                    entry.size = member.size;
+                    entry.compressed_size = member.packed_size;
+                    entry.crc = member.crc;
+                    entry.has_crc = member.has_crc;
+                    entry.method = rar::method_name(member);
+                    if (member.has_mtime) entry.modified = format_time(static_cast<std::time_t>(member.mtime));
+                    entries.push_back(std::move(entry));
+                }
+                return entries;
+            }
+
+            bool empty(const Archive& archive) override {
+                rar::Index index = rar::read_index(archive.path);
+                return index.valid && !index.needs_tool && !index.truncated && index.members.empty();
+            }
+        };
+        // Reads the TOC in-process and decodes members straight from their heap ranges, so xar
+        // archives can be browsed and extracted on hosts without the xar tool.
+        class NativeXar : public ArchiveBackend {
+        public:
+            std::string name() const override { return "native-xar"; }
+
+            std::vector<Capability> capabilities() const override {
+                return {
+                    {Operation::List, FileType::ARCHIVE_XAR, Cost{0.05, 0.01}},
+                    {Operation::ReadEntry, FileType::ARCHIVE_XAR, Cost{0.05, 1.0}},
+                    {Operation::Seek, FileType::ARCHIVE_XAR, Cost{0.05, 0.01}},
+                    {Operation::ExtractEntry, FileType::ARCHIVE_XAR, Cost{0.05, 1.0}},
+                    {Operation::Extract, FileType::ARCHIVE_XAR, Cost{0.05, 3.0}},
+                };
+            }
+
+            // Hard links without their own data and unknown encodings are left to xar.
+            bool accepts(Operation op, const Archive& archive) const override {
+                if (op != Operation::Extract) return true;
+                std::shared_ptr<const xar::Index> index = cached_index(archive.path);
+                return index->valid && !index->members.empty() &&
+                       std::all_of(index->members.begin(), index->members.end(), [](const xar::Member& member) { return extractable(member); });
+            }
+
+            std::vector<ArchiveEntry> list(const Archive& archive) override {
+                std::shared_ptr<const xar::Index> index = cached_index(archive.path);
+                std::vector<ArchiveEntry> entries;
+                if (!index->valid) return entries;
+                entries.reserve(index->members.size());
+                for (const auto& member : index->members) {
+                    ArchiveEntry entry;
+                    entry.path = member.path;
+                    entry.is_directory = member.is_directory;
+                    entry.size = member.size;
+                    entry.compressed_size = member.length;
+                    if (member.has_data) entry.method = xar::encoding_name(member.encoding);
+                    if (member.has_mtime) entry.modified = format_time(static_cast<std::time_t>(member.mtime));
+                    entries.push_back(std::move(entry));
+                }
+                return entries;
+            }
+
+            bool empty(const Archive& archive) override {
+                std::shared_ptr<const xar::Index> index = cached_index(archive.path);
+                return index->valid && index->members.empty();
+            }
+
+            bool read_entry(const Archive& archive, const std::string& entry, const StreamSink& sink) override {
+                std::shared_ptr<const xar::Index> index = cached_index(archive.path);
+                const xar::Member* member = find_member(*index, entry);
+                if (!member || member->is_directory || !xar::can_decode(*member)) return false;
+                return xar::decode_member(archive.path, *index, *member, sink);
+            }
+
+            // Only stored members can be entered mid-way; the registry streams the rest.
+            bool read_at(const Archive& archive, const std::string& entry, uint64_t offset, char* buffer, size_t size, size_t& copied) override {
+                copied = 0;
+                std::shared_ptr<const xar::Index> index = cached_index(archive.path);
+                const xar::Member* member = find_member(*index, entry);
+                if (!member || member->is_directory || member->encoding != xar::Encoding::None) return false;
+                if (!member->has_data || offset >= member->size || size == 0) return true;
+                std::ifstream input(archive.path, std::ios::binary);
+                size_t want = static_cast<size_t>(std::min<uint64_t>(size, member->size - offset));
+                input.seekg(static_cast<std::streamoff>(index->heap_offset + member->offset + offset));
+                if (!input.read(buffer, static_cast<std::streamsize>(want))) return false;
+                copied = want;
+                return true;
+            }
+
+            bool extract_entry(const Archive& archive, const std::string& entry, const std::string& output_dir) override {
+                std::shared_ptr<const xar::Index> index = cached_index(archive.path);
+                if (!index->valid) return false;
+                std::string prefix = entry;
+                while (!prefix.empty() && prefix.back() == '/') prefix.pop_back();
+
+                std::vector<size_t> selected;
+                for (size_t i = 0; i < index->members.size(); ++i) {
+                    const xar::Member& member = index->members[i];
+                    if (member.path != prefix && member.path.compare(0, prefix.size() + 1, prefix + "/") != 0) continue;
+                    if (!extractable(member)) return false;
+                    selected.push_back(i);
+                }
+                if (selected.empty()) return false;
+                return extract_members(archive.path, *index, selected, output_dir, JobContext{});
+            }
+
+            int extract(const Archive& archive, const std::string& target_dir, const JobContext& context) override {
+                std::shared_ptr<const xar::Index> index = cached_index(archive.path);
+                if (!index->valid) return 1;
+                std::vector<size_t> all(index->members.size());
+                for (size_t i = 0; i < all.size(); ++i) all[i] = i;
+                return extract_members(archive.path, *index, all, target_dir, context) ? 0 : 1;
+            }
+
+        private:
+            static bool extractable(const xar::Member& member) {
+                bool known = member.is_directory || member.is_symlink || member.type == "file" || (member.type == "hardlink" && member.has_data);
+                return known && xar::can_decode(member) && safe_relative(member.path);
+            }
+
+            bool extract_members(const std::string& path, const xar::Index& index, const std::vector<size_t>& selected,
+                                 const std::string& output_dir, const JobContext& context) {
+                trace::Span span("native_xar_extract", "native");
+                std::vector<size_t> kept = last_of_each_path(selected, [&](size_t i) { return index.members[i].path; });
+                std::vector<OutputEntry> outputs;
+                for (size_t i : kept) {
+                    const xar::Member& member = index.members[i];
+                    OutputEntry out;
+                    out.path = member.path;
+                    out.source = i;
+                    out.is_directory = member.is_directory;
+                    out.is_symlink = member.is_symlink;
+                    out.mode = member.mode;
+                    out.has_mtime = member.has_mtime;
+                    out.mtime = static_cast<std::time_t>(member.mtime);
+                    outputs.push_back(std::move(out));
+                }
+                OutputTree tree(output_dir);
+                if (!tree.prepare(outputs)) return false;
+
+                int threads = extraction_threads(context);
+                std::vector<std::pair<size_t, size_t>> units = balanced_runs(outputs, threads, [&](const OutputEntry& out) {
+                    return index.members[out.source].size;
+                });
+                std::atomic<bool> failed{false};
+                executor::global().parallel_for(units.size(), threads, [&](size_t u) {
+                    for (size_t i = units[u].first; i < units[u].second && !failed.load(); ++i) {
+                        const OutputEntry& out = outputs[i];
+                        if (out.is_directory) continue;
+                        const xar::Member& member = index.members[out.source];
+                        EntryWriter writer(tree, out);
+                        bool ok = writer.ok();
+                        uint64_t expected = member.size;
+                        if (ok && member.is_symlink) {
+                            ok = writer.write(member.link_target.data(), member.link_target.size());
+                            expected = member.link_target.size();
+                        } else if (ok) {
+                            ok = xar::decode_member(path, index, member, [&](const char* data, size_t size) { return writer.write(data, size); });
+                        }
+                        if (!ok || !writer.close(expected, false, 0)) {
+                            failed = true;
+                            break;
+                        }
+                        if (context.advance) context.advance(member.length, member.size);
+                    }
+                });
+                span.arg("entries", static_cast<int64_t>(outputs.size()));
+                span.arg("units", static_cast<int64_t>(units.size()));
+                return !failed && tree.finish(outputs);
+            }
+
+            static const xar::Member* find_member(const xar::Index& index, const std::string& entry) {
+                if (!index.valid) return nullptr;
+                for (auto it = index.members.rbegin(); it != index.members.rend(); ++it) {
+                    if (it->path == entry) return &*it;
+                }
+                return nullptr;
+            }
+
+            std::shared_ptr<const xar::Index> cached_index(const std::string& path) const {
+                std::error_code ec;
+                uint64_t size = fs::file_size(path, ec);
+                auto mtime = fs::last_write_time(path, ec);
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!cached_ || cached_path_ != path || cached_size_ != size || cached_mtime_ != mtime) {
+                    cached_ = std::make_shared<const xar::Index>(xar::read_index(path));
+                    cached_path_ = path;
+                    cached_size_ = size;
+                    cached_mtime_ = mtime;
+                }
+                return cached_;
+            }
+
+            mutable std::mutex mutex_;
+            mutable std::shared_ptr<const xar::Index> cached_;
+            mutable std::string cached_path_;
+            mutable uint64_t cached_size_ = 0;
+            mutable fs::file_time_type cached_mtime_{};
+        };
+    }
+
+    std::unique_ptr<ArchiveBackend> make_native_tar_backend() {
+        return std::make_unique<NativeTar>();
+    }
+
+    std::unique_ptr<ArchiveBackend> make_native_zip_backend() {
+        return std::make_unique<NativeZip>();
+    }
+
+    std::unique_ptr<ArchiveBackend> make_native_7z_backend() {
+        return std::make_unique<NativeSevenZip>();
+    }
+
+    std::unique_ptr<ArchiveBackend> make_native_rar_backend() {
+        return std::make_unique<NativeRar>();
+    }
+
+    std::unique_ptr<ArchiveBackend> make_native_xar_backend() {
+        return std::make_unique<NativeXar>();
+    }
+}
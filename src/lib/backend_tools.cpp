@@ -0,0 +1,501 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "include/archive_backend.h"
+#include "include/error.h"
+#include "include/i18n.h"
+#include "include/operation.h"
+#include "include/stream_probe.h"
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace backend {
+    namespace {
+        using file_type::FileType;
+        using tui::archive_ops::run_command_capture;
+        using tui::archive_ops::run_command_status;
+        using tui::archive_ops::run_command_stream;
+
+        const std::vector<FileType> kTarFormats = {
+            FileType::ARCHIVE_TAR, FileType::ARCHIVE_TAR_GZ, FileType::ARCHIVE_TAR_BZ2,
+            FileType::ARCHIVE_TAR_XZ, FileType::ARCHIVE_TAR_ZSTD,
+        };
+
+        void declare(std::vector<Capability>& capabilities, std::initializer_list<Operation> operations,
+                     const std::vector<FileType>& formats, Cost cost) {
+            for (Operation op : operations) {
+                for (FileType format : formats) capabilities.push_back({op, format, cost});
+            }
+        }
+
+        std::string absolute(const std::string& path) {
+            return fs::absolute(path).string();
+        }
+
+        // Name of the single member of an lz4 or zstd file.
+        std::string single_member_name(const std::string& archive_path) {
+            fs::path p(archive_path);
+            std::string stem = p.stem().string();
+            return stem.empty() ? p.filename().string() : stem;
+        }
+
+        // The frame headers give the real size when the encoder recorded it; otherwise the
+        // compressed size stands in.
+        std::vector<ArchiveEntry> list_single_member(const std::string& archive_path, FileType format) {
+            ArchiveEntry entry;
+            entry.path = single_member_name(archive_path);
+            std::error_code ec;
+            if (fs::exists(archive_path, ec)) entry.size = fs::file_size(archive_path, ec);
+            stream_probe::Probe probe = stream_probe::probe(archive_path, format);
+            if (probe.size_known) {
+                entry.compressed_size = entry.size;
+                entry.size = probe.content_size;
+            }
+            return {entry};
+        }
+
+        class ToolBackend : public ArchiveBackend {
+        public:
+            explicit ToolBackend(std::string tool) : tool_(std::move(tool)) {}
+
+            std::string name() const override { return tool_; }
+            bool available() const override { return operation::is_tool_available(tool_); }
+
+        protected:
+            int run(const JobContext& context, const std::vector<std::string>& args, const std::string& working_dir = "") const {
+                if (context.run_tool) return context.run_tool(tool_, args, working_dir);
+                std::vector<std::string> cmd = {tool_};
+                cmd.insert(cmd.end(), args.begin(), args.end());
+                return run_command_status(cmd);
+            }
+
+            bool stream(const std::vector<std::string>& args, const StreamSink& sink) const {
+                std::vector<std::string> cmd = {tool_};
+                cmd.insert(cmd.end(), args.begin(), args.end());
+                return run_command_stream(cmd, sink) == 0;
+            }
+
+            bool status(const std::vector<std::string>& args) const {
+                std::vector<std::string> cmd = {tool_};
+                cmd.insert(cmd.end(), args.begin(), args.end());
+                return run_command_status(cmd) == 0;
+            }
+
+            tui::archive_ops::CommandResult capture(const std::vector<std::string>& args) const {
+                std::vector<std::string> cmd = {tool_};
+                cmd.insert(cmd.end(), args.begin(), args.end());
+                return run_command_capture(cmd);
+            }
+
+            static void warn(const JobContext& context, const std::string& message) {
+                if (context.report) context.report(message);
+            }
+
+            std::string tool_;
+        };
+
+        class TarTool : public ToolBackend {
+        public:
+            TarTool() : ToolBackend("tar") {}
+
+            std::vector<Capability> capabilities() const override {
+                std::vector<Capability> caps;
+                for (FileType format : kTarFormats) {
+                    Cost decode{2.0, decode_ms_per_mib(format)};
+                    declare(caps, {Operation::List, Operation::ReadEntry, Operation::ExtractEntry, Operation::Extract, Operation::Verify}, {format}, decode);
+                    declare(caps, {Operation::Create}, {format}, Cost{2.0, encode_ms_per_mib(format)});
+                }
+                return caps;
+            }
+
+            std::vector<ArchiveEntry> list(const Archive& archive) override {
+                std::vector<std::string> args = flags(archive.format, 't');
+                args.push_back(archive.path);
+                auto result = capture(args);
+                if (result.exit_code != 0) return {};
+                return tui::archive_ops::parse_tar_listing(result.stdout_output);
+            }
+
+            bool empty(const Archive& archive) override {
+                std::vector<std::string> args = flags(archive.format, 't');
+                args.push_back(archive.path);
+                auto result = capture(args);
+                return result.exit_code == 0 && tui::archive_ops::parse_tar_listing(result.stdout_output).empty();
+            }
+
+            bool read_entry(const Archive& archive, const std::string& entry, const StreamSink& sink) override {
+                std::vector<std::string> args = flags(archive.format, 'x');
+                args.insert(args.end(), {archive.path, "-O", entry});
+                return stream(args, sink);
+            }
+
+            bool extract_entry(const Archive& archive, const std::string& entry, const std::string& output_dir) override {
+                std::vector<std::string> args = flags(archive.format, 'x');
+                args.insert(args.end(), {archive.path, "-C", output_dir, entry});
+                return status(args);
+            }
+
+            int extract(const Archive& archive, const std::string& target_dir, const JobContext& context) override {
+                if (!archive.password.empty()) warn(context, i18n::get("warning_tar_password"));
+                std::vector<std::string> args = flags(archive.format, 'x');
+                args.insert(args.end(), {absolute(archive.path), "-C", absolute(target_dir)});
+                return run(context, args);
+            }
+
+            int create(const Archive& target, const CreateJob& job, const JobContext& context) override {
+                if (!target.password.empty()) warn(context, i18n::get("warning_tar_password"));
+                std::vector<std::string> args = flags(target.format, 'c');
+                args.push_back(absolute(target.path));
+                args.insert(args.end(), job.items.begin(), job.items.end());
+                return run(context, args, job.working_dir);
+            }
+
+            int verify(const Archive& archive, const JobContext& context) override {
+                return run(context, {"-tf", archive.path});
+            }
+
+        private:
+            static std::vector<std::string> flags(FileType format, char mode) {
+                std::string letters = std::string("-") + mode;
+                switch (format) {
+                    case FileType::ARCHIVE_TAR_ZSTD: return {"--zstd", letters + "f"};
+                    case FileType::ARCHIVE_TAR_GZ: return {letters + "zf"};
+                    case FileType::ARCHIVE_TAR_BZ2: return {letters + "jf"};
+                    case FileType::ARCHIVE_TAR_XZ: return {letters + "Jf"};
+                    default: return {letters + "f"};
+                }
+            }
+
+            static double decode_ms_per_mib(FileType format) {
+                switch (format) {
+                    case FileType::ARCHIVE_TAR_GZ: return 4.0;
+                    case FileType::ARCHIVE_TAR_BZ2: return 25.0;
+                    case FileType::ARCHIVE_TAR_XZ: return 10.0;
+                    case FileType::ARCHIVE_TAR_ZSTD: return 1.5;
+                    default: return 0.5;
+                }
+            }
+
+            static double encode_ms_per_mib(FileType format) {
+                switch (format) {
+                    case FileType::ARCHIVE_TAR_GZ: return 25.0;
+                    case FileType::ARCHIVE_TAR_BZ2: return 60.0;
+                    case FileType::ARCHIVE_TAR_XZ: return 120.0;
+                    case FileType::ARCHIVE_TAR_ZSTD: return 4.0;
+                    default: return 1.0;
+                }
+            }
+        };
+
+        class UnzipTool : public ToolBackend {
+        public:
+            UnzipTool() : ToolBackend("unzip") {}
+
+            std::vector<Capability> capabilities() const override {
+                std::vector<Capability> caps;
+                declare(caps, {Operation::List}, {FileType::ARCHIVE_ZIP}, Cost{2.0, 0.2});
+                declare(caps, {Operation::ReadEntry, Operation::ExtractEntry}, {FileType::ARCHIVE_ZIP}, Cost{2.0, 0.2});
+                declare(caps, {Operation::Extract, Operation::Verify}, {FileType::ARCHIVE_ZIP}, Cost{2.0, 5.0});
+                return caps;
+            }
+
+            // Split sets need 7z to join the parts.
+            bool accepts(Operation op, const Archive& archive) const override {
+                return op != Operation::Extract || !operation::is_split_zip(archive.path);
+            }
+
+            std::vector<ArchiveEntry> list(const Archive& archive) override {
+                auto result = capture(with_password(archive, {"-v", archive.path}));
+                if (result.exit_code != 0) return {};
+                return tui::archive_ops::parse_unzip_listing(result.stdout_output);
+            }
+
+            bool read_entry(const Archive& archive, const std::string& entry, const StreamSink& sink) override {
+                return stream(with_password(archive, {"-p", archive.path, entry}), sink);
+            }
+
+            bool extract_entry(const Archive& archive, const std::string& entry, const std::string& output_dir) override {
+                return status(with_password(archive, {"-o", archive.path, entry, "-d", output_dir}));
+            }
+
+            int extract(const Archive& archive, const std::string& target_dir, const JobContext& context) override {
+                std::vector<std::string> args;
+                if (!archive.password.empty()) args.insert(args.end(), {"-P", archive.password});
+                args.insert(args.end(), {"-o", absolute(archive.path), "-d", absolute(target_dir)});
+                return run(context, args);
+            }
+
+            int verify(const Archive& archive, const JobContext& context) override {
+                return run(context, {"-t", archive.path});
+            }
+
+        private:
+            // Options go before the archive name; -v/-p/-o stay first.
+            static std::vector<std::string> with_password(const Archive& archive, std::vector<std::string> args) {
+                if (!archive.password.empty()) args.insert(args.begin() + 1, {"-P", archive.password});
+                return args;
+            }
+        };
+
+        class ZipTool : public ToolBackend {
+        public:
+            ZipTool() : ToolBackend("zip") {}
+
+            std::vector<Capability> capabilities() const override {
+                std::vector<Capability> caps;
+                declare(caps, {Operation::Create}, {FileType::ARCHIVE_ZIP}, Cost{3.0, 25.0});
+                return caps;
+            }
+
+            int create(const Archive& target, const CreateJob& job, const JobContext& context) override {
+                std::vector<std::string> args;
+                if (!target.password.empty()) args.insert(args.end(), {"-P", target.password});
+                if (context.compression_level > 0) args.push_back("-" + std::to_string(context.compression_level));
+                args.push_back("-r");
+                args.push_back(absolute(target.path));
+                args.insert(args.end(), job.items.begin(), job.items.end());
+                return run(context, args, job.working_dir);
+            }
+        };
+
+        class SevenZipTool : public ToolBackend {
+        public:
+            SevenZipTool() : ToolBackend("7z") {}
+
+            std::vector<Capability> capabilities() const override {
+                std::vector<Capability> caps;
+                declare(caps, {Operation::List}, {FileType::ARCHIVE_7Z, FileType::ARCHIVE_ZIP, FileType::ARCHIVE_RAR}, Cost{8.0, 0.1});
+                declare(caps, {Operation::ReadEntry, Operation::ExtractEntry}, {FileType::ARCHIVE_7Z, FileType::ARCHIVE_ZIP, FileType::ARCHIVE_RAR}, Cost{8.0, 1.0});
+                declare(caps, {Operation::Extract, Operation::Verify}, {FileType::ARCHIVE_7Z, FileType::ARCHIVE_ZIP, FileType::ARCHIVE_RAR}, Cost{8.0, 6.0});
+                declare(caps, {Operation::Create}, {FileType::ARCHIVE_7Z}, Cost{8.0, 80.0});
+                return caps;
+            }
+
+            std::vector<ArchiveEntry> list(const Archive& archive) override {
+                auto result = capture(with_password(archive, {"l", "-slt", archive.path}));
+                if (result.exit_code != 0) return {};
+                return tui::archive_ops::parse_7z_listing(result.stdout_output);
+            }
+
+            bool empty(const Archive& archive) override {
+                auto result = capture(with_password(archive, {"l", "-slt", archive.path}));
+                return result.exit_code == 0 && tui::archive_ops::parse_7z_listing(result.stdout_output).empty();
+            }
+
+            bool read_entry(const Archive& archive, const std::string& entry, const StreamSink& sink) override {
+                return stream(with_password(archive, {"e", "-so", archive.path, entry}), sink);
+            }
+
+            bool extract_entry(const Archive& archive, const std::string& entry, const std::string& output_dir) override {
+                return status(with_password(archive, {"x", archive.path, entry, "-o" + output_dir, "-y"}));
+            }
+
+            int extract(const Archive& archive, const std::string& target_dir, const JobContext& context) override {
+                std::string source = archive.path;
+                if (archive.format == FileType::ARCHIVE_ZIP && operation::is_split_zip(archive.path)) {
+                    if (operation::is_split_zip_part(archive.path)) {
+                        source = operation::find_split_zip_main(archive.path);
+                        if (source.empty()) {
+                            std::string main_zip = fs::path(archive.path).replace_extension(".zip").string();
+                            error::throw_error(error::ErrorCode::INVALID_SOURCE,
+                                {{"PATH", main_zip}, {"REASON", i18n::get("error_split_zip_main_not_found", {{"PATH", main_zip}})}});
+                        }
+                    }
+                    if (context.verbose) warn(context, i18n::get("info_split_zip_detected"));
+                }
+                std::vector<std::string> args = {"x"};
+                if (!archive.password.empty()) args.push_back("-p" + archive.password);
+                args.insert(args.end(), {absolute(source), "-o" + absolute(target_dir), "-y"});
+                return run(context, args);
+            }
+
+            int create(const Archive& target, const CreateJob& job, const JobContext& context) override {
+                std::vector<std::string> args = {"a"};
+                if (!target.password.empty()) args.push_back("-p" + target.password);
+                if (context.compression_level > 0) args.push_back("-mx=" + std::to_string(context.compression_level));
+                args.push_back(absolute(target.path));
+                args.insert(args.end(), job.items.begin(), job.items.end());
+                return run(context, args, job.working_dir);
+            }
+
+            int verify(const Archive& archive, const JobContext& context) override {
+                return run(context, {"t", archive.path});
+            }
+
+        private:
+            static std::vector<std::string> with_password(const Archive& archive, std::vector<std::string> args) {
+                if (!archive.password.empty()) args.insert(args.begin() + 1, "-p" + archive.password);
+                return args;
+            }
+        };
+
+        class UnrarTool : public ToolBackend {
+        public:
+            UnrarTool() : ToolBackend("unrar") {}
+
+            std::vector<Capability> capabilities() const override {
+                std::vector<Capability> caps;
+                declare(caps, {Operation::List}, {FileType::ARCHIVE_RAR}, Cost{4.0, 0.1});
+                declare(caps, {Operation::ReadEntry, Operation::ExtractEntry}, {FileType::ARCHIVE_RAR}, Cost{4.0, 1.0});
+                declare(caps, {Operation::Extract, Operation::Verify}, {FileType::ARCHIVE_RAR}, Cost{4.0, 6.0});
+                return caps;
+            }
+
+            std::vector<ArchiveEntry> list(const Archive& archive) override {
+                auto result = capture({"lb", password_arg(archive), archive.path});
+                if (result.exit_code != 0) return {};
+                return tui::archive_ops::parse_tar_listing(result.stdout_output);
+            }
+
+            bool read_entry(const Archive& archive, const std::string& entry, const StreamSink& sink) override {
+                return stream({"p", "-inul", password_arg(archive), archive.path, entry}, sink);
+            }
+
+            bool extract_entry(const Archive& archive, const std::string& entry, const std::string& output_dir) override {
+                return status({"x", password_arg(archive), "-o+", archive.path, entry, output_dir});
+            }
+
+            int extract(const Archive& archive, const std::string& target_dir, const JobContext& context) override {
+                std::vector<std::string> args = {"x"};
+                if (!archive.password.empty()) args.push_back("-p" + archive.password);
+                args.insert(args.end(), {"-o+", absolute(archive.path), absolute(target_dir)});
+                return run(context, args);
+            }
+
+            int verify(const Archive& archive, const JobContext& context) override {
+                return run(context, {"t", archive.path});
+            }
+
+        private:
+            // "-p-" stops unrar from prompting when no password was given.
+            static std::string password_arg(const Archive& archive) {
+                return archive.password.empty() ? "-p-" : "-p" + archive.password;
+            }
+        };
+
+        class XarTool : public ToolBackend {
+        public:
+            XarTool() : ToolBackend("xar") {}
+
+            std::vector<Capability> capabilities() const override {
+                std::vector<Capability> caps;
+                declare(caps, {Operation::List}, {FileType::ARCHIVE_XAR}, Cost{3.0, 0.1});
+                declare(caps, {Operation::ReadEntry, Operation::ExtractEntry}, {FileType::ARCHIVE_XAR}, Cost{3.0, 1.0});
+                declare(caps, {Operation::Extract, Operation::Verify}, {FileType::ARCHIVE_XAR}, Cost{3.0, 5.0});
+                declare(caps, {Operation::Create}, {FileType::ARCHIVE_XAR}, Cost{3.0, 25.0});
+                return caps;
+            }
+
+            std::vector<ArchiveEntry> list(const Archive& archive) override {
+                auto result = capture({"-tf", archive.path});
+                if (result.exit_code != 0) return {};
+                return tui::archive_ops::parse_tar_listing(result.stdout_output);
+            }
+
+            bool read_entry(const Archive& archive, const std::string& entry, const StreamSink& sink) override {
+                return stream({"-xf", archive.path, "-O", entry}, sink);
+            }
+
+            bool extract_entry(const Archive& archive, const std::string& entry, const std::string& output_dir) override {
+                return status({"-xf", archive.path, "-C", output_dir, entry});
+            }
+
+            int extract(const Archive& archive, const std::string& target_dir, const JobContext& context) override {
+                return run(context, {"-xf", absolute(archive.path), "-C", absolute(target_dir)});
+            }
+
+            int create(const Archive& target, const CreateJob& job, const JobContext& context) override {
+                std::vector<std::string> args = {"-cf", absolute(target.path)};
+                args.insert(args.end(), job.items.begin(), job.items.end());
+                return run(context, args, job.working_dir);
+            }
+
+            int verify(const Archive& archive, const JobContext& context) override {
+                return run(context, {"-tf", archive.path});
+            }
+        };
+
+        // lz4 and zstd compress exactly one file and share their command-line shape.
+        class SingleFileTool : public ToolBackend {
+        public:
+            SingleFileTool(std::string tool, FileType format, std::string archive_hint, Cost decode, Cost encode)
+                : ToolBackend(std::move(tool)), format_(format), archive_hint_(std::move(archive_hint)), decode_(decode), encode_(encode) {}
+
+            std::vector<Capability> capabilities() const override {
+                std::vector<Capability> caps;
+                declare(caps, {Operation::List}, {format_}, Cost{0.1, 0.0});
+                declare(caps, {Operation::ReadEntry, Operation::ExtractEntry, Operation::Extract, Operation::Verify}, {format_}, decode_);
+                declare(caps, {Operation::Create}, {format_}, encode_);
+                return caps;
+            }
+
+            std::vector<ArchiveEntry> list(const Archive& archive) override {
+                return list_single_member(archive.path, format_);
+            }
+
+            bool read_entry(const Archive& archive, const std::string&, const StreamSink& sink) override {
+                return stream({"-d", "-f", "-c", archive.path}, sink);
+            }
+
+            bool extract_entry(const Archive& archive, const std::string&, const std::string& output_dir) override {
+                fs::path out_path = fs::path(output_dir) / single_member_name(archive.path);
+                return status(output_args(archive.path, out_path.string()));
+            }
+
+            int extract(const Archive& archive, const std::string& target_dir, const JobContext& context) override {
+                fs::path out_path = fs::path(target_dir) / fs::path(archive.path).stem();
+                fs::create_directories(out_path.parent_path());
+                return run(context, output_args(absolute(archive.path), absolute(out_path.string())));
+            }
+
+            int create(const Archive& target, const CreateJob& job, const JobContext& context) override {
+                if (job.sources.size() != 1) {
+                    error::throw_error(error::ErrorCode::UNKNOWN_FORMAT, {{"INFO", "Multiple sources are not supported for " + tool_ + " compression."}});
+                }
+                if (fs::is_directory(job.sources.front())) {
+                    error::throw_error(error::ErrorCode::UNKNOWN_FORMAT, {{"INFO", tool_ + " does not support directory compression. Use " + archive_hint_ + " instead."}});
+                }
+                std::vector<std::string> args;
+                if (context.compression_level > 0) args.push_back("-" + std::to_string(context.compression_level));
+                args.push_back(absolute(job.sources.front()));
+                if (tool_ == "zstd") args.push_back("-o");
+                args.push_back(absolute(target.path));
+                return run(context, args, job.working_dir);
+            }
+
+            int verify(const Archive& archive, const JobContext& context) override {
+                return run(context, {"-t", archive.path});
+            }
+
+        private:
+            std::vector<std::string> output_args(const std::string& input, const std::string& output) const {
+                if (tool_ == "zstd") return {"-d", "-f", input, "-o", output};
+                return {"-d", "-f", input, output};
+            }
+
+            FileType format_;
+            std::string archive_hint_;
+            Cost decode_;
+            Cost encode_;
+        };
+    }
+
+    std::vector<std::unique_ptr<ArchiveBackend>> make_tool_backends() {
+        // Registration order breaks cost ties and picks the tool named when none is installed.
+        std::vector<std::unique_ptr<ArchiveBackend>> tools;
+        tools.push_back(std::make_unique<TarTool>());
+        tools.push_back(std::make_unique<UnzipTool>());
+        tools.push_back(std::make_unique<ZipTool>());
+        tools.push_back(std::make_unique<UnrarTool>());
+        tools.push_back(std::make_unique<SevenZipTool>());
+        tools.push_back(std::make_unique<XarTool>());
+        tools.push_back(std::make_unique<SingleFileTool>("lz4", FileType::ARCHIVE_LZ4, "tar.lz4", Cost{1.5, 1.0}, Cost{1.5, 2.0}));
+        tools.push_back(std::make_unique<SingleFileTool>("zstd", FileType::ARCHIVE_ZSTD, "tar.zst", Cost{1.5, 1.5}, Cost{1.5, 4.0}));
+        return tools;
+    }
+}
@@ -0,0 +1,59 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "include/checksum.h"
+#include "include/simd.h"
+
+namespace checksum {
+    namespace {
+        // GF(2) 32x32 matrix helpers: feeding a zero bit through the CRC register is linear,
+        // so n zero bytes is the per-bit operator raised to 8n by repeated squaring.
+        uint32_t gf2_matrix_times(const uint32_t* matrix, uint32_t vector) {
+            uint32_t sum = 0;
+            for (; vector != 0; vector >>= 1, ++matrix) {
+                if (vector & 1) sum ^= *matrix;
+            }
+            return sum;
+        }
+
+        void gf2_matrix_square(uint32_t* square, const uint32_t* matrix) {
+            for (int n = 0; n < 32; ++n) {
+                square[n] = gf2_matrix_times(matrix, matrix[n]);
+            }
+        }
+    }
+
+    uint32_t crc32(uint32_t crc, const void* data, size_t length) {
+        return simd::crc32(crc, data, length);
+    }
+
+    uint32_t crc32_zeros(uint32_t crc, uint64_t length) {
+        if (length == 0) return crc;
+
+        uint32_t even[32];
+        uint32_t odd[32];
+        odd[0] = 0xEDB88320u;
+        for (int n = 1; n < 32; ++n) {
+            odd[n] = 1u << (n - 1);
+        }
+        gf2_matrix_square(even, odd);
+        gf2_matrix_square(odd, even);
+
+        uint32_t reg = ~crc;
+        while (true) {
+            gf2_matrix_square(even, odd);
+            if (length & 1) reg = gf2_matrix_times(even, reg);
+            length >>= 1;
+            if (length == 0) break;
+
+            gf2_matrix_square(odd, even);
+            if (length & 1) reg = gf2_matrix_times(odd, reg);
+            length >>= 1;
+            if (length == 0) break;
+        }
+        return ~reg;
+    }
+}
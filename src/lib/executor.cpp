@@ -0,0 +1,232 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "include/executor.h"
+#include "include/trace.h"
+
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <string>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace executor {
+    namespace {
+        constexpr size_t kNotAWorker = static_cast<size_t>(-1);
+
+        thread_local Executor* current_executor = nullptr;
+        thread_local size_t current_worker = kNotAWorker;
+
+        std::atomic<int> requested_threads{0};
+
+        // CPUs granted by a cgroup v2 cpu.max or v1 cfs quota, rounded up; 0 when unlimited.
+        size_t cgroup_cpu_limit() {
+            double quota = 0;
+            double period = 0;
+            std::ifstream v2("/sys/fs/cgroup/cpu.max");
+            std::string quota_text;
+            if (v2 >> quota_text >> period) {
+                if (quota_text == "max") return 0;
+                quota = std::stod(quota_text);
+            } else {
+                std::ifstream v1_quota("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+                std::ifstream v1_period("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+                if (!(v1_quota >> quota) || !(v1_period >> period)) return 0;
+            }
+            if (quota <= 0 || period <= 0) return 0;
+            return static_cast<size_t>(std::max(1.0, quota / period + 0.999));
+        }
+
+        void raise_peak(std::atomic<size_t>& peak, size_t value) {
+            size_t seen = peak.load(std::memory_order_relaxed);
+            while (value > seen && !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+        }
+    }
+
+    Executor::Executor(size_t workers) {
+        workers = std::max<size_t>(1, workers);
+        for (size_t i = 0; i < workers; ++i) workers_.push_back(std::make_unique<Worker>());
+        threads_.reserve(workers);
+        for (size_t i = 0; i < workers; ++i) {
+            threads_.emplace_back([this, i]() { run_worker(i); });
+        }
+    }
+
+    Executor::~Executor() {
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex_);
+            stopping_ = true;
+        }
+        idle_.notify_all();
+        for (auto& thread : threads_) thread.join();
+    }
+
+    void Executor::submit(std::function<void()> task, Priority priority) {
+        size_t target = current_executor == this ? current_worker
+                                                 : next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+        // Counted before it is visible so a worker that takes it cannot drive the count below zero.
+        raise_peak(peak_queued_, queued_.fetch_add(1) + 1);
+        {
+            std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+            workers_[target]->tasks[static_cast<size_t>(priority)].push_back(std::move(task));
+        }
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        idle_.notify_one();
+    }
+
+    // Own deque newest-first (still warm in cache), then the oldest task of a peer, one priority at a time.
+    bool Executor::take(size_t self, std::function<void()>& task) {
+        for (size_t priority = 0; priority < kPriorityCount; ++priority) {
+            {
+                Worker& own = *workers_[self];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                auto& tasks = own.tasks[priority];
+                if (!tasks.empty()) {
+                    task = std::move(tasks.back());
+                    tasks.pop_back();
+                    queued_.fetch_sub(1);
+                    return true;
+                }
+            }
+            for (size_t offset = 1; offset < workers_.size(); ++offset) {
+                Worker& victim = *workers_[(self + offset) % workers_.size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                auto& tasks = victim.tasks[priority];
+                if (!tasks.empty()) {
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                    queued_.fetch_sub(1);
+                    stolen_.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void Executor::run_worker(size_t self) {
+        current_executor = this;
+        current_worker = self;
+        std::function<void()> task;
+        while (true) {
+            if (take(self, task)) {
+                // Counted before it runs: a task may wake the thread that then reads stats().
+                executed_.fetch_add(1, std::memory_order_relaxed);
+                trace::Span span("task", "executor");
+                span.arg("queue_depth", static_cast<int64_t>(queue_depth()));
+                try {
+                    task();
+                } catch (...) {
+                    // Tasks report their own failures; one that escapes must not take the worker down.
+                }
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(idle_mutex_);
+            if (stopping_ && queued_.load() == 0) return;
+            idle_.wait(lock, [this]() { return stopping_ || queued_.load() > 0; });
+        }
+    }
+
+    void Executor::parallel_for(size_t count, int max_threads, const std::function<void(size_t)>& body, Priority priority) {
+        if (count == 0) return;
+
+        struct Loop {
+            std::atomic<size_t> next{0};
+            size_t count = 0;
+            const std::function<void(size_t)>* body = nullptr;
+            std::mutex mutex;
+            std::condition_variable done;
+            size_t finished = 0;
+            std::exception_ptr first_error;
+        };
+        // Helpers that start after the caller returned find no index left and never touch body.
+        auto loop = std::make_shared<Loop>();
+        loop->count = count;
+        loop->body = &body;
+
+        auto drain = [loop]() {
+            size_t index;
+            while ((index = loop->next.fetch_add(1)) < loop->count) {
+                std::exception_ptr error;
+                try {
+                    (*loop->body)(index);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                std::lock_guard<std::mutex> lock(loop->mutex);
+                if (error && !loop->first_error) loop->first_error = error;
+                if (++loop->finished == loop->count) loop->done.notify_all();
+            }
+        };
+
+        size_t helpers = workers_.size();
+        if (max_threads > 0) helpers = std::min(helpers, static_cast<size_t>(max_threads) - 1);
+        helpers = std::min(helpers, count - 1);
+        for (size_t i = 0; i < helpers; ++i) submit(drain, priority);
+
+        // The caller works too, so nested loops inside a task cannot starve waiting on the pool.
+        drain();
+        std::unique_lock<std::mutex> lock(loop->mutex);
+        loop->done.wait(lock, [&]() { return loop->finished == loop->count; });
+        if (loop->first_error) std::rethrow_exception(loop->first_error);
+    }
+
+    Stats Executor::stats() const {
+        Stats stats;
+        stats.workers = workers_.size();
+        stats.queue_depth = queue_depth();
+        stats.peak_queue_depth = peak_queued_.load(std::memory_order_relaxed);
+        stats.executed = executed_.load(std::memory_order_relaxed);
+        stats.stolen = stolen_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void TaskGroup::submit(std::function<void()> task, Priority priority) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++pending_;
+        }
+        executor_.submit([this, task = std::move(task)]() {
+            try {
+                task();
+            } catch (...) {
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) done_.notify_all();
+        }, priority);
+    }
+
+    void TaskGroup::wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return pending_ == 0; });
+    }
+
+    size_t available_parallelism() {
+        size_t cpus = std::thread::hardware_concurrency();
+#ifdef __linux__
+        cpu_set_t mask;
+        if (sched_getaffinity(0, sizeof(mask), &mask) == 0) cpus = static_cast<size_t>(CPU_COUNT(&mask));
+#endif
+        size_t limit = cgroup_cpu_limit();
+        if (limit > 0) cpus = std::min(cpus, limit);
+        return std::max<size_t>(1, cpus);
+    }
+
+    void configure(int thread_count) {
+        requested_threads = thread_count;
+    }
+
+    Executor& global() {
+        // Never destroyed: tasks may still be running while static destructors run at exit.
+        static Executor* instance = new Executor(requested_threads > 0 ? static_cast<size_t>(requested_threads.load())
+                                                                         : available_parallelism());
+        return *instance;
+    }
+}
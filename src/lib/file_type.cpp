@@ -6,16 +6,183 @@
 
 #include "include/file_type.h"
 #include "include/error.h"
+#include "include/tar_header.h"
 
 #include <filesystem>
 #include <fstream>
 #include <array>
 #include <algorithm>
 #include <cctype>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include <bzlib.h>
+#include <lzma.h>
+#include <zlib.h>
+#ifdef HITPAG_HAVE_ZSTD
+#include <zstd.h>
+#endif
 
 namespace fs = std::filesystem;
 
 namespace file_type {
+    namespace {
+        // bzip2 emits nothing before its first block (up to 900 kB) is complete.
+        constexpr size_t kMaxSniffInput = 1024 * 1024;
+
+        enum class Sniff { Tar, NotTar, Undecided };
+        enum class Step { More, Ended, Failed };
+
+        // Appends more of the file to the buffer; false at the end or at kMaxSniffInput.
+        using Grow = std::function<bool(std::vector<char>&)>;
+
+        bool is_tar_block(const char* block) {
+            return !tar_header::is_zero_block(block) &&
+                   (std::memcmp(block + 257, "ustar", 5) == 0 || tar_header::checksum_valid(block));
+        }
+
+        // Drives a streaming decoder over the buffered start of the file until it has produced
+        // one tar block, so recognition never decompresses more than 512 bytes.
+        template <typename Decode>
+        Sniff sniff_stream(std::vector<char>& buffer, const Grow& grow, Decode&& decode) {
+            char block[tar_header::kBlockSize];
+            size_t offset = 0;
+            size_t produced = 0;
+            Step step = Step::More;
+            while (produced < sizeof(block) && step == Step::More) {
+                if (offset == buffer.size() && !grow(buffer)) break;
+                size_t used = 0;
+                size_t made = 0;
+                step = decode(buffer.data() + offset, buffer.size() - offset, used, block + produced, sizeof(block) - produced, made);
+                offset += used;
+                produced += made;
+                if (step == Step::More && used == 0 && made == 0 && !grow(buffer)) break;
+            }
+            if (step == Step::Failed) return Sniff::Undecided;
+            if (produced < sizeof(block)) return step == Step::Ended ? Sniff::NotTar : Sniff::Undecided;
+            return is_tar_block(block) ? Sniff::Tar : Sniff::NotTar;
+        }
+
+        Sniff sniff_gzip(std::vector<char>& buffer, const Grow& grow) {
+            z_stream stream{};
+            if (inflateInit2(&stream, 15 + 16) != Z_OK) return Sniff::Undecided;
+            Sniff result = sniff_stream(buffer, grow, [&](const char* in, size_t in_size, size_t& in_used, char* out, size_t out_size, size_t& out_used) {
+                stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+                stream.avail_in = static_cast<uInt>(in_size);
+                stream.next_out = reinterpret_cast<Bytef*>(out);
+                stream.avail_out = static_cast<uInt>(out_size);
+                int status = inflate(&stream, Z_NO_FLUSH);
+                in_used = in_size - stream.avail_in;
+                out_used = out_size - stream.avail_out;
+                if (status == Z_STREAM_END) return Step::Ended;
+                return status == Z_OK || status == Z_BUF_ERROR ? Step::More : Step::Failed;
+            });
+            inflateEnd(&stream);
+            return result;
+        }
+
+        Sniff sniff_bzip2(std::vector<char>& buffer, const Grow& grow) {
+            bz_stream stream{};
+            if (BZ2_bzDecompressInit(&stream, 0, 0) != BZ_OK) return Sniff::Undecided;
+            Sniff result = sniff_stream(buffer, grow, [&](const char* in, size_t in_size, size_t& in_used, char* out, size_t out_size, size_t& out_used) {
+                stream.next_in = const_cast<char*>(in);
+                stream.avail_in = static_cast<unsigned>(in_size);
+                stream.next_out = out;
+                stream.avail_out = static_cast<unsigned>(out_size);
+                int status = BZ2_bzDecompress(&stream);
+                in_used = in_size - stream.avail_in;
+                out_used = out_size - stream.avail_out;
+                if (status == BZ_STREAM_END) return Step::Ended;
+                return status == BZ_OK ? Step::More : Step::Failed;
+            });
+            BZ2_bzDecompressEnd(&stream);
+            return result;
+        }
+
+        Sniff sniff_xz(std::vector<char>& buffer, const Grow& grow) {
+            lzma_stream stream = LZMA_STREAM_INIT;
+            if (lzma_stream_decoder(&stream, UINT64_MAX, 0) != LZMA_OK) return Sniff::Undecided;
+            Sniff result = sniff_stream(buffer, grow, [&](const char* in, size_t in_size, size_t& in_used, char* out, size_t out_size, size_t& out_used) {
+                stream.next_in = reinterpret_cast<const uint8_t*>(in);
+                stream.avail_in = in_size;
+                stream.next_out = reinterpret_cast<uint8_t*>(out);
+                stream.avail_out = out_size;
+                lzma_ret status = lzma_code(&stream, LZMA_RUN);
+                in_used = in_size - stream.avail_in;
+                out_used = out_size - stream.avail_out;
+                if (status == LZMA_STREAM_END) return Step::Ended;
+                return status == LZMA_OK || status == LZMA_BUF_ERROR ? Step::More : Step::Failed;
+            });
+            lzma_end(&stream);
+            return result;
+        }
+
+        Sniff sniff_zstd(std::vector<char>& buffer, const Grow& grow) {
+#ifdef HITPAG_HAVE_ZSTD
+            ZSTD_DStream* stream = ZSTD_createDStream();
+            if (!stream) return Sniff::Undecided;
+            Sniff result = sniff_stream(buffer, grow, [&](const char* in, size_t in_size, size_t& in_used, char* out, size_t out_size, size_t& out_used) {
+                ZSTD_inBuffer input{in, in_size, 0};
+                ZSTD_outBuffer output{out, out_size, 0};
+                size_t status = ZSTD_decompressStream(stream, &output, &input);
+                in_used = input.pos;
+                out_used = output.pos;
+                if (ZSTD_isError(status)) return Step::Failed;
+                return status == 0 ? Step::Ended : Step::More;
+            });
+            ZSTD_freeDStream(stream);
+            return result;
+#else
+            (void)buffer;
+            (void)grow;
+            return Sniff::Undecided;
+#endif
+        }
+
+        bool starts_with(const std::vector<char>& buffer, std::initializer_list<unsigned char> magic) {
+            if (buffer.size() < magic.size()) return false;
+            size_t i = 0;
+            for (unsigned char byte : magic) {
+                if (static_cast<unsigned char>(buffer[i++]) != byte) return false;
+            }
+            return true;
+        }
+
+        // Signatures first; compressed streams are then told apart from compressed tarballs by
+        // decoding their first 512 bytes. A stream that cannot be decoded that far keeps the
+        // guess its signature alone gives.
+        FileType recognize_buffer(std::vector<char>& buffer, const Grow& grow) {
+            if (buffer.size() < 4) return FileType::UNKNOWN;
+
+            if (starts_with(buffer, {'P', 'K', 0x03, 0x04}) || starts_with(buffer, {'P', 'K', 0x05, 0x06}) ||
+                starts_with(buffer, {'P', 'K', 0x01, 0x02})) {
+                return FileType::ARCHIVE_ZIP;
+            }
+            if (starts_with(buffer, {'R', 'a', 'r', '!'})) return FileType::ARCHIVE_RAR;
+            if (starts_with(buffer, {'7', 'z', 0xBC, 0xAF, 0x27, 0x1C})) return FileType::ARCHIVE_7Z;
+            if (starts_with(buffer, {'x', 'a', 'r', '!'})) return FileType::ARCHIVE_XAR;
+
+            if (starts_with(buffer, {0x1F, 0x8B, 0x08})) {
+                return sniff_gzip(buffer, grow) == Sniff::Tar ? FileType::ARCHIVE_TAR_GZ : FileType::UNKNOWN;
+            }
+            if (buffer.size() >= 10 && starts_with(buffer, {'B', 'Z', 'h'}) && buffer[3] >= '1' && buffer[3] <= '9') {
+                return sniff_bzip2(buffer, grow) == Sniff::Tar ? FileType::ARCHIVE_TAR_BZ2 : FileType::UNKNOWN;
+            }
+            if (starts_with(buffer, {0xFD, '7', 'z', 'X', 'Z', 0x00})) {
+                return sniff_xz(buffer, grow) == Sniff::NotTar ? FileType::UNKNOWN : FileType::ARCHIVE_TAR_XZ;
+            }
+            // No tar.lz4 type exists, so lz4 frames need no decoding.
+            if (starts_with(buffer, {0x04, 0x22, 0x4D, 0x18})) return FileType::ARCHIVE_LZ4;
+            if (starts_with(buffer, {0x28, 0xB5, 0x2F, 0xFD}) || starts_with(buffer, {0x22, 0xB5, 0x2F, 0xFD})) {
+                return sniff_zstd(buffer, grow) == Sniff::Tar ? FileType::ARCHIVE_TAR_ZSTD : FileType::ARCHIVE_ZSTD;
+            }
+
+            if (buffer.size() >= tar_header::kBlockSize && is_tar_block(buffer.data())) return FileType::ARCHIVE_TAR;
+            return FileType::UNKNOWN;
+        }
+    }
+
     bool is_split_zip_extension(const std::string& ext_lower) {
         return ext_lower.size() == 4 && ext_lower[0] == '.' && ext_lower[1] == 'z' &&
                std::isdigit(static_cast<unsigned char>(ext_lower[2])) &&
@@ -54,77 +221,26 @@ namespace file_type {
         return FileType::UNKNOWN;
     }
 
+    FileType recognize_header_bytes(std::vector<char>& head, const ReadMore& read_more) {
+        return recognize_buffer(head, [&read_more](std::vector<char>& data) {
+            if (!read_more || data.size() >= kMaxSniffInput) return false;
+            size_t old_size = data.size();
+            data.resize(std::min(kMaxSniffInput, std::max(old_size * 2, HEADER_READ_SIZE)));
+            data.resize(old_size + read_more(data.data() + old_size, data.size() - old_size));
+            return data.size() > old_size;
+        });
+    }
+
     FileType recognize_by_header(const std::string& path) {
         std::ifstream file(path, std::ios::binary);
         if (!file) return FileType::UNKNOWN;
-        std::array<char, 16> header{};
-        file.read(header.data(), header.size());
-        if(file.gcount() < 4 || file.fail()) return FileType::UNKNOWN;
-
-        if (header[0] == 0x50 && header[1] == 0x4B) {
-            if ((header[2] == 0x03 && header[3] == 0x04) ||
-                (header[2] == 0x05 && header[3] == 0x06) ||
-                (header[2] == 0x01 && header[3] == 0x02)) {
-                return FileType::ARCHIVE_ZIP;
-            }
-        }
-
-        if (header[0] == 0x52 && header[1] == 0x61 && header[2] == 0x72 && header[3] == 0x21) {
-            return FileType::ARCHIVE_RAR;
-        }
-
-        if (file.gcount() >= 6 && header[0] == 0x37 && header[1] == 0x7A && header[2] == (char)0xBC && header[3] == (char)0xAF &&
-            header[4] == 0x27 && header[5] == 0x1C) {
-            return FileType::ARCHIVE_7Z;
-        }
-
-
-        if (file.gcount() >= 6 && header[0] == (char)0xFD && header[1] == 0x37 && header[2] == 0x7A &&
-            header[3] == 0x58 && header[4] == 0x5A && header[5] == 0x00) {
-            return FileType::ARCHIVE_TAR_XZ;
-        }
-
-        if (header[0] == 0x04 && header[1] == 0x22 && header[2] == 0x4D && header[3] == 0x18) {
-            return FileType::ARCHIVE_LZ4;
-        }
-
-        if ((header[0] == 0x28 && header[1] == (char)0xB5 && header[2] == 0x2F && header[3] == (char)0xFD) ||
-            (header[0] == 0x22 && header[1] == (char)0xB5 && header[2] == 0x2F && header[3] == (char)0xFD)) {
-            return FileType::ARCHIVE_ZSTD;
-        }
-
-        file.clear();
-        file.seekg(257);
-        std::array<char, 6> tar_header{};
-        file.read(tar_header.data(), tar_header.size());
-        if (file.gcount() >= 5 && std::string(tar_header.data(), 5) == "ustar") {
-            return FileType::ARCHIVE_TAR;
-        }
-
-        file.clear();
-        file.seekg(0);
-        std::array<char, 512> tar_block{};
-        file.read(tar_block.data(), tar_block.size());
-        if (file.gcount() >= 512) {
-            bool looks_like_tar = true;
-            bool has_filename = false;
-
-            for (int i = 0; i < 100; ++i) {
-                if (tar_block[i] != 0) {
-                    has_filename = true;
-                    if (tar_block[i] < 32 || tar_block[i] > 126) {
-                        looks_like_tar = false;
-                        break;
-                    }
-                }
-            }
-
-            if (looks_like_tar && has_filename) {
-                return FileType::ARCHIVE_TAR;
-            }
-        }
-
-        return FileType::UNKNOWN;
+        std::vector<char> head(HEADER_READ_SIZE);
+        file.read(head.data(), static_cast<std::streamsize>(head.size()));
+        head.resize(static_cast<size_t>(file.gcount()));
+        return recognize_header_bytes(head, [&file](char* out, size_t capacity) {
+            file.read(out, static_cast<std::streamsize>(capacity));
+            return static_cast<size_t>(file.gcount());
+        });
     }
 
     FileType recognize_source_type(const std::string& source_path_str) {
@@ -183,6 +299,25 @@ namespace file_type {
         return it != type_map.end() ? it->second : "Unknown";
     }
 
+    std::string get_format_name(FileType type) {
+        switch (type) {
+            case FileType::ARCHIVE_TAR: return "tar";
+            case FileType::ARCHIVE_TAR_GZ: return "tar.gz";
+            case FileType::ARCHIVE_TAR_BZ2: return "tar.bz2";
+            case FileType::ARCHIVE_TAR_XZ: return "tar.xz";
+            case FileType::ARCHIVE_TAR_ZSTD: return "tar.zst";
+            case FileType::ARCHIVE_ZIP: return "zip";
+            case FileType::ARCHIVE_RAR: return "rar";
+            case FileType::ARCHIVE_7Z: return "7z";
+            case FileType::ARCHIVE_LZ4: return "lz4";
+            case FileType::ARCHIVE_ZSTD: return "zstd";
+            case FileType::ARCHIVE_XAR: return "xar";
+            case FileType::REGULAR_FILE: return "file";
+            case FileType::DIRECTORY: return "directory";
+            default: return "unknown";
+        }
+    }
+
     FileType parse_format_string(const std::string& format_str) {
         std::string fmt = format_str;
         std::transform(fmt.begin(), fmt.end(), fmt.begin(), [](unsigned char c){ return std::tolower(c); });
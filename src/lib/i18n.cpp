@@ -14,6 +14,8 @@ namespace i18n {
         {"compression_ratio", "Compression ratio: {RATIO}% (saved {SAVED} bytes)"},
         {"operation_time", "Operation completed in {TIME} seconds"},
         {"threads_info", "Using {COUNT} threads for parallel processing"},
+        {"progress_line", "{PERCENT}% {DONE}/{TOTAL}  {RATE} MB/s  ratio {RATIO}  ETA {ETA}"},
+        {"benchmark_phase", "  {PHASE} ({BACKEND}): {TIME} s, {RATE} MB/s"},
         {"usage", "Usage: hitpag [options] [--] SOURCE_PATH TARGET_PATH"},
         {"help_options", "Options:"},
         {"help_i", "  -i              Interactive mode"},
@@ -23,9 +25,18 @@ namespace i18n {
         {"help_verbose", "  --verbose       Show detailed progress information"},
         {"help_exclude", "  --exclude=PATTERN  Exclude files/directories matching pattern"},
         {"help_include", "  --include=PATTERN  Include only files/directories matching pattern"},
-        {"help_benchmark", "  --benchmark     Show compression performance statistics"},
+        {"help_benchmark", "  --benchmark[=json]  Show performance statistics; =json prints per-phase timings and child rusage as one JSON line"},
+        {"help_progress", "  --progress[=json]  Show live bytes, MB/s, ratio and ETA on stderr; =json emits one JSON object per update"},
         {"help_verify", "  --verify        Verify archive integrity after compression"},
+        {"help_diff", "  --diff          Compare two archives by listing size, CRC and method (no extraction)"},
+        {"help_scan", "  --scan          Verify every archive under a directory in parallel and write a TSV report"},
+        {"help_incremental", "  --incremental   With --scan, skip archives whose size and mtime match an ok entry in the old report"},
+        {"help_identify", "  --identify[=json] Print the format of each file under the given paths (or listed on stdin) as TSV or JSON lines"},
         {"help_format", "  --format=TYPE   Force archive type (zip, 7z, tar.gz, tar.bz2, tar.xz, tar.zst, rar, lz4, zstd, xar)"},
+        {"help_trace", "  --trace FILE    Record a Chrome trace (chrome://tracing, Perfetto) of the run to FILE"},
+        {"help_serve", "  --serve SOCKET  Run a daemon on the Unix socket SOCKET that caches listings and entries for queries"},
+        {"help_query", "  --list A | --stat A E | --cat A E | --extract-entry A E DIR  Query an archive, through the daemon when one is running"},
+        {"help_socket", "  --socket=PATH   Daemon socket for queries (default: $HITPAG_SOCKET)"},
         {"help_h", "  -h, --help      Display help information"},
         {"help_v", "  -v, --version   Display version information"},
         {"help_examples", "Examples:"},
@@ -39,6 +50,11 @@ namespace i18n {
         {"help_example7", "  hitpag --verbose --benchmark ./files archive.7z # Verbose compression with benchmarking"},
         {"help_example8", "  hitpag --exclude='*.tmp' --include='*.cpp' src/ code.tar.gz # Filter files during compression"},
         {"help_example9", "  hitpag --tui archive.zip              # Open archive.zip in the TUI browser"},
+        {"help_example_diff", "  hitpag --diff v1.zip v2.zip           # List entries added (A), removed (D) or changed (M)"},
+        {"help_example_scan", "  hitpag --scan --incremental -t8 /backups scan.tsv # Audit all archives under /backups"},
+        {"help_example_identify", "  find /uploads -type f | hitpag --identify=json -t16 # Classify files by content"},
+        {"help_example_serve", "  hitpag --serve /tmp/hitpag.sock &     # Start the query daemon"},
+        {"help_example_query", "  HITPAG_SOCKET=/tmp/hitpag.sock hitpag --cat logs.tar app/today.log # Print one entry"},
         {"error_missing_args", "Error: Missing arguments. {ADDITIONAL_INFO}"},
         {"error_invalid_source", "Error: Source path '{PATH}' does not exist or is invalid. {REASON}"},
         {"error_invalid_target", "Error: Invalid target path '{PATH}'. {REASON}"},
@@ -80,9 +96,30 @@ namespace i18n {
         {"operation_complete", "Operation complete"},
         {"operation_canceled", "Operation canceled"},
         {"warning_tar_password", "Warning: Password protection is not supported for tar formats. The password will be ignored."},
+        {"warning_tar_file", "Warning: {PATH}: {REASON}"},
+        {"warning_tar_shrank", "Warning: {PATH}: file shrank by {BYTES} bytes while it was read; padded with zeros"},
+        {"warning_tar_socket", "Warning: {PATH}: socket ignored"},
+        {"simd_kernels", "CPU kernels: {KERNELS}"},
+        {"backend_info", "Using the {BACKEND} backend to {OPERATION}"},
+        {"ingest_engine", "Reading source files with the {ENGINE} engine"},
+        {"service_listening", "Serving archive queries on {PATH} with {COUNT} worker thread(s); press Ctrl+C to stop"},
+        {"service_stopped", "Query service stopped"},
+        {"service_already_running", "Another hitpag daemon is already serving on this socket."},
+        {"service_socket_path_invalid", "Socket paths must be non-empty and shorter than 108 bytes."},
+        {"service_unsupported", "Unix sockets are not supported on this platform"},
+        {"service_entry_not_found", "No such entry in the archive."},
+        {"service_entry_is_directory", "The entry is a directory."},
+        {"service_answered_remote", "Answered by the daemon on {PATH}"},
+        {"service_answered_local", "Answered in-process (no daemon running)"},
         {"info_split_zip_detected", "Split ZIP archive detected, using 7z for extraction."},
         {"error_split_zip_requires_7z", "Error: Split ZIP archives require '7z' (p7zip) for extraction. Please install p7zip-full."},
         {"error_split_zip_main_not_found", "Main ZIP file not found for split archive. Expected: {PATH}"},
+        {"diff_summary", "{ADDED} added, {REMOVED} removed, {CHANGED} changed, {UNCHANGED} unchanged"},
+        {"diff_used_hashes", "Some entries had no stored checksum; their contents were hashed to compare them."},
+        {"diff_list_command", "list {PATH}"},
+        {"diff_read_command", "read {ENTRY} from {PATH}"},
+        {"scan_summary", "{TOTAL} archives: {OK} ok, {FAILED} failed, {CACHED} unchanged since last scan, {MISSING} skipped (tool missing)"},
+        {"scan_failed", "{COUNT} archive(s) failed verification; see {PATH}"},
         {"filtering_files", "Filtering files: included {INCLUDED}, excluded {EXCLUDED}"},
         {"target_exists_header", "Target {OBJECT_TYPE} '{TARGET_PATH}' already exists."},
         {"target_exists_options", "Choose action: [O]verwrite / [C]ancel / [R]ename"},
@@ -120,7 +157,7 @@ namespace i18n {
         {"tui_back", "Back"},
         {"tui_quit", "Quit"},
         {"tui_help", "Help"},
-        {"tui_help_content", "Navigation: mouse click changes focus, mouse wheel scrolls list or preview | Tab switches focus between list and preview | List focus: Up/Down move, Left go to parent, Right opens a directory or moves to preview for files, Enter opens directories | Preview focus: Up/Down scroll, Left/Enter return to list, Right or PgDn page down, PgUp page up, Home/End jump | q quit | e edit current file | s editor settings | x extract current file | / search | ? help | Esc quit/close"},
+        {"tui_help_content", "Navigation: mouse click changes focus, mouse wheel scrolls list or preview | Tab switches focus between list and preview | List focus: Up/Down move, Left go to parent, Right opens a directory or moves to preview for files, Enter opens directories | Preview focus: Up/Down scroll, Left/Enter return to list, Right or PgDn page down, PgUp page up, Home/End jump | q quit | e edit current file | s editor settings | x extract current file | / search | p performance overlay | ? help | Esc quit/close"},
         {"tui_no_file_selected", "No file selected"},
         {"tui_preview_extract_failed", "Unable to extract this file for preview"},
         {"tui_preview_empty_file", "[Empty file]"},
@@ -150,7 +187,13 @@ namespace i18n {
         {"tui_format_label", "Format:"},
         {"tui_active_suffix", "[Active]"},
         {"tui_preview_shortcut_hint", "Preview: Up/Down scroll | Left/Enter back | Right/PgDn page down | PgUp page up | q quit | e edit | s settings | Esc quit"},
-        {"tui_list_shortcut_hint", "List: Up/Down move | Left parent | Right preview/open dir | Enter open dir | q quit | e edit | s settings | x extract | / search | ? help | Esc quit"},
+        {"tui_list_shortcut_hint", "List: Up/Down move | Left parent | Right preview/open dir | Enter open dir | q quit | e edit | s settings | x extract | / search | p perf | ? help | Esc quit"},
+        {"tui_perf_title", "Performance (p to close)"},
+        {"tui_perf_frame", "Frame: {LAST} ms, worst {WORST} ms of last {COUNT}"},
+        {"tui_perf_filter", "Filter: {TIME} ms, {VISIBLE} visible"},
+        {"tui_perf_preview", "Preview: spawn {SPAWN} ms, decode {DECODE} ms, wrap {WRAP} ms"},
+        {"tui_perf_listing", "Listing: {TIME} ms, {COUNT} entries, {SIZE} entry table"},
+        {"tui_perf_cache", "Cache hits: preview {PREVIEW}, wrap {WRAP}"},
         {"tui_settings_title", "Settings"},
         {"tui_settings_saved_title", "Settings Saved"},
         {"tui_settings_saved_message", "Editor command saved: {COMMAND}"},
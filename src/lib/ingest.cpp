@@ -0,0 +1,341 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "include/ingest.h"
+#include "include/trace.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define HITPAG_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+#endif
+
+namespace ingest {
+    namespace {
+        constexpr size_t kStreamBuffer = 256 * 1024;
+
+        // Streams [offset, limit) of fd to the sink, stopping quietly at end of file.
+        bool pump(int fd, size_t index, uint64_t offset, uint64_t limit, std::vector<char>& buffer, const Sink& sink, int& error) {
+            while (offset < limit) {
+                size_t want = static_cast<size_t>(std::min<uint64_t>(buffer.size(), limit - offset));
+                ssize_t got = ::pread(fd, buffer.data(), want, static_cast<off_t>(offset));
+                if (got < 0) {
+                    if (errno == EINTR) continue;
+                    error = errno;
+                    return true;
+                }
+                if (got == 0) return true;
+                offset += static_cast<uint64_t>(got);
+                if (!sink.data(index, buffer.data(), static_cast<size_t>(got))) return false;
+            }
+            return true;
+        }
+
+        bool read_sync(const std::vector<File>& files, const Sink& sink) {
+            std::vector<char> buffer(kStreamBuffer);
+            for (size_t i = 0; i < files.size(); ++i) {
+                int error = 0;
+                int fd = ::open(files[i].path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) {
+                    error = errno;
+                } else {
+                    bool go_on = pump(fd, i, 0, files[i].size, buffer, sink, error);
+                    ::close(fd);
+                    if (!go_on) return false;
+                }
+                if (!sink.done(i, error)) return false;
+            }
+            return true;
+        }
+
+#ifdef HITPAG_IO_URING
+        // Just enough of liburing: the two mapped rings, SQE allocation, submission and reaping.
+        class Ring {
+        public:
+            Ring() = default;
+            Ring(const Ring&) = delete;
+            Ring& operator=(const Ring&) = delete;
+
+            ~Ring() {
+                if (sqes_ != MAP_FAILED) ::munmap(sqes_, sqes_size_);
+                if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) ::munmap(cq_ring_, cq_ring_size_);
+                if (sq_ring_ != MAP_FAILED) ::munmap(sq_ring_, sq_ring_size_);
+                if (fd_ >= 0) ::close(fd_);
+            }
+
+            bool init(unsigned entries) {
+                io_uring_params params{};
+                fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+                if (fd_ < 0) return false;
+
+                sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                if (single_mmap) sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+                sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+                if (sq_ring_ == MAP_FAILED) return false;
+                cq_ring_ = single_mmap ? sq_ring_
+                                       : ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+                if (cq_ring_ == MAP_FAILED) return false;
+                sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+                sqes_ = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+                if (sqes_ == MAP_FAILED) return false;
+
+                auto* sq = static_cast<char*>(sq_ring_);
+                auto* cq = static_cast<char*>(cq_ring_);
+                sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+                sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+                sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+                sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+                sq_entries_ = params.sq_entries;
+                cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+                cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+                cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+                cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+                tail_ = *sq_tail_;
+                return true;
+            }
+
+            bool supports(std::initializer_list<int> opcodes) const {
+                constexpr unsigned kProbeOps = 256;
+                std::vector<unsigned char> storage(sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op));
+                auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+                if (::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, kProbeOps) < 0) return false;
+                for (int opcode : opcodes) {
+                    if (opcode > probe->last_op || !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED)) return false;
+                }
+                return true;
+            }
+
+            // Fails when RLIMIT_MEMLOCK cannot cover the buffer; plain reads still work then.
+            bool register_buffer(void* base, size_t size) {
+                iovec buffer{base, size};
+                return ::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS, &buffer, 1) == 0;
+            }
+
+            // Submits what is queued first when the submission ring is full.
+            io_uring_sqe* acquire() {
+                if (tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_ && submit(0) < 0) return nullptr;
+                if (tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) return nullptr;
+                unsigned slot = tail_ & sq_mask_;
+                io_uring_sqe* sqe = &static_cast<io_uring_sqe*>(sqes_)[slot];
+                std::memset(sqe, 0, sizeof(*sqe));
+                sq_array_[slot] = slot;
+                ++tail_;
+                return sqe;
+            }
+
+            // Negative errno on failure; interrupted waits count as success.
+            int submit(unsigned wait) {
+                __atomic_store_n(sq_tail_, tail_, __ATOMIC_RELEASE);
+                unsigned pending = tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+                long result = ::syscall(__NR_io_uring_enter, fd_, pending, wait, wait ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+                if (result < 0) return errno == EINTR || errno == EAGAIN || errno == EBUSY ? 0 : -errno;
+                return 0;
+            }
+
+            template <typename Visit>
+            void reap(Visit&& visit) {
+                unsigned head = *cq_head_;
+                unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+                for (; head != tail; ++head) visit(cqes_[head & cq_mask_]);
+                __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+            }
+
+        private:
+            int fd_ = -1;
+            void* sq_ring_ = MAP_FAILED;
+            void* cq_ring_ = MAP_FAILED;
+            void* sqes_ = MAP_FAILED;
+            size_t sq_ring_size_ = 0;
+            size_t cq_ring_size_ = 0;
+            size_t sqes_size_ = 0;
+            unsigned* sq_head_ = nullptr;
+            unsigned* sq_tail_ = nullptr;
+            unsigned* sq_array_ = nullptr;
+            unsigned sq_mask_ = 0;
+            unsigned sq_entries_ = 0;
+            unsigned* cq_head_ = nullptr;
+            unsigned* cq_tail_ = nullptr;
+            unsigned cq_mask_ = 0;
+            io_uring_cqe* cqes_ = nullptr;
+            unsigned tail_ = 0;
+        };
+
+        enum Op : uint64_t { kOpen = 0, kRead = 1, kClose = 2 };
+
+        uint64_t tag(size_t index, Op op) { return (static_cast<uint64_t>(index) << 2) | op; }
+
+        struct Slot {
+            int fd = -1;
+            int error = 0;
+            size_t got = 0;
+            bool read_ahead = false;
+            bool ready = false;
+        };
+
+        // Files [head, next) own slot index % kQueueDepth. Opens are queued as slots free up,
+        // each completed open queues the read of its first kSlotSize bytes, and the head file is
+        // handed to the sink once its read lands; its descriptor is then closed through the ring.
+        bool read_uring(const std::vector<File>& files, const Sink& sink) {
+            Ring ring;
+            if (!ring.init(static_cast<unsigned>(kQueueDepth * 4))) return read_sync(files, sink);
+            std::vector<char> arena(kQueueDepth * kSlotSize);
+            bool fixed = ring.register_buffer(arena.data(), arena.size());
+            std::vector<Slot> slots(kQueueDepth);
+            std::vector<char> buffer(kStreamBuffer);
+
+            size_t head = 0;
+            size_t next = 0;
+            size_t in_flight = 0;
+            bool ok = true;
+
+            while (ok && head < files.size()) {
+                while (ok && next < files.size() && next - head < kQueueDepth) {
+                    slots[next % kQueueDepth] = Slot{};
+                    io_uring_sqe* sqe = ring.acquire();
+                    if (!sqe) {
+                        ok = false;
+                        break;
+                    }
+                    sqe->opcode = IORING_OP_OPENAT;
+                    sqe->fd = AT_FDCWD;
+                    sqe->addr = reinterpret_cast<uint64_t>(files[next].path.c_str());
+                    sqe->open_flags = O_RDONLY | O_CLOEXEC;
+                    sqe->user_data = tag(next, kOpen);
+                    ++in_flight;
+                    ++next;
+                }
+                if (!ok) break;
+
+                if (!slots[head % kQueueDepth].ready && ring.submit(1) < 0) {
+                    ok = false;
+                    break;
+                }
+                ring.reap([&](const io_uring_cqe& cqe) {
+                    --in_flight;
+                    size_t index = static_cast<size_t>(cqe.user_data >> 2);
+                    Op op = static_cast<Op>(cqe.user_data & 3);
+                    if (op == kClose) return;
+                    Slot& slot = slots[index % kQueueDepth];
+                    if (cqe.res < 0) {
+                        slot.error = -cqe.res;
+                        slot.ready = true;
+                        return;
+                    }
+                    if (op == kRead) {
+                        slot.got = static_cast<size_t>(cqe.res);
+                        slot.ready = true;
+                        return;
+                    }
+                    slot.fd = cqe.res;
+                    size_t want = static_cast<size_t>(std::min<uint64_t>(files[index].size, kSlotSize));
+                    io_uring_sqe* sqe = want > 0 ? ring.acquire() : nullptr;
+                    if (!sqe) {
+                        // Empty files need no read; a full ring leaves the read to delivery.
+                        slot.ready = true;
+                        return;
+                    }
+                    sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+                    sqe->fd = slot.fd;
+                    sqe->addr = reinterpret_cast<uint64_t>(arena.data() + (index % kQueueDepth) * kSlotSize);
+                    sqe->len = static_cast<uint32_t>(want);
+                    sqe->off = 0;
+                    sqe->buf_index = 0;
+                    sqe->user_data = tag(index, kRead);
+                    slot.read_ahead = true;
+                    ++in_flight;
+                });
+
+                while (head < next && slots[head % kQueueDepth].ready) {
+                    Slot& slot = slots[head % kQueueDepth];
+                    int error = slot.error;
+                    bool go_on = slot.got == 0 || sink.data(head, arena.data() + (head % kQueueDepth) * kSlotSize, slot.got);
+                    // Whatever the read-ahead did not cover: the tail of a large file, or all of
+                    // a file whose read could not be queued. A short read-ahead means end of file.
+                    if (go_on && error == 0 && slot.fd >= 0 && (!slot.read_ahead || slot.got == kSlotSize)) {
+                        go_on = pump(slot.fd, head, slot.got, files[head].size, buffer, sink, error);
+                    }
+                    if (slot.fd >= 0) {
+                        io_uring_sqe* sqe = ring.acquire();
+                        if (sqe) {
+                            sqe->opcode = IORING_OP_CLOSE;
+                            sqe->fd = slot.fd;
+                            sqe->user_data = tag(head, kClose);
+                            ++in_flight;
+                        } else {
+                            ::close(slot.fd);
+                        }
+                        slot.fd = -1;
+                    }
+                    if (go_on) go_on = sink.done(head, error);
+                    ++head;
+                    if (!go_on) {
+                        ok = false;
+                        break;
+                    }
+                }
+            }
+
+            // Let every outstanding operation finish so no descriptor outlives the ring.
+            while (in_flight > 0) {
+                if (ring.submit(1) < 0) break;
+                ring.reap([&](const io_uring_cqe& cqe) {
+                    --in_flight;
+                    if ((cqe.user_data & 3) == kOpen && cqe.res >= 0) ::close(cqe.res);
+                });
+            }
+            for (size_t i = head; i < next; ++i) {
+                if (slots[i % kQueueDepth].fd >= 0) ::close(slots[i % kQueueDepth].fd);
+            }
+            return ok;
+        }
+#endif
+    }
+
+    Engine engine() {
+        static const Engine chosen = [] {
+            const char* forced = std::getenv("HITPAG_IO");
+            if (forced && std::string(forced) == "sync") return Engine::Sync;
+#ifdef HITPAG_IO_URING
+            Ring ring;
+            if (ring.init(8) && ring.supports({IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_READ_FIXED, IORING_OP_CLOSE})) {
+                return Engine::Uring;
+            }
+#endif
+            return Engine::Sync;
+        }();
+        return chosen;
+    }
+
+    const char* engine_name(Engine engine) {
+        return engine == Engine::Uring ? "io_uring" : "sync";
+    }
+
+    bool read_files(const std::vector<File>& files, const Sink& sink, Engine engine) {
+        trace::Span span("read_files", "ingest");
+        span.arg("files", static_cast<int64_t>(files.size()));
+        span.arg("engine", engine_name(engine));
+#ifdef HITPAG_IO_URING
+        if (engine == Engine::Uring && ingest::engine() == Engine::Uring) return read_uring(files, sink);
+#endif
+        (void)engine;
+        return read_sync(files, sink);
+    }
+}
@@ -5,20 +5,26 @@
 // (at your option) any later version.
 
 #include "include/operation.h"
+#include "include/archive_backend.h"
 #include "include/error.h"
 #include "include/i18n.h"
+#include "include/trace.h"
 
 #include <filesystem>
 #include <iostream>
 #include <string_view>
 #include <algorithm>
 #include <cctype>
+#include <chrono>
+#include <map>
+#include <mutex>
 
 #ifdef _WIN32
 #include <windows.h>
 #include <process.h>
 #else
 #include <cstdio>
+#include <fcntl.h>
 #include <unistd.h>
 #include <sys/wait.h>
 #endif
@@ -27,12 +33,25 @@ namespace fs = std::filesystem;
 
 namespace operation {
     bool is_tool_available(std::string_view tool) {
+        // Probing spawns a shell, so remember the answer for the life of the process.
+        static std::mutex cache_mutex;
+        static std::map<std::string, bool, std::less<>> cache;
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            auto it = cache.find(tool);
+            if (it != cache.end()) return it->second;
+        }
+
 #ifdef _WIN32
         std::string command = "where " + std::string(tool) + " > nul 2>&1";
 #else
         std::string command = "command -v " + std::string(tool) + " > /dev/null 2>&1";
 #endif
-        return system(command.c_str()) == 0;
+        bool available = system(command.c_str()) == 0;
+
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        cache.emplace(std::string(tool), available);
+        return available;
     }
 
     bool is_split_zip_part(const std::string& path) {
@@ -65,19 +84,6 @@ namespace operation {
         return fs::exists(z01_path);
     }
 
-    void build_7z_extract_args(std::vector<std::string>& args,
-                               const std::string& source_path,
-                               const std::string& target_dir_path,
-                               const std::string& password) {
-        args.push_back("x");
-        if (!password.empty()) {
-            args.push_back("-p" + password);
-        }
-        args.push_back(fs::absolute(source_path).string());
-        args.push_back("-o" + fs::absolute(target_dir_path).string());
-        args.push_back("-y");
-    }
-
 #ifdef _WIN32
     std::string quote_argument_for_windows(const std::string& arg) {
         if (arg.empty()) return "\"\"";
@@ -105,10 +111,18 @@ namespace operation {
     }
 #endif
 
-    int execute_command(const std::string& tool, const std::vector<std::string>& args, const std::string& working_dir = "") {
+    int execute_command(const std::string& tool, const std::vector<std::string>& args, const std::string& working_dir = "",
+                        progress::LiveProgress* live = nullptr, bool quiet = false) {
         std::string full_command = tool;
         for (const auto& arg : args) full_command += " " + arg;
 
+        trace::Span span("spawn", "process");
+        if (span.active()) {
+            std::vector<std::string> argv{tool};
+            argv.insert(argv.end(), args.begin(), args.end());
+            span.arg("argv", trace::redacted_command(argv));
+        }
+
 #ifdef _WIN32
         PROCESS_INFORMATION piProcInfo;
         STARTUPINFOA siStartInfo;
@@ -141,12 +155,21 @@ namespace operation {
         CloseHandle(piProcInfo.hProcess);
         CloseHandle(piProcInfo.hThread);
 #else
+        auto started = std::chrono::steady_clock::now();
         pid_t pid = fork();
         if (pid == -1) {
             error::throw_error(error::ErrorCode::OPERATION_FAILED, {{"COMMAND", full_command}, {"EXIT_CODE", "fork_failed"}});
         }
 
         if (pid == 0) {
+            if (quiet) {
+                int devnull = open("/dev/null", O_WRONLY);
+                if (devnull >= 0) {
+                    dup2(devnull, STDOUT_FILENO);
+                    dup2(devnull, STDERR_FILENO);
+                    close(devnull);
+                }
+            }
             if (!working_dir.empty()) {
                 if (chdir(working_dir.c_str()) != 0) {
                     perror("chdir failed in child");
@@ -164,63 +187,65 @@ namespace operation {
             _exit(127);
         }
 
-        int status;
-        waitpid(pid, &status, 0);
-        int exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        if (live) live->watch_process(pid);
+        int status = progress::wait_for_child(pid, tool, started);
+        if (live) live->unwatch_process();
+        int exit_code = status != -1 && WIFEXITED(status) ? WEXITSTATUS(status) : -1;
 #endif
-        if (exit_code != 0) {
+        span.arg("exit_code", static_cast<int64_t>(exit_code));
+        if (exit_code != 0 && !quiet) {
             std::cerr << std::endl;
         }
         return exit_code;
     }
 
-    bool verify_archive(const std::string& archive_path, file_type::FileType format) {
-        std::string tool;
-        std::vector<std::string> args;
-
-        switch (format) {
-            case file_type::FileType::ARCHIVE_TAR:
-            case file_type::FileType::ARCHIVE_TAR_GZ:
-            case file_type::FileType::ARCHIVE_TAR_BZ2:
-            case file_type::FileType::ARCHIVE_TAR_XZ:
-            case file_type::FileType::ARCHIVE_TAR_ZSTD:
-                tool = "tar";
-                args = {"-tf", archive_path};
-                break;
-            case file_type::FileType::ARCHIVE_ZIP:
-                tool = "unzip";
-                args = {"-t", archive_path};
-                break;
-            case file_type::FileType::ARCHIVE_7Z:
-                tool = "7z";
-                args = {"t", archive_path};
-                break;
-            case file_type::FileType::ARCHIVE_RAR:
-                tool = "unrar";
-                args = {"t", archive_path};
-                break;
-            case file_type::FileType::ARCHIVE_LZ4:
-                tool = "lz4";
-                args = {"-t", archive_path};
-                break;
-            case file_type::FileType::ARCHIVE_ZSTD:
-                tool = "zstd";
-                args = {"-t", archive_path};
-                break;
-            case file_type::FileType::ARCHIVE_XAR:
-                tool = "xar";
-                args = {"-tf", archive_path};
-                break;
-            default:
-                return true;
-        }
-
-        if (!is_tool_available(tool)) return false;
-        int result = execute_command(tool, args);
-        return result == 0;
+    bool verify_archive(const std::string& archive_path, file_type::FileType format, bool quiet) {
+        backend::Registry& backends = backend::registry();
+        if (!backends.declares(backend::Operation::Verify, format)) return true;
+
+        backend::Archive archive{archive_path, format, ""};
+        backend::ArchiveBackend* verifier = backends.select(backend::Operation::Verify, archive);
+        if (!verifier) return false;
+        backend::JobContext context;
+        context.run_tool = [quiet](const std::string& tool, const std::vector<std::string>& args, const std::string& working_dir) {
+            return execute_command(tool, args, working_dir, nullptr, quiet);
+        };
+        return backends.timed(*verifier, backend::Operation::Verify, archive, [&]() { return verifier->verify(archive, context); }) == 0;
     }
 
     namespace {
+        progress::LiveProgress::Mode live_progress_mode(const args::Options& options) {
+            if (options.progress_callback) return progress::LiveProgress::Mode::Callback;
+            if (!options.progress) return progress::LiveProgress::Mode::Off;
+            return options.progress_json ? progress::LiveProgress::Mode::Json : progress::LiveProgress::Mode::Line;
+        }
+
+        void report(const args::Options& options, const std::string& message) {
+            if (!options.quiet) std::cout << message << std::endl;
+        }
+
+        backend::JobContext job_context(const args::Options& options, progress::LiveProgress& live) {
+            backend::JobContext context;
+            context.run_tool = [&options, &live](const std::string& tool, const std::vector<std::string>& args, const std::string& working_dir) {
+                return execute_command(tool, args, working_dir, &live, options.quiet);
+            };
+            context.report = [&options](const std::string& message) { report(options, message); };
+            context.advance = [&live](uint64_t in, uint64_t out) {
+                live.add_input(in);
+                live.add_output(out);
+            };
+            context.verbose = options.verbose;
+            context.compression_level = options.compression_level;
+            context.thread_count = options.thread_count;
+            return context;
+        }
+
+        void report_backend(const args::Options& options, backend::Operation op, const backend::ArchiveBackend& chosen) {
+            if (options.verbose) {
+                report(options, i18n::get("backend_info", {{"BACKEND", chosen.name()}, {"OPERATION", backend::operation_name(op)}}));
+            }
+        }
+
         bool is_descendant_or_same(const fs::path& base, const fs::path& target) {
             std::error_code ec;
             fs::path relative = fs::relative(target, base, ec);
@@ -294,14 +319,20 @@ namespace operation {
         std::vector<std::string> items_to_archive;
         items_to_archive.reserve(sources.size());
 
+        uint64_t original_size = 0;
         if (options.benchmark) {
             tracker.start_operation();
-            tracker.set_original_size(calculate_sources_size(canonical_sources, tracker));
+            tracker.begin_phase("scan", "filesystem");
+            original_size = calculate_sources_size(canonical_sources, tracker);
+            tracker.end_phase(original_size, 0);
+            tracker.set_original_size(original_size);
             tracker.set_thread_count(options.thread_count > 0 ? options.thread_count : 1);
+        } else if (options.progress || options.progress_callback) {
+            original_size = calculate_sources_size(canonical_sources, tracker);
         }
 
         if (options.verbose && options.thread_count > 1) {
-            std::cout << i18n::get("threads_info", {{"COUNT", std::to_string(options.thread_count)}}) << std::endl;
+            report(options, i18n::get("threads_info", {{"COUNT", std::to_string(options.thread_count)}}));
         }
 
         if (single_contents_mode) {
@@ -315,132 +346,78 @@ namespace operation {
                 fs::path relative = fs::relative(canonical, base_dir, ec);
                 if (ec || relative.empty() || relative == ".") {
                     fs::path fallback = canonical.filename();
-                    if (fallback.empty()) fallback = canonical;
+                    // Only the filesystem root has no name, and it is then the base directory itself.
+                    if (fallback.empty()) fallback = ".";
                     relative = fallback;
                 }
                 items_to_archive.push_back(relative.string());
             }
         }
 
-        std::string tool;
-        std::vector<std::string> args;
         std::string working_dir_for_cmd = base_dir.empty() ? "" : base_dir.string();
         if (working_dir_for_cmd.empty()) {
             working_dir_for_cmd = fs::current_path().string();
         }
 
-        switch (target_format) {
-            case file_type::FileType::ARCHIVE_TAR:
-            case file_type::FileType::ARCHIVE_TAR_GZ:
-            case file_type::FileType::ARCHIVE_TAR_BZ2:
-            case file_type::FileType::ARCHIVE_TAR_XZ:
-            case file_type::FileType::ARCHIVE_TAR_ZSTD:
-                if (!password.empty()) std::cout << i18n::get("warning_tar_password") << std::endl;
-                tool = "tar";
-                if (!is_tool_available(tool)) error::throw_error(error::ErrorCode::TOOL_NOT_FOUND, {{"TOOL_NAME", tool}});
-                {
-                    if (target_format == file_type::FileType::ARCHIVE_TAR_ZSTD) {
-                        args = {"--zstd", "-cf", fs::absolute(target_path_str).string()};
-                    } else {
-                        std::string flags;
-                        if (target_format == file_type::FileType::ARCHIVE_TAR) flags = "-cf";
-                        if (target_format == file_type::FileType::ARCHIVE_TAR_GZ) flags = "-czf";
-                        if (target_format == file_type::FileType::ARCHIVE_TAR_BZ2) flags = "-cjf";
-                        if (target_format == file_type::FileType::ARCHIVE_TAR_XZ) flags = "-cJf";
-                        args = {flags, fs::absolute(target_path_str).string()};
-                    }
-                    args.insert(args.end(), items_to_archive.begin(), items_to_archive.end());
-                }
-                break;
-            case file_type::FileType::ARCHIVE_ZIP:
-                tool = "zip";
-                if (!is_tool_available(tool)) error::throw_error(error::ErrorCode::TOOL_NOT_FOUND, {{"TOOL_NAME", tool}});
-                if (!password.empty()) args.insert(args.end(), {"-P", password});
-                if (options.compression_level > 0) {
-                    args.push_back("-" + std::to_string(options.compression_level));
-                }
-                args.push_back("-r");
-                args.push_back(fs::absolute(target_path_str).string());
-                args.insert(args.end(), items_to_archive.begin(), items_to_archive.end());
-                break;
-            case file_type::FileType::ARCHIVE_7Z:
-                tool = "7z";
-                if (!is_tool_available(tool)) error::throw_error(error::ErrorCode::TOOL_NOT_FOUND, {{"TOOL_NAME", tool}});
-                args.push_back("a");
-                if (!password.empty()) args.push_back("-p" + password);
-                if (options.compression_level > 0) {
-                    args.push_back("-mx=" + std::to_string(options.compression_level));
-                }
-                args.push_back(fs::absolute(target_path_str).string());
-                args.insert(args.end(), items_to_archive.begin(), items_to_archive.end());
-                break;
-            case file_type::FileType::ARCHIVE_LZ4:
-                tool = "lz4";
-                if (!is_tool_available(tool)) error::throw_error(error::ErrorCode::TOOL_NOT_FOUND, {{"TOOL_NAME", tool}});
-                if (options.compression_level > 0) {
-                    args.push_back("-" + std::to_string(options.compression_level));
-                }
-                if (items_to_archive.size() != 1) {
-                    error::throw_error(error::ErrorCode::UNKNOWN_FORMAT, {{"INFO", "Multiple sources are not supported for lz4 compression."}});
-                }
-                if (fs::is_directory(canonical_sources.front())) {
-                    error::throw_error(error::ErrorCode::UNKNOWN_FORMAT, {{"INFO", "lz4 does not support directory compression. Use tar.lz4 instead."}});
-                }
-                args.push_back(fs::absolute(canonical_sources.front()).string());
-                args.push_back(fs::absolute(target_path_str).string());
-                break;
-            case file_type::FileType::ARCHIVE_ZSTD:
-                tool = "zstd";
-                if (!is_tool_available(tool)) error::throw_error(error::ErrorCode::TOOL_NOT_FOUND, {{"TOOL_NAME", tool}});
-                if (options.compression_level > 0) {
-                    args.push_back("-" + std::to_string(options.compression_level));
-                }
-                if (items_to_archive.size() != 1) {
-                    error::throw_error(error::ErrorCode::UNKNOWN_FORMAT, {{"INFO", "Multiple sources are not supported for zstd compression."}});
-                }
-                if (fs::is_directory(canonical_sources.front())) {
-                    error::throw_error(error::ErrorCode::UNKNOWN_FORMAT, {{"INFO", "zstd does not support directory compression. Use tar.zst instead."}});
-                }
-                args.push_back(fs::absolute(canonical_sources.front()).string());
-                args.push_back("-o");
-                args.push_back(fs::absolute(target_path_str).string());
-                break;
-            case file_type::FileType::ARCHIVE_XAR:
-                tool = "xar";
-                if (!is_tool_available(tool)) error::throw_error(error::ErrorCode::TOOL_NOT_FOUND, {{"TOOL_NAME", tool}});
-                args.push_back("-cf");
-                args.push_back(fs::absolute(target_path_str).string());
-                args.insert(args.end(), items_to_archive.begin(), items_to_archive.end());
-                break;
-            default:
-                error::throw_error(error::ErrorCode::UNKNOWN_FORMAT, {{"INFO", "Unsupported target format for compression."}});
-        }
-
-        std::cout << i18n::get("compressing") << std::endl;
-        int result = execute_command(tool, args, working_dir_for_cmd);
+        backend::Archive target{target_path_str, target_format, password};
+        backend::ArchiveBackend& creator = backend::registry().require(backend::Operation::Create, target);
+        const std::string tool = creator.name();
+        report_backend(options, backend::Operation::Create, creator);
+
+        backend::CreateJob job;
+        job.target = target_path_str;
+        job.working_dir = working_dir_for_cmd;
+        job.items = items_to_archive;
+        for (const auto& canonical : canonical_sources) job.sources.push_back(canonical.string());
+
+        report(options, i18n::get("compressing"));
+        if (options.benchmark) tracker.begin_phase("compress", tool);
+        progress::LiveProgress live(live_progress_mode(options), "compress", true, original_size,
+                                     std::chrono::milliseconds(500), options.progress_callback);
+        // Single-file tools read one input we can follow by position; tree archivers fall back to read counters.
+        bool single_input = target_format == file_type::FileType::ARCHIVE_LZ4 || target_format == file_type::FileType::ARCHIVE_ZSTD;
+        live.set_watch_paths(single_input ? canonical_sources.front().string() : "", fs::absolute(target_path_str).string());
+        backend::JobContext context = job_context(options, live);
+        int result = backend::registry().timed(creator, backend::Operation::Create, target,
+            [&]() { return creator.create(target, job, context); });
         if (result != 0) {
+            live.finish();
             error::throw_error(error::ErrorCode::OPERATION_FAILED, {{"COMMAND", tool}, {"EXIT_CODE", std::to_string(result)}});
         }
+        if (live.enabled()) {
+            std::error_code size_ec;
+            uint64_t final_size = fs::file_size(target_path_str, size_ec);
+            live.finish(original_size, size_ec ? 0 : final_size);
+        }
 
+        uint64_t archive_size = 0;
         if (options.benchmark) {
             tracker.end_operation();
             std::error_code ec;
             if (fs::exists(target_path_str)) {
                 auto size = fs::file_size(target_path_str, ec);
-                if (!ec) tracker.set_compressed_size(size);
+                if (!ec) archive_size = size;
             }
+            tracker.end_phase(original_size, archive_size);
+            tracker.set_compressed_size(archive_size);
         }
 
         if (options.verify) {
-            std::cout << i18n::get("verifying") << std::endl;
-            if (verify_archive(target_path_str, target_format)) {
-                std::cout << i18n::get("verification_success") << std::endl;
+            report(options, i18n::get("verifying"));
+            if (options.benchmark) {
+                backend::ArchiveBackend* verifier = backend::registry().select(backend::Operation::Verify, {target_path_str, target_format, ""});
+                tracker.begin_phase("verify", verifier ? verifier->name() : "none");
+            }
+            bool verified = verify_archive(target_path_str, target_format, options.quiet);
+            if (options.benchmark) tracker.end_phase(archive_size, 0);
+            if (verified) {
+                report(options, i18n::get("verification_success"));
             } else {
-                std::cout << i18n::get("verification_failed") << std::endl;
+                report(options, i18n::get("verification_failed"));
             }
         }
 
-        std::cout << i18n::get("operation_complete") << std::endl;
+        report(options, i18n::get("operation_complete"));
 
         if (options.benchmark || options.verbose) {
             tracker.print_stats(options.verbose, options.benchmark);
@@ -463,117 +440,58 @@ namespace operation {
             catch (const fs::filesystem_error& e) { error::throw_error(error::ErrorCode::INVALID_TARGET, {{"PATH", target_dir_path}, {"REASON", e.what()}}); }
         }
 
-        std::string tool;
-        std::vector<std::string> args;
-
-        switch (source_type) {
-            case file_type::FileType::ARCHIVE_TAR:
-            case file_type::FileType::ARCHIVE_TAR_GZ:
-            case file_type::FileType::ARCHIVE_TAR_BZ2:
-            case file_type::FileType::ARCHIVE_TAR_XZ:
-            case file_type::FileType::ARCHIVE_TAR_ZSTD:
-                if (!password.empty()) std::cout << i18n::get("warning_tar_password") << std::endl;
-                tool = "tar";
-                if (!is_tool_available(tool)) error::throw_error(error::ErrorCode::TOOL_NOT_FOUND, {{"TOOL_NAME", tool}});
-                {
-                    if (source_type == file_type::FileType::ARCHIVE_TAR_ZSTD) {
-                        args = {"-xf", fs::absolute(source_path).string(), "-C", fs::absolute(target_dir_path).string()};
-                    } else {
-                        std::string flags;
-                        if (source_type == file_type::FileType::ARCHIVE_TAR) flags = "-xf";
-                        if (source_type == file_type::FileType::ARCHIVE_TAR_GZ) flags = "-xzf";
-                        if (source_type == file_type::FileType::ARCHIVE_TAR_BZ2) flags = "-xjf";
-                        if (source_type == file_type::FileType::ARCHIVE_TAR_XZ) flags = "-xJf";
-                        args = {flags, fs::absolute(source_path).string(), "-C", fs::absolute(target_dir_path).string()};
-                    }
-                }
-                break;
-            case file_type::FileType::ARCHIVE_ZIP:
-                if (is_split_zip(source_path)) {
-                    tool = "7z";
-                    if (!is_tool_available(tool)) {
-                        throw error::HitpagException(error::ErrorCode::TOOL_NOT_FOUND,
-                            i18n::get("error_split_zip_requires_7z"));
-                    }
-                    std::string actual_source = source_path;
-                    if (is_split_zip_part(source_path)) {
-                        actual_source = find_split_zip_main(source_path);
-                        if (actual_source.empty()) {
-                            error::throw_error(error::ErrorCode::INVALID_SOURCE,
-                                {{"PATH", fs::path(source_path).replace_extension(".zip").string()},
-                                 {"REASON", i18n::get("error_split_zip_main_not_found",
-                                     {{"PATH", fs::path(source_path).replace_extension(".zip").string()}})}});
-                        }
-                    }
-                    if (options.verbose) {
-                        std::cout << i18n::get("info_split_zip_detected") << std::endl;
-                    }
-                    build_7z_extract_args(args, actual_source, target_dir_path, password);
-                } else {
-                    tool = "unzip";
-                    if (!is_tool_available(tool)) error::throw_error(error::ErrorCode::TOOL_NOT_FOUND, {{"TOOL_NAME", tool}});
-                    if (!password.empty()) args.insert(args.end(), {"-P", password});
-                    args.insert(args.end(), {"-o", fs::absolute(source_path).string(), "-d", fs::absolute(target_dir_path).string()});
-                }
-                break;
-            case file_type::FileType::ARCHIVE_RAR:
-                tool = "unrar";
-                if (!is_tool_available(tool)) error::throw_error(error::ErrorCode::TOOL_NOT_FOUND, {{"TOOL_NAME", "unrar"}});
-                args.push_back("x");
-                if (!password.empty()) args.push_back("-p" + password);
-                args.insert(args.end(), {"-o+", fs::absolute(source_path).string(), fs::absolute(target_dir_path).string()});
-                break;
-            case file_type::FileType::ARCHIVE_7Z:
-                tool = "7z";
-                if (!is_tool_available(tool)) error::throw_error(error::ErrorCode::TOOL_NOT_FOUND, {{"TOOL_NAME", tool}});
-                build_7z_extract_args(args, source_path, target_dir_path, password);
-                break;
-            case file_type::FileType::ARCHIVE_LZ4:
-                tool = "lz4";
-                if (!is_tool_available(tool)) error::throw_error(error::ErrorCode::TOOL_NOT_FOUND, {{"TOOL_NAME", tool}});
-                args.push_back("-d");
-                args.push_back("-f");
-                args.push_back(fs::absolute(source_path).string());
-                {
-                    fs::path src_p(source_path);
-                    std::string out_name = src_p.stem().string();
-                    fs::path out_path = fs::path(target_dir_path) / out_name;
-                    fs::create_directories(out_path.parent_path());
-                    args.push_back(fs::absolute(out_path).string());
-                }
-                break;
-            case file_type::FileType::ARCHIVE_ZSTD:
-                tool = "zstd";
-                if (!is_tool_available(tool)) error::throw_error(error::ErrorCode::TOOL_NOT_FOUND, {{"TOOL_NAME", tool}});
-                args.push_back("-d");
-                args.push_back("-f");
-                args.push_back(fs::absolute(source_path).string());
-                {
-                    fs::path src_p(source_path);
-                    std::string out_name = src_p.stem().string();
-                    fs::path out_path = fs::path(target_dir_path) / out_name;
-                    fs::create_directories(out_path.parent_path());
-                    args.push_back("-o");
-                    args.push_back(fs::absolute(out_path).string());
-                }
-                break;
-            case file_type::FileType::ARCHIVE_XAR:
-                tool = "xar";
-                if (!is_tool_available(tool)) error::throw_error(error::ErrorCode::TOOL_NOT_FOUND, {{"TOOL_NAME", tool}});
-                args.push_back("-xf");
-                args.push_back(fs::absolute(source_path).string());
-                args.push_back("-C");
-                args.push_back(fs::absolute(target_dir_path).string());
-                break;
-            default:
-                error::throw_error(error::ErrorCode::UNKNOWN_FORMAT, {{"INFO", "Unsupported source format for decompression."}});
+        backend::Archive source{source_path, source_type, password};
+        if (source_type == file_type::FileType::ARCHIVE_ZIP && is_split_zip(source_path) &&
+            !backend::registry().select(backend::Operation::Extract, source)) {
+            throw error::HitpagException(error::ErrorCode::TOOL_NOT_FOUND, i18n::get("error_split_zip_requires_7z"));
+        }
+        backend::ArchiveBackend& extractor = backend::registry().require(backend::Operation::Extract, source);
+        const std::string tool = extractor.name();
+        report_backend(options, backend::Operation::Extract, extractor);
+
+        // Extracted bytes are measured as growth of the target directory, so only walk it when reporting.
+        const bool measure = options.benchmark || options.progress || options.progress_callback;
+        uint64_t existing_size = 0;
+        uint64_t source_size = 0;
+        if (measure) {
+            existing_size = tracker.calculate_directory_size(target_dir_path);
+            std::error_code size_ec;
+            source_size = fs::file_size(source_path, size_ec);
+            if (size_ec) source_size = 0;
+        }
+        if (options.benchmark) {
+            tracker.set_thread_count(options.thread_count > 0 ? options.thread_count : 1);
+            tracker.start_operation();
+            tracker.begin_phase("decompress", tool);
         }
 
-        std::cout << i18n::get("decompressing") << std::endl;
-        int result = execute_command(tool, args, fs::current_path().string());
+        report(options, i18n::get("decompressing"));
+        progress::LiveProgress live(live_progress_mode(options), "decompress", false, source_size,
+                                     std::chrono::milliseconds(500), options.progress_callback);
+        live.set_watch_paths(source_path, "");
+        backend::JobContext context = job_context(options, live);
+        int result = backend::registry().timed(extractor, backend::Operation::Extract, source,
+            [&]() { return extractor.extract(source, target_dir_path, context); });
         if (result != 0) {
+            live.finish();
             error::throw_error(error::ErrorCode::OPERATION_FAILED, {{"COMMAND", tool}, {"EXIT_CODE", std::to_string(result)}});
         }
-        std::cout << i18n::get("operation_complete") << std::endl;
+
+        if (measure) {
+            if (options.benchmark) tracker.end_operation();
+            uint64_t extracted_total = tracker.calculate_directory_size(target_dir_path);
+            uint64_t extracted_size = extracted_total > existing_size ? extracted_total - existing_size : 0;
+            live.finish(source_size, extracted_size);
+            if (options.benchmark) {
+                tracker.end_phase(source_size, extracted_size);
+                tracker.set_original_size(extracted_size);
+                tracker.set_compressed_size(source_size);
+            }
+        }
+        report(options, i18n::get("operation_complete"));
+
+        if (options.benchmark) {
+            tracker.print_stats(options.verbose, options.benchmark);
+        }
     }
 }
@@ -6,36 +6,423 @@
 
 #include "include/progress.h"
 #include "include/i18n.h"
+#include "include/trace.h"
+#include "include/util.h"
 
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <sstream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
+#ifdef __linux__
+#include <fstream>
+#endif
 
 namespace fs = std::filesystem;
 
 namespace progress {
+    namespace {
+        std::atomic<bool> g_child_accounting{false};
+        std::mutex g_children_mutex;
+        std::vector<ChildUsage> g_children;
+
+#ifndef _WIN32
+        ResourceUsage from_rusage(const struct rusage& usage) {
+            ResourceUsage result;
+            result.user_seconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+            result.system_seconds = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+            result.max_rss_kb = usage.ru_maxrss;
+            return result;
+        }
+#endif
+
+        // Throughput is measured on the uncompressed side, which is the larger of the two.
+        double megabytes_per_second(uint64_t bytes_in, uint64_t bytes_out, double seconds) {
+            if (seconds <= 0.0) return 0.0;
+            return static_cast<double>(std::max(bytes_in, bytes_out)) / 1e6 / seconds;
+        }
+
+        std::string human_bytes(uint64_t bytes) {
+            const char* units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+            double value = static_cast<double>(bytes);
+            int unit = 0;
+            while (value >= 1024.0 && unit < 4) {
+                value /= 1024.0;
+                ++unit;
+            }
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(unit > 0 ? 1 : 0) << value << ' ' << units[unit];
+            return out.str();
+        }
+
+        std::string format_duration(double seconds) {
+            if (seconds < 0) return "--";
+            uint64_t total = static_cast<uint64_t>(seconds + 0.5);
+            std::ostringstream out;
+            if (total >= 3600) {
+                out << total / 3600 << 'h' << std::setw(2) << std::setfill('0') << (total % 3600) / 60 << 'm';
+            } else if (total >= 60) {
+                out << total / 60 << 'm' << std::setw(2) << std::setfill('0') << total % 60 << 's';
+            } else {
+                out << total << 's';
+            }
+            return out.str();
+        }
+
+        struct Snapshot {
+            double percent = -1.0;
+            double mb_per_s = 0.0;
+            double ratio_percent = -1.0;
+            double eta_seconds = -1.0;
+        };
+
+        Snapshot snapshot(uint64_t bytes_in, uint64_t bytes_out, uint64_t total_bytes, bool compressing, double elapsed) {
+            Snapshot result;
+            if (total_bytes > 0) {
+                result.percent = std::min(100.0, static_cast<double>(bytes_in) * 100.0 / static_cast<double>(total_bytes));
+            }
+            result.mb_per_s = megabytes_per_second(bytes_in, bytes_out, elapsed);
+            uint64_t packed = compressing ? bytes_out : bytes_in;
+            uint64_t unpacked = compressing ? bytes_in : bytes_out;
+            if (unpacked > 0 && packed > 0) {
+                result.ratio_percent = static_cast<double>(packed) * 100.0 / static_cast<double>(unpacked);
+            }
+            if (total_bytes > 0 && bytes_in > 0 && elapsed > 0.0) {
+                uint64_t remaining = total_bytes > bytes_in ? total_bytes - bytes_in : 0;
+                result.eta_seconds = static_cast<double>(remaining) * elapsed / static_cast<double>(bytes_in);
+            }
+            return result;
+        }
+
+#ifdef __linux__
+        std::vector<long> process_tree(long root) {
+            std::vector<long> pids{root};
+            for (size_t i = 0; i < pids.size() && pids.size() < 64; ++i) {
+                std::error_code ec;
+                fs::directory_iterator tasks("/proc/" + std::to_string(pids[i]) + "/task", ec);
+                for (; !ec && tasks != fs::directory_iterator(); tasks.increment(ec)) {
+                    std::ifstream children(tasks->path() / "children");
+                    long child = 0;
+                    while (children >> child) pids.push_back(child);
+                }
+            }
+            return pids;
+        }
+
+        bool read_fd_position(long pid, const fs::path& target, uint64_t& position) {
+            std::error_code ec;
+            const std::string proc = "/proc/" + std::to_string(pid);
+            fs::directory_iterator fds(proc + "/fd", ec);
+            for (; !ec && fds != fs::directory_iterator(); fds.increment(ec)) {
+                std::error_code link_ec;
+                fs::path link = fs::read_symlink(fds->path(), link_ec);
+                if (link_ec || link != target) continue;
+
+                std::ifstream info(proc + "/fdinfo/" + fds->path().filename().string());
+                std::string key;
+                uint64_t value = 0;
+                while (info >> key >> value) {
+                    if (key == "pos:") {
+                        position = value;
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        bool read_io_counters(long pid, uint64_t& read_chars, uint64_t& written_chars) {
+            std::ifstream io("/proc/" + std::to_string(pid) + "/io");
+            if (!io) return false;
+            std::string key;
+            uint64_t value = 0;
+            bool found = false;
+            while (io >> key >> value) {
+                if (key == "rchar:") { read_chars = value; found = true; }
+                else if (key == "wchar:") { written_chars = value; }
+            }
+            return found;
+        }
+#endif
+
+        void write_usage(std::ostream& out, const ResourceUsage& usage) {
+            out << "\"user_seconds\":" << usage.user_seconds
+                << ",\"system_seconds\":" << usage.system_seconds
+                << ",\"max_rss_kb\":" << usage.max_rss_kb;
+        }
+    }
+
+    void set_child_accounting(bool enabled) {
+        g_child_accounting = enabled;
+    }
+
+    bool child_accounting_enabled() {
+        return g_child_accounting;
+    }
+
+    void record_child(const ChildUsage& child) {
+        if (!g_child_accounting) return;
+        std::lock_guard<std::mutex> lock(g_children_mutex);
+        g_children.push_back(child);
+    }
+
+    std::vector<ChildUsage> recorded_children() {
+        std::lock_guard<std::mutex> lock(g_children_mutex);
+        return g_children;
+    }
+
+    ResourceUsage self_usage() {
+#ifndef _WIN32
+        struct rusage usage {};
+        if (getrusage(RUSAGE_SELF, &usage) == 0) return from_rusage(usage);
+#endif
+        return {};
+    }
+
+#ifndef _WIN32
+    int wait_for_child(pid_t pid, const std::string& tool, std::chrono::steady_clock::time_point started) {
+        int status = 0;
+        struct rusage usage {};
+        pid_t waited;
+        do {
+            waited = wait4(pid, &status, 0, &usage);
+        } while (waited == -1 && errno == EINTR);
+        if (waited == -1) return -1;
+
+        if (g_child_accounting) {
+            ChildUsage child;
+            child.tool = tool;
+            child.exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+            child.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+            child.usage = from_rusage(usage);
+            record_child(child);
+        }
+        return status;
+    }
+#endif
+
+    LiveProgress::LiveProgress(Mode mode, std::string operation, bool compressing, uint64_t total_bytes,
+                               std::chrono::milliseconds interval, Callback callback)
+        : mode_(mode), operation_(std::move(operation)), compressing_(compressing), total_bytes_(total_bytes),
+          interval_(interval), callback_(std::move(callback)), started_(std::chrono::steady_clock::now()) {
+        if (mode_ == Mode::Callback && !callback_) mode_ = Mode::Off;
+        if (mode_ != Mode::Off) {
+            worker_ = std::thread([this] { loop(); });
+        }
+    }
+
+    LiveProgress::~LiveProgress() {
+        stop_worker();
+        if (mode_ == Mode::Line && last_line_width_ > 0 && !finished_) {
+            std::cerr << std::endl;
+        }
+    }
+
+    void LiveProgress::set_watch_paths(const std::string& input_path, const std::string& output_path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::error_code ec;
+        input_path_ = input_path.empty() ? "" : fs::weakly_canonical(input_path, ec).string();
+        output_path_ = output_path;
+    }
+
+#ifndef _WIN32
+    void LiveProgress::watch_process(pid_t pid) {
+        if (mode_ == Mode::Off) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        watched_pid_ = static_cast<long>(pid);
+    }
+
+    void LiveProgress::unwatch_process() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        watched_pid_ = 0;
+    }
+#endif
+
+    void LiveProgress::loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_) {
+            wake_.wait_for(lock, interval_, [this] { return stopping_; });
+            if (stopping_) break;
+            sample();
+            emit(false);
+        }
+    }
+
+    void LiveProgress::stop_worker() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        if (worker_.joinable()) worker_.join();
+    }
+
+    void LiveProgress::sample() {
+#ifdef __linux__
+        if (watched_pid_ <= 0) return;
+        uint64_t read_chars = 0, written_chars = 0;
+        bool have_io = read_io_counters(watched_pid_, read_chars, written_chars);
+
+        uint64_t position = 0;
+        bool have_position = false;
+        if (!input_path_.empty()) {
+            for (long pid : process_tree(watched_pid_)) {
+                uint64_t pid_position = 0;
+                if (read_fd_position(pid, input_path_, pid_position)) {
+                    position = std::max(position, pid_position);
+                    have_position = true;
+                }
+            }
+        }
+        if (have_position) {
+            sampled_in_ = std::max(sampled_in_, position);
+        } else if (input_path_.empty() && have_io) {
+            sampled_in_ = std::max(sampled_in_, read_chars);
+        }
+        if (total_bytes_ > 0) sampled_in_ = std::min(sampled_in_, total_bytes_);
+
+        std::error_code ec;
+        uint64_t output_size = output_path_.empty() ? 0 : fs::file_size(output_path_, ec);
+        if (!output_path_.empty() && !ec) {
+            sampled_out_ = std::max(sampled_out_, output_size);
+        } else if (have_io) {
+            sampled_out_ = std::max(sampled_out_, written_chars);
+        }
+#endif
+    }
+
+    void LiveProgress::emit(bool final) {
+        uint64_t bytes_in = sampled_in_ + bytes_in_.load(std::memory_order_relaxed);
+        uint64_t bytes_out = sampled_out_ + bytes_out_.load(std::memory_order_relaxed);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count();
+
+        if (mode_ == Mode::Callback) {
+            Update update;
+            update.bytes_in = bytes_in;
+            update.bytes_out = bytes_out;
+            update.total_bytes = total_bytes_;
+            update.elapsed_seconds = elapsed;
+            update.final = final;
+            callback_(update);
+        } else if (mode_ == Mode::Json) {
+            Snapshot snap = snapshot(bytes_in, bytes_out, total_bytes_, compressing_, elapsed);
+            std::ostringstream json;
+            json << std::fixed << std::setprecision(3)
+                 << "{\"event\":\"progress\",\"operation\":" << util::json_quote(operation_)
+                 << ",\"bytes_in\":" << bytes_in
+                 << ",\"bytes_out\":" << bytes_out
+                 << ",\"total_bytes\":" << total_bytes_
+                 << ",\"percent\":" << snap.percent
+                 << ",\"mb_per_s\":" << snap.mb_per_s
+                 << ",\"ratio_percent\":" << snap.ratio_percent
+                 << ",\"eta_seconds\":" << snap.eta_seconds
+                 << ",\"elapsed_seconds\":" << elapsed
+                 << ",\"final\":" << (final ? "true" : "false") << '}';
+            std::cerr << json.str() << std::endl;
+        } else if (mode_ == Mode::Line) {
+            std::string line = format_line(bytes_in, bytes_out, total_bytes_, compressing_, elapsed);
+            size_t width = line.size();
+            if (width < last_line_width_) line.append(last_line_width_ - width, ' ');
+            last_line_width_ = width;
+            std::cerr << '\r' << line;
+            if (final) std::cerr << std::endl;
+            else std::cerr << std::flush;
+        }
+    }
+
+    void LiveProgress::finish(uint64_t final_in, uint64_t final_out) {
+        if (finished_) return;
+        stop_worker();
+        finished_ = true;
+        if (mode_ == Mode::Off) return;
+        if (final_in > 0) sampled_in_ = final_in > bytes_in_ ? final_in - bytes_in_ : 0;
+        if (final_out > 0) sampled_out_ = final_out > bytes_out_ ? final_out - bytes_out_ : 0;
+        emit(true);
+    }
+
+    std::string LiveProgress::format_line(uint64_t bytes_in, uint64_t bytes_out, uint64_t total_bytes,
+                                          bool compressing, double elapsed_seconds) {
+        Snapshot snap = snapshot(bytes_in, bytes_out, total_bytes, compressing, elapsed_seconds);
+        std::ostringstream percent, rate, ratio;
+        percent << std::fixed << std::setprecision(1) << std::max(0.0, snap.percent);
+        rate << std::fixed << std::setprecision(1) << snap.mb_per_s;
+        if (snap.ratio_percent >= 0) ratio << std::fixed << std::setprecision(1) << snap.ratio_percent << '%';
+        else ratio << "--";
+        return i18n::get("progress_line", {
+            {"PERCENT", total_bytes > 0 ? percent.str() : "--"},
+            {"DONE", human_bytes(bytes_in)},
+            {"TOTAL", total_bytes > 0 ? human_bytes(total_bytes) : "?"},
+            {"RATE", rate.str()},
+            {"RATIO", ratio.str()},
+            {"ETA", format_duration(snap.eta_seconds)}
+        });
+    }
+
     void ProgressTracker::start_operation() {
-        start_time_ = std::chrono::high_resolution_clock::now();
+        start_time_ = std::chrono::steady_clock::now();
     }
 
     void ProgressTracker::end_operation() {
-        auto end_time = std::chrono::high_resolution_clock::now();
+        auto end_time = std::chrono::steady_clock::now();
         stats_.compression_time = std::chrono::duration<double>(end_time - start_time_).count();
     }
 
+    void ProgressTracker::begin_phase(const std::string& name, const std::string& backend) {
+        Phase phase;
+        phase.name = name;
+        phase.backend = backend;
+        {
+            std::lock_guard<std::mutex> lock(g_children_mutex);
+            phase.first_child = g_children.size();
+        }
+        phases_.push_back(std::move(phase));
+        phase_self_start_ = self_usage();
+        phase_start_ = std::chrono::steady_clock::now();
+        phase_open_ = true;
+    }
+
+    void ProgressTracker::end_phase(uint64_t bytes_in, uint64_t bytes_out) {
+        if (!phase_open_ || phases_.empty()) return;
+        auto end_time = std::chrono::steady_clock::now();
+        ResourceUsage self_end = self_usage();
+        Phase& phase = phases_.back();
+        phase.wall_seconds = std::chrono::duration<double>(end_time - phase_start_).count();
+        phase.self.user_seconds = self_end.user_seconds - phase_self_start_.user_seconds;
+        phase.self.system_seconds = self_end.system_seconds - phase_self_start_.system_seconds;
+        phase.self.max_rss_kb = self_end.max_rss_kb;
+        phase.bytes_in = bytes_in;
+        phase.bytes_out = bytes_out;
+        {
+            std::lock_guard<std::mutex> lock(g_children_mutex);
+            phase.child_count = g_children.size() - phase.first_child;
+        }
+        phase_open_ = false;
+    }
+
     void ProgressTracker::set_thread_count(int threads) {
         stats_.thread_count = threads;
     }
 
-    void ProgressTracker::set_original_size(size_t size) {
+    void ProgressTracker::set_original_size(uint64_t size) {
         stats_.original_size = size;
     }
 
-    void ProgressTracker::set_compressed_size(size_t size) {
+    void ProgressTracker::set_compressed_size(uint64_t size) {
         stats_.compressed_size = size;
     }
 
-    size_t ProgressTracker::calculate_directory_size(const std::string& path) const {
-        size_t total_size = 0;
+    uint64_t ProgressTracker::calculate_directory_size(const std::string& path) const {
+        trace::Span span("walk_directory", "fs");
+        span.arg("path", path);
+        uint64_t total_size = 0;
 
         for (const auto& entry : fs::recursive_directory_iterator(path)) {
             std::error_code ec;
@@ -48,6 +435,11 @@ namespace progress {
     }
 
     void ProgressTracker::print_stats(bool verbose, bool benchmark) const {
+        if (benchmark && json_output_) {
+            print_json(std::cout);
+            return;
+        }
+
         if (benchmark) {
             std::cout << i18n::get("operation_time", {
                 {"TIME", std::to_string(stats_.compression_time)}
@@ -65,6 +457,75 @@ namespace progress {
                     {"COUNT", std::to_string(stats_.thread_count)}
                 }) << std::endl;
             }
+
+            if (verbose) {
+                for (const auto& phase : phases_) {
+                    std::cout << i18n::get("benchmark_phase", {
+                        {"PHASE", phase.name},
+                        {"BACKEND", phase.backend},
+                        {"TIME", std::to_string(phase.wall_seconds)},
+                        {"RATE", std::to_string(megabytes_per_second(phase.bytes_in, phase.bytes_out, phase.wall_seconds))}
+                    }) << std::endl;
+                }
+            }
+        }
+    }
+
+    // Emitted as a single line so dashboards can pick it out of the human-readable progress output.
+    void ProgressTracker::print_json(std::ostream& out) const {
+        std::vector<ChildUsage> children = recorded_children();
+        ResourceUsage process = self_usage();
+
+        std::ostringstream json;
+        json << std::setprecision(6) << std::fixed;
+        json << "{\"schema\":1"
+             << ",\"threads\":" << stats_.thread_count
+             << ",\"wall_seconds\":" << stats_.compression_time
+             << ",\"bytes_in\":" << stats_.original_size
+             << ",\"bytes_out\":" << stats_.compressed_size
+             << ",\"ratio_percent\":" << stats_.get_compression_ratio()
+             << ",\"process\":{";
+        write_usage(json, process);
+        json << "},\"phases\":[";
+
+        for (size_t i = 0; i < phases_.size(); ++i) {
+            const Phase& phase = phases_[i];
+            ResourceUsage child_total;
+            for (size_t c = phase.first_child; c < phase.first_child + phase.child_count && c < children.size(); ++c) {
+                child_total.user_seconds += children[c].usage.user_seconds;
+                child_total.system_seconds += children[c].usage.system_seconds;
+                child_total.max_rss_kb = std::max(child_total.max_rss_kb, children[c].usage.max_rss_kb);
+            }
+            double cpu_seconds = phase.self.user_seconds + phase.self.system_seconds +
+                                 child_total.user_seconds + child_total.system_seconds;
+
+            if (i > 0) json << ',';
+            json << "{\"name\":" << util::json_quote(phase.name)
+                 << ",\"backend\":" << util::json_quote(phase.backend)
+                 << ",\"wall_seconds\":" << phase.wall_seconds
+                 << ",\"cpu_seconds\":" << cpu_seconds
+                 << ",\"bytes_in\":" << phase.bytes_in
+                 << ",\"bytes_out\":" << phase.bytes_out
+                 << ",\"mb_per_s\":" << megabytes_per_second(phase.bytes_in, phase.bytes_out, phase.wall_seconds)
+                 << ",\"self\":{";
+            write_usage(json, phase.self);
+            json << "},\"children\":{\"count\":" << phase.child_count << ',';
+            write_usage(json, child_total);
+            json << "}}";
         }
+
+        json << "],\"children\":[";
+        for (size_t i = 0; i < children.size(); ++i) {
+            const ChildUsage& child = children[i];
+            if (i > 0) json << ',';
+            json << "{\"tool\":" << util::json_quote(child.tool)
+                 << ",\"exit_code\":" << child.exit_code
+                 << ",\"wall_seconds\":" << child.wall_seconds << ',';
+            write_usage(json, child.usage);
+            json << '}';
+        }
+        json << "]}";
+
+        out << json.str() << std::endl;
     }
 }
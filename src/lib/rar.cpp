@@ -0,0 +1,461 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "include/rar.h"
+#include "include/checksum.h"
+#include "include/trace.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace rar {
+    namespace {
+        constexpr unsigned char kSignature4[7] = {'R', 'a', 'r', '!', 0x1A, 0x07, 0x00};
+        constexpr unsigned char kSignature5[8] = {'R', 'a', 'r', '!', 0x1A, 0x07, 0x01, 0x00};
+        // RAR5 caps headers at 2 MiB; RAR4 sizes are 16-bit anyway.
+        constexpr uint64_t kMaxHeaderSize = 2u << 20;
+
+        uint16_t le16(const unsigned char* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+        uint32_t le32(const unsigned char* p) { return le16(p) | (static_cast<uint32_t>(le16(p + 2)) << 16); }
+        uint64_t le64(const unsigned char* p) { return le32(p) | (static_cast<uint64_t>(le32(p + 4)) << 32); }
+
+        // Bounds-checked cursor over one header; reads past the end fail it and return zero.
+        class Reader {
+        public:
+            Reader(const unsigned char* data, size_t size) : data_(data), size_(size) {}
+
+            bool ok() const { return ok_; }
+            size_t pos() const { return pos_; }
+            void seek(size_t pos) {
+                if (pos > size_) ok_ = false;
+                else pos_ = pos;
+            }
+
+            // RAR5 vint: seven bits per byte, least significant first, high bit continues.
+            uint64_t vint() {
+                uint64_t value = 0;
+                for (int shift = 0; shift < 70 && ok_; shift += 7) {
+                    if (pos_ >= size_) break;
+                    uint8_t byte = data_[pos_++];
+                    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                    if ((byte & 0x80) == 0) return value;
+                }
+                ok_ = false;
+                return 0;
+            }
+
+            const unsigned char* bytes(size_t count) {
+                if (!ok_ || count > size_ - pos_) {
+                    ok_ = false;
+                    return nullptr;
+                }
+                const unsigned char* start = data_ + pos_;
+                pos_ += count;
+                return start;
+            }
+
+            uint32_t u32() {
+                const unsigned char* p = bytes(4);
+                return p ? le32(p) : 0;
+            }
+
+            uint64_t u64() {
+                const unsigned char* p = bytes(8);
+                return p ? le64(p) : 0;
+            }
+
+        private:
+            const unsigned char* data_;
+            size_t size_;
+            size_t pos_ = 0;
+            bool ok_ = true;
+        };
+
+        bool read_at(std::ifstream& input, uint64_t offset, unsigned char* out, size_t size) {
+            input.clear();
+            input.seekg(static_cast<std::streamoff>(offset));
+            return static_cast<bool>(input.read(reinterpret_cast<char*>(out), static_cast<std::streamsize>(size)));
+        }
+
+        int64_t dos_to_unix(uint32_t stamp) {
+            std::tm parts{};
+            parts.tm_year = static_cast<int>((stamp >> 25) & 0x7F) + 80;
+            parts.tm_mon = static_cast<int>((stamp >> 21) & 0x0F) - 1;
+            parts.tm_mday = static_cast<int>((stamp >> 16) & 0x1F);
+            parts.tm_hour = static_cast<int>((stamp >> 11) & 0x1F);
+            parts.tm_min = static_cast<int>((stamp >> 5) & 0x3F);
+            parts.tm_sec = static_cast<int>((stamp & 0x1F) * 2);
+            parts.tm_isdst = -1;
+            return static_cast<int64_t>(std::mktime(&parts));
+        }
+
+        void append_utf8(std::string& out, uint32_t code) {
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+
+        // RAR 3.x Unicode names: "ascii\0packed" where the packed part rebuilds UTF-16 from the
+        // ASCII copy with a shared high byte. Without the NUL the whole field is UTF-8.
+        std::string decode_name(const unsigned char* name, size_t size, bool unicode) {
+            const unsigned char* nul = static_cast<const unsigned char*>(std::memchr(name, 0, size));
+            if (!unicode || !nul) return std::string(reinterpret_cast<const char*>(name), nul ? static_cast<size_t>(nul - name) : size);
+
+            size_t ascii_size = static_cast<size_t>(nul - name);
+            const unsigned char* packed = nul + 1;
+            size_t packed_size = size - ascii_size - 1;
+            std::vector<uint32_t> wide;
+            size_t pos = 0;
+            if (packed_size == 0) return std::string(reinterpret_cast<const char*>(name), ascii_size);
+            uint32_t high = packed[pos++];
+            uint8_t flags = 0;
+            int flag_bits = 0;
+            while (pos < packed_size && wide.size() < 4096) {
+                if (flag_bits == 0) {
+                    flags = packed[pos++];
+                    flag_bits = 8;
+                }
+                switch (flags >> 6) {
+                    case 0:
+                        if (pos < packed_size) wide.push_back(packed[pos++]);
+                        break;
+                    case 1:
+                        if (pos < packed_size) wide.push_back(packed[pos++] + (high << 8));
+                        break;
+                    case 2:
+                        if (pos + 1 < packed_size) wide.push_back(packed[pos] + (static_cast<uint32_t>(packed[pos + 1]) << 8));
+                        pos += 2;
+                        break;
+                    default: {
+                        if (pos >= packed_size) break;
+                        uint32_t length = packed[pos++];
+                        if (length & 0x80) {
+                            if (pos >= packed_size) break;
+                            uint8_t correction = packed[pos++];
+                            for (length = (length & 0x7F) + 2; length > 0; --length) {
+                                size_t at = wide.size();
+                                uint8_t base = at < ascii_size ? name[at] : 0;
+                                wide.push_back(((base + correction) & 0xFF) + (high << 8));
+                            }
+                        } else {
+                            for (length += 2; length > 0; --length) {
+                                size_t at = wide.size();
+                                wide.push_back(at < ascii_size ? name[at] : 0);
+                            }
+                        }
+                        break;
+                    }
+                }
+                flags = static_cast<uint8_t>(flags << 2);
+                flag_bits -= 2;
+            }
+
+            std::string result;
+            for (size_t i = 0; i < wide.size(); ++i) {
+                uint32_t code = wide[i];
+                if (code == 0) break;
+                if (code >= 0xD800 && code < 0xDC00 && i + 1 < wide.size() && wide[i + 1] >= 0xDC00 && wide[i + 1] < 0xE000) {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (wide[++i] - 0xDC00);
+                    result += static_cast<char>(0xF0 | (code >> 18));
+                    result += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                    result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    result += static_cast<char>(0x80 | (code & 0x3F));
+                    continue;
+                }
+                append_utf8(result, code);
+            }
+            return result;
+        }
+
+        // Continuation headers of a split member add their packed part to the first one.
+        void add_member(Index& index, Member member, bool split_before) {
+            if (split_before) {
+                for (auto it = index.members.rbegin(); it != index.members.rend(); ++it) {
+                    if (it->path == member.path) {
+                        it->packed_size += member.packed_size;
+                        // The CRC of a split member is stored whole only in its last part.
+                        if (member.has_crc) {
+                            it->has_crc = true;
+                            it->crc = member.crc;
+                        }
+                        return;
+                    }
+                }
+            }
+            index.members.push_back(std::move(member));
+        }
+
+        // Returns false on a malformed header; more_volumes reports an end block announcing a next volume.
+        bool walk_rar5(std::ifstream& input, uint64_t file_size, Index& index, bool& more_volumes) {
+            uint64_t pos = sizeof(kSignature5);
+            std::vector<unsigned char> header;
+            while (pos < file_size) {
+                // CRC32, then the header size as a vint of at most three bytes.
+                unsigned char lead[7] = {};
+                size_t lead_size = static_cast<size_t>(std::min<uint64_t>(sizeof(lead), file_size - pos));
+                if (lead_size < 5 || !read_at(input, pos, lead, lead_size)) return false;
+                Reader size_reader(lead + 4, lead_size - 4);
+                uint64_t header_size = size_reader.vint();
+                if (!size_reader.ok() || header_size == 0 || header_size > kMaxHeaderSize) return false;
+                size_t size_field = size_reader.pos();
+                uint64_t covered = size_field + header_size;
+                if (pos + 4 + covered > file_size) return false;
+                header.resize(static_cast<size_t>(covered));
+                if (!read_at(input, pos + 4, header.data(), header.size())) return false;
+                if (checksum::crc32(0, header.data(), header.size()) != le32(lead)) return false;
+
+                Reader reader(header.data() + size_field, static_cast<size_t>(header_size));
+                uint64_t type = reader.vint();
+                uint64_t flags = reader.vint();
+                uint64_t extra_size = (flags & 0x0001) ? reader.vint() : 0;
+                uint64_t data_size = (flags & 0x0002) ? reader.vint() : 0;
+                if (!reader.ok() || extra_size > header_size) return false;
+                // The data area must lie inside this volume; an oversized one could wrap pos.
+                if (data_size > file_size - (pos + 4 + covered)) return false;
+
+                if (type == 1) {
+                    uint64_t archive_flags = reader.vint();
+                    index.multi_volume = (archive_flags & 0x0001) != 0;
+                    index.solid = (archive_flags & 0x0004) != 0;
+                } else if (type == 2) {
+                    Member member;
+                    uint64_t file_flags = reader.vint();
+                    uint64_t unpacked = reader.vint();
+                    reader.vint();  // attributes
+                    if (file_flags & 0x0002) {
+                        member.has_mtime = true;
+                        member.mtime = reader.u32();
+                    }
+                    if (file_flags & 0x0004) {
+                        member.has_crc = true;
+                        member.crc = reader.u32();
+                    }
+                    uint64_t compression = reader.vint();
+                    reader.vint();  // host OS
+                    uint64_t name_size = reader.vint();
+                    const unsigned char* name = reader.bytes(static_cast<size_t>(std::min<uint64_t>(name_size, header_size)));
+                    if (!reader.ok()) return false;
+                    member.path.assign(reinterpret_cast<const char*>(name), static_cast<size_t>(name_size));
+                    member.is_directory = (file_flags & 0x0001) != 0;
+                    member.size = (file_flags & 0x0008) ? 0 : unpacked;
+                    member.packed_size = data_size;
+                    member.solid = (compression & 0x0040) != 0;
+                    member.method = static_cast<int>((compression >> 7) & 0x07);
+                    member.dictionary_log = 17 + static_cast<int>((compression >> 10) & 0x0F);
+
+                    // Extra records: size, type, then type-specific data.
+                    Reader extra(header.data() + size_field, static_cast<size_t>(header_size));
+                    extra.seek(static_cast<size_t>(header_size - extra_size));
+                    while (extra.ok() && extra.pos() < header_size) {
+                        uint64_t record_size = extra.vint();
+                        size_t record_start = extra.pos();
+                        uint64_t record_type = extra.vint();
+                        if (!extra.ok() || record_size > header_size) break;
+                        if (record_type == 0x01) {
+                            member.encrypted = true;
+                        } else if (record_type == 0x03) {
+                            uint64_t time_flags = extra.vint();
+                            if (time_flags & 0x0002) {
+                                member.has_mtime = true;
+                                if (time_flags & 0x0001) member.mtime = extra.u32();
+                                else member.mtime = static_cast<int64_t>(extra.u64() / 10000000) - 11644473600ll;
+                            }
+                        }
+                        extra.seek(record_start + static_cast<size_t>(record_size));
+                    }
+                    add_member(index, std::move(member), (flags & 0x0008) != 0);
+                } else if (type == 4) {
+                    index.needs_tool = true;
+                    return false;
+                } else if (type == 5) {
+                    more_volumes = (reader.vint() & 0x0001) != 0;
+                    return true;
+                }
+                uint64_t next = pos + 4 + covered + data_size;
+                if (next <= pos) return false;
+                pos = next;
+            }
+            return true;
+        }
+
+        bool walk_rar4(std::ifstream& input, uint64_t file_size, Index& index, bool& more_volumes) {
+            uint64_t pos = sizeof(kSignature4);
+            std::vector<unsigned char> header;
+            while (pos + 7 <= file_size) {
+                unsigned char base[7];
+                if (!read_at(input, pos, base, sizeof(base))) return false;
+                uint8_t type = base[2];
+                uint16_t flags = le16(base + 3);
+                uint16_t header_size = le16(base + 5);
+                if (header_size < 7 || pos + header_size > file_size) return false;
+                header.resize(header_size);
+                if (!read_at(input, pos, header.data(), header.size())) return false;
+                uint64_t add_size = (flags & 0x8000) && header_size >= 11 ? le32(&header[7]) : 0;
+
+                if (type == 0x73 || type == 0x74) {
+                    // Low 16 bits of the CRC32 of everything after the CRC field.
+                    if ((checksum::crc32(0, header.data() + 2, header.size() - 2) & 0xFFFF) != le16(base)) return false;
+                }
+                if (type == 0x73) {
+                    index.multi_volume = (flags & 0x0001) != 0;
+                    index.solid = (flags & 0x0008) != 0;
+                    if (flags & 0x0080) {
+                        index.needs_tool = true;
+                        return false;
+                    }
+                } else if (type == 0x74) {
+                    if (header_size < 32) return false;
+                    Member member;
+                    uint64_t packed = le32(&header[7]);
+                    uint64_t unpacked = le32(&header[11]);
+                    uint8_t host_os = header[15];
+                    member.has_crc = true;
+                    member.crc = le32(&header[16]);
+                    member.has_mtime = true;
+                    member.mtime = dos_to_unix(le32(&header[20]));
+                    member.method = header[25] >= 0x30 ? header[25] - 0x30 : 0;
+                    uint16_t name_size = le16(&header[26]);
+                    uint32_t attributes = le32(&header[28]);
+                    size_t name_offset = 32;
+                    if (flags & 0x0100) {
+                        if (header_size < 40) return false;
+                        packed |= static_cast<uint64_t>(le32(&header[32])) << 32;
+                        unpacked |= static_cast<uint64_t>(le32(&header[36])) << 32;
+                        name_offset = 40;
+                    }
+                    if (name_offset + name_size > header_size) return false;
+                    member.path = decode_name(&header[name_offset], name_size, (flags & 0x0200) != 0);
+                    // Archives made on Windows use backslashes.
+                    std::replace(member.path.begin(), member.path.end(), '\\', '/');
+                    bool dos_host = host_os == 0 || host_os == 2;
+                    member.is_directory = (flags & 0x00E0) == 0x00E0 || (dos_host && (attributes & 0x10)) ||
+                                          (host_os == 3 && (attributes & 0170000) == 0040000);
+                    member.size = unpacked;
+                    member.packed_size = packed;
+                    member.solid = (flags & 0x0010) != 0;
+                    member.encrypted = (flags & 0x0004) != 0;
+                    member.dictionary_log = member.is_directory ? 0 : 16 + ((flags >> 5) & 0x07);
+                    add_size = packed;
+                    // Parts before the last carry a CRC of their own piece only.
+                    if ((flags & 0x0002) || member.is_directory) member.has_crc = false;
+                    add_member(index, std::move(member), (flags & 0x0001) != 0);
+                } else if (type == 0x7B) {
+                    more_volumes = (flags & 0x0001) != 0;
+                    return true;
+                }
+                if (add_size > file_size - (pos + header_size)) return false;
+                uint64_t next = pos + header_size + add_size;
+                if (next <= pos) return false;
+                pos = next;
+            }
+            return true;
+        }
+
+        // name.part1.rar -> name.part2.rar; name.rar -> name.r00 -> name.r01 ...
+        std::string next_volume(const std::string& path) {
+            std::string lower = path;
+            std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            if (lower.size() > 4 && lower.compare(lower.size() - 4, 4, ".rar") == 0) {
+                size_t digits_end = path.size() - 4;
+                size_t digits_start = digits_end;
+                while (digits_start > 0 && std::isdigit(static_cast<unsigned char>(path[digits_start - 1]))) --digits_start;
+                if (digits_start < digits_end && digits_start >= 5 && lower.compare(digits_start - 5, 5, ".part") == 0) {
+                    std::string number = std::to_string(std::stoull(path.substr(digits_start, digits_end - digits_start)) + 1);
+                    if (number.size() < digits_end - digits_start) number.insert(0, digits_end - digits_start - number.size(), '0');
+                    return path.substr(0, digits_start) + number + path.substr(digits_end);
+                }
+                return path.substr(0, path.size() - 3) + "r00";
+            }
+            if (lower.size() > 4 && lower[lower.size() - 4] == '.' && std::isdigit(static_cast<unsigned char>(lower[lower.size() - 2])) &&
+                std::isdigit(static_cast<unsigned char>(lower.back()))) {
+                int number = std::stoi(path.substr(path.size() - 2)) + 1;
+                char letter = path[path.size() - 3];
+                if (number == 100) {
+                    number = 0;
+                    ++letter;
+                }
+                std::string suffix = {letter, static_cast<char>('0' + number / 10), static_cast<char>('0' + number % 10)};
+                return path.substr(0, path.size() - 3) + suffix;
+            }
+            return "";
+        }
+    }
+
+    bool has_signature(const std::string& path) {
+        std::ifstream input(path, std::ios::binary);
+        unsigned char magic[8] = {};
+        if (!input.read(reinterpret_cast<char*>(magic), 7)) return false;
+        return std::memcmp(magic, kSignature4, 6) == 0 && (magic[6] == 0x00 || magic[6] == 0x01);
+    }
+
+    Index read_index(const std::string& path) {
+        trace::Span span("index_rar", "native");
+        Index index;
+        std::string volume = path;
+        while (!volume.empty()) {
+            std::ifstream input(volume, std::ios::binary);
+            std::error_code ec;
+            uint64_t file_size = fs::file_size(volume, ec);
+            unsigned char magic[8] = {};
+            if (!input || ec || file_size < sizeof(kSignature4) || !read_at(input, 0, magic, std::min<uint64_t>(file_size, sizeof(magic)))) {
+                index.truncated = index.volumes > 0;
+                break;
+            }
+
+            int version = std::memcmp(magic, kSignature5, sizeof(kSignature5)) == 0 ? 5 : std::memcmp(magic, kSignature4, sizeof(kSignature4)) == 0 ? 4 : 0;
+            if (version == 0 || (index.version != 0 && version != index.version)) {
+                index.truncated = index.volumes > 0;
+                break;
+            }
+            index.version = version;
+            bool more_volumes = false;
+            bool ok = version == 5 ? walk_rar5(input, file_size, index, more_volumes) : walk_rar4(input, file_size, index, more_volumes);
+            if (!ok) {
+                if (index.volumes == 0 || index.needs_tool) {
+                    index.members.clear();
+                    span.arg("needs_tool", index.needs_tool ? 1 : 0);
+                    return index;
+                }
+                index.truncated = true;
+                break;
+            }
+            ++index.volumes;
+            if (!more_volumes) break;
+            volume = next_volume(volume);
+            if (volume.empty() || !fs::exists(volume, ec)) {
+                index.truncated = true;
+                break;
+            }
+        }
+        index.valid = index.volumes > 0;
+        span.arg("members", static_cast<int64_t>(index.members.size()));
+        span.arg("volumes", static_cast<int64_t>(index.volumes));
+        span.arg("truncated", index.truncated ? 1 : 0);
+        return index;
+    }
+
+    std::string method_name(const Member& member) {
+        if (member.is_directory) return "";
+        std::string name = "m" + std::to_string(member.method);
+        if (member.method != 0) name += ":" + std::to_string(member.dictionary_log);
+        if (member.solid) name += ":s";
+        if (member.encrypted) name += " +";
+        return name;
+    }
+}
@@ -0,0 +1,650 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "include/service.h"
+#include "include/archive_backend.h"
+#include "include/executor.h"
+#include "include/i18n.h"
+#include "include/trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace service {
+    namespace {
+        using tui::archive_ops::ArchiveEntry;
+
+        // Single entries larger than this share of the budget are served but not kept.
+        constexpr size_t kLargestCachedShare = 8;
+        // Request fields are paths and passwords; anything longer is a broken client.
+        constexpr size_t kMaxRequestField = 1024 * 1024;
+
+        std::atomic<bool> interrupted{false};
+
+        bool is_archive_type(file_type::FileType type) {
+            return type != file_type::FileType::UNKNOWN &&
+                   type != file_type::FileType::REGULAR_FILE &&
+                   type != file_type::FileType::DIRECTORY;
+        }
+
+        // Messages are netstrings ("LEN:BYTES,") so paths and entry data need no escaping.
+        void append_field(std::string& out, const std::string& field) {
+            out += std::to_string(field.size());
+            out += ':';
+            out += field;
+            out += ',';
+        }
+
+#ifndef _WIN32
+        class FdReader {
+        public:
+            explicit FdReader(int fd) : fd_(fd) {}
+
+            // False on EOF or a malformed field.
+            bool field(std::string& out, size_t limit) {
+                size_t length = 0;
+                size_t digits = 0;
+                char c = 0;
+                while (true) {
+                    if (!get(c)) return false;
+                    if (c == ':') break;
+                    if (c < '0' || c > '9' || ++digits > 19) return false;
+                    length = length * 10 + static_cast<size_t>(c - '0');
+                }
+                if (digits == 0 || length > limit) return false;
+                out.clear();
+                out.reserve(length);
+                while (out.size() < length) {
+                    if (pos_ == len_ && !fill()) return false;
+                    size_t take = std::min(length - out.size(), len_ - pos_);
+                    out.append(buffer_ + pos_, take);
+                    pos_ += take;
+                }
+                return get(c) && c == ',';
+            }
+
+        private:
+            bool fill() {
+                ssize_t n;
+                do {
+                    n = ::read(fd_, buffer_, sizeof(buffer_));
+                } while (n < 0 && errno == EINTR);
+                if (n <= 0) return false;
+                pos_ = 0;
+                len_ = static_cast<size_t>(n);
+                return true;
+            }
+
+            bool get(char& c) {
+                if (pos_ == len_ && !fill()) return false;
+                c = buffer_[pos_++];
+                return true;
+            }
+
+            int fd_;
+            char buffer_[64 * 1024];
+            size_t pos_ = 0;
+            size_t len_ = 0;
+        };
+
+        // Parses one field from a connection's buffered input: 1 when it is complete, 0 when
+        // more bytes are needed, -1 when it is malformed.
+        int parse_field(const std::string& buffer, size_t& pos, std::string& out, size_t limit) {
+            size_t at = pos;
+            size_t length = 0;
+            size_t digits = 0;
+            while (true) {
+                if (at == buffer.size()) return 0;
+                char c = buffer[at++];
+                if (c == ':') break;
+                if (c < '0' || c > '9' || ++digits > 19) return -1;
+                length = length * 10 + static_cast<size_t>(c - '0');
+            }
+            if (digits == 0 || length > limit) return -1;
+            if (buffer.size() - at <= length) return 0;
+            if (buffer[at + length] != ',') return -1;
+            out.assign(buffer, at, length);
+            pos = at + length + 1;
+            return 1;
+        }
+
+        std::string encode_reply(const Response& response) {
+            std::string reply;
+            append_field(reply, std::to_string(static_cast<int>(response.code)));
+            append_field(reply, response.payload);
+            return reply;
+        }
+
+        struct Connection {
+            std::string input;
+            std::string output;
+            size_t sent = 0;
+            // A request is with the executor; nothing more is read until its reply is out.
+            bool busy = false;
+        };
+
+        bool write_all(int fd, const std::string& data) {
+            size_t sent = 0;
+            while (sent < data.size()) {
+                ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return false;
+                sent += static_cast<size_t>(n);
+            }
+            return true;
+        }
+
+        bool make_address(const std::string& socket_path, sockaddr_un& address) {
+            std::memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path)) return false;
+            std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+            return true;
+        }
+
+        int connect_to(const std::string& socket_path) {
+            sockaddr_un address;
+            if (!make_address(socket_path, address)) return -1;
+            int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd < 0) return -1;
+            if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                ::close(fd);
+                return -1;
+            }
+            return fd;
+        }
+
+        // Only the user running the daemon may ask it to read archives and write output.
+        bool peer_is_owner(int fd) {
+            ucred peer{};
+            socklen_t length = sizeof(peer);
+            return ::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &length) == 0 && peer.uid == ::geteuid();
+        }
+
+        void on_signal(int) {
+            interrupted = true;
+        }
+#endif
+    }
+
+    bool parse_command(const std::string& name, Command& command) {
+        if (name == "list") command = Command::List;
+        else if (name == "stat") command = Command::Stat;
+        else if (name == "cat") command = Command::Cat;
+        else if (name == "extract") command = Command::Extract;
+        else return false;
+        return true;
+    }
+
+    const char* command_name(Command command) {
+        switch (command) {
+            case Command::List: return "list";
+            case Command::Stat: return "stat";
+            case Command::Cat: return "cat";
+            case Command::Extract: return "extract";
+        }
+        return "unknown";
+    }
+
+    Service::Service(size_t content_cache_bytes) : content_budget_(content_cache_bytes) {}
+
+    Response Service::handle(const Request& request) {
+        trace::Span span("service_request", "service");
+        span.arg("command", command_name(request.command));
+        Response response;
+        try {
+            switch (request.command) {
+                case Command::List: response.payload = list(request); break;
+                case Command::Stat: response.payload = stat(request); break;
+                case Command::Cat: response.payload = cat(request); break;
+                case Command::Extract: response.payload = extract(request); break;
+            }
+        } catch (const error::HitpagException& e) {
+            response.code = e.code();
+            response.payload = e.what();
+        } catch (const std::exception& e) {
+            response.code = error::ErrorCode::UNKNOWN_ERROR;
+            response.payload = e.what();
+        }
+        return response;
+    }
+
+    size_t Service::cached_archives() const {
+        std::lock_guard<std::mutex> lock(archives_mutex_);
+        return archives_.size();
+    }
+
+    size_t Service::cached_content_bytes() const {
+        std::lock_guard<std::mutex> lock(content_mutex_);
+        return content_bytes_;
+    }
+
+    // Entries stay valid while the archive's size and mtime are unchanged.
+    std::shared_ptr<Service::ArchiveState> Service::archive_state(const std::string& path) {
+        std::error_code ec;
+        if (!fs::is_regular_file(path, ec)) {
+            error::throw_error(error::ErrorCode::INVALID_SOURCE, {{"PATH", path}});
+        }
+        uint64_t size = fs::file_size(path, ec);
+        auto mtime = fs::last_write_time(path, ec);
+        {
+            std::lock_guard<std::mutex> lock(archives_mutex_);
+            auto it = archives_.find(path);
+            if (it != archives_.end() && it->second->size == size && it->second->mtime == mtime) return it->second;
+        }
+
+        auto state = std::make_shared<ArchiveState>();
+        state->path = path;
+        state->size = size;
+        state->mtime = mtime;
+        state->type = file_type::recognize_source_type(path);
+        if (!is_archive_type(state->type)) {
+            error::throw_error(error::ErrorCode::UNKNOWN_FORMAT, {{"INFO", path}});
+        }
+        std::lock_guard<std::mutex> lock(archives_mutex_);
+        state->generation = next_generation_++;
+        archives_[path] = state;
+        return state;
+    }
+
+    std::shared_ptr<const Service::Listing> Service::listing(ArchiveState& state, const std::string& password) {
+        std::shared_ptr<Listing> listing;
+        {
+            std::lock_guard<std::mutex> lock(state.listings_mutex);
+            std::shared_ptr<Listing>& slot = state.listings[password];
+            if (!slot) slot = std::make_shared<Listing>();
+            listing = slot;
+        }
+
+        std::lock_guard<std::mutex> lock(listing->mutex);
+        if (listing->complete) return listing;
+        listing->entries = tui::archive_ops::list_archive(state.path, state.type, password);
+        listing->complete = !listing->entries.empty() || backend::registry().empty({state.path, state.type, password});
+        if (!listing->complete) {
+            {
+                std::lock_guard<std::mutex> map_lock(state.listings_mutex);
+                auto it = state.listings.find(password);
+                if (it != state.listings.end() && it->second == listing) state.listings.erase(it);
+            }
+            error::throw_error(error::ErrorCode::OPERATION_FAILED,
+                {{"COMMAND", i18n::get("diff_list_command", {{"PATH", state.path}})}, {"EXIT_CODE", "-"}});
+        }
+        listing->by_path.reserve(listing->entries.size());
+        for (size_t i = 0; i < listing->entries.size(); ++i) listing->by_path.emplace(listing->entries[i].path, i);
+        return listing;
+    }
+
+    const ArchiveEntry& Service::find_entry(const ArchiveState& state, const Listing& listing, const std::string& entry) {
+        std::string key = entry;
+        while (key.size() > 1 && key.back() == '/') key.pop_back();
+        auto it = listing.by_path.find(key);
+        if (it == listing.by_path.end()) {
+            error::throw_error(error::ErrorCode::INVALID_SOURCE,
+                {{"PATH", state.path + ":" + entry}, {"REASON", i18n::get("service_entry_not_found")}});
+        }
+        return listing.entries[it->second];
+    }
+
+    std::shared_ptr<const std::string> Service::read_entry(ArchiveState& state, const Request& request) {
+        // Decrypted content is only handed back to callers presenting the same password.
+        std::string key = std::to_string(state.generation) + '\0' + std::to_string(request.password.size()) + ':' +
+                          request.password + request.entry;
+        {
+            std::lock_guard<std::mutex> lock(content_mutex_);
+            auto it = content_index_.find(key);
+            if (it != content_index_.end()) {
+                content_lru_.splice(content_lru_.begin(), content_lru_, it->second);
+                return it->second->second;
+            }
+        }
+
+        auto content = std::make_shared<std::string>();
+        if (!tui::archive_ops::stream_entry(state.path, request.entry, state.type, request.password, [&](const char* data, size_t size) {
+                content->append(data, size);
+                return true;
+            })) {
+            error::throw_error(error::ErrorCode::OPERATION_FAILED, {{"COMMAND", "cat " + request.entry}, {"EXIT_CODE", "-1"}});
+        }
+
+        if (content->size() <= content_budget_ / kLargestCachedShare) {
+            std::lock_guard<std::mutex> lock(content_mutex_);
+            if (content_index_.find(key) == content_index_.end()) {
+                content_lru_.emplace_front(key, content);
+                content_index_[key] = content_lru_.begin();
+                content_bytes_ += content->size();
+                while (content_bytes_ > content_budget_ && !content_lru_.empty()) {
+                    content_bytes_ -= content_lru_.back().second->size();
+                    content_index_.erase(content_lru_.back().first);
+                    content_lru_.pop_back();
+                }
+            }
+        }
+        return content;
+    }
+
+    std::string Service::list(const Request& request) {
+        std::shared_ptr<ArchiveState> state = archive_state(request.archive);
+        std::shared_ptr<const Listing> entries = listing(*state, request.password);
+
+        std::string out;
+        for (const auto& entry : entries->entries) {
+            out += entry.path;
+            if (entry.is_directory) out += '/';
+            out += '\n';
+        }
+        return out;
+    }
+
+    std::string Service::stat(const Request& request) {
+        std::shared_ptr<ArchiveState> state = archive_state(request.archive);
+        std::shared_ptr<const Listing> entries = listing(*state, request.password);
+        const ArchiveEntry& entry = find_entry(*state, *entries, request.entry);
+
+        std::string out = "path=" + entry.path + "\n";
+        out += std::string("type=") + (entry.is_directory ? "directory" : "file") + "\n";
+        out += "size=" + std::to_string(entry.size) + "\n";
+        if (entry.compressed_size > 0) out += "compressed_size=" + std::to_string(entry.compressed_size) + "\n";
+        if (!entry.modified.empty()) out += "modified=" + entry.modified + "\n";
+        if (!entry.method.empty()) out += "method=" + entry.method + "\n";
+        if (entry.has_crc) {
+            char crc[16];
+            std::snprintf(crc, sizeof(crc), "%08x", entry.crc);
+            out += std::string("crc=") + crc + "\n";
+        }
+        out += "format=" + file_type::get_file_type_string(state->type) + "\n";
+        return out;
+    }
+
+    std::string Service::cat(const Request& request) {
+        std::shared_ptr<ArchiveState> state = archive_state(request.archive);
+        std::shared_ptr<const Listing> entries = listing(*state, request.password);
+        if (find_entry(*state, *entries, request.entry).is_directory) {
+            error::throw_error(error::ErrorCode::INVALID_SOURCE,
+                {{"PATH", state->path + ":" + request.entry}, {"REASON", i18n::get("service_entry_is_directory")}});
+        }
+        return *read_entry(*state, request);
+    }
+
+    std::string Service::extract(const Request& request) {
+        std::shared_ptr<ArchiveState> state = archive_state(request.archive);
+        std::shared_ptr<const Listing> entries = listing(*state, request.password);
+        const ArchiveEntry& entry = find_entry(*state, *entries, request.entry);
+        std::error_code ec;
+        fs::create_directories(request.output_dir, ec);
+        if (ec) {
+            error::throw_error(error::ErrorCode::INVALID_TARGET, {{"PATH", request.output_dir}, {"REASON", ec.message()}});
+        }
+        if (!tui::archive_ops::extract_single(state->path, entry.path, request.output_dir, state->type, request.password)) {
+            error::throw_error(error::ErrorCode::OPERATION_FAILED, {{"COMMAND", "extract " + entry.path}, {"EXIT_CODE", "-1"}});
+        }
+        return (fs::path(request.output_dir) / entry.path).string() + "\n";
+    }
+
+    Server::Server(std::string socket_path, Service& service)
+        : socket_path_(std::move(socket_path)), service_(service) {}
+
+    Server::~Server() {
+#ifndef _WIN32
+        if (listen_fd_ >= 0) {
+            ::close(listen_fd_);
+            ::unlink(socket_path_.c_str());
+        }
+#endif
+    }
+
+#ifndef _WIN32
+    void Server::listen() {
+        sockaddr_un address;
+        if (!make_address(socket_path_, address)) {
+            error::throw_error(error::ErrorCode::INVALID_TARGET, {{"PATH", socket_path_}, {"REASON", i18n::get("service_socket_path_invalid")}});
+        }
+        // A socket file nobody answers on is left over from a daemon that died; replace it.
+        int probe = connect_to(socket_path_);
+        if (probe >= 0) {
+            ::close(probe);
+            error::throw_error(error::ErrorCode::INVALID_TARGET, {{"PATH", socket_path_}, {"REASON", i18n::get("service_already_running")}});
+        }
+        std::error_code ec;
+        if (fs::is_socket(socket_path_, ec)) ::unlink(socket_path_.c_str());
+
+        // The socket is made private before listen(), so nobody else can connect in between.
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool bound = listen_fd_ >= 0 && ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        if (!bound || ::chmod(socket_path_.c_str(), 0600) != 0 || ::listen(listen_fd_, 128) != 0) {
+            std::string reason = std::strerror(errno);
+            if (listen_fd_ >= 0) ::close(listen_fd_);
+            if (bound) ::unlink(socket_path_.c_str());
+            listen_fd_ = -1;
+            error::throw_error(error::ErrorCode::INVALID_TARGET, {{"PATH", socket_path_}, {"REASON", reason}});
+        }
+    }
+
+    void Server::run() {
+        int wake[2];
+        if (::pipe2(wake, O_CLOEXEC | O_NONBLOCK) != 0) {
+            error::throw_error(error::ErrorCode::INVALID_TARGET, {{"PATH", socket_path_}, {"REASON", std::strerror(errno)}});
+        }
+        executor::TaskGroup requests(executor::global());
+        std::mutex replies_mutex;
+        std::vector<std::pair<int, std::string>> replies;
+        std::map<int, Connection> connections;
+
+        // Starts the next buffered request; false when the client sent something malformed.
+        auto dispatch = [&](int fd, Connection& connection) {
+            std::vector<std::string> fields(5);
+            size_t pos = 0;
+            for (auto& field : fields) {
+                int parsed = parse_field(connection.input, pos, field, kMaxRequestField);
+                if (parsed <= 0) return parsed == 0;
+            }
+            connection.input.erase(0, pos);
+            connection.sent = 0;
+
+            Request request;
+            if (!parse_command(fields[0], request.command)) {
+                Response response;
+                response.code = error::ErrorCode::MISSING_ARGS;
+                response.payload = "unknown command: " + fields[0];
+                connection.output = encode_reply(response);
+                return true;
+            }
+            request.archive = std::move(fields[1]);
+            request.entry = std::move(fields[2]);
+            request.output_dir = std::move(fields[3]);
+            request.password = std::move(fields[4]);
+            connection.busy = true;
+            requests.submit([this, fd, request = std::move(request), &replies_mutex, &replies, &wake]() {
+                std::string reply = encode_reply(service_.handle(request));
+                {
+                    std::lock_guard<std::mutex> lock(replies_mutex);
+                    replies.emplace_back(fd, std::move(reply));
+                }
+                char byte = 0;
+                ssize_t ignored = ::write(wake[1], &byte, 1);
+                (void)ignored;
+            }, executor::Priority::Interactive);
+            return true;
+        };
+
+        auto receive = [&](int fd, Connection& connection) {
+            char buffer[64 * 1024];
+            ssize_t n = ::recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            if (n == 0) return false;
+            connection.input.append(buffer, static_cast<size_t>(n));
+            return dispatch(fd, connection);
+        };
+
+        // Once a reply is out, a request the client already pipelined is started.
+        auto flush = [&](int fd, Connection& connection) {
+            ssize_t n = ::send(fd, connection.output.data() + connection.sent, connection.output.size() - connection.sent,
+                               MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            connection.sent += static_cast<size_t>(n);
+            if (connection.sent < connection.output.size()) return true;
+            connection.output.clear();
+            return dispatch(fd, connection);
+        };
+
+        std::vector<pollfd> watch;
+        std::vector<int> clients;
+        while (!stopping_ && !interrupted) {
+            watch.assign({{listen_fd_, POLLIN, 0}, {wake[0], POLLIN, 0}});
+            clients.clear();
+            for (const auto& [fd, connection] : connections) {
+                // Busy connections are left out entirely so a hang-up cannot spin the loop.
+                watch.push_back({connection.busy ? -1 : fd, static_cast<short>(connection.output.empty() ? POLLIN : POLLOUT), 0});
+                clients.push_back(fd);
+            }
+            // The timeout bounds how long stop() and signals wait to be noticed.
+            if (::poll(watch.data(), watch.size(), 200) <= 0) continue;
+
+            if (watch[1].revents & POLLIN) {
+                char drain[256];
+                while (::read(wake[0], drain, sizeof(drain)) > 0) {}
+                std::lock_guard<std::mutex> lock(replies_mutex);
+                for (auto& [fd, reply] : replies) {
+                    Connection& connection = connections[fd];
+                    connection.busy = false;
+                    connection.output = std::move(reply);
+                    connection.sent = 0;
+                }
+                replies.clear();
+            }
+            for (size_t i = 0; i < clients.size(); ++i) {
+                short events = watch[i + 2].revents;
+                if (events == 0) continue;
+                int fd = clients[i];
+                Connection& connection = connections[fd];
+                bool keep = (events & POLLOUT) ? flush(fd, connection) : receive(fd, connection);
+                if (!keep) {
+                    ::close(fd);
+                    connections.erase(fd);
+                }
+            }
+            if (watch[0].revents & POLLIN) {
+                int client = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+                if (client >= 0 && peer_is_owner(client)) {
+                    connections[client];
+                } else if (client >= 0) {
+                    ::close(client);
+                }
+            }
+        }
+
+        // Requests already being answered finish; idle connections are simply closed.
+        stopping_ = true;
+        requests.wait();
+        for (const auto& [fd, connection] : connections) ::close(fd);
+        ::close(wake[0]);
+        ::close(wake[1]);
+        ::close(listen_fd_);
+        ::unlink(socket_path_.c_str());
+        listen_fd_ = -1;
+    }
+
+    void Server::stop() {
+        stopping_ = true;
+    }
+
+    bool call(const std::string& socket_path, const Request& request, Response& response) {
+        int fd = connect_to(socket_path);
+        if (fd < 0) return false;
+
+        std::string message;
+        append_field(message, command_name(request.command));
+        append_field(message, request.archive);
+        append_field(message, request.entry);
+        append_field(message, request.output_dir);
+        append_field(message, request.password);
+
+        FdReader reader(fd);
+        std::string code;
+        bool ok = write_all(fd, message) &&
+                  reader.field(code, 16) &&
+                  reader.field(response.payload, static_cast<size_t>(-1));
+        ::close(fd);
+        if (!ok) return false;
+        response.code = static_cast<error::ErrorCode>(std::atoi(code.c_str()));
+        return true;
+    }
+#else
+    void Server::listen() {
+        error::throw_error(error::ErrorCode::OPERATION_FAILED, {{"COMMAND", "--serve"}, {"EXIT_CODE", i18n::get("service_unsupported")}});
+    }
+
+    void Server::run() {}
+
+    void Server::stop() {
+        stopping_ = true;
+    }
+
+    bool call(const std::string&, const Request&, Response&) {
+        return false;
+    }
+#endif
+
+    void serve(const args::Options& options) {
+        Service service;
+        Server server(options.serve_socket, service);
+        server.listen();
+#ifndef _WIN32
+        std::signal(SIGINT, on_signal);
+        std::signal(SIGTERM, on_signal);
+        std::signal(SIGPIPE, SIG_IGN);
+#endif
+        std::cout << i18n::get("service_listening", {{"PATH", options.serve_socket}, {"COUNT", std::to_string(executor::global().worker_count())}}) << std::endl;
+        server.run();
+        std::cout << i18n::get("service_stopped") << std::endl;
+    }
+
+    int run_query(const args::Options& options) {
+        Request request;
+        parse_command(options.query_command, request.command);
+        request.archive = fs::absolute(options.query_args.at(0)).string();
+        if (options.query_args.size() > 1) request.entry = options.query_args[1];
+        if (options.query_args.size() > 2) request.output_dir = fs::absolute(options.query_args[2]).string();
+        request.password = options.password;
+
+        std::string socket_path = options.socket_path;
+        if (socket_path.empty()) {
+            const char* from_env = std::getenv("HITPAG_SOCKET");
+            if (from_env) socket_path = from_env;
+        }
+
+        Response response;
+        bool remote = !socket_path.empty() && call(socket_path, request, response);
+        if (!remote) {
+            static Service local;
+            response = local.handle(request);
+        }
+        if (options.verbose) {
+            std::cerr << (remote ? i18n::get("service_answered_remote", {{"PATH", socket_path}})
+                                 : i18n::get("service_answered_local")) << std::endl;
+        }
+        if (response.code != error::ErrorCode::SUCCESS) {
+            throw error::HitpagException(response.code, response.payload);
+        }
+        std::cout.write(response.payload.data(), static_cast<std::streamsize>(response.payload.size()));
+        std::cout.flush();
+        return 0;
+    }
+}
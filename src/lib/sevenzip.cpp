@@ -0,0 +1,848 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "include/sevenzip.h"
+#include "include/checksum.h"
+#include "include/trace.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <lzma.h>
+
+namespace fs = std::filesystem;
+
+namespace sevenzip {
+    namespace {
+        constexpr size_t kSignatureHeaderSize = 32;
+        constexpr unsigned char kSignature[6] = {'7', 'z', 0xBC, 0xAF, 0x27, 0x1C};
+        // Headers (and decoded headers) larger than this are treated as corrupt.
+        constexpr uint64_t kMaxHeaderSize = 1ull << 30;
+        constexpr uint64_t kMaxCount = 1ull << 24;
+
+        enum Property : uint8_t {
+            kEnd = 0x00,
+            kHeader = 0x01,
+            kArchiveProperties = 0x02,
+            kAdditionalStreamsInfo = 0x03,
+            kMainStreamsInfo = 0x04,
+            kFilesInfo = 0x05,
+            kPackInfo = 0x06,
+            kUnPackInfo = 0x07,
+            kSubStreamsInfo = 0x08,
+            kSize = 0x09,
+            kCRC = 0x0A,
+            kFolder = 0x0B,
+            kCodersUnPackSize = 0x0C,
+            kNumUnPackStream = 0x0D,
+            kEmptyStream = 0x0E,
+            kEmptyFile = 0x0F,
+            kAnti = 0x10,
+            kName = 0x11,
+            kMTime = 0x14,
+            kWinAttributes = 0x15,
+            kEncodedHeader = 0x17,
+        };
+
+        uint32_t le32(const unsigned char* p) {
+            return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+                   static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+        }
+
+        uint64_t le64(const unsigned char* p) {
+            return le32(p) | static_cast<uint64_t>(le32(p + 4)) << 32;
+        }
+
+        // Bounds-checked cursor over header bytes. The first overrun marks it failed and every
+        // later read returns zero, so parsers check ok() once per record instead of per field.
+        class Reader {
+        public:
+            Reader(const std::vector<uint8_t>& data, size_t pos) : data_(data), pos_(pos) {}
+
+            bool ok() const { return ok_; }
+            void fail() { ok_ = false; }
+            size_t pos() const { return pos_; }
+            size_t remaining() const { return ok_ ? data_.size() - pos_ : 0; }
+
+            uint8_t byte() {
+                if (!ok_ || pos_ >= data_.size()) {
+                    ok_ = false;
+                    return 0;
+                }
+                return data_[pos_++];
+            }
+
+            const uint8_t* bytes(size_t count) {
+                if (!ok_ || count > data_.size() - pos_) {
+                    ok_ = false;
+                    return nullptr;
+                }
+                const uint8_t* start = data_.data() + pos_;
+                pos_ += count;
+                return start;
+            }
+
+            void seek(size_t pos) {
+                if (pos > data_.size()) ok_ = false;
+                else pos_ = pos;
+            }
+
+            // 7z NUMBER: the count of leading one bits in the first byte gives the extra bytes.
+            uint64_t number() {
+                uint8_t first = byte();
+                uint8_t mask = 0x80;
+                uint64_t value = 0;
+                for (int i = 0; i < 8; ++i) {
+                    if ((first & mask) == 0) {
+                        uint64_t high = first & (mask - 1u);
+                        return value | (high << (8 * i));
+                    }
+                    value |= static_cast<uint64_t>(byte()) << (8 * i);
+                    mask >>= 1;
+                }
+                return value;
+            }
+
+            // A NUMBER used to size a vector; rejects values the header could not possibly hold.
+            uint64_t count() {
+                uint64_t value = number();
+                if (value > kMaxCount || value > remaining() * 8 + 8) ok_ = false;
+                return ok_ ? value : 0;
+            }
+
+            uint32_t uint32() {
+                const uint8_t* p = bytes(4);
+                return p ? le32(p) : 0;
+            }
+
+            uint64_t uint64() {
+                const uint8_t* p = bytes(8);
+                return p ? le64(p) : 0;
+            }
+
+            std::vector<bool> bits(size_t count) {
+                std::vector<bool> result(count);
+                uint8_t mask = 0;
+                uint8_t current = 0;
+                for (size_t i = 0; i < count && ok_; ++i) {
+                    if (mask == 0) {
+                        current = byte();
+                        mask = 0x80;
+                    }
+                    result[i] = (current & mask) != 0;
+                    mask >>= 1;
+                }
+                return result;
+            }
+
+            // AllAreDefined byte followed, when zero, by a bit vector.
+            std::vector<bool> defined(size_t count) {
+                return byte() != 0 ? std::vector<bool>(count, true) : bits(count);
+            }
+
+        private:
+            const std::vector<uint8_t>& data_;
+            size_t pos_;
+            bool ok_ = true;
+        };
+
+        struct Digests {
+            std::vector<bool> defined;
+            std::vector<uint32_t> values;
+        };
+
+        Digests read_digests(Reader& reader, size_t count) {
+            Digests digests;
+            digests.defined = reader.defined(count);
+            digests.values.resize(count);
+            for (size_t i = 0; i < count && reader.ok(); ++i) {
+                if (digests.defined[i]) digests.values[i] = reader.uint32();
+            }
+            return digests;
+        }
+
+        struct StreamsInfo {
+            uint64_t pack_pos = 0;
+            std::vector<uint64_t> pack_sizes;
+            std::vector<Folder> folders;
+            std::vector<uint64_t> streams_per_folder;
+            std::vector<uint64_t> stream_sizes;
+            std::vector<bool> stream_has_crc;
+            std::vector<uint32_t> stream_crcs;
+        };
+
+        void read_pack_info(Reader& reader, StreamsInfo& info) {
+            info.pack_pos = reader.number();
+            uint64_t count = reader.count();
+            info.pack_sizes.assign(count, 0);
+            uint8_t type = reader.byte();
+            if (type == kSize) {
+                for (auto& size : info.pack_sizes) size = reader.number();
+                type = reader.byte();
+            }
+            if (type == kCRC) {
+                read_digests(reader, info.pack_sizes.size());
+                type = reader.byte();
+            }
+            if (type != kEnd) reader.fail();
+        }
+
+        Folder read_folder(Reader& reader) {
+            Folder folder;
+            uint64_t coder_count = reader.number();
+            if (coder_count == 0 || coder_count > 64) {
+                reader.fail();
+                return folder;
+            }
+            uint64_t total_in = 0;
+            uint64_t total_out = 0;
+            for (uint64_t i = 0; i < coder_count && reader.ok(); ++i) {
+                Coder coder;
+                uint8_t flags = reader.byte();
+                // Bit 7 announced alternative methods in early drafts; no encoder writes it.
+                if (flags & 0x80) reader.fail();
+                size_t id_size = flags & 0x0F;
+                const uint8_t* id = reader.bytes(id_size);
+                if (id) coder.id.assign(id, id + id_size);
+                if (flags & 0x10) {
+                    coder.in_streams = reader.number();
+                    coder.out_streams = reader.number();
+                    if (coder.in_streams > 64 || coder.out_streams > 64) reader.fail();
+                }
+                if (flags & 0x20) {
+                    uint64_t size = reader.number();
+                    const uint8_t* properties = reader.bytes(static_cast<size_t>(std::min<uint64_t>(size, reader.remaining() + 1)));
+                    if (properties) coder.properties.assign(properties, properties + size);
+                }
+                total_in += coder.in_streams;
+                total_out += coder.out_streams;
+                folder.coders.push_back(std::move(coder));
+            }
+            if (!reader.ok() || total_out == 0 || total_in < total_out - 1) {
+                reader.fail();
+                return folder;
+            }
+
+            for (uint64_t i = 0; i + 1 < total_out; ++i) {
+                uint64_t in = reader.number();
+                uint64_t out = reader.number();
+                folder.bind_pairs.emplace_back(in, out);
+            }
+            uint64_t packed = total_in - folder.bind_pairs.size();
+            if (packed == 1) {
+                for (uint64_t in = 0; in < total_in; ++in) {
+                    bool bound = std::any_of(folder.bind_pairs.begin(), folder.bind_pairs.end(),
+                        [&](const auto& pair) { return pair.first == in; });
+                    if (!bound) {
+                        folder.packed_streams.push_back(in);
+                        break;
+                    }
+                }
+                if (folder.packed_streams.empty()) reader.fail();
+            } else {
+                for (uint64_t i = 0; i < packed && reader.ok(); ++i) folder.packed_streams.push_back(reader.number());
+            }
+            folder.unpack_sizes.assign(total_out, 0);
+            return folder;
+        }
+
+        void read_unpack_info(Reader& reader, StreamsInfo& info) {
+            if (reader.byte() != kFolder) {
+                reader.fail();
+                return;
+            }
+            uint64_t count = reader.count();
+            // External folder records live in an additional stream; nothing writes them.
+            if (reader.byte() != 0) {
+                reader.fail();
+                return;
+            }
+            for (uint64_t i = 0; i < count && reader.ok(); ++i) info.folders.push_back(read_folder(reader));
+
+            if (reader.byte() != kCodersUnPackSize) {
+                reader.fail();
+                return;
+            }
+            for (auto& folder : info.folders) {
+                for (auto& size : folder.unpack_sizes) size = reader.number();
+            }
+            uint8_t type = reader.byte();
+            if (type == kCRC) {
+                Digests digests = read_digests(reader, info.folders.size());
+                for (size_t i = 0; i < info.folders.size() && reader.ok(); ++i) {
+                    info.folders[i].has_crc = digests.defined[i];
+                    info.folders[i].crc = digests.values[i];
+                }
+                type = reader.byte();
+            }
+            if (type != kEnd) reader.fail();
+        }
+
+        void read_substreams_info(Reader& reader, StreamsInfo& info) {
+            info.streams_per_folder.assign(info.folders.size(), 1);
+            uint8_t type = reader.byte();
+            if (type == kNumUnPackStream) {
+                for (auto& count : info.streams_per_folder) count = reader.count();
+                type = reader.byte();
+            }
+
+            info.stream_sizes.clear();
+            for (size_t f = 0; f < info.folders.size() && reader.ok(); ++f) {
+                uint64_t streams = info.streams_per_folder[f];
+                if (streams == 0) continue;
+                uint64_t sum = 0;
+                if (type == kSize) {
+                    for (uint64_t j = 1; j < streams && reader.ok(); ++j) {
+                        uint64_t size = reader.number();
+                        info.stream_sizes.push_back(size);
+                        sum += size;
+                    }
+                }
+                uint64_t total = info.folders[f].unpack_size();
+                if (sum > total || (type != kSize && streams != 1)) reader.fail();
+                info.stream_sizes.push_back(total - sum);
+            }
+            if (type == kSize) type = reader.byte();
+
+            // Streams alone in a folder with a known CRC reuse it; the rest are listed here.
+            size_t unknown = 0;
+            for (size_t f = 0; f < info.folders.size(); ++f) {
+                uint64_t streams = info.streams_per_folder[f];
+                if (!(streams == 1 && info.folders[f].has_crc)) unknown += static_cast<size_t>(streams);
+            }
+            Digests digests;
+            if (type == kCRC) {
+                digests = read_digests(reader, unknown);
+                type = reader.byte();
+            }
+            info.stream_has_crc.clear();
+            info.stream_crcs.clear();
+            size_t next = 0;
+            for (size_t f = 0; f < info.folders.size() && reader.ok(); ++f) {
+                uint64_t streams = info.streams_per_folder[f];
+                if (streams == 1 && info.folders[f].has_crc) {
+                    info.stream_has_crc.push_back(true);
+                    info.stream_crcs.push_back(info.folders[f].crc);
+                    continue;
+                }
+                for (uint64_t j = 0; j < streams; ++j, ++next) {
+                    bool known = next < digests.defined.size() && digests.defined[next];
+                    info.stream_has_crc.push_back(known);
+                    info.stream_crcs.push_back(known ? digests.values[next] : 0);
+                }
+            }
+            if (type != kEnd) reader.fail();
+        }
+
+        void default_substreams(StreamsInfo& info) {
+            info.streams_per_folder.assign(info.folders.size(), 1);
+            for (const auto& folder : info.folders) {
+                info.stream_sizes.push_back(folder.unpack_size());
+                info.stream_has_crc.push_back(folder.has_crc);
+                info.stream_crcs.push_back(folder.crc);
+            }
+        }
+
+        StreamsInfo read_streams_info(Reader& reader) {
+            StreamsInfo info;
+            uint8_t type = reader.byte();
+            if (type == kPackInfo) {
+                read_pack_info(reader, info);
+                type = reader.byte();
+            }
+            if (type == kUnPackInfo) {
+                read_unpack_info(reader, info);
+                type = reader.byte();
+            }
+            if (type == kSubStreamsInfo) {
+                read_substreams_info(reader, info);
+                type = reader.byte();
+            } else {
+                default_substreams(info);
+            }
+            if (type != kEnd) reader.fail();
+
+            // Packed streams follow one another from pack_pos, folder by folder.
+            uint64_t offset = kSignatureHeaderSize + info.pack_pos;
+            size_t pack_index = 0;
+            for (auto& folder : info.folders) {
+                folder.pack_offset = offset;
+                for (size_t i = 0; i < folder.packed_streams.size(); ++i, ++pack_index) {
+                    if (pack_index >= info.pack_sizes.size()) {
+                        reader.fail();
+                        return info;
+                    }
+                    folder.packed_sizes.push_back(info.pack_sizes[pack_index]);
+                    offset += info.pack_sizes[pack_index];
+                }
+            }
+            return info;
+        }
+
+        void append_utf8(std::string& out, uint32_t code) {
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+
+        // Names are NUL-terminated UTF-16LE.
+        void read_names(Reader& reader, size_t end, std::vector<File>& files) {
+            for (auto& file : files) {
+                while (reader.ok()) {
+                    if (reader.pos() + 2 > end) {
+                        reader.fail();
+                        return;
+                    }
+                    const uint8_t* unit = reader.bytes(2);
+                    uint32_t code = static_cast<uint32_t>(unit[0] | (unit[1] << 8));
+                    if (code == 0) break;
+                    if (code >= 0xD800 && code < 0xDC00 && reader.pos() + 2 <= end) {
+                        const uint8_t* low = reader.bytes(2);
+                        uint32_t low_code = static_cast<uint32_t>(low[0] | (low[1] << 8));
+                        if (low_code >= 0xDC00 && low_code < 0xE000) {
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low_code - 0xDC00);
+                        } else {
+                            append_utf8(file.path, 0xFFFD);
+                            code = low_code;
+                        }
+                    }
+                    append_utf8(file.path, code);
+                }
+            }
+        }
+
+        void read_files_info(Reader& reader, const StreamsInfo& streams, Index& index) {
+            uint64_t count = reader.count();
+            index.files.assign(count, File{});
+            std::vector<bool> empty_stream(count, false);
+            std::vector<bool> empty_file;
+            std::vector<bool> anti;
+            size_t empty_count = 0;
+
+            while (reader.ok()) {
+                uint8_t type = reader.byte();
+                if (type == kEnd) break;
+                uint64_t size = reader.number();
+                if (size > reader.remaining()) {
+                    reader.fail();
+                    break;
+                }
+                size_t end = reader.pos() + static_cast<size_t>(size);
+                switch (type) {
+                    case kEmptyStream:
+                        empty_stream = reader.bits(count);
+                        empty_count = static_cast<size_t>(std::count(empty_stream.begin(), empty_stream.end(), true));
+                        break;
+                    case kEmptyFile:
+                        empty_file = reader.bits(empty_count);
+                        break;
+                    case kAnti:
+                        anti = reader.bits(empty_count);
+                        break;
+                    case kName:
+                        if (reader.byte() != 0) reader.fail();
+                        read_names(reader, end, index.files);
+                        break;
+                    case kMTime: {
+                        std::vector<bool> defined = reader.defined(count);
+                        if (reader.byte() != 0) reader.fail();
+                        for (size_t i = 0; i < count && reader.ok(); ++i) {
+                            if (!defined[i]) continue;
+                            index.files[i].has_mtime = true;
+                            index.files[i].mtime = reader.uint64();
+                        }
+                        break;
+                    }
+                    case kWinAttributes: {
+                        std::vector<bool> defined = reader.defined(count);
+                        if (reader.byte() != 0) reader.fail();
+                        for (size_t i = 0; i < count && reader.ok(); ++i) {
+                            if (defined[i]) index.files[i].attributes = reader.uint32();
+                        }
+                        break;
+                    }
+                    default:
+                        break;
+                }
+                reader.seek(end);
+            }
+            if (!reader.ok()) return;
+
+            size_t empty_index = 0;
+            size_t stream = 0;
+            size_t folder = 0;
+            uint64_t in_folder = 0;
+            uint64_t folder_offset = 0;
+            for (size_t i = 0; i < index.files.size(); ++i) {
+                File& file = index.files[i];
+                if (empty_stream[i]) {
+                    bool is_empty_file = empty_index < empty_file.size() && empty_file[empty_index];
+                    file.is_anti = empty_index < anti.size() && anti[empty_index];
+                    file.is_directory = !is_empty_file;
+                    ++empty_index;
+                    continue;
+                }
+                // Skip folders that hold no files.
+                while (folder < streams.folders.size() && in_folder >= streams.streams_per_folder[folder]) {
+                    ++folder;
+                    in_folder = 0;
+                    folder_offset = 0;
+                }
+                if (folder >= streams.folders.size() || stream >= streams.stream_sizes.size()) {
+                    reader.fail();
+                    return;
+                }
+                Folder& owner = index.folders[folder];
+                if (in_folder == 0) owner.first_file = i;
+                owner.file_count = i - owner.first_file + 1;
+                file.has_stream = true;
+                file.folder = folder;
+                file.folder_offset = folder_offset;
+                file.size = streams.stream_sizes[stream];
+                file.has_crc = streams.stream_has_crc[stream];
+                file.crc = streams.stream_crcs[stream];
+                folder_offset += file.size;
+                ++stream;
+                ++in_folder;
+            }
+            // FILE_ATTRIBUTE_DIRECTORY also marks directories written with an empty stream bit missing.
+            for (auto& file : index.files) {
+                if (file.attributes & 0x10) file.is_directory = true;
+            }
+        }
+
+        bool read_header(const std::vector<uint8_t>& header, Index& index) {
+            Reader reader(header, 1);
+            StreamsInfo streams;
+            uint8_t type = reader.byte();
+            if (type == kArchiveProperties) {
+                while (reader.ok()) {
+                    if (reader.byte() == 0) break;
+                    uint64_t size = reader.number();
+                    reader.bytes(static_cast<size_t>(std::min<uint64_t>(size, reader.remaining() + 1)));
+                }
+                type = reader.byte();
+            }
+            if (type == kAdditionalStreamsInfo) {
+                read_streams_info(reader);
+                type = reader.byte();
+            }
+            if (type == kMainStreamsInfo) {
+                streams = read_streams_info(reader);
+                index.folders = streams.folders;
+                type = reader.byte();
+            }
+            if (type == kFilesInfo) {
+                read_files_info(reader, streams, index);
+                type = reader.byte();
+            }
+            return reader.ok() && type == kEnd;
+        }
+
+        bool read_file_range(const std::string& path, uint64_t offset, uint64_t size, std::vector<uint8_t>& out) {
+            std::ifstream input(path, std::ios::binary);
+            if (!input) return false;
+            out.resize(static_cast<size_t>(size));
+            input.seekg(static_cast<std::streamoff>(offset));
+            return static_cast<bool>(input.read(reinterpret_cast<char*>(out.data()), static_cast<std::streamsize>(size)));
+        }
+
+        bool id_is(const Coder& coder, std::initializer_list<uint8_t> id) {
+            return coder.id.size() == id.size() && std::equal(id.begin(), id.end(), coder.id.begin());
+        }
+
+        // liblzma filter for a coder; LZMA_VLI_UNKNOWN when liblzma has none. Copy is id 0.
+        lzma_vli filter_id(const Coder& coder) {
+            if (id_is(coder, {0x00})) return 0;
+            if (id_is(coder, {0x21})) return LZMA_FILTER_LZMA2;
+            if (id_is(coder, {0x03, 0x01, 0x01})) return LZMA_FILTER_LZMA1;
+            if (id_is(coder, {0x03})) return LZMA_FILTER_DELTA;
+            if (id_is(coder, {0x03, 0x03, 0x01, 0x03})) return LZMA_FILTER_X86;
+            if (id_is(coder, {0x03, 0x03, 0x02, 0x05})) return LZMA_FILTER_POWERPC;
+            if (id_is(coder, {0x03, 0x03, 0x04, 0x01})) return LZMA_FILTER_IA64;
+            if (id_is(coder, {0x03, 0x03, 0x05, 0x01})) return LZMA_FILTER_ARM;
+            if (id_is(coder, {0x03, 0x03, 0x07, 0x01})) return LZMA_FILTER_ARMTHUMB;
+            if (id_is(coder, {0x03, 0x03, 0x08, 0x05})) return LZMA_FILTER_SPARC;
+#ifdef LZMA_FILTER_ARM64
+            if (id_is(coder, {0x0A})) return LZMA_FILTER_ARM64;
+#endif
+            return LZMA_VLI_UNKNOWN;
+        }
+
+        size_t main_output(const Folder& folder) {
+            for (size_t out = 0; out < folder.unpack_sizes.size(); ++out) {
+                bool bound = std::any_of(folder.bind_pairs.begin(), folder.bind_pairs.end(),
+                    [&](const auto& pair) { return pair.second == out; });
+                if (!bound) return out;
+            }
+            return 0;
+        }
+
+        // Coders from the folder's output back to its single packed stream, which is the
+        // order liblzma expects a filter chain in. Empty when the folder is not a simple chain.
+        std::vector<size_t> coder_chain(const Folder& folder) {
+            std::vector<size_t> chain;
+            for (const auto& coder : folder.coders) {
+                if (coder.in_streams != 1 || coder.out_streams != 1) return {};
+            }
+            if (folder.packed_streams.size() != 1) return {};
+            std::vector<bool> seen(folder.coders.size(), false);
+            size_t coder = main_output(folder);
+            while (true) {
+                if (coder >= folder.coders.size() || seen[coder]) return {};
+                seen[coder] = true;
+                chain.push_back(coder);
+                auto bound = std::find_if(folder.bind_pairs.begin(), folder.bind_pairs.end(),
+                    [&](const auto& pair) { return pair.first == coder; });
+                if (bound == folder.bind_pairs.end()) break;
+                coder = static_cast<size_t>(bound->second);
+            }
+            if (chain.size() != folder.coders.size() || folder.packed_streams[0] != chain.back()) return {};
+            return chain;
+        }
+
+        std::string dictionary_name(uint64_t size) {
+            for (int bits = 0; bits < 64; ++bits) {
+                if (size == (1ull << bits)) return std::to_string(bits);
+            }
+            if (size % (1u << 20) == 0) return std::to_string(size >> 20) + "m";
+            if (size % (1u << 10) == 0) return std::to_string(size >> 10) + "k";
+            return std::to_string(size);
+        }
+
+        std::string coder_name(const Coder& coder) {
+            const auto& props = coder.properties;
+            if (id_is(coder, {0x00})) return "Copy";
+            if (id_is(coder, {0x21})) {
+                if (props.size() != 1 || props[0] > 40) return "LZMA2";
+                if (props[0] == 40) return "LZMA2:4g";
+                uint64_t dictionary = (2ull | (props[0] & 1u)) << (props[0] / 2 + 11);
+                return "LZMA2:" + dictionary_name(dictionary);
+            }
+            if (id_is(coder, {0x03, 0x01, 0x01})) {
+                return props.size() == 5 ? "LZMA:" + dictionary_name(le32(props.data() + 1)) : "LZMA";
+            }
+            if (id_is(coder, {0x03})) return props.size() == 1 ? "Delta:" + std::to_string(props[0] + 1) : "Delta";
+            if (id_is(coder, {0x03, 0x03, 0x01, 0x03})) return "BCJ";
+            if (id_is(coder, {0x03, 0x03, 0x01, 0x1B})) return "BCJ2";
+            if (id_is(coder, {0x03, 0x03, 0x02, 0x05})) return "PPC";
+            if (id_is(coder, {0x03, 0x03, 0x04, 0x01})) return "IA64";
+            if (id_is(coder, {0x03, 0x03, 0x05, 0x01})) return "ARM";
+            if (id_is(coder, {0x03, 0x03, 0x07, 0x01})) return "ARMT";
+            if (id_is(coder, {0x03, 0x03, 0x08, 0x05})) return "SPARC";
+            if (id_is(coder, {0x0A})) return "ARM64";
+            if (id_is(coder, {0x03, 0x04, 0x01})) return "PPMD";
+            if (id_is(coder, {0x04, 0x01, 0x08})) return "Deflate";
+            if (id_is(coder, {0x04, 0x01, 0x09})) return "Deflate64";
+            if (id_is(coder, {0x04, 0x02, 0x02})) return "BZip2";
+            if (id_is(coder, {0x04, 0xF7, 0x11, 0x01})) return "ZSTD";
+            if (id_is(coder, {0x06, 0xF1, 0x07, 0x01})) return "7zAES";
+            std::string hex;
+            char digits[4];
+            for (uint8_t byte : coder.id) {
+                std::snprintf(digits, sizeof(digits), "%02X", byte);
+                hex += digits;
+            }
+            return hex;
+        }
+
+        struct FilterChain {
+            std::array<lzma_filter, LZMA_FILTERS_MAX + 1> filters{};
+            size_t count = 0;
+
+            ~FilterChain() {
+                for (size_t i = 0; i < count; ++i) std::free(filters[i].options);
+            }
+        };
+
+        bool build_filters(const Folder& folder, FilterChain& chain) {
+            for (size_t coder_index : coder_chain(folder)) {
+                const Coder& coder = folder.coders[coder_index];
+                lzma_vli id = filter_id(coder);
+                if (id == LZMA_VLI_UNKNOWN) return false;
+                if (id == 0) continue;
+                if (chain.count == LZMA_FILTERS_MAX) return false;
+                lzma_filter& filter = chain.filters[chain.count];
+                filter.id = id;
+                filter.options = nullptr;
+                if (lzma_properties_decode(&filter, nullptr, coder.properties.data(), coder.properties.size()) != LZMA_OK) return false;
+                ++chain.count;
+            }
+            chain.filters[chain.count].id = LZMA_VLI_UNKNOWN;
+            // liblzma chains must end in LZMA1/LZMA2; a bare BCJ or Delta folder is not something encoders write.
+            return chain.count == 0 ||
+                   chain.filters[chain.count - 1].id == LZMA_FILTER_LZMA1 || chain.filters[chain.count - 1].id == LZMA_FILTER_LZMA2;
+        }
+    }
+
+    uint64_t Folder::unpack_size() const {
+        return unpack_sizes.empty() ? 0 : unpack_sizes[main_output(*this)];
+    }
+
+    uint64_t Folder::packed_size() const {
+        uint64_t total = 0;
+        for (uint64_t size : packed_sizes) total += size;
+        return total;
+    }
+
+    bool has_signature(const std::string& path) {
+        std::ifstream input(path, std::ios::binary);
+        unsigned char magic[sizeof(kSignature)] = {};
+        return input.read(reinterpret_cast<char*>(magic), sizeof(magic)) && std::memcmp(magic, kSignature, sizeof(magic)) == 0;
+    }
+
+    Index read_index(const std::string& path) {
+        trace::Span span("index_7z", "native");
+        Index index;
+        std::error_code ec;
+        uint64_t file_size = fs::file_size(path, ec);
+        std::vector<uint8_t> start;
+        if (ec || file_size < kSignatureHeaderSize || !read_file_range(path, 0, kSignatureHeaderSize, start)) return index;
+        if (std::memcmp(start.data(), kSignature, sizeof(kSignature)) != 0) return index;
+        if (checksum::crc32(0, start.data() + 12, 20) != le32(start.data() + 8)) return index;
+
+        uint64_t next_offset = le64(start.data() + 12);
+        uint64_t next_size = le64(start.data() + 20);
+        uint32_t next_crc = le32(start.data() + 28);
+        if (next_size == 0) {
+            index.valid = true;
+            return index;
+        }
+        if (next_size > kMaxHeaderSize || next_offset > file_size ||
+            kSignatureHeaderSize + next_offset + next_size > file_size) {
+            return index;
+        }
+
+        std::vector<uint8_t> header;
+        if (!read_file_range(path, kSignatureHeaderSize + next_offset, next_size, header)) return index;
+        if (checksum::crc32(0, header.data(), header.size()) != next_crc) return index;
+
+        // Archives written with header compression (the 7-Zip default) pack the real header
+        // into a folder of its own, described by a small streams-info record.
+        while (!header.empty() && header[0] == kEncodedHeader) {
+            Reader reader(header, 1);
+            StreamsInfo streams = read_streams_info(reader);
+            if (!reader.ok() || streams.folders.empty()) return index;
+            const Folder& folder = streams.folders.front();
+            if (!can_decode(folder)) {
+                index.needs_tool = true;
+                return index;
+            }
+            uint64_t size = folder.unpack_size();
+            if (size > kMaxHeaderSize || folder.pack_offset + folder.packed_size() > file_size) return index;
+            std::vector<uint8_t> decoded;
+            decoded.reserve(static_cast<size_t>(std::min<uint64_t>(size, 16u << 20)));
+            bool ok = decode_folder(path, folder, [&](const char* data, size_t length) {
+                decoded.insert(decoded.end(), data, data + length);
+                return true;
+            });
+            if (!ok || decoded.size() != size) return index;
+            if (folder.has_crc && checksum::crc32(0, decoded.data(), decoded.size()) != folder.crc) return index;
+            header.swap(decoded);
+        }
+        if (header.empty() || header[0] != kHeader) return index;
+
+        index.valid = read_header(header, index);
+        if (!index.valid) {
+            index.files.clear();
+            index.folders.clear();
+        }
+        span.arg("files", static_cast<int64_t>(index.files.size()));
+        span.arg("folders", static_cast<int64_t>(index.folders.size()));
+        return index;
+    }
+
+    std::string method_name(const Folder& folder) {
+        std::string name;
+        // 7-Zip lists the coder nearest the packed data first.
+        for (auto it = folder.coders.rbegin(); it != folder.coders.rend(); ++it) {
+            if (!name.empty()) name += ' ';
+            name += coder_name(*it);
+        }
+        return name;
+    }
+
+    bool can_decode(const Folder& folder) {
+        FilterChain chain;
+        return !coder_chain(folder).empty() && build_filters(folder, chain);
+    }
+
+    bool decode_folder(const std::string& path, const Folder& folder, const std::function<bool(const char*, size_t)>& sink) {
+        trace::Span span("decode_7z_folder", "native");
+        FilterChain chain;
+        if (coder_chain(folder).empty() || !build_filters(folder, chain)) return false;
+
+        std::ifstream input(path, std::ios::binary);
+        if (!input) return false;
+        input.seekg(static_cast<std::streamoff>(folder.pack_offset));
+
+        uint64_t packed_left = folder.packed_size();
+        uint64_t output_left = folder.unpack_size();
+        std::vector<uint8_t> in_buffer(64 * 1024);
+        std::vector<uint8_t> out_buffer(256 * 1024);
+
+        if (chain.count == 0) {
+            if (packed_left < output_left) return false;
+            while (output_left > 0) {
+                size_t want = static_cast<size_t>(std::min<uint64_t>(output_left, out_buffer.size()));
+                if (!input.read(reinterpret_cast<char*>(out_buffer.data()), static_cast<std::streamsize>(want))) return false;
+                output_left -= want;
+                if (!sink(reinterpret_cast<const char*>(out_buffer.data()), want)) return true;
+            }
+            return true;
+        }
+
+        lzma_stream stream = LZMA_STREAM_INIT;
+        if (lzma_raw_decoder(&stream, chain.filters.data()) != LZMA_OK) return false;
+        bool ok = true;
+        while (output_left > 0) {
+            if (stream.avail_in == 0 && packed_left > 0) {
+                size_t want = static_cast<size_t>(std::min<uint64_t>(packed_left, in_buffer.size()));
+                if (!input.read(reinterpret_cast<char*>(in_buffer.data()), static_cast<std::streamsize>(want))) {
+                    ok = false;
+                    break;
+                }
+                packed_left -= want;
+                stream.next_in = in_buffer.data();
+                stream.avail_in = want;
+            }
+            // LZMA1 streams in 7z carry no end marker, so the output size is what ends decoding.
+            size_t room = static_cast<size_t>(std::min<uint64_t>(output_left, out_buffer.size()));
+            stream.next_out = out_buffer.data();
+            stream.avail_out = room;
+            lzma_ret result = lzma_code(&stream, packed_left == 0 ? LZMA_FINISH : LZMA_RUN);
+            size_t produced = room - stream.avail_out;
+            output_left -= produced;
+            if (produced > 0 && !sink(reinterpret_cast<const char*>(out_buffer.data()), produced)) break;
+            if (result == LZMA_STREAM_END) {
+                ok = output_left == 0;
+                break;
+            }
+            if (result != LZMA_OK || (produced == 0 && stream.avail_in == 0 && packed_left == 0)) {
+                ok = false;
+                break;
+            }
+        }
+        lzma_end(&stream);
+        return ok;
+    }
+}
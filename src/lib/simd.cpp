@@ -0,0 +1,482 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "include/simd.h"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HITPAG_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace simd {
+    namespace {
+        using Crc32Fn = uint32_t (*)(uint32_t, const unsigned char*, size_t);
+        using FindByteFn = size_t (*)(const char*, size_t, char);
+        using FindNocaseFn = size_t (*)(const char*, size_t, const char*, size_t);
+        using CountFn = size_t (*)(const char*, size_t);
+
+        struct Kernels {
+            Level level;
+            const char* crc32_name;
+            Crc32Fn crc32;
+            const char* vector_name;
+            FindByteFn find_byte;
+            FindNocaseFn find_nocase;
+            CountFn count_control;
+        };
+
+        // ---- scalar ----
+
+        using Crc32Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+        Crc32Tables make_crc32_tables() {
+            Crc32Tables tables{};
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t value = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    value = (value & 1) ? (value >> 1) ^ 0xEDB88320u : value >> 1;
+                }
+                tables[0][i] = value;
+            }
+            for (size_t k = 1; k < tables.size(); ++k) {
+                for (uint32_t i = 0; i < 256; ++i) {
+                    tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+                }
+            }
+            return tables;
+        }
+
+        uint32_t load_le32(const unsigned char* p) {
+            return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+                   static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+        }
+
+        // Slicing-by-8: eight table lookups per eight input bytes instead of one per byte.
+        uint32_t crc32_slice8(uint32_t crc, const unsigned char* bytes, size_t length) {
+            static const Crc32Tables tables = make_crc32_tables();
+            crc = ~crc;
+            while (length >= 8) {
+                uint32_t low = load_le32(bytes) ^ crc;
+                uint32_t high = load_le32(bytes + 4);
+                crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^
+                      tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24] ^
+                      tables[3][high & 0xFF] ^ tables[2][(high >> 8) & 0xFF] ^
+                      tables[1][(high >> 16) & 0xFF] ^ tables[0][high >> 24];
+                bytes += 8;
+                length -= 8;
+            }
+            while (length-- > 0) {
+                crc = tables[0][(crc ^ *bytes++) & 0xFF] ^ (crc >> 8);
+            }
+            return ~crc;
+        }
+
+        size_t find_byte_scalar(const char* data, size_t length, char byte) {
+            for (size_t i = 0; i < length; ++i) {
+                if (data[i] == byte) return i;
+            }
+            return length;
+        }
+
+        char ascii_lower(char c) {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+        }
+
+        bool equal_nocase(const char* text, const char* needle, size_t length) {
+            for (size_t i = 0; i < length; ++i) {
+                if (ascii_lower(text[i]) != needle[i]) return false;
+            }
+            return true;
+        }
+
+        size_t find_nocase_scalar(const char* haystack, size_t length, const char* needle, size_t needle_length) {
+            if (needle_length > length) return npos;
+            for (size_t i = 0; i + needle_length <= length; ++i) {
+                if (equal_nocase(haystack + i, needle, needle_length)) return i;
+            }
+            return npos;
+        }
+
+        bool is_control(unsigned char c) {
+            return c < 32 && c != '\n' && c != '\r' && c != '\t';
+        }
+
+        size_t count_control_scalar(const char* data, size_t length) {
+            size_t count = 0;
+            for (size_t i = 0; i < length; ++i) {
+                if (is_control(static_cast<unsigned char>(data[i]))) ++count;
+            }
+            return count;
+        }
+
+        // Finishes a vector search on the tail the vector loop could not cover.
+        size_t find_nocase_tail(const char* haystack, size_t length, const char* needle, size_t needle_length, size_t from) {
+            size_t rest = find_nocase_scalar(haystack + from, length - from, needle, needle_length);
+            return rest == npos ? npos : from + rest;
+        }
+
+#ifdef HITPAG_SIMD_X86
+        // ---- SSE4.2 / PCLMUL ----
+
+        __attribute__((target("sse4.2,pclmul")))
+        __m128i fold128(__m128i value, __m128i next, __m128i constants) {
+            __m128i low = _mm_clmulepi64_si128(value, constants, 0x00);
+            __m128i high = _mm_clmulepi64_si128(value, constants, 0x11);
+            return _mm_xor_si128(_mm_xor_si128(high, next), low);
+        }
+
+        // Folds 64-byte blocks with carry-less multiplies and finishes with a Barrett reduction
+        // (Gopal et al., "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ").
+        // `length` is a multiple of 16 and at least 64; crc is the inverted running value.
+        __attribute__((target("sse4.2,pclmul")))
+        uint32_t crc32_fold(const unsigned char* bytes, size_t length, uint32_t crc) {
+            const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+            const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+            const __m128i k5k0 = _mm_set_epi64x(0, 0x0163cd6124);
+            const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+
+            __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+            __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 16));
+            __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 32));
+            __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 48));
+            x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+            bytes += 64;
+            length -= 64;
+
+            while (length >= 64) {
+                __m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+                __m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+                __m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+                __m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+                x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+                x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+                x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+                x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+                x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes)));
+                x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 16)));
+                x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 32)));
+                x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 48)));
+                bytes += 64;
+                length -= 64;
+            }
+
+            x1 = fold128(x1, x2, k3k4);
+            x1 = fold128(x1, x3, k3k4);
+            x1 = fold128(x1, x4, k3k4);
+            while (length >= 16) {
+                x1 = fold128(x1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes)), k3k4);
+                bytes += 16;
+                length -= 16;
+            }
+
+            const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+            x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+            x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+            x2 = _mm_srli_si128(x1, 4);
+            x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k5k0, 0x00);
+            x1 = _mm_xor_si128(x1, x2);
+
+            x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), poly, 0x10);
+            x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask32), poly, 0x00);
+            x1 = _mm_xor_si128(x1, x2);
+            return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+        }
+
+        uint32_t crc32_pclmul(uint32_t crc, const unsigned char* bytes, size_t length) {
+            if (length >= 64) {
+                size_t folded = length & ~static_cast<size_t>(15);
+                crc = ~crc32_fold(bytes, folded, ~crc);
+                bytes += folded;
+                length -= folded;
+            }
+            return crc32_slice8(crc, bytes, length);
+        }
+
+        __attribute__((target("sse4.2")))
+        size_t find_byte_sse42(const char* data, size_t length, char byte) {
+            const __m128i target = _mm_set1_epi8(byte);
+            size_t i = 0;
+            for (; i + 16 <= length; i += 16) {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, target));
+                if (mask) return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+            }
+            return i + find_byte_scalar(data + i, length - i, byte);
+        }
+
+        // Candidates match the needle's first and last byte with bit 5 forced on, which is
+        // a superset of case-insensitive matches; each candidate is then checked in full.
+        __attribute__((target("sse4.2")))
+        size_t find_nocase_sse42(const char* haystack, size_t length, const char* needle, size_t needle_length) {
+            if (needle_length == 0) return 0;
+            if (needle_length > length) return npos;
+            const __m128i fold = _mm_set1_epi8(0x20);
+            const __m128i first = _mm_set1_epi8(static_cast<char>(needle[0] | 0x20));
+            const __m128i last = _mm_set1_epi8(static_cast<char>(needle[needle_length - 1] | 0x20));
+            size_t starts = length - needle_length + 1;
+            size_t i = 0;
+            for (; i + 16 <= starts; i += 16) {
+                __m128i a = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i)), fold);
+                __m128i b = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i + needle_length - 1)), fold);
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+                while (mask) {
+                    size_t at = i + static_cast<size_t>(__builtin_ctz(mask));
+                    if (equal_nocase(haystack + at, needle, needle_length)) return at;
+                    mask &= mask - 1;
+                }
+            }
+            return find_nocase_tail(haystack, length, needle, needle_length, i);
+        }
+
+        __attribute__((target("sse4.2")))
+        size_t count_control_sse42(const char* data, size_t length) {
+            const __m128i limit = _mm_set1_epi8(0x1F);
+            const __m128i tab = _mm_set1_epi8('\t');
+            const __m128i newline = _mm_set1_epi8('\n');
+            const __m128i carriage = _mm_set1_epi8('\r');
+            size_t count = 0;
+            size_t i = 0;
+            for (; i + 16 <= length; i += 16) {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                __m128i low = _mm_cmpeq_epi8(_mm_min_epu8(block, limit), block);
+                __m128i allowed = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, tab), _mm_cmpeq_epi8(block, newline)),
+                                               _mm_cmpeq_epi8(block, carriage));
+                count += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(_mm_movemask_epi8(_mm_andnot_si128(allowed, low)))));
+            }
+            return count + count_control_scalar(data + i, length - i);
+        }
+
+        // ---- AVX2 ----
+
+        __attribute__((target("avx2")))
+        size_t find_byte_avx2(const char* data, size_t length, char byte) {
+            const __m256i target = _mm256_set1_epi8(byte);
+            size_t i = 0;
+            for (; i + 32 <= length; i += 32) {
+                __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, target)));
+                if (mask) return i + static_cast<size_t>(__builtin_ctz(mask));
+            }
+            return i + find_byte_scalar(data + i, length - i, byte);
+        }
+
+        __attribute__((target("avx2")))
+        size_t find_nocase_avx2(const char* haystack, size_t length, const char* needle, size_t needle_length) {
+            if (needle_length == 0) return 0;
+            if (needle_length > length) return npos;
+            const __m256i fold = _mm256_set1_epi8(0x20);
+            const __m256i first = _mm256_set1_epi8(static_cast<char>(needle[0] | 0x20));
+            const __m256i last = _mm256_set1_epi8(static_cast<char>(needle[needle_length - 1] | 0x20));
+            size_t starts = length - needle_length + 1;
+            size_t i = 0;
+            for (; i + 32 <= starts; i += 32) {
+                __m256i a = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i)), fold);
+                __m256i b = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i + needle_length - 1)), fold);
+                unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last))));
+                while (mask) {
+                    size_t at = i + static_cast<size_t>(__builtin_ctz(mask));
+                    if (equal_nocase(haystack + at, needle, needle_length)) return at;
+                    mask &= mask - 1;
+                }
+            }
+            return find_nocase_tail(haystack, length, needle, needle_length, i);
+        }
+
+        __attribute__((target("avx2")))
+        size_t count_control_avx2(const char* data, size_t length) {
+            const __m256i limit = _mm256_set1_epi8(0x1F);
+            const __m256i tab = _mm256_set1_epi8('\t');
+            const __m256i newline = _mm256_set1_epi8('\n');
+            const __m256i carriage = _mm256_set1_epi8('\r');
+            size_t count = 0;
+            size_t i = 0;
+            for (; i + 32 <= length; i += 32) {
+                __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                __m256i low = _mm256_cmpeq_epi8(_mm256_min_epu8(block, limit), block);
+                __m256i allowed = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, tab), _mm256_cmpeq_epi8(block, newline)),
+                                                  _mm256_cmpeq_epi8(block, carriage));
+                count += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(_mm256_movemask_epi8(_mm256_andnot_si256(allowed, low)))));
+            }
+            return count + count_control_scalar(data + i, length - i);
+        }
+
+        // ---- AVX-512BW ----
+
+        __attribute__((target("avx512bw")))
+        size_t find_byte_avx512(const char* data, size_t length, char byte) {
+            const __m512i target = _mm512_set1_epi8(byte);
+            size_t i = 0;
+            for (; i + 64 <= length; i += 64) {
+                __mmask64 mask = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(data + i), target);
+                if (mask) return i + static_cast<size_t>(__builtin_ctzll(mask));
+            }
+            return i + find_byte_scalar(data + i, length - i, byte);
+        }
+
+        __attribute__((target("avx512bw")))
+        size_t find_nocase_avx512(const char* haystack, size_t length, const char* needle, size_t needle_length) {
+            if (needle_length == 0) return 0;
+            if (needle_length > length) return npos;
+            const __m512i fold = _mm512_set1_epi8(0x20);
+            const __m512i first = _mm512_set1_epi8(static_cast<char>(needle[0] | 0x20));
+            const __m512i last = _mm512_set1_epi8(static_cast<char>(needle[needle_length - 1] | 0x20));
+            size_t starts = length - needle_length + 1;
+            size_t i = 0;
+            for (; i + 64 <= starts; i += 64) {
+                __m512i a = _mm512_or_si512(_mm512_loadu_si512(haystack + i), fold);
+                __m512i b = _mm512_or_si512(_mm512_loadu_si512(haystack + i + needle_length - 1), fold);
+                __mmask64 mask = _mm512_cmpeq_epi8_mask(a, first) & _mm512_cmpeq_epi8_mask(b, last);
+                while (mask) {
+                    size_t at = i + static_cast<size_t>(__builtin_ctzll(mask));
+                    if (equal_nocase(haystack + at, needle, needle_length)) return at;
+                    mask &= mask - 1;
+                }
+            }
+            return find_nocase_tail(haystack, length, needle, needle_length, i);
+        }
+
+        __attribute__((target("avx512bw")))
+        size_t count_control_avx512(const char* data, size_t length) {
+            const __m512i limit = _mm512_set1_epi8(0x1F);
+            const __m512i tab = _mm512_set1_epi8('\t');
+            const __m512i newline = _mm512_set1_epi8('\n');
+            const __m512i carriage = _mm512_set1_epi8('\r');
+            size_t count = 0;
+            size_t i = 0;
+            for (; i + 64 <= length; i += 64) {
+                __m512i block = _mm512_loadu_si512(data + i);
+                __mmask64 low = _mm512_cmple_epu8_mask(block, limit);
+                __mmask64 allowed = _mm512_cmpeq_epi8_mask(block, tab) | _mm512_cmpeq_epi8_mask(block, newline) |
+                                    _mm512_cmpeq_epi8_mask(block, carriage);
+                count += static_cast<size_t>(__builtin_popcountll(low & ~allowed));
+            }
+            return count + count_control_scalar(data + i, length - i);
+        }
+#endif
+
+        const Kernels kScalar{Level::Scalar, "slice8", crc32_slice8, "scalar", find_byte_scalar, find_nocase_scalar, count_control_scalar};
+#ifdef HITPAG_SIMD_X86
+        const Kernels kSSE42{Level::SSE42, "slice8", crc32_slice8, "sse4.2", find_byte_sse42, find_nocase_sse42, count_control_sse42};
+        const Kernels kAVX2{Level::AVX2, "slice8", crc32_slice8, "avx2", find_byte_avx2, find_nocase_avx2, count_control_avx2};
+        const Kernels kAVX512{Level::AVX512, "slice8", crc32_slice8, "avx512bw", find_byte_avx512, find_nocase_avx512, count_control_avx512};
+#endif
+
+        Level supported_level() {
+            const CpuFeatures& cpu = cpu_features();
+            if (cpu.avx512bw) return Level::AVX512;
+            if (cpu.avx2) return Level::AVX2;
+            if (cpu.sse42) return Level::SSE42;
+            return Level::Scalar;
+        }
+
+        Kernels make_kernels(Level level) {
+            Kernels kernels = kScalar;
+#ifdef HITPAG_SIMD_X86
+            if (level >= Level::AVX512) kernels = kAVX512;
+            else if (level >= Level::AVX2) kernels = kAVX2;
+            else if (level >= Level::SSE42) kernels = kSSE42;
+            // The carry-less CRC only needs PCLMUL next to SSE4.1, independent of the vector width.
+            if (level >= Level::SSE42 && cpu_features().pclmul) {
+                kernels.crc32_name = "pclmul";
+                kernels.crc32 = crc32_pclmul;
+            }
+#else
+            (void)level;
+#endif
+            return kernels;
+        }
+
+        std::array<Kernels, 4> make_table() {
+            return {make_kernels(Level::Scalar), make_kernels(Level::SSE42), make_kernels(Level::AVX2), make_kernels(Level::AVX512)};
+        }
+
+        const std::array<Kernels, 4>& kernel_table() {
+            static const std::array<Kernels, 4> table = make_table();
+            return table;
+        }
+
+        std::atomic<const Kernels*>& active() {
+            static std::atomic<const Kernels*> kernels{&kernel_table()[static_cast<size_t>(best_level())]};
+            return kernels;
+        }
+
+        const Kernels& kernels() {
+            return *active().load(std::memory_order_relaxed);
+        }
+    }
+
+    const CpuFeatures& cpu_features() {
+        static const CpuFeatures features = []() {
+            CpuFeatures detected;
+#ifdef HITPAG_SIMD_X86
+            __builtin_cpu_init();
+            detected.sse42 = __builtin_cpu_supports("sse4.2");
+            detected.pclmul = __builtin_cpu_supports("pclmul");
+            detected.avx2 = __builtin_cpu_supports("avx2");
+            detected.avx512bw = __builtin_cpu_supports("avx512bw");
+#endif
+            return detected;
+        }();
+        return features;
+    }
+
+    const char* level_name(Level level) {
+        switch (level) {
+            case Level::Scalar: return "scalar";
+            case Level::SSE42: return "sse4.2";
+            case Level::AVX2: return "avx2";
+            case Level::AVX512: return "avx512";
+        }
+        return "scalar";
+    }
+
+    Level best_level() {
+        Level level = supported_level();
+        const char* cap = std::getenv("HITPAG_SIMD");
+        if (cap) {
+            for (Level candidate : {Level::Scalar, Level::SSE42, Level::AVX2, Level::AVX512}) {
+                if (level_name(candidate) == std::string(cap) && candidate < level) level = candidate;
+            }
+        }
+        return level;
+    }
+
+    Level active_level() {
+        return kernels().level;
+    }
+
+    Level select(Level level) {
+        if (level > supported_level()) level = supported_level();
+        active().store(&kernel_table()[static_cast<size_t>(level)]);
+        return level;
+    }
+
+    std::string describe() {
+        const Kernels& current = kernels();
+        std::string vector = current.vector_name;
+        return std::string("crc32=") + current.crc32_name + " search=" + vector + " newline=" + vector + " classify=" + vector;
+    }
+
+    uint32_t crc32(uint32_t crc, const void* data, size_t length) {
+        return kernels().crc32(crc, static_cast<const unsigned char*>(data), length);
+    }
+
+    size_t find_byte(const char* data, size_t length, char byte) {
+        return kernels().find_byte(data, length, byte);
+    }
+
+    size_t find_ascii_nocase(const char* haystack, size_t length, const char* needle, size_t needle_length) {
+        return kernels().find_nocase(haystack, length, needle, needle_length);
+    }
+
+    size_t count_control(const char* data, size_t length) {
+        return kernels().count_control(data, length);
+    }
+}
@@ -0,0 +1,262 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "include/stream_probe.h"
+#include "include/checksum.h"
+#include "include/trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace stream_probe {
+    namespace {
+        constexpr uint32_t kZstdMagic = 0xFD2FB528;
+        constexpr uint32_t kLz4Magic = 0x184D2204;
+        constexpr uint32_t kLz4LegacyMagic = 0x184C2102;
+        constexpr uint32_t kSkippableMask = 0xFFFFFFF0;
+        constexpr uint32_t kSkippableMagic = 0x184D2A50;
+        constexpr unsigned char kXzHeaderMagic[6] = {0xFD, '7', 'z', 'X', 'Z', 0x00};
+        // An xz index holds two varints per block; anything beyond this is not a real index.
+        constexpr uint64_t kMaxXzIndex = 64ull << 20;
+
+        uint32_t le32(const unsigned char* p) {
+            return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                   (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+
+        uint64_t le_n(const unsigned char* p, size_t bytes) {
+            uint64_t value = 0;
+            for (size_t i = bytes; i-- > 0;) value = (value << 8) | p[i];
+            return value;
+        }
+
+        class File {
+        public:
+            explicit File(const std::string& path) : input_(path, std::ios::binary) {
+                std::error_code ec;
+                size_ = fs::file_size(path, ec);
+                if (ec || !input_) size_ = 0;
+            }
+
+            uint64_t size() const { return size_; }
+
+            bool read(uint64_t offset, unsigned char* out, size_t count) {
+                if (offset > size_ || count > size_ - offset) return false;
+                input_.clear();
+                input_.seekg(static_cast<std::streamoff>(offset));
+                return static_cast<bool>(input_.read(reinterpret_cast<char*>(out), static_cast<std::streamsize>(count)));
+            }
+
+        private:
+            std::ifstream input_;
+            uint64_t size_ = 0;
+        };
+
+        // Skippable frames are shared by zstd and lz4: magic, 32-bit length, payload.
+        bool skip_skippable(File& file, uint64_t& pos) {
+            unsigned char length[4];
+            if (!file.read(pos + 4, length, sizeof(length))) return false;
+            pos += 8 + static_cast<uint64_t>(le32(length));
+            return pos <= file.size();
+        }
+
+        Probe finish(Probe probe, bool ok, bool all_sized) {
+            probe.valid = ok && probe.frames > 0;
+            probe.size_known = probe.valid && all_sized;
+            if (!probe.size_known) probe.content_size = 0;
+            return probe;
+        }
+    }
+
+    Probe zstd(const std::string& path) {
+        trace::Span span("probe_zstd", "native");
+        File file(path);
+        Probe probe;
+        bool all_sized = true;
+        uint64_t pos = 0;
+        while (pos < file.size()) {
+            unsigned char head[18];
+            size_t head_size = static_cast<size_t>(std::min<uint64_t>(sizeof(head), file.size() - pos));
+            if (head_size < 4 || !file.read(pos, head, head_size)) return finish(probe, false, all_sized);
+            uint32_t magic = le32(head);
+            if ((magic & kSkippableMask) == kSkippableMagic) {
+                if (!skip_skippable(file, pos)) return finish(probe, false, all_sized);
+                continue;
+            }
+            if (magic != kZstdMagic || head_size < 6) return finish(probe, false, all_sized);
+
+            uint8_t descriptor = head[4];
+            if (descriptor & 0x08) return finish(probe, false, all_sized);
+            bool single_segment = (descriptor & 0x20) != 0;
+            static const size_t kDictBytes[4] = {0, 1, 2, 4};
+            size_t fcs_flag = descriptor >> 6;
+            size_t fcs_bytes = fcs_flag == 0 ? (single_segment ? 1 : 0) : (size_t{1} << fcs_flag);
+            size_t fcs_at = 5 + (single_segment ? 0 : 1) + kDictBytes[descriptor & 0x03];
+            if (fcs_at + fcs_bytes > head_size) return finish(probe, false, all_sized);
+            if (fcs_bytes == 0) {
+                all_sized = false;
+            } else {
+                uint64_t content = le_n(head + fcs_at, fcs_bytes);
+                probe.content_size += fcs_bytes == 2 ? content + 256 : content;
+            }
+
+            // Block headers: last flag, type (raw, RLE, compressed, reserved), size.
+            pos += fcs_at + fcs_bytes;
+            bool last = false;
+            while (!last) {
+                unsigned char block[3];
+                if (!file.read(pos, block, sizeof(block))) return finish(probe, false, all_sized);
+                uint32_t header = static_cast<uint32_t>(le_n(block, 3));
+                last = (header & 1) != 0;
+                uint32_t type = (header >> 1) & 3;
+                if (type == 3) return finish(probe, false, all_sized);
+                pos += 3 + (type == 1 ? 1 : header >> 3);
+                if (pos > file.size()) return finish(probe, false, all_sized);
+            }
+            if (descriptor & 0x04) pos += 4;
+            if (pos > file.size()) return finish(probe, false, all_sized);
+            ++probe.frames;
+        }
+        span.arg("frames", static_cast<int64_t>(probe.frames));
+        return finish(probe, true, all_sized);
+    }
+
+    Probe lz4(const std::string& path) {
+        trace::Span span("probe_lz4", "native");
+        File file(path);
+        Probe probe;
+        bool all_sized = true;
+        uint64_t pos = 0;
+        while (pos < file.size()) {
+            unsigned char head[19];
+            size_t head_size = static_cast<size_t>(std::min<uint64_t>(sizeof(head), file.size() - pos));
+            if (head_size < 4 || !file.read(pos, head, head_size)) return finish(probe, false, all_sized);
+            uint32_t magic = le32(head);
+            if ((magic & kSkippableMask) == kSkippableMagic) {
+                if (!skip_skippable(file, pos)) return finish(probe, false, all_sized);
+                continue;
+            }
+            // Legacy frames carry no sizes and no end mark; nothing after them can be framed.
+            if (magic == kLz4LegacyMagic) {
+                ++probe.frames;
+                return finish(probe, true, false);
+            }
+            if (magic != kLz4Magic || head_size < 7) return finish(probe, false, all_sized);
+
+            uint8_t flags = head[4];
+            if ((flags >> 6) != 1) return finish(probe, false, all_sized);
+            bool block_checksum = (flags & 0x10) != 0;
+            bool has_size = (flags & 0x08) != 0;
+            bool content_checksum = (flags & 0x04) != 0;
+            bool has_dict = (flags & 0x01) != 0;
+            size_t header_size = 4 + 2 + (has_size ? 8 : 0) + (has_dict ? 4 : 0) + 1;
+            if (header_size > head_size) return finish(probe, false, all_sized);
+            if (has_size) probe.content_size += le_n(head + 6, 8);
+            else all_sized = false;
+
+            pos += header_size;
+            for (;;) {
+                unsigned char block[4];
+                if (!file.read(pos, block, sizeof(block))) return finish(probe, false, all_sized);
+                uint32_t size = le32(block) & 0x7FFFFFFF;
+                pos += 4;
+                if (le32(block) == 0) break;
+                pos += size + (block_checksum ? 4 : 0);
+                if (pos > file.size()) return finish(probe, false, all_sized);
+            }
+            if (content_checksum) pos += 4;
+            if (pos > file.size()) return finish(probe, false, all_sized);
+            ++probe.frames;
+        }
+        span.arg("frames", static_cast<int64_t>(probe.frames));
+        return finish(probe, true, all_sized);
+    }
+
+    Probe gzip(const std::string& path) {
+        File file(path);
+        Probe probe;
+        unsigned char head[3];
+        unsigned char trailer[4];
+        // Header, at least an empty deflate block, then CRC32 and ISIZE.
+        if (file.size() < 18 || !file.read(0, head, sizeof(head)) || head[0] != 0x1F || head[1] != 0x8B || head[2] != 8) return probe;
+        if (!file.read(file.size() - 4, trailer, sizeof(trailer))) return probe;
+        probe.frames = 1;
+        probe.content_size = le32(trailer);
+        return finish(probe, true, true);
+    }
+
+    Probe xz(const std::string& path) {
+        trace::Span span("probe_xz", "native");
+        File file(path);
+        Probe probe;
+        uint64_t end = file.size();
+        while (end > 0) {
+            // Stream padding: zero bytes in multiples of four between and after streams.
+            unsigned char word[4];
+            while (end >= 4 && file.read(end - 4, word, 4) && le32(word) == 0) end -= 4;
+            if (end < 24) return finish(probe, false, true);
+
+            unsigned char footer[12];
+            if (!file.read(end - 12, footer, sizeof(footer)) || footer[10] != 'Y' || footer[11] != 'Z') return finish(probe, false, true);
+            if (checksum::crc32(0, footer + 4, 6) != le32(footer)) return finish(probe, false, true);
+            uint64_t index_size = (static_cast<uint64_t>(le32(footer + 4)) + 1) * 4;
+            if (index_size > kMaxXzIndex || index_size + 24 > end) return finish(probe, false, true);
+
+            std::vector<unsigned char> index(static_cast<size_t>(index_size));
+            uint64_t index_at = end - 12 - index_size;
+            if (!file.read(index_at, index.data(), index.size()) || index[0] != 0x00) return finish(probe, false, true);
+            if (checksum::crc32(0, index.data(), index.size() - 4) != le32(&index[index.size() - 4])) return finish(probe, false, true);
+
+            size_t at = 1;
+            bool ok = true;
+            auto vint = [&]() {
+                uint64_t value = 0;
+                for (int shift = 0; shift < 63; shift += 7) {
+                    if (at >= index.size() - 4) break;
+                    uint8_t byte = index[at++];
+                    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                    if ((byte & 0x80) == 0) return value;
+                }
+                ok = false;
+                return uint64_t{0};
+            };
+            uint64_t records = vint();
+            uint64_t blocks_size = 0;
+            for (uint64_t i = 0; i < records && ok; ++i) {
+                uint64_t unpadded = vint();
+                uint64_t uncompressed = vint();
+                blocks_size += (unpadded + 3) & ~uint64_t{3};
+                probe.content_size += uncompressed;
+                if (blocks_size > index_at) ok = false;
+            }
+            if (!ok || index_at < 12 + blocks_size) return finish(probe, false, true);
+
+            uint64_t start = index_at - blocks_size - 12;
+            unsigned char header[6];
+            if (!file.read(start, header, sizeof(header)) || std::memcmp(header, kXzHeaderMagic, sizeof(header)) != 0) return finish(probe, false, true);
+            ++probe.frames;
+            end = start;
+        }
+        span.arg("streams", static_cast<int64_t>(probe.frames));
+        return finish(probe, true, true);
+    }
+
+    Probe probe(const std::string& path, file_type::FileType format) {
+        switch (format) {
+            case file_type::FileType::ARCHIVE_ZSTD:
+            case file_type::FileType::ARCHIVE_TAR_ZSTD: return zstd(path);
+            case file_type::FileType::ARCHIVE_LZ4: return lz4(path);
+            case file_type::FileType::ARCHIVE_TAR_GZ: return gzip(path);
+            case file_type::FileType::ARCHIVE_TAR_XZ: return xz(path);
+            default: return Probe{};
+        }
+    }
+}
@@ -0,0 +1,473 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "include/tar_writer.h"
+#include "include/i18n.h"
+#include "include/tar_header.h"
+#include "include/trace.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <utility>
+
+#include <fcntl.h>
+#include <grp.h>
+#include <pwd.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace tar_writer {
+    namespace {
+        using tar_header::kBlockSize;
+
+        // tar's default blocking factor of 20: the archive is padded to a multiple of this.
+        constexpr size_t kRecordSize = 20 * kBlockSize;
+        constexpr size_t kOutputBuffer = 1024 * 1024;
+        constexpr size_t kNoFile = static_cast<size_t>(-1);
+
+        struct Member {
+            std::string name;
+            std::string source;
+            char type = '0';
+            uint64_t size = 0;
+            uint32_t mode = 0;
+            uint64_t uid = 0;
+            uint64_t gid = 0;
+            int64_t mtime = 0;
+            long mtime_nsec = 0;
+            uint64_t dev_major = 0;
+            uint64_t dev_minor = 0;
+            std::string link;
+            // For a hard link, the file's size, should it have to carry the data after all.
+            uint64_t link_size = 0;
+            // Position in the ingest list for regular files with data.
+            size_t file = kNoFile;
+        };
+
+        class Output {
+        public:
+            explicit Output(int fd) : fd_(fd) { buffer_.reserve(kOutputBuffer); }
+
+            void write(const char* data, size_t size) {
+                written_ += size;
+                while (size > 0) {
+                    size_t take = std::min(size, kOutputBuffer - buffer_.size());
+                    buffer_.insert(buffer_.end(), data, data + take);
+                    data += take;
+                    size -= take;
+                    if (buffer_.size() == kOutputBuffer) flush();
+                }
+            }
+
+            void zeros(size_t count) {
+                static const char kZeros[kBlockSize] = {};
+                while (count > 0) {
+                    size_t take = std::min(count, sizeof(kZeros));
+                    write(kZeros, take);
+                    count -= take;
+                }
+            }
+
+            void pad_block() { zeros(static_cast<size_t>(tar_header::padded_size(written_) - written_)); }
+
+            bool flush() {
+                size_t done = 0;
+                while (ok_ && done < buffer_.size()) {
+                    ssize_t put = ::write(fd_, buffer_.data() + done, buffer_.size() - done);
+                    if (put < 0 && errno == EINTR) continue;
+                    if (put <= 0) ok_ = false;
+                    else done += static_cast<size_t>(put);
+                }
+                buffer_.clear();
+                return ok_;
+            }
+
+            uint64_t written() const { return written_; }
+            bool ok() const { return ok_; }
+
+        private:
+            int fd_;
+            std::vector<char> buffer_;
+            uint64_t written_ = 0;
+            bool ok_ = true;
+        };
+
+        // Octal with a terminating NUL when it fits, else GNU base-256.
+        void put_number(char* field, size_t length, uint64_t value) {
+            uint64_t limit = uint64_t{1} << (3 * (length - 1));
+            if (length - 1 >= 22 || value < limit) {
+                for (size_t i = length - 1; i-- > 0;) {
+                    field[i] = static_cast<char>('0' + (value & 7));
+                    value >>= 3;
+                }
+                field[length - 1] = '\0';
+                return;
+            }
+            std::memset(field, 0, length);
+            for (size_t i = length; i-- > 1 && value > 0;) {
+                field[i] = static_cast<char>(value & 0xFF);
+                value >>= 8;
+            }
+            field[0] = static_cast<char>(0x80);
+        }
+
+        void put_string(char* field, size_t length, const std::string& value) {
+            std::memcpy(field, value.data(), std::min(length, value.size()));
+        }
+
+        // "<length> <key>=<value>\n", where the length counts its own digits.
+        std::string pax_record(const std::string& key, const std::string& value) {
+            size_t body = key.size() + value.size() + 3;
+            size_t length = body + std::to_string(body).size();
+            if (std::to_string(length).size() != std::to_string(body).size()) ++length;
+            return std::to_string(length) + " " + key + "=" + value + "\n";
+        }
+
+        // Splits a long name at a slash into the 155-byte prefix and 100-byte name fields.
+        bool split_name(const std::string& name, std::string& prefix, std::string& rest) {
+            if (name.size() <= 100) {
+                prefix.clear();
+                rest = name;
+                return true;
+            }
+            for (size_t slash = name.find('/'); slash != std::string::npos && slash <= 155; slash = name.find('/', slash + 1)) {
+                if (name.size() - slash - 1 <= 100 && slash + 1 < name.size()) {
+                    prefix = name.substr(0, slash);
+                    rest = name.substr(slash + 1);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        class Archiver {
+        public:
+            Archiver(Output& output, const Options& options) : output_(output), options_(options) {}
+
+            void add(const fs::path& source, const std::string& name, dev_t skip_dev, ino_t skip_ino) {
+                struct stat info {};
+                if (::lstat(source.c_str(), &info) != 0) {
+                    warn(source.string(), std::strerror(errno), 2);
+                    return;
+                }
+                if (info.st_dev == skip_dev && info.st_ino == skip_ino) return;
+
+                Member member;
+                member.name = name;
+                member.source = source.string();
+                member.mode = static_cast<uint32_t>(info.st_mode & 07777);
+                member.uid = info.st_uid;
+                member.gid = info.st_gid;
+                member.mtime = static_cast<int64_t>(info.st_mtim.tv_sec);
+                member.mtime_nsec = info.st_mtim.tv_nsec;
+                if (S_ISDIR(info.st_mode)) {
+                    member.type = '5';
+                    if (member.name.back() != '/') member.name += '/';
+                    std::string parent = member.name;
+                    members_.push_back(std::move(member));
+                    std::vector<std::string> children;
+                    std::error_code ec;
+                    for (fs::directory_iterator it(source, ec), end; !ec && it != end; it.increment(ec)) {
+                        children.push_back(it->path().filename().string());
+                    }
+                    if (ec) warn(source.string(), ec.message(), 2);
+                    std::sort(children.begin(), children.end());
+                    for (const auto& child : children) add(source / child, parent + child, skip_dev, skip_ino);
+                    return;
+                }
+                if (S_ISLNK(info.st_mode)) {
+                    std::error_code ec;
+                    member.type = '2';
+                    member.link = fs::read_symlink(source, ec).string();
+                    if (ec) {
+                        warn(source.string(), ec.message(), 2);
+                        return;
+                    }
+                } else if (S_ISREG(info.st_mode)) {
+                    auto inode = std::make_pair(info.st_dev, info.st_ino);
+                    auto seen = info.st_nlink > 1 ? links_.find(inode) : links_.end();
+                    if (seen != links_.end()) {
+                        member.type = '1';
+                        member.link = seen->second;
+                        member.link_size = static_cast<uint64_t>(info.st_size);
+                    } else {
+                        if (info.st_nlink > 1) links_[inode] = member.name;
+                        member.size = static_cast<uint64_t>(info.st_size);
+                        member.file = files_.size();
+                        files_.push_back({member.source, member.size});
+                    }
+                } else if (S_ISCHR(info.st_mode) || S_ISBLK(info.st_mode) || S_ISFIFO(info.st_mode)) {
+                    member.type = S_ISCHR(info.st_mode) ? '3' : S_ISBLK(info.st_mode) ? '4' : '6';
+                    if (member.type != '6') {
+                        member.dev_major = major(info.st_rdev);
+                        member.dev_minor = minor(info.st_rdev);
+                    }
+                } else {
+                    if (options_.report) options_.report(i18n::get("warning_tar_socket", {{"PATH", source.string()}}));
+                    return;
+                }
+                members_.push_back(std::move(member));
+            }
+
+            int finish() {
+                std::vector<size_t> member_of(files_.size());
+                for (size_t i = 0; i < members_.size(); ++i) {
+                    if (members_[i].file != kNoFile) member_of[members_[i].file] = i;
+                }
+                std::vector<uint64_t> copied(files_.size(), 0);
+                std::vector<bool> started(files_.size(), false);
+
+                ingest::Sink sink;
+                sink.data = [&](size_t file, const char* data, size_t size) {
+                    Member& member = members_[member_of[file]];
+                    if (!started[file]) {
+                        emit_until(member_of[file]);
+                        header(member);
+                        started[file] = true;
+                    }
+                    size_t take = static_cast<size_t>(std::min<uint64_t>(size, member.size - copied[file]));
+                    output_.write(data, take);
+                    copied[file] += take;
+                    if (options_.advance) options_.advance(take, take);
+                    return output_.ok();
+                };
+                sink.done = [&](size_t file, int error) {
+                    size_t index = member_of[file];
+                    Member& member = members_[index];
+                    if (error != 0 && !started[file]) {
+                        emit_until(index);
+                        next_ = index + 1;
+                        warn(member.source, std::strerror(error), 2);
+                        promote_link(index);
+                        return output_.ok();
+                    }
+                    if (!started[file]) {
+                        emit_until(index);
+                        header(member);
+                    }
+                    end_data(member, copied[file], error);
+                    next_ = index + 1;
+                    return output_.ok();
+                };
+                bool read_all = ingest::read_files(files_, sink, options_.engine);
+                emit_until(members_.size());
+                if (!read_all && output_.ok()) status_ = 2;
+                return status_;
+            }
+
+        private:
+            void warn(const std::string& path, const std::string& reason, int status) {
+                status_ = std::max(status_, status);
+                if (options_.report) options_.report(i18n::get("warning_tar_file", {{"PATH", path}, {"REASON", reason}}));
+            }
+
+            // Members before end that carry no data from the ingest.
+            void emit_until(size_t end) {
+                for (; next_ < end; ++next_) {
+                    if (members_[next_].file != kNoFile) continue;
+                    if (members_[next_].type == '0') copy_promoted(next_);
+                    else header(members_[next_]);
+                }
+            }
+
+            // The header already promised member.size bytes.
+            void end_data(const Member& member, uint64_t copied, int error) {
+                if (copied < member.size) {
+                    if (error != 0) {
+                        warn(member.source, std::strerror(error), 2);
+                    } else {
+                        status_ = std::max(status_, 1);
+                        if (options_.report) {
+                            options_.report(i18n::get("warning_tar_shrank", {
+                                {"PATH", member.source}, {"BYTES", std::to_string(member.size - copied)}}));
+                        }
+                    }
+                    output_.zeros(static_cast<size_t>(member.size - copied));
+                }
+                output_.pad_block();
+            }
+
+            // The first name of a hard-linked file could not be read, so the next name for it
+            // carries the data instead and any later names link to that one.
+            void promote_link(size_t failed) {
+                const std::string target = members_[failed].name;
+                Member* heir = nullptr;
+                for (size_t i = failed + 1; i < members_.size(); ++i) {
+                    Member& member = members_[i];
+                    if (member.type != '1' || member.link != target) continue;
+                    if (heir) {
+                        member.link = heir->name;
+                        continue;
+                    }
+                    heir = &member;
+                    member.type = '0';
+                    member.link.clear();
+                    member.size = member.link_size;
+                }
+            }
+
+            // Promoted links are not in the ingest list, so their data is read here.
+            void copy_promoted(size_t index) {
+                Member& member = members_[index];
+                int fd = ::open(member.source.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) {
+                    warn(member.source, std::strerror(errno), 2);
+                    promote_link(index);
+                    return;
+                }
+                header(member);
+                std::vector<char> buffer(ingest::kSlotSize);
+                uint64_t copied = 0;
+                int error = 0;
+                while (copied < member.size) {
+                    ssize_t got = ::read(fd, buffer.data(), static_cast<size_t>(std::min<uint64_t>(buffer.size(), member.size - copied)));
+                    if (got < 0 && errno == EINTR) continue;
+                    if (got < 0) error = errno;
+                    if (got <= 0) break;
+                    output_.write(buffer.data(), static_cast<size_t>(got));
+                    copied += static_cast<uint64_t>(got);
+                    if (options_.advance) options_.advance(static_cast<uint64_t>(got), static_cast<uint64_t>(got));
+                }
+                ::close(fd);
+                end_data(member, copied, error);
+            }
+
+            void header(const Member& member) {
+                std::string prefix;
+                std::string name;
+                std::string records;
+                if (!split_name(member.name, prefix, name)) {
+                    records += pax_record("path", member.name);
+                    name = member.name.substr(0, 100);
+                    prefix.clear();
+                }
+                if (member.link.size() > 100) records += pax_record("linkpath", member.link);
+                if (member.size >= (uint64_t{1} << 33)) records += pax_record("size", std::to_string(member.size));
+                if (!records.empty()) {
+                    // Readers that see a pax header trust its times to the nanosecond.
+                    char mtime[48];
+                    std::snprintf(mtime, sizeof(mtime), "%lld.%09ld", static_cast<long long>(member.mtime), member.mtime_nsec);
+                    records += pax_record("mtime", mtime);
+                    std::string base = fs::path(member.name.back() == '/' ? member.name.substr(0, member.name.size() - 1) : member.name)
+                                           .filename().string();
+                    Member pax;
+                    pax.name = "PaxHeaders/" + base.substr(0, 89);
+                    pax.type = 'x';
+                    pax.mode = 0644;
+                    pax.uid = member.uid;
+                    pax.gid = member.gid;
+                    pax.mtime = member.mtime;
+                    pax.size = records.size();
+                    block(pax, "", pax.name);
+                    output_.write(records.data(), records.size());
+                    output_.pad_block();
+                }
+                block(member, prefix, name);
+            }
+
+            void block(const Member& member, const std::string& prefix, const std::string& name) {
+                char header[kBlockSize] = {};
+                put_string(header, 100, name);
+                put_number(header + 100, 8, member.mode);
+                put_number(header + 108, 8, member.uid);
+                put_number(header + 116, 8, member.gid);
+                put_number(header + 124, 12, member.size);
+                put_number(header + 136, 12, static_cast<uint64_t>(std::max<int64_t>(member.mtime, 0)));
+                header[156] = member.type;
+                put_string(header + 157, 100, member.link);
+                std::memcpy(header + 257, "ustar\0" "00", 8);
+                put_string(header + 265, 31, user_name(member.uid));
+                put_string(header + 297, 31, group_name(member.gid));
+                if (member.type == '3' || member.type == '4') {
+                    put_number(header + 329, 8, member.dev_major);
+                    put_number(header + 337, 8, member.dev_minor);
+                }
+                put_string(header + 345, 155, prefix);
+
+                std::memset(header + 148, ' ', 8);
+                unsigned sum = 0;
+                for (unsigned char byte : header) sum += byte;
+                put_number(header + 148, 7, sum);
+                output_.write(header, sizeof(header));
+            }
+
+            const std::string& user_name(uint64_t uid) {
+                auto found = users_.find(uid);
+                if (found != users_.end()) return found->second;
+                std::vector<char> storage(4096);
+                struct passwd entry {};
+                struct passwd* result = nullptr;
+                std::string name;
+                if (::getpwuid_r(static_cast<uid_t>(uid), &entry, storage.data(), storage.size(), &result) == 0 && result) name = result->pw_name;
+                return users_[uid] = name;
+            }
+
+            const std::string& group_name(uint64_t gid) {
+                auto found = groups_.find(gid);
+                if (found != groups_.end()) return found->second;
+                std::vector<char> storage(4096);
+                struct group entry {};
+                struct group* result = nullptr;
+                std::string name;
+                if (::getgrgid_r(static_cast<gid_t>(gid), &entry, storage.data(), storage.size(), &result) == 0 && result) name = result->gr_name;
+                return groups_[gid] = name;
+            }
+
+            Output& output_;
+            const Options& options_;
+            std::vector<Member> members_;
+            std::vector<ingest::File> files_;
+            std::map<std::pair<dev_t, ino_t>, std::string> links_;
+            std::map<uint64_t, std::string> users_;
+            std::map<uint64_t, std::string> groups_;
+            size_t next_ = 0;
+            int status_ = 0;
+        };
+    }
+
+    int write(const std::string& target, const std::string& working_dir, const std::vector<std::string>& items,
+              const Options& options) {
+        trace::Span span("write_tar", "native");
+        int fd = ::open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        if (fd < 0) {
+            if (options.report) options.report(i18n::get("warning_tar_file", {{"PATH", target}, {"REASON", std::strerror(errno)}}));
+            return 2;
+        }
+        // The archive itself is never archived, even when it lies inside an item.
+        struct stat self {};
+        ::fstat(fd, &self);
+
+        Output output(fd);
+        Archiver archiver(output, options);
+        for (const auto& item : items) {
+            fs::path source = fs::path(working_dir) / item;
+            // Like GNU tar, member names never start with '/'; the root itself is archived as ".".
+            size_t start = item.find_first_not_of('/');
+            std::string name = start == std::string::npos ? "." : item.substr(start);
+            while (name.size() > 1 && name.back() == '/') name.pop_back();
+            archiver.add(source, name, self.st_dev, self.st_ino);
+        }
+        int status = archiver.finish();
+
+        output.zeros(2 * kBlockSize);
+        output.zeros(static_cast<size_t>((kRecordSize - output.written() % kRecordSize) % kRecordSize));
+        bool written = output.flush();
+        if (::close(fd) != 0) written = false;
+        span.arg("bytes", static_cast<int64_t>(output.written()));
+        if (!written) {
+            if (options.report) options.report(i18n::get("warning_tar_file", {{"PATH", target}, {"REASON", std::strerror(errno)}}));
+            return 2;
+        }
+        return status;
+    }
+}
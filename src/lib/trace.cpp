@@ -0,0 +1,202 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "include/trace.h"
+#include "include/util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+namespace trace {
+    std::atomic<bool> g_enabled{false};
+
+    namespace {
+        constexpr size_t RING_CAPACITY = 1 << 16;
+
+        struct Event {
+            const char* name = nullptr;
+            const char* category = nullptr;
+            uint64_t start_us = 0;
+            uint64_t duration_us = 0;
+            std::string args;
+        };
+
+        struct ThreadBuffer {
+            std::mutex mutex;
+            std::vector<Event> events;
+            size_t next = 0;
+            bool wrapped = false;
+            int64_t tid = 0;
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+            std::string output_path;
+        };
+
+        Registry& registry() {
+            static Registry instance;
+            return instance;
+        }
+
+        const auto g_epoch = std::chrono::steady_clock::now();
+
+        int64_t current_tid() {
+#ifdef __linux__
+            return static_cast<int64_t>(::syscall(SYS_gettid));
+#else
+            static std::atomic<int64_t> next_tid{1};
+            thread_local int64_t tid = next_tid++;
+            return tid;
+#endif
+        }
+
+        ThreadBuffer& local_buffer() {
+            // The registry keeps a reference, so events survive the thread that recorded them.
+            thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+                auto created = std::make_shared<ThreadBuffer>();
+                created->tid = current_tid();
+                Registry& reg = registry();
+                std::lock_guard<std::mutex> lock(reg.mutex);
+                reg.buffers.push_back(created);
+                return created;
+            }();
+            return *buffer;
+        }
+
+        void append_arg(std::string& args, const char* key, const std::string& json_value) {
+            if (!args.empty()) args += ',';
+            args += util::json_quote(key);
+            args += ':';
+            args += json_value;
+        }
+
+        int64_t process_id() {
+#ifndef _WIN32
+            return static_cast<int64_t>(::getpid());
+#else
+            return 1;
+#endif
+        }
+    }
+
+    uint64_t now_us() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - g_epoch).count());
+    }
+
+    std::string redacted_command(const std::vector<std::string>& argv) {
+        std::string joined;
+        bool mask_next = false;
+        for (const auto& arg : argv) {
+            if (!joined.empty()) joined += ' ';
+            if (mask_next) {
+                joined += "***";
+                mask_next = false;
+            } else if (arg == "-P") {
+                joined += arg;
+                mask_next = true;
+            } else if (arg.size() > 2 && arg.rfind("-p", 0) == 0) {
+                joined += "-p***";
+            } else {
+                joined += arg;
+            }
+        }
+        return joined;
+    }
+
+    bool start(const std::string& output_path) {
+        std::ofstream probe(output_path, std::ios::trunc);
+        if (!probe) return false;
+
+        Registry& reg = registry();
+        {
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.output_path = output_path;
+        }
+        g_enabled.store(true);
+        return true;
+    }
+
+    void complete(const char* name, const char* category, uint64_t start_us, uint64_t duration_us, std::string args) {
+        if (!enabled()) return;
+        ThreadBuffer& buffer = local_buffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        Event event{name, category, start_us, duration_us, std::move(args)};
+        if (buffer.events.size() < RING_CAPACITY) {
+            buffer.events.push_back(std::move(event));
+        } else {
+            buffer.events[buffer.next] = std::move(event);
+            buffer.wrapped = true;
+        }
+        buffer.next = (buffer.next + 1) % RING_CAPACITY;
+    }
+
+    void Span::arg(const char* key, const std::string& value) {
+        if (!active_) return;
+        append_arg(args_, key, util::json_quote(value));
+    }
+
+    void Span::arg(const char* key, int64_t value) {
+        if (!active_) return;
+        append_arg(args_, key, std::to_string(value));
+    }
+
+    bool stop() {
+        if (!g_enabled.exchange(false)) return true;
+
+        Registry& reg = registry();
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        std::string output_path;
+        {
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            buffers = reg.buffers;
+            output_path = reg.output_path;
+        }
+
+        std::ofstream output(output_path, std::ios::trunc);
+        if (!output) return false;
+
+        const int64_t pid = process_id();
+        output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        for (const auto& buffer : buffers) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            size_t count = buffer->events.size();
+            size_t begin = buffer->wrapped ? buffer->next : 0;
+            for (size_t i = 0; i < count; ++i) {
+                const Event& event = buffer->events[(begin + i) % count];
+                output << (first ? "\n" : ",\n");
+                first = false;
+                output << "{\"name\":" << util::json_quote(event.name)
+                       << ",\"cat\":" << util::json_quote(event.category)
+                       << ",\"ph\":\"X\",\"ts\":" << event.start_us
+                       << ",\"dur\":" << event.duration_us
+                       << ",\"pid\":" << pid
+                       << ",\"tid\":" << buffer->tid;
+                if (!event.args.empty()) output << ",\"args\":{" << event.args << '}';
+                output << '}';
+            }
+            buffer->events.clear();
+            buffer->next = 0;
+            buffer->wrapped = false;
+        }
+        output << "\n]}\n";
+        return output.good();
+    }
+}
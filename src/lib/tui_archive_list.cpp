@@ -6,6 +6,8 @@
 
 #include "include/tui_archive_list.h"
 #include "include/i18n.h"
+#include "include/simd.h"
+#include "include/trace.h"
 
 #include <ftxui/dom/elements.hpp>
 #include <ftxui/component/component.hpp>
@@ -13,6 +15,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <chrono>
 #include <map>
 #include <utility>
 
@@ -33,12 +36,34 @@ namespace tui {
             if (pos == std::string::npos) return "";
             return path.substr(0, pos);
         }
+
+        double elapsed_ms(std::chrono::steady_clock::time_point since) {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+        }
+
+        // Heap allocation behind a string; short strings live inside the object.
+        size_t heap_bytes(const std::string& value) {
+            return value.capacity() > std::string().capacity() ? value.capacity() + 1 : 0;
+        }
     }
 
     void ArchiveList::load(const std::string& archive_path, file_type::FileType type, const std::string& password) {
+        auto started = std::chrono::steady_clock::now();
+        auto entries = archive_ops::list_archive(archive_path, type, password);
+        double load_ms = elapsed_ms(started);
+        set_entries(archive_path, type, std::move(entries));
+        load_ms_ = load_ms;
+    }
+
+    void ArchiveList::set_entries(const std::string& archive_path, file_type::FileType type, std::vector<archive_ops::ArchiveEntry> entries) {
         archive_path_ = archive_path;
         type_ = type;
-        entries_ = archive_ops::list_archive(archive_path, type, password);
+        entries_ = std::move(entries);
+        load_ms_ = 0.0;
+        entry_table_bytes_ = entries_.capacity() * sizeof(archive_ops::ArchiveEntry);
+        for (const auto& entry : entries_) {
+            entry_table_bytes_ += heap_bytes(entry.path) + heap_bytes(entry.modified) + heap_bytes(entry.method);
+        }
         selected_idx_ = 0;
         scroll_offset_ = 0;
         current_directory_.clear();
@@ -55,6 +80,9 @@ namespace tui {
     }
 
     void ArchiveList::apply_filter() {
+        trace::Span span("apply_filter", "tui");
+        span.arg("entries", static_cast<int64_t>(entries_.size()));
+        auto started = std::chrono::steady_clock::now();
         visible_entries_.clear();
 
         std::string lower_query = to_lower(search_query_);
@@ -71,9 +99,8 @@ namespace tui {
 
         for (size_t i = 0; i < entries_.size(); ++i) {
             const auto& entry = entries_[i];
-            std::string lower_path = to_lower(entry.path);
-
-            if (!lower_query.empty() && lower_path.find(lower_query) == std::string::npos) {
+            if (!lower_query.empty() &&
+                simd::find_ascii_nocase(entry.path.data(), entry.path.size(), lower_query.data(), lower_query.size()) == simd::npos) {
                 continue;
             }
 
@@ -157,6 +184,7 @@ namespace tui {
             visible_entries_.end());
 
         clamp_selection();
+        last_filter_ms_ = elapsed_ms(started);
     }
 
     void ArchiveList::clamp_selection() {
@@ -5,23 +5,25 @@
 // (at your option) any later version.
 
 #include "include/tui_archive_ops.h"
-#include "include/operation.h"
+#include "include/archive_backend.h"
+#include "include/progress.h"
+#include "include/simd.h"
+#include "include/trace.h"
 
 #include <cstdio>
 #include <array>
 #include <sstream>
 #include <algorithm>
-#include <filesystem>
 #include <cctype>
+#include <chrono>
 
 #ifndef _WIN32
 #include <unistd.h>
 #include <sys/wait.h>
 #include <fcntl.h>
+#include <csignal>
 #endif
 
-namespace fs = std::filesystem;
-
 namespace tui::archive_ops {
 
     static std::string trim_str(std::string s) {
@@ -30,18 +32,6 @@ namespace tui::archive_ops {
         return s;
     }
 
-    static std::string build_unrar_password_arg(const std::string& password) {
-        return password.empty() ? "-p-" : "-p" + password;
-    }
-
-    static TextExtractionResult make_text_extraction_result(CommandResult result) {
-        TextExtractionResult extraction;
-        extraction.success = (result.exit_code == 0);
-        extraction.content = extraction.success ? std::move(result.stdout_output) : "";
-        extraction.empty_file = extraction.success && extraction.content.empty();
-        return extraction;
-    }
-
 #ifdef _WIN32
     static CommandResult run_command_capture_windows(const std::vector<std::string>& cmd) {
         CommandResult result;
@@ -134,6 +124,22 @@ namespace tui::archive_ops {
         return -1;
     }
 #else
+    static double elapsed_ms(std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    }
+
+    // read() that records a trace span when the child kept us waiting for more than a millisecond.
+    static ssize_t traced_read(int fd, char* buffer, size_t size) {
+        if (!trace::enabled()) return read(fd, buffer, size);
+        uint64_t start = trace::now_us();
+        ssize_t bytes_read = read(fd, buffer, size);
+        uint64_t waited = trace::now_us() - start;
+        if (waited >= 1000) {
+            trace::complete("pipe_stall", "io", start, waited, "\"bytes\":" + std::to_string(bytes_read));
+        }
+        return bytes_read;
+    }
+
     static CommandResult run_command_capture_posix(const std::vector<std::string>& cmd) {
         CommandResult result;
         if (cmd.empty()) return result;
@@ -147,6 +153,7 @@ namespace tui::archive_ops {
         int pipefd[2];
         if (pipe(pipefd) != 0) return result;
 
+        auto started = std::chrono::steady_clock::now();
         pid_t pid = fork();
         if (pid == 0) {
             close(pipefd[0]);
@@ -166,18 +173,25 @@ namespace tui::archive_ops {
             close(pipefd[1]);
             std::array<char, 4096> buffer;
             ssize_t bytes_read;
-            while ((bytes_read = read(pipefd[0], buffer.data(), buffer.size())) > 0) {
+            bool first_chunk = true;
+            while ((bytes_read = traced_read(pipefd[0], buffer.data(), buffer.size())) > 0) {
+                if (first_chunk) {
+                    result.spawn_ms = elapsed_ms(started);
+                    first_chunk = false;
+                }
                 result.stdout_output.append(buffer.data(), bytes_read);
             }
             close(pipefd[0]);
 
-            int status;
-            waitpid(pid, &status, 0);
-            if (WIFEXITED(status)) {
+            int status = progress::wait_for_child(pid, cmd.front(), started);
+            if (status != -1 && WIFEXITED(status)) {
                 result.exit_code = WEXITSTATUS(status);
             } else {
                 result.exit_code = -1;
             }
+            double total_ms = elapsed_ms(started);
+            if (first_chunk) result.spawn_ms = total_ms;
+            result.decode_ms = total_ms - result.spawn_ms;
         } else {
             close(pipefd[0]);
             close(pipefd[1]);
@@ -195,6 +209,7 @@ namespace tui::archive_ops {
         }
         argv.push_back(nullptr);
 
+        auto started = std::chrono::steady_clock::now();
         pid_t pid = fork();
         if (pid == 0) {
             int devnull = open("/dev/null", O_WRONLY);
@@ -212,68 +227,115 @@ namespace tui::archive_ops {
             execvp(argv[0], argv.data());
             _exit(127);
         } else if (pid > 0) {
-            int status;
-            waitpid(pid, &status, 0);
-            if (WIFEXITED(status)) {
+            int status = progress::wait_for_child(pid, cmd.front(), started);
+            if (status != -1 && WIFEXITED(status)) {
                 return WEXITSTATUS(status);
             }
             return -1;
         }
         return -1;
     }
+
+    static int run_command_stream_posix(const std::vector<std::string>& cmd, const StreamSink& sink) {
+        if (cmd.empty()) return -1;
+
+        std::vector<char*> argv;
+        for (const auto& arg : cmd) {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+
+        int pipefd[2];
+        if (pipe(pipefd) != 0) return -1;
+
+        auto started = std::chrono::steady_clock::now();
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(pipefd[0]);
+            dup2(pipefd[1], STDOUT_FILENO);
+            close(pipefd[1]);
+
+            int devnull = open("/dev/null", O_RDWR);
+            if (devnull >= 0) {
+                dup2(devnull, STDIN_FILENO);
+                dup2(devnull, STDERR_FILENO);
+                close(devnull);
+            }
+
+            execvp(argv[0], argv.data());
+            _exit(127);
+        } else if (pid < 0) {
+            close(pipefd[0]);
+            close(pipefd[1]);
+            return -1;
+        }
+
+        close(pipefd[1]);
+        std::vector<char> buffer(64 * 1024);
+        bool stopped = false;
+        ssize_t bytes_read;
+        while ((bytes_read = traced_read(pipefd[0], buffer.data(), buffer.size())) > 0) {
+            if (!sink(buffer.data(), static_cast<size_t>(bytes_read))) {
+                stopped = true;
+                kill(pid, SIGTERM);
+                break;
+            }
+        }
+        close(pipefd[0]);
+
+        int status = progress::wait_for_child(pid, cmd.front(), started);
+        if (stopped) return 0;
+        return status != -1 && WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
 #endif
 
     CommandResult run_command_capture(const std::vector<std::string>& cmd) {
+        trace::Span span("spawn", "process");
+        span.arg("argv", trace::redacted_command(cmd));
 #ifdef _WIN32
-        return run_command_capture_windows(cmd);
+        CommandResult result = run_command_capture_windows(cmd);
 #else
-        return run_command_capture_posix(cmd);
+        CommandResult result = run_command_capture_posix(cmd);
 #endif
+        span.arg("exit_code", static_cast<int64_t>(result.exit_code));
+        span.arg("output_bytes", static_cast<int64_t>(result.stdout_output.size()));
+        return result;
     }
 
     int run_command_status(const std::vector<std::string>& cmd) {
+        trace::Span span("spawn", "process");
+        span.arg("argv", trace::redacted_command(cmd));
 #ifdef _WIN32
-        return run_command_status_windows(cmd);
+        int exit_code = run_command_status_windows(cmd);
 #else
-        return run_command_status_posix(cmd);
+        int exit_code = run_command_status_posix(cmd);
 #endif
+        span.arg("exit_code", static_cast<int64_t>(exit_code));
+        return exit_code;
     }
 
-    static bool is_tar_family(file_type::FileType type) {
-        return type == file_type::FileType::ARCHIVE_TAR ||
-               type == file_type::FileType::ARCHIVE_TAR_GZ ||
-               type == file_type::FileType::ARCHIVE_TAR_BZ2 ||
-               type == file_type::FileType::ARCHIVE_TAR_XZ ||
-               type == file_type::FileType::ARCHIVE_TAR_ZSTD;
-    }
-
-    static std::string get_tar_flags(file_type::FileType type) {
-        switch (type) {
-            case file_type::FileType::ARCHIVE_TAR_GZ: return "-xzf";
-            case file_type::FileType::ARCHIVE_TAR_BZ2: return "-xjf";
-            case file_type::FileType::ARCHIVE_TAR_XZ: return "-xJf";
-            case file_type::FileType::ARCHIVE_TAR_ZSTD: return "-xf";
-            default: return "-xf";
+    int run_command_stream(const std::vector<std::string>& cmd, const StreamSink& sink) {
+        trace::Span span("spawn", "process");
+        span.arg("argv", trace::redacted_command(cmd));
+#ifdef _WIN32
+        CommandResult result = run_command_capture_windows(cmd);
+        if (!result.stdout_output.empty()) {
+            sink(result.stdout_output.data(), result.stdout_output.size());
         }
+        int exit_code = result.exit_code;
+#else
+        int exit_code = run_command_stream_posix(cmd, sink);
+#endif
+        span.arg("exit_code", static_cast<int64_t>(exit_code));
+        return exit_code;
     }
 
-    static std::vector<ArchiveEntry> list_tar(const std::string& archive_path, file_type::FileType type) {
-        std::vector<ArchiveEntry> entries;
-        std::string flags = "-tf";
-        if (type == file_type::FileType::ARCHIVE_TAR_ZSTD) {
-            flags = "--zstd -tf";
-        } else if (type == file_type::FileType::ARCHIVE_TAR_GZ) {
-            flags = "-tzf";
-        } else if (type == file_type::FileType::ARCHIVE_TAR_BZ2) {
-            flags = "-tjf";
-        } else if (type == file_type::FileType::ARCHIVE_TAR_XZ) {
-            flags = "-tJf";
-        }
+    std::vector<ArchiveEntry> parse_tar_listing(const std::string& output) {
+        trace::Span parse_span("parse_listing", "list");
+        parse_span.arg("bytes", static_cast<int64_t>(output.size()));
 
-        auto result = run_command_capture({"tar", flags, archive_path});
-        if (result.exit_code != 0) return entries;
-
-        std::istringstream stream(result.stdout_output);
+        std::vector<ArchiveEntry> entries;
+        std::istringstream stream(output);
         std::string line;
         while (std::getline(stream, line)) {
             line = trim_str(line);
@@ -290,17 +352,12 @@ namespace tui::archive_ops {
         return entries;
     }
 
-    static std::vector<ArchiveEntry> list_7z(const std::string& archive_path, const std::string& password) {
-        std::vector<ArchiveEntry> entries;
-        std::vector<std::string> cmd = {"7z", "l", "-slt", archive_path};
-        if (!password.empty()) {
-            cmd.insert(cmd.begin() + 2, "-p" + password);
-        }
-
-        auto result = run_command_capture(cmd);
-        if (result.exit_code != 0) return entries;
+    std::vector<ArchiveEntry> parse_7z_listing(const std::string& output) {
+        trace::Span parse_span("parse_listing", "list");
+        parse_span.arg("bytes", static_cast<int64_t>(output.size()));
 
-        std::istringstream stream(result.stdout_output);
+        std::vector<ArchiveEntry> entries;
+        std::istringstream stream(output);
         std::string line;
         ArchiveEntry current;
         bool past_separator = false;
@@ -350,7 +407,10 @@ namespace tui::archive_ops {
             } else if (key == "Method") {
                 current.method = value;
             } else if (key == "CRC") {
-                try { current.crc = std::stoul(value, nullptr, 16); } catch (...) {}
+                try {
+                    current.crc = static_cast<uint32_t>(std::stoul(value, nullptr, 16));
+                    current.has_crc = true;
+                } catch (...) {}
             }
         }
 
@@ -360,93 +420,47 @@ namespace tui::archive_ops {
         return entries;
     }
 
-    static std::vector<ArchiveEntry> list_unzip(const std::string& archive_path, const std::string& password) {
-        std::vector<ArchiveEntry> entries;
-        std::vector<std::string> cmd = {"unzip", "-l", archive_path};
-        if (!password.empty()) {
-            cmd.insert(cmd.begin() + 2, "-P");
-            cmd.insert(cmd.begin() + 3, password);
-        }
-
-        auto result = run_command_capture(cmd);
-        if (result.exit_code != 0) return entries;
+    std::vector<ArchiveEntry> parse_unzip_listing(const std::string& output) {
+        trace::Span parse_span("parse_listing", "list");
+        parse_span.arg("bytes", static_cast<int64_t>(output.size()));
 
-        std::istringstream stream(result.stdout_output);
+        std::vector<ArchiveEntry> entries;
+        std::istringstream stream(output);
         std::string line;
         bool in_listing = false;
-        bool past_dash_line = false;
 
         while (std::getline(stream, line)) {
-            if (line.find("Archive:") != std::string::npos) continue;
-
-            if (line.find("-------") != std::string::npos) {
-                if (!past_dash_line) {
-                    past_dash_line = true;
-                    in_listing = true;
-                } else {
-                    break;
-                }
+            if (line.rfind("--------", 0) == 0) {
+                if (in_listing) break;
+                in_listing = true;
                 continue;
             }
-
             if (!in_listing || line.empty()) continue;
 
             std::istringstream ls(line);
             uint64_t size_val = 0, compressed_val = 0;
-            std::string date_str, time_str, name;
-            if (ls >> size_val >> date_str >> time_str >> name) {
-                if (name.empty()) continue;
-                ArchiveEntry entry;
-                entry.path = name;
-                entry.size = size_val;
-                entry.compressed_size = compressed_val;
-                entry.modified = date_str + " " + time_str;
-                if (!name.empty() && name.back() == '/') {
-                    entry.is_directory = true;
-                    entry.path.pop_back();
-                }
-                entries.push_back(entry);
-            }
-        }
-        return entries;
-    }
-
-    static std::vector<ArchiveEntry> list_xar(const std::string& archive_path) {
-        std::vector<ArchiveEntry> entries;
-        auto result = run_command_capture({"xar", "-tf", archive_path});
-        if (result.exit_code != 0) return entries;
-
-        std::istringstream stream(result.stdout_output);
-        std::string line;
-        while (std::getline(stream, line)) {
-            line = trim_str(line);
-            if (line.empty()) continue;
-
-            ArchiveEntry entry;
-            entry.path = line;
-            if (!line.empty() && line.back() == '/') {
-                entry.is_directory = true;
-                entry.path.pop_back();
-            }
-            entries.push_back(entry);
-        }
-        return entries;
-    }
+            std::string method, ratio, date_str, time_str, crc_str;
+            if (!(ls >> size_val >> method >> compressed_val >> ratio >> date_str >> time_str >> crc_str)) continue;
 
-    static std::vector<ArchiveEntry> list_rar(const std::string& archive_path, const std::string& password) {
-        std::vector<ArchiveEntry> entries;
-        auto result = run_command_capture({"unrar", "lb", build_unrar_password_arg(password), archive_path});
-        if (result.exit_code != 0) return entries;
-
-        std::istringstream stream(result.stdout_output);
-        std::string line;
-        while (std::getline(stream, line)) {
-            line = trim_str(line);
-            if (line.empty()) continue;
+            std::string name;
+            std::getline(ls, name);
+            size_t name_start = name.find_first_not_of(' ');
+            if (name_start == std::string::npos) continue;
+            name = name.substr(name_start);
+            if (!name.empty() && name.back() == '\r') name.pop_back();
+            if (name.empty()) continue;
 
             ArchiveEntry entry;
-            entry.path = line;
-            if (!line.empty() && line.back() == '/') {
+            entry.path = name;
+            entry.size = size_val;
+            entry.compressed_size = compressed_val;
+            entry.modified = date_str + " " + time_str;
+            entry.method = method;
+            try {
+                entry.crc = static_cast<uint32_t>(std::stoul(crc_str, nullptr, 16));
+                entry.has_crc = true;
+            } catch (...) {}
+            if (name.back() == '/') {
                 entry.is_directory = true;
                 entry.path.pop_back();
             }
@@ -455,384 +469,68 @@ namespace tui::archive_ops {
         return entries;
     }
 
-    static std::vector<ArchiveEntry> list_single_file_archive(const std::string& archive_path, file_type::FileType type) {
-        std::vector<ArchiveEntry> entries;
-        fs::path p(archive_path);
-        std::string stem = p.stem().string();
-        if (stem.empty()) stem = p.filename().string();
-
-        ArchiveEntry entry;
-        entry.path = stem;
-        entry.is_directory = false;
-
-        std::error_code ec;
-        if (fs::exists(archive_path, ec)) {
-            entry.size = fs::file_size(archive_path, ec);
-        }
-
-        entries.push_back(entry);
-        return entries;
-    }
-
     std::vector<ArchiveEntry> list_archive(const std::string& archive_path, file_type::FileType type, const std::string& password) {
-        std::vector<ArchiveEntry> entries;
-
-        switch (type) {
-            case file_type::FileType::ARCHIVE_TAR:
-            case file_type::FileType::ARCHIVE_TAR_GZ:
-            case file_type::FileType::ARCHIVE_TAR_BZ2:
-            case file_type::FileType::ARCHIVE_TAR_XZ:
-            case file_type::FileType::ARCHIVE_TAR_ZSTD:
-                entries = list_tar(archive_path, type);
-                break;
-
-            case file_type::FileType::ARCHIVE_7Z:
-                if (operation::is_tool_available("7z")) {
-                    entries = list_7z(archive_path, password);
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_RAR:
-                if (operation::is_tool_available("unrar")) {
-                    entries = list_rar(archive_path, password);
-                } else if (operation::is_tool_available("7z")) {
-                    entries = list_7z(archive_path, password);
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_ZIP:
-                if (operation::is_tool_available("7z")) {
-                    entries = list_7z(archive_path, password);
-                } else if (operation::is_tool_available("unzip")) {
-                    entries = list_unzip(archive_path, password);
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_XAR:
-                if (operation::is_tool_available("xar")) {
-                    entries = list_xar(archive_path);
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_LZ4:
-                if (operation::is_tool_available("lz4")) {
-                    entries = list_single_file_archive(archive_path, type);
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_ZSTD:
-                if (operation::is_tool_available("zstd")) {
-                    entries = list_single_file_archive(archive_path, type);
-                }
-                break;
-
-            default:
-                break;
-        }
+        trace::Span span("list_archive", "list");
+        span.arg("path", archive_path);
 
+        std::vector<ArchiveEntry> entries = backend::registry().list({archive_path, type, password});
         std::sort(entries.begin(), entries.end(), [](const ArchiveEntry& a, const ArchiveEntry& b) {
             if (a.is_directory != b.is_directory) return a.is_directory > b.is_directory;
             return a.path < b.path;
         });
 
+        span.arg("entries", static_cast<int64_t>(entries.size()));
         return entries;
     }
 
-    static CommandResult extract_tar_command(const std::string& archive_path, const std::string& entry_path, file_type::FileType type) {
-        std::vector<std::string> cmd = {"tar", "-xf", archive_path, "-O", entry_path};
-        if (type == file_type::FileType::ARCHIVE_TAR_ZSTD) {
-            cmd = {"tar", "--zstd", "-xf", archive_path, "-O", entry_path};
-        } else if (type == file_type::FileType::ARCHIVE_TAR_GZ) {
-            cmd = {"tar", "-xzf", archive_path, "-O", entry_path};
-        } else if (type == file_type::FileType::ARCHIVE_TAR_BZ2) {
-            cmd = {"tar", "-xjf", archive_path, "-O", entry_path};
-        } else if (type == file_type::FileType::ARCHIVE_TAR_XZ) {
-            cmd = {"tar", "-xJf", archive_path, "-O", entry_path};
-        }
-        return run_command_capture(cmd);
-    }
-
-    static CommandResult extract_7z_command(const std::string& archive_path, const std::string& entry_path, const std::string& password) {
-        std::vector<std::string> cmd = {"7z", "e", "-so", archive_path, entry_path};
-        if (!password.empty()) {
-            cmd.insert(cmd.begin() + 2, "-p" + password);
-        }
-        return run_command_capture(cmd);
-    }
-
-    static CommandResult extract_unzip_command(const std::string& archive_path, const std::string& entry_path, const std::string& password) {
-        std::vector<std::string> cmd = {"unzip", "-p", archive_path, entry_path};
-        if (!password.empty()) {
-            cmd.insert(cmd.begin() + 2, "-P");
-            cmd.insert(cmd.begin() + 3, password);
-        }
-        return run_command_capture(cmd);
-    }
-
-    static CommandResult extract_xar_command(const std::string& archive_path, const std::string& entry_path) {
-        return run_command_capture({"xar", "-xf", archive_path, "-O", entry_path});
-    }
-
-    static CommandResult extract_rar_command(const std::string& archive_path, const std::string& entry_path, const std::string& password) {
-        return run_command_capture({"unrar", "p", "-inul", build_unrar_password_arg(password), archive_path, entry_path});
-    }
-
-    static CommandResult extract_lz4_command(const std::string& archive_path) {
-        return run_command_capture({"lz4", "-d", "-f", archive_path, "-"});
-    }
-
-    static CommandResult extract_zstd_command(const std::string& archive_path) {
-        return run_command_capture({"zstd", "-d", "-f", "-c", archive_path});
-    }
-
-    TextExtractionResult extract_text(const std::string& archive_path, const std::string& entry_path, file_type::FileType type, const std::string& password) {
-        switch (type) {
-            case file_type::FileType::ARCHIVE_TAR:
-            case file_type::FileType::ARCHIVE_TAR_GZ:
-            case file_type::FileType::ARCHIVE_TAR_BZ2:
-            case file_type::FileType::ARCHIVE_TAR_XZ:
-            case file_type::FileType::ARCHIVE_TAR_ZSTD:
-                return make_text_extraction_result(extract_tar_command(archive_path, entry_path, type));
-
-            case file_type::FileType::ARCHIVE_7Z:
-                if (operation::is_tool_available("7z")) {
-                    return make_text_extraction_result(extract_7z_command(archive_path, entry_path, password));
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_RAR:
-                if (operation::is_tool_available("unrar")) {
-                    return make_text_extraction_result(extract_rar_command(archive_path, entry_path, password));
-                }
-                if (operation::is_tool_available("7z")) {
-                    return make_text_extraction_result(extract_7z_command(archive_path, entry_path, password));
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_ZIP:
-                if (operation::is_tool_available("7z")) {
-                    return make_text_extraction_result(extract_7z_command(archive_path, entry_path, password));
-                }
-                if (operation::is_tool_available("unzip")) {
-                    return make_text_extraction_result(extract_unzip_command(archive_path, entry_path, password));
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_XAR:
-                if (operation::is_tool_available("xar")) {
-                    return make_text_extraction_result(extract_xar_command(archive_path, entry_path));
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_LZ4:
-                if (operation::is_tool_available("lz4")) {
-                    return make_text_extraction_result(extract_lz4_command(archive_path));
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_ZSTD:
-                if (operation::is_tool_available("zstd")) {
-                    return make_text_extraction_result(extract_zstd_command(archive_path));
-                }
-                break;
-
-            default:
-                break;
-        }
-
-        return TextExtractionResult{};
-    }
-
-    std::string extract_to_string(const std::string& archive_path, const std::string& entry_path, file_type::FileType type, const std::string& password) {
-        switch (type) {
-            case file_type::FileType::ARCHIVE_TAR:
-            case file_type::FileType::ARCHIVE_TAR_GZ:
-            case file_type::FileType::ARCHIVE_TAR_BZ2:
-            case file_type::FileType::ARCHIVE_TAR_XZ:
-            case file_type::FileType::ARCHIVE_TAR_ZSTD:
-            {
-                auto result = extract_tar_command(archive_path, entry_path, type);
-                return result.exit_code == 0 ? result.stdout_output : "";
+    TextExtractionResult extract_text(const std::string& archive_path, const std::string& entry_path, file_type::FileType type, const std::string& password, size_t limit) {
+        TextExtractionResult extraction;
+        auto started = std::chrono::steady_clock::now();
+        auto since_start = [&]() { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count(); };
+        bool first_chunk = true;
+        extraction.success = backend::registry().read_entry({archive_path, type, password}, entry_path, [&](const char* data, size_t size) {
+            if (first_chunk) {
+                extraction.spawn_ms = since_start();
+                first_chunk = false;
             }
-
-            case file_type::FileType::ARCHIVE_7Z:
-                if (operation::is_tool_available("7z")) {
-                    auto result = extract_7z_command(archive_path, entry_path, password);
-                    return result.exit_code == 0 ? result.stdout_output : "";
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_RAR:
-                if (operation::is_tool_available("unrar")) {
-                    auto result = extract_rar_command(archive_path, entry_path, password);
-                    return result.exit_code == 0 ? result.stdout_output : "";
-                }
-                if (operation::is_tool_available("7z")) {
-                    auto result = extract_7z_command(archive_path, entry_path, password);
-                    return result.exit_code == 0 ? result.stdout_output : "";
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_ZIP:
-                if (operation::is_tool_available("7z")) {
-                    auto result = extract_7z_command(archive_path, entry_path, password);
-                    return result.exit_code == 0 ? result.stdout_output : "";
-                } else if (operation::is_tool_available("unzip")) {
-                    auto result = extract_unzip_command(archive_path, entry_path, password);
-                    return result.exit_code == 0 ? result.stdout_output : "";
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_XAR:
-                if (operation::is_tool_available("xar")) {
-                    auto result = extract_xar_command(archive_path, entry_path);
-                    return result.exit_code == 0 ? result.stdout_output : "";
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_LZ4:
-                if (operation::is_tool_available("lz4")) {
-                    auto result = extract_lz4_command(archive_path);
-                    return result.exit_code == 0 ? result.stdout_output : "";
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_ZSTD:
-                if (operation::is_tool_available("zstd")) {
-                    auto result = extract_zstd_command(archive_path);
-                    return result.exit_code == 0 ? result.stdout_output : "";
-                }
-                break;
-
-            default:
-                break;
-        }
-        return "";
-    }
-
-    static bool extract_single_tar(const std::string& archive_path, const std::string& entry_path, const std::string& output_dir, file_type::FileType type) {
-        std::vector<std::string> cmd;
-        if (type == file_type::FileType::ARCHIVE_TAR_ZSTD) {
-            cmd = {"tar", "--zstd", "-xf", archive_path, "-C", output_dir, entry_path};
-        } else if (type == file_type::FileType::ARCHIVE_TAR_GZ) {
-            cmd = {"tar", "-xzf", archive_path, "-C", output_dir, entry_path};
-        } else if (type == file_type::FileType::ARCHIVE_TAR_BZ2) {
-            cmd = {"tar", "-xjf", archive_path, "-C", output_dir, entry_path};
-        } else if (type == file_type::FileType::ARCHIVE_TAR_XZ) {
-            cmd = {"tar", "-xJf", archive_path, "-C", output_dir, entry_path};
-        } else {
-            cmd = {"tar", "-xf", archive_path, "-C", output_dir, entry_path};
-        }
-        return run_command_status(cmd) == 0;
-    }
-
-    static bool extract_single_7z(const std::string& archive_path, const std::string& entry_path, const std::string& output_dir, const std::string& password) {
-        std::vector<std::string> cmd = {"7z", "x", archive_path, entry_path, "-o" + output_dir, "-y"};
-        if (!password.empty()) {
-            cmd.insert(cmd.begin() + 2, "-p" + password);
-        }
-        return run_command_status(cmd) == 0;
-    }
-
-    static bool extract_single_unzip(const std::string& archive_path, const std::string& entry_path, const std::string& output_dir, const std::string& password) {
-        std::vector<std::string> cmd = {"unzip", "-o", archive_path, entry_path, "-d", output_dir};
-        if (!password.empty()) {
-            cmd.insert(cmd.begin() + 2, "-P");
-            cmd.insert(cmd.begin() + 3, password);
-        }
-        return run_command_status(cmd) == 0;
-    }
-
-    static bool extract_single_xar(const std::string& archive_path, const std::string& entry_path, const std::string& output_dir) {
-        return run_command_status({"xar", "-xf", archive_path, "-C", output_dir, entry_path}) == 0;
-    }
-
-    static bool extract_single_rar(const std::string& archive_path, const std::string& entry_path, const std::string& output_dir, const std::string& password) {
-        return run_command_status({"unrar", "x", build_unrar_password_arg(password), "-o+", archive_path, entry_path, output_dir}) == 0;
+            if (limit > 0 && extraction.content.size() + size >= limit) {
+                extraction.truncated = true;
+                extraction.content.append(data, limit - extraction.content.size());
+                return false;
+            }
+            extraction.content.append(data, size);
+            return true;
+        });
+        double total_ms = since_start();
+        if (first_chunk) extraction.spawn_ms = total_ms;
+        extraction.decode_ms = total_ms - extraction.spawn_ms;
+        if (!extraction.success) extraction.content.clear();
+        extraction.empty_file = extraction.success && extraction.content.empty();
+        return extraction;
     }
 
-    static bool extract_single_lz4(const std::string& archive_path, const std::string& output_dir) {
-        fs::path p(archive_path);
-        std::string out_name = p.stem().string();
-        if (out_name.empty()) out_name = p.filename().string();
-        fs::path out_path = fs::path(output_dir) / out_name;
-        return run_command_status({"lz4", "-d", "-f", archive_path, out_path.string()}) == 0;
+    std::string extract_to_string(const std::string& archive_path, const std::string& entry_path, file_type::FileType type, const std::string& password) {
+        std::string content;
+        bool ok = stream_entry(archive_path, entry_path, type, password, [&](const char* data, size_t size) {
+            content.append(data, size);
+            return true;
+        });
+        return ok ? content : "";
     }
 
-    static bool extract_single_zstd(const std::string& archive_path, const std::string& output_dir) {
-        fs::path p(archive_path);
-        std::string out_name = p.stem().string();
-        if (out_name.empty()) out_name = p.filename().string();
-        fs::path out_path = fs::path(output_dir) / out_name;
-        return run_command_status({"zstd", "-d", "-f", archive_path, "-o", out_path.string()}) == 0;
+    bool stream_entry(const std::string& archive_path, const std::string& entry_path, file_type::FileType type, const std::string& password, const StreamSink& sink) {
+        return backend::registry().read_entry({archive_path, type, password}, entry_path, sink);
     }
 
     bool extract_single(const std::string& archive_path, const std::string& entry_path, const std::string& output_dir, file_type::FileType type, const std::string& password) {
-        switch (type) {
-            case file_type::FileType::ARCHIVE_TAR:
-            case file_type::FileType::ARCHIVE_TAR_GZ:
-            case file_type::FileType::ARCHIVE_TAR_BZ2:
-            case file_type::FileType::ARCHIVE_TAR_XZ:
-            case file_type::FileType::ARCHIVE_TAR_ZSTD:
-                return extract_single_tar(archive_path, entry_path, output_dir, type);
-
-            case file_type::FileType::ARCHIVE_7Z:
-                if (operation::is_tool_available("7z")) {
-                    return extract_single_7z(archive_path, entry_path, output_dir, password);
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_RAR:
-                if (operation::is_tool_available("unrar")) {
-                    return extract_single_rar(archive_path, entry_path, output_dir, password);
-                }
-                if (operation::is_tool_available("7z")) {
-                    return extract_single_7z(archive_path, entry_path, output_dir, password);
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_ZIP:
-                if (operation::is_tool_available("7z")) {
-                    return extract_single_7z(archive_path, entry_path, output_dir, password);
-                } else if (operation::is_tool_available("unzip")) {
-                    return extract_single_unzip(archive_path, entry_path, output_dir, password);
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_XAR:
-                if (operation::is_tool_available("xar")) {
-                    return extract_single_xar(archive_path, entry_path, output_dir);
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_LZ4:
-                if (operation::is_tool_available("lz4")) {
-                    return extract_single_lz4(archive_path, output_dir);
-                }
-                break;
-
-            case file_type::FileType::ARCHIVE_ZSTD:
-                if (operation::is_tool_available("zstd")) {
-                    return extract_single_zstd(archive_path, output_dir);
-                }
-                break;
-
-            default:
-                break;
-        }
-        return false;
+        return backend::registry().extract_entry({archive_path, type, password}, entry_path, output_dir);
     }
 
     bool is_text_content(const std::string& content) {
         if (content.empty()) return false;
         if (content.size() > 1024 * 1024) return false;
 
-        size_t non_text = 0;
-        for (unsigned char c : content) {
-            if (c < 32 && c != '\n' && c != '\r' && c != '\t') {
-                non_text++;
-            }
-        }
+        size_t non_text = simd::count_control(content.data(), content.size());
         return (non_text * 100 / content.size()) < 5;
     }
 }
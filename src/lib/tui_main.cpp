@@ -16,6 +16,7 @@
 #include "include/i18n.h"
 #include "include/file_type.h"
 #include "include/interactive.h"
+#include "include/trace.h"
 
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/component_options.hpp>
@@ -25,10 +26,14 @@
 #include <ftxui/screen/screen.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <chrono>
 #include <functional>
 #include <filesystem>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -68,6 +73,100 @@ namespace tui {
             return std::make_shared<HideCursorNode>(Elements{std::move(child)});
         }
 
+        // Build, layout and paint time of recent frames, for the performance overlay.
+        struct FrameStats {
+            static constexpr size_t kWindow = 64;
+            std::array<double, kWindow> recent{};
+            size_t count = 0;
+            double last_ms = 0.0;
+
+            void record(double ms) {
+                last_ms = ms;
+                recent[count++ % kWindow] = ms;
+            }
+
+            double worst_ms() const {
+                size_t n = std::min(count, kWindow);
+                return n == 0 ? 0.0 : *std::max_element(recent.begin(), recent.begin() + static_cast<std::ptrdiff_t>(n));
+            }
+        };
+
+        // Times the frame up to the end of its paint into the screen buffer.
+        class FrameTimerNode : public Node {
+        public:
+            FrameTimerNode(Elements children, FrameStats& stats, std::chrono::steady_clock::time_point started)
+                : Node(std::move(children)), stats_(stats), started_(started) {}
+
+            void ComputeRequirement() override {
+                Node::ComputeRequirement();
+                requirement_ = children_[0]->requirement();
+            }
+
+            void SetBox(Box box) override {
+                Node::SetBox(box);
+                children_[0]->SetBox(box);
+            }
+
+            void Render(Screen& screen) override {
+                children_[0]->Render(screen);
+                stats_.record(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started_).count());
+            }
+
+        private:
+            FrameStats& stats_;
+            std::chrono::steady_clock::time_point started_;
+        };
+
+        std::string format_ms(double ms) {
+            std::ostringstream oss;
+            oss << std::fixed << std::setprecision(ms < 10.0 ? 2 : 1) << ms;
+            return oss.str();
+        }
+
+        std::string format_mib(size_t bytes) {
+            std::ostringstream oss;
+            oss << std::fixed << std::setprecision(1) << static_cast<double>(bytes) / (1024.0 * 1024.0) << " MiB";
+            return oss.str();
+        }
+
+        std::string format_ratio(size_t hits, size_t lookups) {
+            if (lookups == 0) return "-";
+            std::ostringstream oss;
+            oss << (hits * 100 / lookups) << "% (" << hits << "/" << lookups << ")";
+            return oss.str();
+        }
+
+        Element perf_overlay(const FrameStats& frames, const ArchiveList& list, const PreviewModel& preview_model) {
+            const PreviewTimings& preview = preview_model.panel().timings();
+            return vbox({
+                text(i18n::get("tui_perf_title")) | bold,
+                separator(),
+                text(i18n::get("tui_perf_frame", {
+                    {"LAST", format_ms(frames.last_ms)},
+                    {"WORST", format_ms(frames.worst_ms())},
+                    {"COUNT", std::to_string(std::min(frames.count, FrameStats::kWindow))},
+                })),
+                text(i18n::get("tui_perf_filter", {
+                    {"TIME", format_ms(list.last_filter_ms())},
+                    {"VISIBLE", std::to_string(list.visible_count())},
+                })),
+                text(i18n::get("tui_perf_preview", {
+                    {"SPAWN", format_ms(preview.spawn_ms)},
+                    {"DECODE", format_ms(preview.decode_ms)},
+                    {"WRAP", format_ms(preview.wrap_ms)},
+                })),
+                text(i18n::get("tui_perf_listing", {
+                    {"TIME", format_ms(list.load_ms())},
+                    {"COUNT", std::to_string(list.entries().size())},
+                    {"SIZE", format_mib(list.entry_table_bytes())},
+                })),
+                text(i18n::get("tui_perf_cache", {
+                    {"PREVIEW", format_ratio(preview_model.selection_hits(), preview_model.selection_lookups())},
+                    {"WRAP", format_ratio(preview.wrap_hits, preview.wrap_lookups)},
+                })),
+            }) | border | bgcolor(Color::Black) | color(Color::White) | clear_under;
+        }
+
         enum class PanelFocus {
             List,
             Preview,
@@ -120,6 +219,7 @@ namespace tui {
         preview_model.sync_selection(list.selected_entry(), list.entries(), archive_path, type, options.password);
 
         TuiState state;
+        FrameStats frame_stats;
         std::string search_input;
         PanelFocus focus = PanelFocus::List;
         bool first_time_editor_setup = false;
@@ -310,6 +410,8 @@ namespace tui {
         };
 
         auto main_renderer = Renderer([&]() -> Element {
+            trace::Span frame_span("render_frame", "tui");
+            auto frame_started = std::chrono::steady_clock::now();
             Elements left_panel;
             std::string left_title = i18n::get("tui_file_list");
             if (!list.current_directory().empty()) {
@@ -385,6 +487,13 @@ namespace tui {
                 vbox(status_items) | bgcolor(Color::Black),
             });
 
+            if (state.show_perf_overlay) {
+                document = dbox({
+                    document,
+                    vbox({hbox({filler(), perf_overlay(frame_stats, list, preview_model)}), filler()}),
+                });
+            }
+
             if (state.mode == UiMode::EditorSettings) {
                 Elements modal_items;
                 modal_items.push_back(text(first_time_editor_setup ? i18n::get("tui_settings_configure_editor") : i18n::get("tui_settings_editor_settings")) | bold);
@@ -494,7 +603,7 @@ namespace tui {
                 });
             }
 
-            return hide_terminal_cursor(document);
+            return hide_terminal_cursor(std::make_shared<FrameTimerNode>(Elements{std::move(document)}, frame_stats, frame_started));
         }) | CatchEvent([&](Event event) {
             if (state.mode == UiMode::Alert) {
                 if (event == Event::Escape || event == Event::Return) {
@@ -732,6 +841,11 @@ namespace tui {
                 return true;
             }
 
+            if (event == Event::Character('p')) {
+                state.show_perf_overlay = !state.show_perf_overlay;
+                return true;
+            }
+
             if (event == Event::Tab || event == Event::TabReverse) {
                 focus = (focus == PanelFocus::List) ? PanelFocus::Preview : PanelFocus::List;
                 state.mode = (focus == PanelFocus::Preview) ? UiMode::PreviewScroll : UiMode::Browse;
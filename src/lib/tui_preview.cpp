@@ -7,10 +7,13 @@
 #include "include/tui_preview.h"
 #include "include/tui_archive_ops.h"
 #include "include/i18n.h"
+#include "include/simd.h"
+#include "include/trace.h"
 
 #include <ftxui/dom/elements.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <sstream>
 #include <iomanip>
 #include <map>
@@ -18,6 +21,11 @@
 namespace tui {
     using namespace ftxui;
 
+    namespace {
+        constexpr size_t MAX_PREVIEW_LINES = 500;
+        constexpr size_t MAX_PREVIEW_SIZE = 64 * 1024;
+    }
+
     std::string PreviewPanel::format_size(uint64_t size) const {
         const char* units[] = {"B", "KB", "MB", "GB", "TB"};
         int unit_idx = 0;
@@ -34,6 +42,8 @@ namespace tui {
     }
 
     void PreviewPanel::load(const std::string& archive_path, const std::string& entry_path, file_type::FileType type, const std::string& password) {
+        trace::Span span("preview_load", "tui");
+        span.arg("entry", entry_path);
         lines_.clear();
         wrapped_lines_.clear();
         status_message_.clear();
@@ -42,7 +52,11 @@ namespace tui {
         scroll_offset_ = 0;
         is_directory_view_ = false;
 
-        archive_ops::TextExtractionResult extraction = archive_ops::extract_text(archive_path, entry_path, type, password);
+        // One byte past the window is enough to tell that the file was cut.
+        archive_ops::TextExtractionResult extraction = archive_ops::extract_text(archive_path, entry_path, type, password, MAX_PREVIEW_SIZE + 1);
+        timings_.spawn_ms = extraction.spawn_ms;
+        timings_.decode_ms = extraction.decode_ms;
+        timings_.wrap_ms = 0.0;
 
         if (!extraction.success) {
             status_message_ = i18n::get("tui_preview_extract_failed");
@@ -54,26 +68,35 @@ namespace tui {
             return;
         }
 
-        std::string content = std::move(extraction.content);
+        show_content(entry_path, std::move(extraction.content));
+    }
+
+    void PreviewPanel::show_content(const std::string& entry_path, std::string content) {
+        lines_.clear();
+        wrapped_lines_.clear();
+        status_message_.clear();
+        loaded_entry_path_ = entry_path;
+        wrapped_width_ = 0;
+        scroll_offset_ = 0;
+        is_directory_view_ = false;
 
         if (!archive_ops::is_text_content(content)) {
             status_message_ = i18n::get("tui_binary_file");
             return;
         }
 
-        constexpr size_t MAX_PREVIEW_LINES = 500;
-        constexpr size_t MAX_PREVIEW_SIZE = 64 * 1024;
-
         if (content.size() > MAX_PREVIEW_SIZE) {
             content = content.substr(0, MAX_PREVIEW_SIZE);
             status_message_ = i18n::get("tui_file_too_large");
         }
 
-        std::istringstream stream(content);
-        std::string line;
         size_t line_count = 0;
+        size_t start = 0;
 
-        while (std::getline(stream, line) && line_count < MAX_PREVIEW_LINES) {
+        while (start < content.size() && line_count < MAX_PREVIEW_LINES) {
+            size_t end = start + simd::find_byte(content.data() + start, content.size() - start, '\n');
+            std::string line = content.substr(start, end - start);
+            start = end + 1;
             if (line.size() > 200) {
                 line = line.substr(0, 197) + "...";
             }
@@ -87,6 +110,8 @@ namespace tui {
     }
 
     void PreviewPanel::load_directory(const std::string& dir_path, const std::vector<archive_ops::ArchiveEntry>& entries) {
+        trace::Span span("preview_load_directory", "tui");
+        span.arg("entries", static_cast<int64_t>(entries.size()));
         lines_.clear();
         wrapped_lines_.clear();
         status_message_.clear();
@@ -220,9 +245,18 @@ namespace tui {
         scroll_offset_ = std::clamp(scroll_offset_, 0, max_scroll_offset());
     }
 
+    size_t PreviewPanel::wrapped_line_count() const {
+        refresh_wrapped_lines();
+        return wrapped_lines_.size();
+    }
+
     void PreviewPanel::refresh_wrapped_lines() const {
         int width = content_width();
+        if (!lines_.empty()) {
+            ++timings_.wrap_lookups;
+        }
         if (wrapped_width_ == width && !wrapped_lines_.empty()) {
+            ++timings_.wrap_hits;
             return;
         }
 
@@ -233,9 +267,11 @@ namespace tui {
             return;
         }
 
+        auto started = std::chrono::steady_clock::now();
         for (const auto& line : lines_) {
             append_wrapped_line(line, width);
         }
+        timings_.wrap_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
     }
 
     void PreviewPanel::append_wrapped_line(const std::string& line, int width) const {
@@ -17,7 +17,9 @@ namespace tui {
             return;
         }
 
+        ++selection_lookups_;
         if (loaded_entry_path_ == entry->path && loaded_directory_ == entry->is_directory && panel_.has_content()) {
+            ++selection_hits_;
             return;
         }
 
@@ -6,6 +6,8 @@
 
 #include "include/util.h"
 
+#include <cstdio>
+
 namespace util {
     std::string trim_copy(const std::string& value) {
         const auto first = value.find_first_not_of(" \t\n\r");
@@ -15,4 +17,30 @@ namespace util {
         const auto last = value.find_last_not_of(" \t\n\r");
         return value.substr(first, last - first + 1);
     }
+
+    std::string json_quote(const std::string& value) {
+        std::string quoted;
+        quoted.reserve(value.size() + 2);
+        quoted += '"';
+        for (unsigned char c : value) {
+            switch (c) {
+                case '"': quoted += "\\\""; break;
+                case '\\': quoted += "\\\\"; break;
+                case '\n': quoted += "\\n"; break;
+                case '\r': quoted += "\\r"; break;
+                case '\t': quoted += "\\t"; break;
+                default:
+                    if (c < 0x20) {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        quoted += escaped;
+                    } else {
+                        quoted += static_cast<char>(c);
+                    }
+            }
+        }
+        quoted += '"';
+        return quoted;
+    }
+
 }
@@ -0,0 +1,446 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+#include "include/xar.h"
+#include "include/trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+#include <bzlib.h>
+#include <lzma.h>
+#include <zlib.h>
+
+namespace fs = std::filesystem;
+
+namespace xar {
+    namespace {
+        constexpr uint32_t kMagic = 0x78617221;  // "xar!"
+        constexpr uint64_t kMaxTocSize = 256ull << 20;
+        constexpr size_t kMaxDepth = 256;
+        constexpr size_t kChunk = 256 * 1024;
+
+        uint16_t be16(const unsigned char* p) { return static_cast<uint16_t>((p[0] << 8) | p[1]); }
+        uint32_t be32(const unsigned char* p) { return (static_cast<uint32_t>(be16(p)) << 16) | be16(p + 2); }
+        uint64_t be64(const unsigned char* p) { return (static_cast<uint64_t>(be32(p)) << 32) | be32(p + 4); }
+
+        struct Node {
+            std::string name;
+            std::vector<std::pair<std::string, std::string>> attributes;
+            std::string text;
+            std::vector<Node> children;
+
+            const Node* child(const char* tag) const {
+                for (const auto& node : children) {
+                    if (node.name == tag) return &node;
+                }
+                return nullptr;
+            }
+
+            std::string attribute(const char* key) const {
+                for (const auto& item : attributes) {
+                    if (item.first == key) return item.second;
+                }
+                return "";
+            }
+
+            std::string child_text(const char* tag) const {
+                const Node* node = child(tag);
+                return node ? node->text : "";
+            }
+        };
+
+        void append_utf8(std::string& out, uint32_t code) {
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else if (code < 0x110000) {
+                out += static_cast<char>(0xF0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+
+        std::string unescape(const std::string& text) {
+            if (text.find('&') == std::string::npos) return text;
+            std::string out;
+            out.reserve(text.size());
+            for (size_t i = 0; i < text.size(); ++i) {
+                size_t end = text[i] == '&' ? text.find(';', i) : std::string::npos;
+                if (end == std::string::npos || end - i > 12) {
+                    out += text[i];
+                    continue;
+                }
+                std::string entity = text.substr(i + 1, end - i - 1);
+                if (entity == "amp") out += '&';
+                else if (entity == "lt") out += '<';
+                else if (entity == "gt") out += '>';
+                else if (entity == "quot") out += '"';
+                else if (entity == "apos") out += '\'';
+                else if (entity.size() > 1 && entity[0] == '#') {
+                    bool hex = entity[1] == 'x' || entity[1] == 'X';
+                    append_utf8(out, static_cast<uint32_t>(std::strtoul(entity.c_str() + (hex ? 2 : 1), nullptr, hex ? 16 : 10)));
+                } else {
+                    out += text.substr(i, end - i + 1);
+                }
+                i = end;
+            }
+            return out;
+        }
+
+        // Just enough XML for a TOC: elements, attributes, text, CDATA and entities. Comments,
+        // declarations and processing instructions are skipped.
+        bool parse_xml(const std::string& xml, Node& root) {
+            std::vector<Node*> stack{&root};
+            size_t pos = 0;
+            while (pos < xml.size()) {
+                size_t open = xml.find('<', pos);
+                if (open == std::string::npos) open = xml.size();
+                if (open > pos) stack.back()->text += unescape(xml.substr(pos, open - pos));
+                if (open == xml.size()) break;
+
+                if (xml.compare(open, 9, "<![CDATA[") == 0) {
+                    size_t end = xml.find("]]>", open);
+                    if (end == std::string::npos) return false;
+                    stack.back()->text += xml.substr(open + 9, end - open - 9);
+                    pos = end + 3;
+                    continue;
+                }
+                if (xml.compare(open, 4, "<!--") == 0) {
+                    size_t end = xml.find("-->", open);
+                    if (end == std::string::npos) return false;
+                    pos = end + 3;
+                    continue;
+                }
+                size_t close = xml.find('>', open);
+                if (close == std::string::npos) return false;
+                pos = close + 1;
+                char kind = open + 1 < xml.size() ? xml[open + 1] : '\0';
+                if (kind == '?' || kind == '!') continue;
+
+                if (kind == '/') {
+                    if (stack.size() < 2) return false;
+                    stack.pop_back();
+                    continue;
+                }
+                bool self_closing = xml[close - 1] == '/';
+                std::string tag = xml.substr(open + 1, close - open - 1 - (self_closing ? 1 : 0));
+                size_t name_end = tag.find_first_of(" \t\r\n");
+                Node node;
+                node.name = tag.substr(0, name_end);
+                size_t at = name_end;
+                while (at != std::string::npos && at < tag.size()) {
+                    size_t key_start = tag.find_first_not_of(" \t\r\n", at);
+                    if (key_start == std::string::npos) break;
+                    size_t equals = tag.find('=', key_start);
+                    if (equals == std::string::npos || equals + 1 >= tag.size()) break;
+                    char quote = tag[equals + 1];
+                    size_t value_end = tag.find(quote, equals + 2);
+                    if ((quote != '"' && quote != '\'') || value_end == std::string::npos) break;
+                    std::string key = tag.substr(key_start, equals - key_start);
+                    key.erase(key.find_last_not_of(" \t\r\n") + 1);
+                    node.attributes.emplace_back(key, unescape(tag.substr(equals + 2, value_end - equals - 2)));
+                    at = value_end + 1;
+                }
+                // A child is only ever appended to the innermost open element, so the pointers
+                // held on the stack stay valid.
+                stack.back()->children.push_back(std::move(node));
+                if (!self_closing) {
+                    if (stack.size() > kMaxDepth) return false;
+                    stack.push_back(&stack.back()->children.back());
+                }
+            }
+            return stack.size() == 1;
+        }
+
+        uint64_t to_number(const std::string& text, int base = 10) {
+            return std::strtoull(text.c_str(), nullptr, base);
+        }
+
+        int64_t days_from_civil(int64_t year, unsigned month, unsigned day) {
+            year -= month <= 2;
+            int64_t era = (year >= 0 ? year : year - 399) / 400;
+            unsigned year_of_era = static_cast<unsigned>(year - era * 400);
+            unsigned day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+            unsigned day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+            return era * 146097 + static_cast<int64_t>(day_of_era) - 719468;
+        }
+
+        // "2017-12-27T20:12:07Z", always UTC.
+        bool parse_time(const std::string& text, int64_t& seconds) {
+            int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+            if (std::sscanf(text.c_str(), "%d-%d-%dT%d:%d:%d", &year, &month, &day, &hour, &minute, &second) != 6) return false;
+            if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+            seconds = days_from_civil(year, static_cast<unsigned>(month), static_cast<unsigned>(day)) * 86400 + hour * 3600 + minute * 60 + second;
+            return true;
+        }
+
+        Encoding encoding_of(const std::string& style) {
+            if (style.empty() || style == "application/octet-stream") return Encoding::None;
+            if (style == "application/x-gzip") return Encoding::Gzip;
+            if (style == "application/x-bzip2") return Encoding::Bzip2;
+            if (style == "application/x-lzma" || style == "application/x-xz") return Encoding::Xz;
+            return Encoding::Unsupported;
+        }
+
+        void collect(const Node& parent, const std::string& prefix, std::vector<Member>& members, size_t depth) {
+            if (depth > kMaxDepth) return;
+            for (const auto& node : parent.children) {
+                if (node.name != "file") continue;
+                Member member;
+                std::string name = node.child_text("name");
+                member.path = prefix.empty() ? name : prefix + "/" + name;
+                member.type = node.child_text("type");
+                if (member.type.empty()) member.type = "file";
+                member.is_directory = member.type == "directory";
+                member.is_symlink = member.type == "symlink";
+                if (member.is_symlink) member.link_target = node.child_text("link");
+                member.mode = static_cast<uint32_t>(to_number(node.child_text("mode"), 8)) & 07777;
+                member.has_mtime = parse_time(node.child_text("mtime"), member.mtime);
+                if (const Node* data = node.child("data")) {
+                    member.has_data = true;
+                    member.length = to_number(data->child_text("length"));
+                    member.offset = to_number(data->child_text("offset"));
+                    member.size = to_number(data->child_text("size"));
+                    const Node* encoding = data->child("encoding");
+                    member.encoding = encoding_of(encoding ? encoding->attribute("style") : "");
+                }
+                if (!name.empty()) members.push_back(member);
+                collect(node, member.path, members, depth + 1);
+            }
+        }
+
+        // One decoder per encoding; feed() returns false on corrupt input.
+        class Decoder {
+        public:
+            virtual ~Decoder() = default;
+            virtual bool feed(const unsigned char* data, size_t size, const std::function<bool(const char*, size_t)>& emit, bool& stopped) = 0;
+            virtual bool finished() const = 0;
+        };
+
+        class CopyDecoder : public Decoder {
+        public:
+            bool feed(const unsigned char* data, size_t size, const std::function<bool(const char*, size_t)>& emit, bool& stopped) override {
+                stopped = !emit(reinterpret_cast<const char*>(data), size);
+                return true;
+            }
+            bool finished() const override { return true; }
+        };
+
+        class ZlibDecoder : public Decoder {
+        public:
+            ZlibDecoder() {
+                // 15 + 32 accepts both the zlib streams xar writes and gzip.
+                ok_ = inflateInit2(&stream_, 15 + 32) == Z_OK;
+            }
+            ~ZlibDecoder() override { inflateEnd(&stream_); }
+
+            bool feed(const unsigned char* data, size_t size, const std::function<bool(const char*, size_t)>& emit, bool& stopped) override {
+                stream_.next_in = const_cast<Bytef*>(data);
+                stream_.avail_in = static_cast<uInt>(size);
+                while (ok_ && !done_ && stream_.avail_in > 0) {
+                    stream_.next_out = reinterpret_cast<Bytef*>(out_);
+                    stream_.avail_out = sizeof(out_);
+                    int status = inflate(&stream_, Z_NO_FLUSH);
+                    if (status != Z_OK && status != Z_STREAM_END) return ok_ = false;
+                    done_ = status == Z_STREAM_END;
+                    size_t produced = sizeof(out_) - stream_.avail_out;
+                    if (produced > 0 && !emit(out_, produced)) {
+                        stopped = true;
+                        return true;
+                    }
+                }
+                return ok_;
+            }
+            bool finished() const override { return done_; }
+
+        private:
+            z_stream stream_{};
+            bool ok_ = false;
+            bool done_ = false;
+            char out_[kChunk];
+        };
+
+        class Bzip2Decoder : public Decoder {
+        public:
+            Bzip2Decoder() { ok_ = BZ2_bzDecompressInit(&stream_, 0, 0) == BZ_OK; }
+            ~Bzip2Decoder() override { BZ2_bzDecompressEnd(&stream_); }
+
+            bool feed(const unsigned char* data, size_t size, const std::function<bool(const char*, size_t)>& emit, bool& stopped) override {
+                stream_.next_in = const_cast<char*>(reinterpret_cast<const char*>(data));
+                stream_.avail_in = static_cast<unsigned>(size);
+                while (ok_ && !done_ && stream_.avail_in > 0) {
+                    stream_.next_out = out_;
+                    stream_.avail_out = sizeof(out_);
+                    int status = BZ2_bzDecompress(&stream_);
+                    if (status != BZ_OK && status != BZ_STREAM_END) return ok_ = false;
+                    done_ = status == BZ_STREAM_END;
+                    size_t produced = sizeof(out_) - stream_.avail_out;
+                    if (produced > 0 && !emit(out_, produced)) {
+                        stopped = true;
+                        return true;
+                    }
+                }
+                return ok_;
+            }
+            bool finished() const override { return done_; }
+
+        private:
+            bz_stream stream_{};
+            bool ok_ = false;
+            bool done_ = false;
+            char out_[kChunk];
+        };
+
+        class XzDecoder : public Decoder {
+        public:
+            // The auto decoder takes both .xz streams and the legacy .lzma format.
+            XzDecoder() { ok_ = lzma_auto_decoder(&stream_, UINT64_MAX, 0) == LZMA_OK; }
+            ~XzDecoder() override { lzma_end(&stream_); }
+
+            bool feed(const unsigned char* data, size_t size, const std::function<bool(const char*, size_t)>& emit, bool& stopped) override {
+                stream_.next_in = data;
+                stream_.avail_in = size;
+                while (ok_ && !done_ && stream_.avail_in > 0) {
+                    stream_.next_out = reinterpret_cast<uint8_t*>(out_);
+                    stream_.avail_out = sizeof(out_);
+                    lzma_ret status = lzma_code(&stream_, LZMA_RUN);
+                    if (status != LZMA_OK && status != LZMA_STREAM_END) return ok_ = false;
+                    done_ = status == LZMA_STREAM_END;
+                    size_t produced = sizeof(out_) - stream_.avail_out;
+                    if (produced > 0 && !emit(out_, produced)) {
+                        stopped = true;
+                        return true;
+                    }
+                }
+                return ok_;
+            }
+            // Legacy .lzma streams without an end marker never report the end.
+            bool finished() const override { return true; }
+
+        private:
+            lzma_stream stream_ = LZMA_STREAM_INIT;
+            bool ok_ = false;
+            bool done_ = false;
+            char out_[kChunk];
+        };
+
+        std::unique_ptr<Decoder> make_decoder(Encoding encoding) {
+            switch (encoding) {
+                case Encoding::None: return std::make_unique<CopyDecoder>();
+                case Encoding::Gzip: return std::make_unique<ZlibDecoder>();
+                case Encoding::Bzip2: return std::make_unique<Bzip2Decoder>();
+                case Encoding::Xz: return std::make_unique<XzDecoder>();
+                case Encoding::Unsupported: break;
+            }
+            return nullptr;
+        }
+    }
+
+    bool has_signature(const std::string& path) {
+        std::ifstream input(path, std::ios::binary);
+        unsigned char magic[4] = {};
+        return input.read(reinterpret_cast<char*>(magic), sizeof(magic)) && be32(magic) == kMagic;
+    }
+
+    Index read_index(const std::string& path) {
+        trace::Span span("index_xar", "native");
+        Index index;
+        std::ifstream input(path, std::ios::binary);
+        std::error_code ec;
+        uint64_t file_size = fs::file_size(path, ec);
+        unsigned char header[28];
+        if (!input || ec || file_size < sizeof(header)) return index;
+        if (!input.read(reinterpret_cast<char*>(header), sizeof(header)) || be32(header) != kMagic) return index;
+        uint16_t header_size = be16(header + 4);
+        uint64_t toc_packed = be64(header + 8);
+        uint64_t toc_size = be64(header + 16);
+        // Deflate cannot expand more than about 1032:1, which bounds what a damaged header can ask for.
+        if (header_size < sizeof(header) || header_size > file_size || toc_size > kMaxTocSize || toc_size > toc_packed * 1032 + 64 ||
+            toc_packed > file_size - header_size) {
+            return index;
+        }
+
+        std::vector<unsigned char> packed(static_cast<size_t>(toc_packed));
+        input.seekg(header_size);
+        if (!input.read(reinterpret_cast<char*>(packed.data()), static_cast<std::streamsize>(packed.size()))) return index;
+        std::string toc(static_cast<size_t>(toc_size), '\0');
+        uLongf produced = static_cast<uLongf>(toc.size());
+        if (uncompress(reinterpret_cast<Bytef*>(&toc[0]), &produced, packed.data(), static_cast<uLong>(packed.size())) != Z_OK ||
+            produced != toc.size()) {
+            return index;
+        }
+
+        Node root;
+        if (!parse_xml(toc, root)) return index;
+        const Node* xar = root.child("xar");
+        const Node* toc_node = xar ? xar->child("toc") : nullptr;
+        if (!toc_node) return index;
+        collect(*toc_node, "", index.members, 0);
+        index.heap_offset = header_size + toc_packed;
+        index.valid = true;
+        span.arg("members", static_cast<int64_t>(index.members.size()));
+        return index;
+    }
+
+    const char* encoding_name(Encoding encoding) {
+        switch (encoding) {
+            case Encoding::None: return "stored";
+            case Encoding::Gzip: return "gzip";
+            case Encoding::Bzip2: return "bzip2";
+            case Encoding::Xz: return "xz";
+            case Encoding::Unsupported: break;
+        }
+        return "unknown";
+    }
+
+    bool can_decode(const Member& member) {
+        return !member.has_data || member.encoding != Encoding::Unsupported;
+    }
+
+    bool decode_member(const std::string& path, const Index& index, const Member& member,
+                       const std::function<bool(const char*, size_t)>& sink) {
+        if (!member.has_data) return true;
+        if (member.length == 0) return member.size == 0;
+        std::unique_ptr<Decoder> decoder = make_decoder(member.encoding);
+        std::ifstream input(path, std::ios::binary);
+        if (!decoder || !input) return false;
+        input.seekg(static_cast<std::streamoff>(index.heap_offset + member.offset));
+
+        uint64_t produced = 0;
+        bool stopped = false;
+        bool overflow = false;
+        auto emit = [&](const char* data, size_t size) {
+            produced += size;
+            if (produced > member.size) {
+                overflow = true;
+                return false;
+            }
+            return sink(data, size);
+        };
+        std::vector<unsigned char> buffer(kChunk);
+        uint64_t remaining = member.length;
+        while (remaining > 0 && !stopped) {
+            size_t want = static_cast<size_t>(std::min<uint64_t>(remaining, buffer.size()));
+            if (!input.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(want))) return false;
+            remaining -= want;
+            if (!decoder->feed(buffer.data(), want, emit, stopped)) return false;
+        }
+        if (overflow) return false;
+        return stopped || (produced == member.size && decoder->finished());
+    }
+}
@@ -9,17 +9,24 @@
 // website: https://hitmux.org
 // github: https://github.com/Hitmux/hitpag
 
+#include <cstdlib>
 #include <iostream>
 #include <filesystem>
 
+#include "include/archive_diff.h"
+#include "include/archive_scan.h"
 #include "include/args.h"
 #include "include/error.h"
+#include "include/executor.h"
 #include "include/i18n.h"
 #include "include/file_type.h"
 #include "include/operation.h"
 #include "include/interactive.h"
 #include "include/progress.h"
+#include "include/service.h"
+#include "include/simd.h"
 #include "include/target_path.h"
+#include "include/trace.h"
 #include "include/tui.h"
 
 namespace fs = std::filesystem;
@@ -37,13 +44,43 @@ int main(int argc, char* argv[]) {
             return 0;
         }
 
+        executor::configure(options.thread_count);
+        if (options.verbose) {
+            // Queries and --identify keep stdout for their results.
+            (options.query_command.empty() && !options.identify_mode ? std::cout : std::cerr)
+                << i18n::get("simd_kernels", {{"KERNELS", simd::describe()}}) << std::endl;
+        }
+
+        if (!options.trace_path.empty()) {
+            if (!trace::start(options.trace_path)) {
+                error::throw_error(error::ErrorCode::INVALID_TARGET, {{"PATH", options.trace_path}, {"REASON", "cannot create trace file"}});
+            }
+            // Flushed at exit so failed runs, which return from the catch blocks below, are traced too.
+            std::atexit([] { trace::stop(); });
+        }
+
         progress::ProgressTracker tracker;
+        tracker.set_json_output(options.benchmark_json);
+        progress::set_child_accounting(options.benchmark);
 
         if (options.password_prompt) {
             options.password = interactive::get_password_interactively(i18n::get("enter_password"));
         }
 
-        if (!options.tui_mode && !options.interactive_mode &&
+        // Queries and --identify print results to stdout, so they return before the closing status line.
+        if (!options.serve_socket.empty()) {
+            service::serve(options);
+            return 0;
+        }
+        if (!options.query_command.empty()) {
+            return service::run_query(options);
+        }
+        if (options.identify_mode) {
+            archive_scan::run_identify(options);
+            return 0;
+        }
+
+        if (!options.tui_mode && !options.interactive_mode && !options.diff_mode && !options.scan_mode &&
             options.source_paths.empty() && options.source_path.empty() &&
             !options.target_path.empty()) {
             file_type::FileType source_type = file_type::recognize_source_type(options.target_path);
@@ -56,7 +93,11 @@ int main(int argc, char* argv[]) {
             }
         }
 
-        if (options.tui_mode) {
+        if (options.diff_mode) {
+            archive_diff::run(options, tracker);
+        } else if (options.scan_mode) {
+            archive_scan::run(options, tracker);
+        } else if (options.tui_mode) {
             tui::run(options, tracker);
         } else if (options.interactive_mode) {
             interactive::run(options, tracker);
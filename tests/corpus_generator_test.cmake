@@ -0,0 +1,79 @@
+if(NOT DEFINED CORPUS)
+    message(FATAL_ERROR "CORPUS is required")
+endif()
+
+set(test_dir "/opt/hitpag/tmp/corpus_generator_test")
+file(REMOVE_RECURSE "${test_dir}")
+file(MAKE_DIRECTORY "${test_dir}")
+
+function(run_corpus out_var)
+    execute_process(
+        COMMAND "${CORPUS}" ${ARGN}
+        RESULT_VARIABLE status
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE error
+    )
+    if(NOT status EQUAL 0)
+        file(REMOVE_RECURSE "${test_dir}")
+        message(FATAL_ERROR "hitpag_corpus ${ARGN} failed:\n${output}\n${error}")
+    endif()
+    set(${out_var} "${output}" PARENT_SCOPE)
+endfunction()
+
+set(tree_args --seed=7 --files=200 --sizes=lognormal:2K:1.2 --duplicates=0.3 --sparse=0.1 --depth=6 --fanout=3)
+run_corpus(first tree "${test_dir}/a" ${tree_args})
+run_corpus(second tree "${test_dir}/b" ${tree_args})
+run_corpus(other tree "${test_dir}/c" --seed=8 --files=200 --sizes=lognormal:2K:1.2 --duplicates=0.3 --sparse=0.1 --depth=6 --fanout=3)
+if(NOT first STREQUAL second)
+    file(REMOVE_RECURSE "${test_dir}")
+    message(FATAL_ERROR "same seed produced different trees:\n${first}${second}")
+endif()
+if(first STREQUAL other)
+    file(REMOVE_RECURSE "${test_dir}")
+    message(FATAL_ERROR "different seeds produced identical trees:\n${first}")
+endif()
+file(GLOB_RECURSE tree_a RELATIVE "${test_dir}/a" "${test_dir}/a/*")
+file(GLOB_RECURSE tree_b RELATIVE "${test_dir}/b" "${test_dir}/b/*")
+if(NOT tree_a STREQUAL tree_b)
+    file(REMOVE_RECURSE "${test_dir}")
+    message(FATAL_ERROR "same seed produced different layouts")
+endif()
+
+# 70000 entries forces the zip64 end of central directory; 5 GiB forces zip64 sizes and
+# base-256 tar sizes. Both are sparse, so they cost no disk space.
+run_corpus(many archive "${test_dir}/many.zip" --kind=many-entries --entries=70000 --member-size=16)
+run_corpus(huge_zip archive "${test_dir}/huge.zip" --kind=huge-member --member-size=5G)
+run_corpus(huge_tar archive "${test_dir}/huge.tar" --kind=huge-member --member-size=9G)
+run_corpus(long_tar archive "${test_dir}/long.tar" --kind=long-names --entries=5 --name-length=600)
+
+find_program(UNZIP_TOOL unzip)
+if(UNZIP_TOOL)
+    execute_process(COMMAND "${UNZIP_TOOL}" -tq "${test_dir}/many.zip" RESULT_VARIABLE status OUTPUT_VARIABLE output ERROR_VARIABLE error)
+    if(NOT status EQUAL 0)
+        file(REMOVE_RECURSE "${test_dir}")
+        message(FATAL_ERROR "unzip rejected the many-entries zip:\n${output}\n${error}")
+    endif()
+    execute_process(COMMAND "${UNZIP_TOOL}" -l "${test_dir}/huge.zip" RESULT_VARIABLE status OUTPUT_VARIABLE output)
+    if(NOT status EQUAL 0 OR NOT output MATCHES "5368709120")
+        file(REMOVE_RECURSE "${test_dir}")
+        message(FATAL_ERROR "unzip did not list the 5 GiB member:\n${output}")
+    endif()
+endif()
+
+find_program(TAR_TOOL tar)
+if(TAR_TOOL)
+    execute_process(COMMAND "${TAR_TOOL}" -tvf "${test_dir}/huge.tar" RESULT_VARIABLE status OUTPUT_VARIABLE output ERROR_VARIABLE error)
+    if(NOT status EQUAL 0 OR NOT output MATCHES "9663676416")
+        file(REMOVE_RECURSE "${test_dir}")
+        message(FATAL_ERROR "tar did not list the 9 GiB member:\n${output}\n${error}")
+    endif()
+    execute_process(COMMAND "${TAR_TOOL}" -tf "${test_dir}/long.tar" RESULT_VARIABLE status OUTPUT_VARIABLE output ERROR_VARIABLE error)
+    string(REGEX MATCH "[^\n]*file4\\.txt" long_name "${output}")
+    string(LENGTH "${long_name}" long_name_length)
+    if(NOT status EQUAL 0 OR long_name_length LESS 590)
+        file(REMOVE_RECURSE "${test_dir}")
+        message(FATAL_ERROR "tar did not read the long pax names:\n${output}\n${error}")
+    endif()
+endif()
+
+file(REMOVE_RECURSE "${test_dir}")
@@ -0,0 +1,332 @@
+// Copyright (C) 2025 Hitmux
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// Performance regression scenarios (ctest label "perf"). Medians are compared against
+// tests/perf_baseline.tsv; results are written as JSON artifacts and appended to a history file.
+
+#include "bench_stats.h"
+#include "corpus_gen.h"
+#include "include/args.h"
+#include "include/operation.h"
+#include "include/progress.h"
+#include "include/tui_archive_list.h"
+#include "include/tui_archive_ops.h"
+#include "include/tui_preview.h"
+#include "include/util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+using tui::archive_ops::ArchiveEntry;
+
+namespace {
+    constexpr double DEFAULT_TOLERANCE_PCT = 100.0;
+    // Absolute slack so sub-millisecond medians do not fail on scheduler noise.
+    constexpr double SLACK_MS = 2.0;
+
+    struct Result {
+        std::string scenario;
+        std::string detail;
+        bench::Summary summary;
+        bool skipped = false;
+        std::string status = "ok";
+        double baseline_ms = 0.0;
+        double limit_ms = 0.0;
+    };
+
+    struct Baseline {
+        double median_ms = 0.0;
+        double tolerance_pct = DEFAULT_TOLERANCE_PCT;
+    };
+
+    std::map<std::string, Baseline> read_baseline(const std::string& path) {
+        std::map<std::string, Baseline> baseline;
+        std::ifstream input(path);
+        std::string line;
+        while (std::getline(input, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream fields(line);
+            std::string name;
+            Baseline entry;
+            if (fields >> name >> entry.median_ms) {
+                if (!(fields >> entry.tolerance_pct)) entry.tolerance_pct = DEFAULT_TOLERANCE_PCT;
+                baseline[name] = entry;
+            }
+        }
+        return baseline;
+    }
+
+    bool write_baseline(const std::string& path, const std::vector<Result>& results,
+                        const std::map<std::string, Baseline>& previous) {
+        std::ofstream output(path, std::ios::trunc);
+        if (!output) return false;
+        output << "# scenario\tmedian_ms\ttolerance_pct\n";
+        for (const auto& result : results) {
+            if (result.skipped) continue;
+            auto it = previous.find(result.scenario);
+            double tolerance = it == previous.end() ? DEFAULT_TOLERANCE_PCT : it->second.tolerance_pct;
+            output << result.scenario << '\t' << std::fixed << std::setprecision(3) << result.summary.median_ms
+                   << '\t' << std::setprecision(0) << tolerance << '\n';
+        }
+        return output.good();
+    }
+
+    std::string result_json(const Result& result) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3)
+            << "{\"scenario\":" << util::json_quote(result.scenario)
+            << ",\"detail\":" << util::json_quote(result.detail)
+            << ",\"status\":" << util::json_quote(result.status)
+            << ",\"samples\":" << result.summary.runs
+            << ",\"median_ms\":" << result.summary.median_ms
+            << ",\"p95_ms\":" << result.summary.p95_ms
+            << ",\"max_ms\":" << result.summary.max_ms
+            << ",\"baseline_ms\":" << result.baseline_ms
+            << ",\"limit_ms\":" << result.limit_ms << '}';
+        return out.str();
+    }
+
+    void write_artifacts(const fs::path& dir, const std::vector<Result>& results) {
+        std::error_code ec;
+        fs::create_directories(dir, ec);
+        const long long timestamp = static_cast<long long>(std::time(nullptr));
+
+        std::ofstream latest(dir / "perf_results.json", std::ios::trunc);
+        latest << "{\"timestamp\":" << timestamp << ",\"results\":[\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            latest << "  " << result_json(results[i]) << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        latest << "]}\n";
+
+        // One line per run, so trends survive across builds of the same tree.
+        std::ofstream history(dir / "perf_history.jsonl", std::ios::app);
+        history << "{\"timestamp\":" << timestamp << ",\"results\":[";
+        for (size_t i = 0; i < results.size(); ++i) {
+            history << (i ? "," : "") << result_json(results[i]);
+        }
+        history << "]}\n";
+    }
+
+    template <typename Fn>
+    std::vector<double> repeat(int reps, Fn&& fn) {
+        std::vector<double> samples;
+        for (int i = 0; i < reps; ++i) samples.push_back(bench::time_ms(fn));
+        return samples;
+    }
+
+    class Scenarios {
+    public:
+        explicit Scenarios(fs::path work_dir) : work_dir_(std::move(work_dir)) {}
+
+        std::vector<Result> run() {
+            std::error_code ec;
+            fs::remove_all(work_dir_, ec);
+            fs::create_directories(work_dir_);
+
+            std::vector<Result> results;
+            const bool have_unzip = operation::is_tool_available("unzip");
+            const bool have_zip = operation::is_tool_available("zip");
+
+            results.push_back(have_unzip ? list_big_zip() : skipped("list_500k_zip", "unzip not available"));
+            results.push_back(!big_entries_.empty() ? navigate() : skipped("navigate_dirs", "no listing"));
+            results.push_back(!big_entries_.empty() ? search() : skipped("search_1000", "no listing"));
+            results.push_back(have_unzip ? preview() : skipped("preview_1000", "unzip not available"));
+            results.push_back(have_zip ? compress_parallel() : skipped("compress_parallel", "zip not available"));
+
+            fs::remove_all(work_dir_, ec);
+            return results;
+        }
+
+    private:
+        fs::path work_dir_;
+        std::vector<ArchiveEntry> big_entries_;
+
+        static Result skipped(const std::string& name, const std::string& why) {
+            Result result;
+            result.scenario = name;
+            result.skipped = true;
+            result.status = "skipped: " + why;
+            return result;
+        }
+
+        Result list_big_zip() {
+            corpus::ArchiveOptions options;
+            options.kind = corpus::Pathology::ManyEntries;
+            options.format = file_type::FileType::ARCHIVE_ZIP;
+            options.entries = 500000;
+            fs::path archive = work_dir_ / "list-500k.zip";
+            corpus::generate_archive(archive.string(), options);
+
+            Result result{"list_500k_zip", "list_archive over a 500k-entry zip, 3 runs"};
+            result.summary = bench::summarize(repeat(3, [&]() {
+                big_entries_ = tui::archive_ops::list_archive(archive.string(), file_type::FileType::ARCHIVE_ZIP);
+            }));
+            if (big_entries_.size() != options.entries) result.status = "wrong entry count";
+            return result;
+        }
+
+        // Enter a directory, move around, go back up: each event is one sample.
+        Result navigate() {
+            tui::ArchiveList list;
+            list.set_entries("list-500k.zip", file_type::FileType::ARCHIVE_ZIP, big_entries_);
+            std::vector<double> samples;
+            for (int cycle = 0; cycle < 5; ++cycle) {
+                list.set_selected_index(cycle * 37);
+                samples.push_back(bench::time_ms([&]() { list.enter_selected(); }));
+                samples.push_back(bench::time_ms([&]() { list.page_down(); list.selected_entry(); }));
+                samples.push_back(bench::time_ms([&]() { list.go_parent(); }));
+            }
+            Result result{"navigate_dirs", "enter/page/parent events on the 500k listing"};
+            result.summary = bench::summarize(samples);
+            return result;
+        }
+
+        // Typing 1000 incremental queries against a 10k-entry slice of the listing.
+        Result search() {
+            std::vector<ArchiveEntry> slice(big_entries_.begin(),
+                big_entries_.begin() + static_cast<std::ptrdiff_t>(std::min<size_t>(10000, big_entries_.size())));
+            tui::ArchiveList list;
+            list.set_entries("list-500k.zip", file_type::FileType::ARCHIVE_ZIP, std::move(slice));
+
+            std::vector<double> samples;
+            for (int word = 0; samples.size() < 1000; ++word) {
+                char target[16];
+                std::snprintf(target, sizeof(target), "f%07d", word * 97 % 10000);
+                std::string query;
+                for (size_t i = 0; target[i] != '\0' && samples.size() < 1000; ++i) {
+                    query += target[i];
+                    samples.push_back(bench::time_ms([&]() { list.set_search_query(query); }));
+                }
+            }
+            Result result{"search_1000", "1000 incremental searches over 10k entries"};
+            result.summary = bench::summarize(samples);
+            return result;
+        }
+
+        Result preview() {
+            corpus::ArchiveOptions options;
+            options.kind = corpus::Pathology::ManyEntries;
+            options.format = file_type::FileType::ARCHIVE_ZIP;
+            options.entries = 1000;
+            options.member_size = 2048;
+            fs::path archive = work_dir_ / "preview-1k.zip";
+            corpus::generate_archive(archive.string(), options);
+
+            tui::PreviewPanel panel;
+            std::vector<double> samples;
+            for (const auto& member : corpus::pathological_members(options)) {
+                samples.push_back(bench::time_ms([&]() {
+                    panel.load(archive.string(), member.path, file_type::FileType::ARCHIVE_ZIP);
+                    panel.wrapped_line_count();
+                }));
+            }
+            Result result{"preview_1000", "load and wrap 1000 zip members"};
+            result.summary = bench::summarize(samples);
+            return result;
+        }
+
+        Result compress_parallel() {
+            corpus::TreeOptions tree;
+            tree.seed = 84;
+            tree.files = 1000;
+            tree.compressibility = 0.7;
+            fs::path source = work_dir_ / "compress-src";
+            corpus::generate_tree(source.string(), tree);
+
+            args::Options options;
+            options.thread_count = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            fs::path target = work_dir_ / "compress.zip";
+            std::vector<operation::CompressionSource> sources = {{source.string(), true}};
+
+            std::vector<double> samples;
+            {
+                bench::StdoutSilencer silence;
+                samples = repeat(3, [&]() {
+                    fs::remove(target);
+                    progress::ProgressTracker tracker;
+                    operation::compress(sources, target.string(), file_type::FileType::ARCHIVE_ZIP, "", options, tracker);
+                });
+            }
+
+            Result result{"compress_parallel", "zip 1000 generated files with -t" + std::to_string(options.thread_count)};
+            result.summary = bench::summarize(samples);
+            return result;
+        }
+    };
+}
+
+int main(int argc, char* argv[]) {
+    std::string baseline_path;
+    std::string artifacts_dir;
+    bool update = std::getenv("HITPAG_PERF_UPDATE_BASELINE") != nullptr;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--baseline=", 0) == 0) baseline_path = arg.substr(11);
+        else if (arg.rfind("--artifacts=", 0) == 0) artifacts_dir = arg.substr(12);
+        else if (arg == "--update-baseline") update = true;
+        else {
+            std::cerr << "Usage: hitpag_perf_test --baseline=FILE [--artifacts=DIR] [--update-baseline]" << std::endl;
+            return 2;
+        }
+    }
+
+    const auto baseline = read_baseline(baseline_path);
+    std::vector<Result> results;
+    try {
+        results = Scenarios("/opt/hitpag/tmp/perf_test").run();
+    } catch (const std::exception& ex) {
+        std::cerr << "FAIL: perf scenario aborted: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    bool ok = true;
+    std::cout << std::left << std::setw(20) << "scenario" << std::right << std::setw(9) << "samples"
+              << std::setw(13) << "median_ms" << std::setw(13) << "p95_ms" << std::setw(13) << "limit_ms" << "  status\n";
+    for (auto& result : results) {
+        if (!result.skipped) {
+            auto it = baseline.find(result.scenario);
+            if (it != baseline.end()) {
+                result.baseline_ms = it->second.median_ms;
+                result.limit_ms = it->second.median_ms * (1.0 + it->second.tolerance_pct / 100.0) + SLACK_MS;
+                if (!update && result.summary.median_ms > result.limit_ms && result.status == "ok") {
+                    result.status = "REGRESSION";
+                }
+            } else if (result.status == "ok") {
+                result.status = "no baseline";
+            }
+        }
+        if (result.status != "ok" && result.status != "no baseline" && !result.skipped) ok = false;
+
+        std::cout << std::left << std::setw(20) << result.scenario << std::right << std::setw(9) << result.summary.runs
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(13) << result.summary.median_ms << std::setw(13) << result.summary.p95_ms
+                  << std::setw(13) << result.limit_ms << "  " << result.status << '\n';
+    }
+
+    if (!artifacts_dir.empty()) write_artifacts(artifacts_dir, results);
+    if (update) {
+        if (!write_baseline(baseline_path, results, baseline)) {
+            std::cerr << "FAIL: cannot write baseline " << baseline_path << std::endl;
+            return 1;
+        }
+        std::cout << "baseline updated: " << baseline_path << std::endl;
+        return 0;
+    }
+    return ok ? 0 : 1;
+}
@@ -1,15 +1,43 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "include/archive.h"
+#include "include/archive_backend.h"
+#include "include/archive_diff.h"
+#include "include/archive_scan.h"
 #include "include/args.h"
+#include "include/checksum.h"
 #include "include/error.h"
+#include "include/executor.h"
 #include "include/i18n.h"
+#include "include/ingest.h"
 #include "include/operation.h"
+#include "include/progress.h"
+#include "include/rar.h"
+#include "include/simd.h"
+#include "include/service.h"
+#include "include/sevenzip.h"
+#include "include/stream_probe.h"
+#include "include/tar_writer.h"
+#include "include/trace.h"
 #include "include/tui_archive_ops.h"
+#include "include/util.h"
+#include "include/xar.h"
 
 namespace fs = std::filesystem;
 
@@ -141,6 +169,12 @@ namespace {
             "tui_preview_directories_suffix",
             "tui_preview_files_suffix",
             "tui_preview_first_entries",
+            "tui_perf_title",
+            "tui_perf_frame",
+            "tui_perf_filter",
+            "tui_perf_preview",
+            "tui_perf_listing",
+            "tui_perf_cache",
         };
 
         for (const std::string& key : keys) {
@@ -163,6 +197,8 @@ namespace {
 
         int tar_status = std::system((std::string("tar -cf ") + archive_path.string() + " -C " + tmp_root.string() + " empty.txt").c_str());
         ok &= expect(tar_status == 0, "tar command should create a test archive");
+        ok &= expect(file_type::recognize_by_header(archive_path.string()) == file_type::FileType::ARCHIVE_TAR,
+            "a ustar header should be recognized without an extension hint");
 
         std::vector<tui::archive_ops::ArchiveEntry> entries =
             tui::archive_ops::list_archive(archive_path.string(), file_type::FileType::ARCHIVE_TAR, "");
@@ -175,6 +211,8 @@ namespace {
         ok &= expect(extraction.success, "extract_text should succeed for an existing tar entry");
         ok &= expect(extraction.empty_file, "extract_text should mark empty extracted content as empty_file");
         ok &= expect(extraction.content.empty(), "extract_text should return empty content for empty file");
+        ok &= expect(extraction.spawn_ms > 0.0 && extraction.decode_ms >= 0.0,
+            "extract_text should report spawn and decode time for the performance overlay");
 
         return ok;
     }
@@ -196,6 +234,10 @@ namespace {
         std::vector<tui::archive_ops::ArchiveEntry> entries =
             tui::archive_ops::list_archive(archive_path.string(), type, "");
         ok &= expect(!entries.empty(), "list_archive should expose a synthetic entry for " + tool);
+        // zstd records the content size for files; lz4 only with --content-size.
+        if (tool == "zstd" && !entries.empty()) {
+            ok &= expect(entries.front().size == 31 && entries.front().compressed_size > 0, "zstd listing should report the frame content size");
+        }
 
         tui::archive_ops::TextExtractionResult extraction =
             tui::archive_ops::extract_text(archive_path.string(), entries.empty() ? "" : entries.front().path, type, "");
@@ -212,6 +254,1223 @@ namespace {
 
         return ok;
     }
+
+    bool test_archive_diff(const fs::path& tmp_root) {
+        if (!operation::is_tool_available("zip") || !operation::is_tool_available("gzip")) {
+            std::cout << "skip archive diff coverage: zip or gzip not available" << std::endl;
+            return true;
+        }
+
+        bool ok = true;
+        fs::path v1 = tmp_root / "diff-v1";
+        fs::path v2 = tmp_root / "diff-v2";
+        std::error_code ec;
+        fs::create_directories(v1 / "docs", ec);
+        fs::create_directories(v2 / "docs", ec);
+        ok &= expect(write_text_file(v1 / "same.txt", "unchanged\n"), "should create diff input");
+        ok &= expect(write_text_file(v2 / "same.txt", "unchanged\n"), "should create diff input");
+        ok &= expect(write_text_file(v1 / "docs" / "edit me.txt", "first\n"), "should create diff input");
+        ok &= expect(write_text_file(v2 / "docs" / "edit me.txt", "secnd\n"), "should create diff input");
+        ok &= expect(write_text_file(v1 / "gone.txt", "bye\n"), "should create diff input");
+        ok &= expect(write_text_file(v2 / "new.txt", "hi\n"), "should create diff input");
+
+        auto make = [&](const std::string& command) {
+            ok &= expect(std::system(command.c_str()) == 0, "archive command should succeed: " + command);
+        };
+        make("cd " + v1.string() + " && zip -qr ../diff-v1.zip same.txt docs gone.txt");
+        make("cd " + v2.string() + " && zip -qr ../diff-v2.zip same.txt docs new.txt");
+        make("tar -czf " + (tmp_root / "diff-v1.tar.gz").string() + " -C " + v1.string() + " .");
+        make("tar -czf " + (tmp_root / "diff-v2.tar.gz").string() + " -C " + v2.string() + " .");
+
+        auto summarize = [](const archive_diff::DiffResult& result) {
+            std::string summary;
+            for (const auto& change : result.changes) {
+                char marker = change.kind == archive_diff::ChangeKind::Added ? 'A'
+                    : change.kind == archive_diff::ChangeKind::Removed ? 'D' : 'M';
+                summary += std::string(1, marker) + ":" + change.path + ";";
+            }
+            return summary + "unchanged=" + std::to_string(result.unchanged);
+        };
+        const std::string expected = "M:docs/edit me.txt;D:gone.txt;A:new.txt;unchanged=2";
+
+        archive_diff::DiffResult zip_diff = archive_diff::diff(
+            (tmp_root / "diff-v1.zip").string(), file_type::FileType::ARCHIVE_ZIP,
+            (tmp_root / "diff-v2.zip").string(), file_type::FileType::ARCHIVE_ZIP, "", 2);
+        ok &= expect_equal(summarize(zip_diff), expected, "zip diff should classify entries from listing CRCs");
+
+        archive_diff::DiffResult tar_diff = archive_diff::diff(
+            (tmp_root / "diff-v1.tar.gz").string(), file_type::FileType::ARCHIVE_TAR_GZ,
+            (tmp_root / "diff-v2.tar.gz").string(), file_type::FileType::ARCHIVE_TAR_GZ, "", 2);
+        ok &= expect_equal(summarize(tar_diff), expected, "tar.gz diff should classify entries from streamed hashes");
+        ok &= expect(tar_diff.used_content_hashes, "tar diff should report hashing fallback");
+
+        archive_diff::DiffResult mixed_diff = archive_diff::diff(
+            (tmp_root / "diff-v1.zip").string(), file_type::FileType::ARCHIVE_ZIP,
+            (tmp_root / "diff-v1.tar.gz").string(), file_type::FileType::ARCHIVE_TAR_GZ, "", 2);
+        ok &= expect_equal(summarize(mixed_diff), "unchanged=4", "zip and tar of the same tree should have matching CRCs");
+
+        // End of central directory record with no entries.
+        fs::path empty_zip = tmp_root / "diff-empty.zip";
+        {
+            std::ofstream output(empty_zip, std::ios::binary);
+            output.write("PK\x05\x06", 4);
+            output.write(std::string(18, '\0').data(), 18);
+        }
+        try {
+            archive_diff::DiffResult empty_diff = archive_diff::diff(
+                empty_zip.string(), file_type::FileType::ARCHIVE_ZIP,
+                (tmp_root / "diff-v1.zip").string(), file_type::FileType::ARCHIVE_ZIP, "", 2);
+            ok &= expect(empty_diff.changes.size() == 4 && empty_diff.unchanged == 0, "diff against an empty zip should report every entry as added");
+        } catch (const std::exception& e) {
+            ok &= expect(false, std::string("an empty zip should diff, not fail: ") + e.what());
+        }
+        bool failed = false;
+        try {
+            archive_diff::diff((tmp_root / "missing.zip").string(), file_type::FileType::ARCHIVE_ZIP,
+                (tmp_root / "diff-v1.zip").string(), file_type::FileType::ARCHIVE_ZIP, "", 2);
+        } catch (const std::exception&) {
+            failed = true;
+        }
+        ok &= expect(failed, "an unlistable archive should still fail the diff");
+
+        return ok;
+    }
+
+    bool test_benchmark_json() {
+        bool ok = true;
+        progress::set_child_accounting(true);
+        progress::ProgressTracker tracker;
+        tracker.start_operation();
+        tracker.begin_phase("verify", "true");
+        ok &= expect(tui::archive_ops::run_command_status({"true"}) == 0, "child command should succeed");
+        tracker.end_phase(1024, 0);
+        tracker.end_operation();
+        progress::set_child_accounting(false);
+
+        ok &= expect(tracker.phases().size() == 1 && tracker.phases().front().child_count == 1,
+            "phase should own the child spawned inside it");
+
+        std::ostringstream json;
+        tracker.print_json(json);
+        const std::string line = json.str();
+        ok &= expect(line.find("\"name\":\"verify\",\"backend\":\"true\"") != std::string::npos, "json should name the phase and backend");
+        ok &= expect(line.find("\"tool\":\"true\",\"exit_code\":0") != std::string::npos, "json should list child rusage");
+        ok &= expect(std::count(line.begin(), line.end(), '\n') == 1, "json should be a single line");
+        return ok;
+    }
+
+    bool test_crc32_zeros() {
+        bool ok = true;
+        const std::string zeros(100000, '\0');
+        const uint32_t seed = checksum::crc32(0, "abc", 3);
+        ok &= expect(checksum::crc32_zeros(seed, zeros.size()) == checksum::crc32(seed, zeros.data(), zeros.size()),
+            "crc32_zeros should match a CRC over real zero bytes");
+        ok &= expect(checksum::crc32_zeros(0, 1) == 0xD202EF8Du, "crc32 of one zero byte");
+        ok &= expect(checksum::crc32_zeros(seed, 0) == seed, "zero-length extension should be a no-op");
+        return ok;
+    }
+
+    bool test_live_progress_line() {
+        bool ok = true;
+        const uint64_t mib = 1024 * 1024;
+        ok &= expect_equal(progress::LiveProgress::format_line(50 * mib, 25 * mib, 100 * mib, true, 1.0),
+            "50.0% 50.0 MiB/100.0 MiB  52.4 MB/s  ratio 50.0%  ETA 1s", "progress line should show rate, ratio and ETA");
+        ok &= expect_equal(progress::LiveProgress::format_line(0, 0, 0, false, 0.0),
+            "--% 0 B/?  0.0 MB/s  ratio --  ETA --", "progress line should tolerate unknown totals");
+
+        progress::LiveProgress live(progress::LiveProgress::Mode::Off, "compress", true, 10);
+        live.add_input(10);
+        live.finish();
+        ok &= expect(!live.enabled(), "disabled progress should stay silent");
+        return ok;
+    }
+
+    bool test_trace_export(const fs::path& tmp_root) {
+        bool ok = true;
+        fs::path trace_file = tmp_root / "trace.json";
+        ok &= expect(trace::start(trace_file.string()), "trace should start");
+        {
+            trace::Span span("outer", "test");
+            span.arg("note", std::string("quote\"d"));
+            ok &= expect(tui::archive_ops::run_command_status({"true"}) == 0, "traced command should succeed");
+        }
+        ok &= expect(trace::stop(), "trace should be written");
+        {
+            trace::Span ignored("after_stop", "test");
+        }
+
+        std::ifstream input(trace_file);
+        std::string json((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        ok &= expect(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0, "trace should use Chrome trace format");
+        ok &= expect(json.find("\"name\":\"spawn\"") != std::string::npos &&
+                     json.find("\"argv\":\"true\",\"exit_code\":0") != std::string::npos, "trace should record tool spawns");
+        ok &= expect(json.find("\"note\":\"quote\\\"d\"") != std::string::npos, "trace args should be JSON-escaped");
+        ok &= expect(json.find("after_stop") == std::string::npos, "spans after stop should be dropped");
+        ok &= expect_equal(trace::redacted_command({"zip", "-P", "secret", "-pother", "a.zip"}), "zip -P *** -p*** a.zip",
+            "trace argv should mask passwords");
+        return ok;
+    }
+
+    bool test_archive_scan(const fs::path& tmp_root) {
+        if (!operation::is_tool_available("zip") || !operation::is_tool_available("unzip")) {
+            std::cout << "skip archive scan coverage: zip or unzip not available" << std::endl;
+            return true;
+        }
+
+        bool ok = true;
+        fs::path root = tmp_root / "scan-root";
+        std::error_code ec;
+        fs::create_directories(root / "nested", ec);
+        ok &= expect(write_text_file(root / "notes.txt", "not an archive\n"), "should create scan input");
+        ok &= expect(write_text_file(root / "payload.txt", std::string(64, 'x') + "\n" + std::string(4096, 'y')), "should create scan input");
+        ok &= expect(std::system(("cd " + root.string() + " && zip -q good.zip payload.txt && tar -czf nested/good.tar.gz payload.txt").c_str()) == 0,
+            "should create scan archives");
+
+        std::ifstream good_zip(root / "good.zip", std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(good_zip)), std::istreambuf_iterator<char>());
+        ok &= expect(write_text_file(root / "nested" / "bad.zip", bytes.substr(0, bytes.size() / 2)), "should create truncated zip");
+
+        auto statuses = [](const std::vector<archive_scan::ScanRecord>& records) {
+            std::string summary;
+            for (const auto& record : records) {
+                summary += fs::path(record.path).filename().string() + "=" + archive_scan::status_name(record.status) + ";";
+            }
+            return summary;
+        };
+
+        archive_scan::ScanOptions scan_options;
+        scan_options.thread_count = 2;
+        std::vector<archive_scan::ScanRecord> first = archive_scan::scan(root.string(), scan_options);
+        std::sort(first.begin(), first.end(), [](const auto& a, const auto& b) { return a.path < b.path; });
+        ok &= expect_equal(statuses(first), "good.zip=ok;bad.zip=failed;good.tar.gz=ok;", "scan should verify each archive once");
+
+        fs::path report = tmp_root / "scan.tsv";
+        ok &= expect(archive_scan::write_report(report.string(), first), "scan report should be written");
+        scan_options.previous = archive_scan::read_report(report.string());
+        ok &= expect(scan_options.previous.size() == 3, "scan report should round-trip");
+
+        std::vector<archive_scan::ScanRecord> second = archive_scan::scan(root.string(), scan_options);
+        std::sort(second.begin(), second.end(), [](const auto& a, const auto& b) { return a.path < b.path; });
+        ok &= expect_equal(statuses(second), "good.zip=cached;bad.zip=failed;good.tar.gz=cached;",
+            "incremental scan should only re-verify failed or changed archives");
+
+        return ok;
+    }
+
+    bool test_archive_api(const fs::path& tmp_root) {
+        bool ok = true;
+        fs::path archive_path = tmp_root / "api.tar.gz";
+        fs::path source = tmp_root / "api-source.txt";
+        ok &= expect(write_text_file(source, "from disk\n"), "should create writer input");
+
+        bool final_progress = false;
+        {
+            archive::ArchiveWriter writer(archive_path.string());
+            writer.add_data("docs/readme.txt", "hello archive api\n");
+            writer.add_file(source.string(), "docs/source.txt");
+            auto stream = writer.open_entry("data/numbers.txt");
+            for (int i = 0; i < 1000; ++i) stream.write(std::to_string(i) + "\n");
+            stream.close();
+            writer.finish([&](const progress::Update& update) { final_progress |= update.final; });
+        }
+        ok &= expect(final_progress, "ArchiveWriter should report final progress");
+
+        archive::ArchiveReader reader(archive_path.string());
+        ok &= expect(reader.type() == file_type::FileType::ARCHIVE_TAR_GZ, "ArchiveReader should detect the format");
+        ok &= expect(reader.find("docs/readme.txt") != nullptr, "ArchiveReader should list written entries");
+        size_t files = 0;
+        reader.for_each([&](const archive::Entry& entry) {
+            if (!entry.is_directory) ++files;
+            return true;
+        });
+        ok &= expect(files == 3, "ArchiveReader should iterate every file entry");
+        ok &= expect_equal(reader.read("docs/source.txt"), "from disk\n", "ArchiveReader should read whole entries");
+
+        char window[8] = {};
+        size_t copied = reader.read("data/numbers.txt", 10, window, 7);
+        ok &= expect_equal(std::string(window, copied), "5\n6\n7\n8", "ArchiveReader should read at an offset");
+        ok &= expect(reader.verify(), "ArchiveReader should verify the archive");
+
+        reader.extract("docs/readme.txt", (tmp_root / "api-out").string());
+        ok &= expect(fs::exists(tmp_root / "api-out" / "docs" / "readme.txt"), "ArchiveReader should extract one entry");
+
+        bool threw = false;
+        try {
+            archive::ArchiveWriter bad((tmp_root / "bad.tar").string());
+            bad.add_data("../escape.txt", "x");
+        } catch (const error::HitpagException&) {
+            threw = true;
+        }
+        ok &= expect(threw, "ArchiveWriter should reject entry paths outside the archive");
+
+        // Staged files may be hard links to the sources; replacing an entry must not write through them.
+        fs::path first = tmp_root / "api-first.txt";
+        fs::path second = tmp_root / "api-second.txt";
+        ok &= expect(write_text_file(first, "first\n") && write_text_file(second, "second\n"), "should create writer inputs");
+        fs::path replaced_path = tmp_root / "api-replaced.tar";
+        {
+            archive::ArchiveWriter writer(replaced_path.string());
+            writer.add_file(first.string(), "a.txt");
+            writer.add_file(second.string(), "a.txt");
+            writer.add_file(second.string(), "b.txt");
+            writer.add_data("b.txt", "replaced\n");
+            writer.finish();
+        }
+        std::ifstream first_input(first, std::ios::binary);
+        std::ifstream second_input(second, std::ios::binary);
+        ok &= expect_equal(std::string((std::istreambuf_iterator<char>(first_input)), std::istreambuf_iterator<char>()), "first\n",
+            "adding an entry again should leave the earlier source untouched");
+        ok &= expect_equal(std::string((std::istreambuf_iterator<char>(second_input)), std::istreambuf_iterator<char>()), "second\n",
+            "replacing an entry with data should leave its source untouched");
+        archive::ArchiveReader replaced(replaced_path.string());
+        ok &= expect_equal(replaced.read("a.txt"), "second\n", "the last file added under a name should win");
+        ok &= expect_equal(replaced.read("b.txt"), "replaced\n", "data added under a name should replace the file");
+        return ok;
+    }
+    class FakeBackend : public backend::ArchiveBackend {
+    public:
+        FakeBackend(std::string name, double startup_ms) : name_(std::move(name)), startup_ms_(startup_ms) {}
+        std::string name() const override { return name_; }
+        std::vector<backend::Capability> capabilities() const override {
+            return {{backend::Operation::List, file_type::FileType::ARCHIVE_TAR, backend::Cost{startup_ms_, 0.0}}};
+        }
+
+    private:
+        std::string name_;
+        double startup_ms_;
+    };
+
+    bool test_archive_backends(const fs::path& tmp_root) {
+        bool ok = true;
+        fs::path root = tmp_root / "backends";
+        std::string long_name(120, 'n');
+        fs::create_directories(root / "dir" / "sub");
+        ok &= expect(write_text_file(root / "dir" / "a.txt", "0123456789abcdef\n"), "should create backend input");
+        ok &= expect(write_text_file(root / "dir" / "sub" / (long_name + ".txt"), "long\n"), "should create long-named input");
+        std::string tar_path = (tmp_root / "backends.tar").string();
+        std::string zip_path = (tmp_root / "backends.zip").string();
+        ok &= expect(std::system(("cd " + root.string() + " && tar -cf " + tar_path + " dir && zip -qr " + zip_path + " dir").c_str()) == 0,
+            "backend test archives should be created");
+
+        backend::Registry local;
+        local.add(std::make_unique<FakeBackend>("slow", 10.0));
+        local.add(std::make_unique<FakeBackend>("fast", 1.0));
+        backend::Archive fake{tar_path, file_type::FileType::ARCHIVE_TAR, ""};
+        backend::ArchiveBackend* chosen = local.select(backend::Operation::List, fake);
+        ok &= expect(chosen && chosen->name() == "fast", "registry should pick the cheapest declared backend");
+        local.record(*chosen, backend::Operation::List, fake, 500.0);
+        chosen = local.select(backend::Operation::List, fake);
+        ok &= expect(chosen && chosen->name() == "slow", "measured costs should override declared ones");
+        ok &= expect(local.select(backend::Operation::Extract, fake) == nullptr, "undeclared operations should not dispatch");
+
+        backend::Archive tar{tar_path, file_type::FileType::ARCHIVE_TAR, ""};
+        chosen = backend::registry().select(backend::Operation::List, tar);
+        ok &= expect(chosen && chosen->name() == "native-tar", "plain tar should be listed natively");
+        auto native = backend::registry().list(tar);
+        auto tool = tui::archive_ops::parse_tar_listing(tui::archive_ops::run_command_capture({"tar", "-tf", tar_path}).stdout_output);
+        ok &= expect(native.size() == tool.size(), "native tar listing should match tar -tf");
+        for (size_t i = 0; i < std::min(native.size(), tool.size()); ++i) {
+            ok &= expect_equal(native[i].path, tool[i].path, "native tar entry path should match tar -tf");
+            ok &= expect(native[i].is_directory == tool[i].is_directory, "native tar directory flag should match tar -tf");
+        }
+
+        char window[4] = {};
+        size_t copied = 0;
+        ok &= expect(backend::registry().read_at(tar, "dir/a.txt", 10, window, sizeof(window), copied), "native tar should seek into an entry");
+        ok &= expect_equal(std::string(window, copied), "abcd", "native tar seek should return the requested window");
+        ok &= expect_equal(tui::archive_ops::extract_to_string(tar_path, "dir/sub/" + long_name + ".txt", tar.format), "long\n",
+            "native tar should read GNU long-name members");
+
+        std::string corrupt_path = (tmp_root / "corrupt.tar").string();
+        fs::copy_file(tar_path, corrupt_path, fs::copy_options::overwrite_existing);
+        {
+            std::fstream corrupt(corrupt_path, std::ios::in | std::ios::out | std::ios::binary);
+            corrupt.seekp(148);
+            corrupt.write("9999999", 7);
+        }
+        ok &= expect(operation::verify_archive(tar_path, tar.format, true), "intact tar should verify");
+        ok &= expect(!operation::verify_archive(corrupt_path, tar.format, true), "a header checksum mismatch should fail verification");
+
+        backend::Archive zip{zip_path, file_type::FileType::ARCHIVE_ZIP, ""};
+        chosen = backend::registry().select(backend::Operation::List, zip);
+        ok &= expect(chosen && chosen->name() == "native-zip", "zip should be listed from the central directory");
+        auto native_zip = backend::registry().list(zip);
+        auto unzip = tui::archive_ops::parse_unzip_listing(tui::archive_ops::run_command_capture({"unzip", "-v", zip_path}).stdout_output);
+        ok &= expect(native_zip.size() == unzip.size(), "native zip listing should match unzip -v");
+        for (size_t i = 0; i < std::min(native_zip.size(), unzip.size()); ++i) {
+            ok &= expect_equal(native_zip[i].path, unzip[i].path, "native zip entry path should match unzip -v");
+            ok &= expect_equal(native_zip[i].method, unzip[i].method, "native zip method should match unzip -v");
+            ok &= expect_equal(native_zip[i].modified, unzip[i].modified, "native zip timestamp should match unzip -v");
+            ok &= expect(native_zip[i].size == unzip[i].size && native_zip[i].crc == unzip[i].crc,
+                "native zip size and CRC should match unzip -v");
+        }
+        return ok;
+    }
+    // bsdtar --format 7zip (LZMA, compressed header) of dir/{a.txt,b.txt,empty,sub/}.
+    const unsigned char kSevenZipFixture[] = {
+            0x37, 0x7a, 0xbc, 0xaf, 0x27, 0x1c, 0x00, 0x03, 0xf7, 0x0c, 0x1d, 0x85, 0xae, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x19, 0x82, 0xab, 0x89,
+            0x00, 0x30, 0x98, 0x88, 0xab, 0xd4, 0x4f, 0x5e, 0x53, 0x03, 0x6d, 0x5a, 0x96, 0x0a, 0x76, 0xd9,
+            0x62, 0x81, 0x07, 0xef, 0xff, 0xfb, 0x01, 0x20, 0x00, 0x00, 0x00, 0x81, 0x33, 0x07, 0xae, 0x0f,
+            0xcf, 0x92, 0x6e, 0x60, 0x0f, 0xeb, 0xea, 0x9e, 0x01, 0x0d, 0x62, 0x03, 0x8d, 0xd3, 0x4c, 0x42,
+            0x3f, 0x0e, 0xe6, 0xd1, 0x0d, 0xfe, 0x90, 0x3d, 0x59, 0xf5, 0x00, 0x3f, 0x0d, 0x89, 0xf7, 0xe8,
+            0x0d, 0xba, 0x63, 0x51, 0xff, 0xd6, 0x91, 0x5a, 0x1f, 0x46, 0x79, 0xbd, 0xc2, 0x4f, 0x65, 0xd6,
+            0x3c, 0xaa, 0x2a, 0xfc, 0xfa, 0xae, 0xdd, 0x10, 0xfb, 0x06, 0x40, 0x86, 0x7b, 0xf8, 0xe9, 0x81,
+            0x2a, 0x5a, 0x1c, 0xdc, 0x36, 0x2e, 0x04, 0xc8, 0x4e, 0xa1, 0xd4, 0x32, 0x78, 0x0f, 0x80, 0x82,
+            0xd0, 0xd8, 0x3e, 0xd0, 0xde, 0xa4, 0x63, 0xca, 0x3d, 0x12, 0xbc, 0x86, 0x89, 0x32, 0x1f, 0x8f,
+            0x66, 0xea, 0xe6, 0x35, 0x72, 0x1f, 0xc7, 0xc9, 0x5d, 0x96, 0x22, 0x9a, 0x9a, 0x22, 0xaf, 0x7d,
+            0xc4, 0xda, 0x4a, 0x12, 0x73, 0x04, 0xb7, 0x28, 0xb0, 0x07, 0x77, 0xbb, 0x26, 0xdc, 0x54, 0xc6,
+            0x8c, 0xc4, 0x3b, 0x78, 0x87, 0x3a, 0x77, 0xab, 0xff, 0xff, 0x63, 0x5e, 0x00, 0x00, 0x17, 0x06,
+            0x19, 0x01, 0x09, 0x80, 0x95, 0x00, 0x07, 0x0b, 0x01, 0x00, 0x01, 0x23, 0x03, 0x01, 0x01, 0x05,
+            0x5d, 0x00, 0x00, 0x80, 0x00, 0x0c, 0x81, 0x29, 0x0a, 0x01, 0x95, 0x0d, 0x00, 0xca, 0x00, 0x00,
+    };
+
+    bool test_sevenzip_index(const fs::path& tmp_root) {
+        bool ok = true;
+        std::string path = (tmp_root / "fixture.7z").string();
+        {
+            std::ofstream output(path, std::ios::binary);
+            output.write(reinterpret_cast<const char*>(kSevenZipFixture), sizeof(kSevenZipFixture));
+        }
+        const std::string a_text = "hello 7z\n";
+        std::string b_text;
+        for (int i = 0; i < 40; ++i) b_text += "abc";
+
+        sevenzip::Index index = sevenzip::read_index(path);
+        ok &= expect(index.valid && !index.needs_tool, "7z end header should parse");
+        ok &= expect(index.folders.size() == 1 && index.files.size() == 5, "7z index should hold one solid folder and five files");
+        if (!ok) return ok;
+        const sevenzip::Folder& folder = index.folders[0];
+        ok &= expect(sevenzip::can_decode(folder), "LZMA folder should be decodable");
+        ok &= expect_equal(sevenzip::method_name(folder), "LZMA:23", "7z method should be named like 7z l");
+        ok &= expect(folder.first_file == 0 && folder.file_count == 2, "solid folder should map its two files");
+        std::string decoded;
+        ok &= expect(sevenzip::decode_folder(path, folder, [&](const char* data, size_t size) {
+            decoded.append(data, size);
+            return true;
+        }), "7z folder should decode");
+        for (const auto& file : index.files) {
+            if (file.path == "dir/a.txt" || file.path == "dir/b.txt") {
+                const std::string& expected = file.path == "dir/a.txt" ? a_text : b_text;
+                ok &= expect(file.folder == 0 && file.size == expected.size(), "7z file should map into the solid folder");
+                ok &= expect(file.has_crc && file.crc == checksum::crc32(0, expected.data(), expected.size()), "7z file CRC should be read");
+                ok &= expect_equal(decoded.substr(static_cast<size_t>(file.folder_offset), expected.size()), expected,
+                    "7z folder offset should locate the file's bytes");
+            } else {
+                ok &= expect(file.folder == sevenzip::kNoFolder && !file.has_stream, "7z empty entries should have no stream");
+                ok &= expect(file.is_directory == (file.path != "dir/empty"), "7z directory flags should follow empty-stream bits");
+            }
+        }
+
+        backend::Archive archive{path, file_type::FileType::ARCHIVE_7Z, ""};
+        backend::ArchiveBackend* chosen = backend::registry().select(backend::Operation::List, archive);
+        ok &= expect(chosen && chosen->name() == "native-7z", "7z should be listed natively");
+        auto entries = backend::registry().list(archive);
+        ok &= expect(entries.size() == 5, "native 7z listing should include every entry");
+        for (const auto& entry : entries) {
+            if (entry.path == "dir/b.txt") {
+                ok &= expect(entry.compressed_size == folder.packed_size() && entry.method == "LZMA:23" && !entry.modified.empty(),
+                    "first file of a solid block should carry its packed size");
+            }
+        }
+
+        chosen = backend::registry().select(backend::Operation::ReadEntry, archive);
+        ok &= expect(chosen && chosen->name() == "native-7z", "7z entries should be read natively");
+        ok &= expect_equal(tui::archive_ops::extract_to_string(path, "dir/b.txt", archive.format), b_text, "native 7z should read an entry");
+        ok &= expect_equal(tui::archive_ops::extract_to_string(path, "dir/a.txt", archive.format), a_text,
+            "native 7z should read a sibling from the cached block");
+        char window[4] = {};
+        size_t copied = 0;
+        ok &= expect(backend::registry().read_at(archive, "dir/a.txt", 6, window, sizeof(window), copied) &&
+            std::string(window, copied) == "7z\n", "native 7z should seek into a cached block");
+
+        fs::path out = tmp_root / "sevenzip_out";
+        ok &= expect(backend::registry().extract_entry(archive, "dir", out.string()), "native 7z should extract a directory entry");
+        ok &= expect(fs::is_directory(out / "dir" / "sub") && fs::is_regular_file(out / "dir" / "empty"),
+            "native 7z extraction should recreate empty entries");
+        std::ifstream extracted(out / "dir" / "b.txt", std::ios::binary);
+        std::string extracted_text((std::istreambuf_iterator<char>(extracted)), std::istreambuf_iterator<char>());
+        ok &= expect_equal(extracted_text, b_text, "native 7z extraction should write file contents");
+
+        ok &= expect(backend::registry().select(backend::Operation::Extract, archive) == chosen, "7z should be extracted natively");
+        fs::path all_out = tmp_root / "sevenzip_all";
+        archive::ArchiveReader(path).extract_all(all_out.string());
+        std::ifstream all_a(all_out / "dir" / "a.txt", std::ios::binary);
+        std::string all_a_text((std::istreambuf_iterator<char>(all_a)), std::istreambuf_iterator<char>());
+        ok &= expect_equal(all_a_text, a_text, "native 7z full extraction should write every file");
+
+        std::string truncated_path = (tmp_root / "truncated.7z").string();
+        {
+            std::ofstream output(truncated_path, std::ios::binary);
+            output.write(reinterpret_cast<const char*>(kSevenZipFixture), sizeof(kSevenZipFixture) - 8);
+        }
+        ok &= expect(!sevenzip::read_index(truncated_path).valid, "a truncated 7z should not parse");
+        return ok;
+    }
+
+    // Stored RAR5 volume pair: dir/, dir/a.txt, and dir/b.txt split across both volumes.
+    const unsigned char kRar5Volume1[] = {
+            0x52, 0x61, 0x72, 0x21, 0x1a, 0x07, 0x01, 0x00, 0x53, 0x2a, 0x34, 0x45, 0x03, 0x01, 0x00, 0x01,
+            0xd9, 0x7f, 0x99, 0xa0, 0x0e, 0x02, 0x02, 0x00, 0x01, 0x00, 0xed, 0x83, 0x01, 0x00, 0x01, 0x03,
+            0x64, 0x69, 0x72, 0x0c, 0x88, 0x7c, 0x97, 0x20, 0x02, 0x03, 0x07, 0x0a, 0x04, 0x0a, 0xa4, 0x83,
+            0x02, 0x9d, 0xd2, 0x80, 0xb1, 0x00, 0x01, 0x09, 0x64, 0x69, 0x72, 0x2f, 0x61, 0x2e, 0x74, 0x78,
+            0x74, 0x06, 0x03, 0x03, 0x00, 0xf1, 0x53, 0x65, 0x68, 0x65, 0x6c, 0x6c, 0x6f, 0x20, 0x72, 0x61,
+            0x72, 0x0a, 0x50, 0xbe, 0xb1, 0x18, 0x15, 0x02, 0x12, 0x3c, 0x00, 0x96, 0x01, 0xa4, 0x83, 0x02,
+            0x00, 0x01, 0x09, 0x64, 0x69, 0x72, 0x2f, 0x62, 0x2e, 0x74, 0x78, 0x74, 0x78, 0x79, 0x7a, 0x78,
+            0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79,
+            0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a,
+            0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78,
+            0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x8f, 0x82, 0x3d, 0x42, 0x03, 0x05, 0x00, 0x01,
+    };
+    const unsigned char kRar5Volume2[] = {
+            0x52, 0x61, 0x72, 0x21, 0x1a, 0x07, 0x01, 0x00, 0xed, 0x55, 0x34, 0xd7, 0x04, 0x01, 0x00, 0x03,
+            0x01, 0xc7, 0x36, 0xbb, 0x5d, 0x19, 0x02, 0x0a, 0x5a, 0x04, 0x96, 0x01, 0xa4, 0x83, 0x02, 0x59,
+            0x8e, 0xd1, 0x08, 0x00, 0x01, 0x09, 0x64, 0x69, 0x72, 0x2f, 0x62, 0x2e, 0x74, 0x78, 0x74, 0x78,
+            0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79,
+            0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a,
+            0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78,
+            0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79,
+            0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a,
+            0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x78, 0x79, 0x7a, 0x19, 0xb2, 0x3a, 0x35, 0x03, 0x05, 0x00,
+            0x00,
+    };
+    // Stored RAR4 with a backslash path and a RAR 3.x Unicode name.
+    const unsigned char kRar4Fixture[] = {
+            0x52, 0x61, 0x72, 0x21, 0x1a, 0x07, 0x00, 0xcf, 0x90, 0x73, 0x00, 0x00, 0x0d, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0xb5, 0x7e, 0x74, 0xe0, 0x80, 0x23, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x05, 0x39, 0xa6, 0x58, 0x1d, 0x30, 0x03, 0x00,
+            0xed, 0x41, 0x00, 0x00, 0x74, 0x6f, 0x70, 0x18, 0x95, 0x74, 0x00, 0x80, 0x29, 0x00, 0x09, 0x00,
+            0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x03, 0x85, 0xa6, 0x97, 0x82, 0x05, 0x39, 0xa6, 0x58, 0x1d,
+            0x30, 0x09, 0x00, 0xa4, 0x81, 0x00, 0x00, 0x74, 0x6f, 0x70, 0x5c, 0x63, 0x2e, 0x74, 0x78, 0x74,
+            0x72, 0x61, 0x72, 0x20, 0x66, 0x6f, 0x75, 0x72, 0x0a, 0x31, 0x83, 0x74, 0x00, 0x82, 0x49, 0x00,
+            0x09, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x03, 0x92, 0xbf, 0x10, 0x3e, 0x05, 0x39, 0xa6,
+            0x58, 0x1d, 0x30, 0x29, 0x00, 0xa4, 0x81, 0x00, 0x00, 0x74, 0x6f, 0x70, 0x2f, 0x63, 0x61, 0x66,
+            0x65, 0x2e, 0x74, 0x78, 0x74, 0x00, 0x00, 0xaa, 0x74, 0x00, 0x6f, 0x00, 0x70, 0x00, 0x2f, 0x00,
+            0xaa, 0x63, 0x00, 0x61, 0x00, 0x66, 0x00, 0xe9, 0x00, 0xaa, 0x2e, 0x00, 0x74, 0x00, 0x78, 0x00,
+            0x74, 0x00, 0x63, 0x61, 0x66, 0xc3, 0xa9, 0x2e, 0x74, 0x78, 0x74, 0x04, 0xb0, 0x7b, 0x00, 0x00,
+            0x07, 0x00,
+    };
+
+    bool test_rar_index(const fs::path& tmp_root) {
+        bool ok = true;
+        auto write_fixture = [](const fs::path& path, const unsigned char* data, size_t size) {
+            std::ofstream output(path, std::ios::binary);
+            output.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+        };
+        std::string volume_path = (tmp_root / "fixture.part1.rar").string();
+        write_fixture(volume_path, kRar5Volume1, sizeof(kRar5Volume1));
+        write_fixture(tmp_root / "fixture.part2.rar", kRar5Volume2, sizeof(kRar5Volume2));
+        std::string b_text;
+        for (int i = 0; i < 50; ++i) b_text += "xyz";
+
+        rar::Index index = rar::read_index(volume_path);
+        ok &= expect(index.valid && index.version == 5 && index.multi_volume && index.volumes == 2, "RAR5 volume chain should be followed");
+        ok &= expect(index.members.size() == 3, "split RAR5 member should be listed once");
+        for (const auto& member : index.members) {
+            if (member.path == "dir") {
+                ok &= expect(member.is_directory && rar::method_name(member).empty(), "RAR5 directory flag should be read");
+            } else if (member.path == "dir/a.txt") {
+                ok &= expect(member.size == 10 && member.packed_size == 10 && member.has_crc && member.crc == checksum::crc32(0, "hello rar\n", 10),
+                    "RAR5 file sizes and CRC should be read");
+                ok &= expect(member.has_mtime && member.mtime == 1700000000, "RAR5 time record should give the mtime");
+                ok &= expect_equal(rar::method_name(member), "m0", "stored RAR5 member should be named m0");
+            } else {
+                ok &= expect(member.size == b_text.size() && member.packed_size == b_text.size(), "split member should sum packed sizes over volumes");
+                ok &= expect(member.has_crc && member.crc == checksum::crc32(0, b_text.data(), b_text.size()), "split member CRC should come from its last part");
+            }
+        }
+
+        std::string rar4_path = (tmp_root / "fixture4.rar").string();
+        write_fixture(rar4_path, kRar4Fixture, sizeof(kRar4Fixture));
+        rar::Index rar4 = rar::read_index(rar4_path);
+        ok &= expect(rar4.valid && rar4.version == 4 && rar4.members.size() == 3, "RAR4 headers should parse");
+        if (rar4.members.size() == 3) {
+            ok &= expect(rar4.members[0].is_directory && rar4.members[0].path == "top", "RAR4 directory should be recognised");
+            ok &= expect_equal(rar4.members[1].path, "top/c.txt", "RAR4 backslashes should become slashes");
+            ok &= expect(rar4.members[1].size == 9 && rar4.members[1].crc == checksum::crc32(0, "rar four\n", 9), "RAR4 sizes and CRC should be read");
+            ok &= expect_equal(rar4.members[2].path, "top/caf\xc3\xa9.txt", "RAR4 Unicode names should be decoded");
+        }
+
+        backend::Archive archive{rar4_path, file_type::FileType::ARCHIVE_RAR, ""};
+        backend::ArchiveBackend* chosen = backend::registry().select(backend::Operation::List, archive);
+        ok &= expect(chosen && chosen->name() == "native-rar", "RAR should be listed natively");
+        auto entries = backend::registry().list(archive);
+        ok &= expect(entries.size() == 3 && entries[1].compressed_size == 9 && entries[1].method == "m0" && !entries[1].modified.empty(),
+            "native RAR listing should carry sizes, method and time");
+
+        std::string damaged_path = (tmp_root / "damaged.rar").string();
+        std::vector<unsigned char> damaged(kRar4Fixture, kRar4Fixture + sizeof(kRar4Fixture));
+        damaged[30] ^= 0xFF;
+        write_fixture(damaged_path, damaged.data(), damaged.size());
+        ok &= expect(!rar::read_index(damaged_path).valid, "a RAR4 header with a bad CRC should not parse");
+
+        std::string lone_path = (tmp_root / "lone.part1.rar").string();
+        write_fixture(lone_path, kRar5Volume1, sizeof(kRar5Volume1));
+        rar::Index lone = rar::read_index(lone_path);
+        ok &= expect(lone.valid && lone.truncated && lone.volumes == 1, "a missing next volume should mark the index truncated");
+        ok &= expect(!index.truncated && !rar4.truncated, "complete archives should not be marked truncated");
+        backend::Archive lone_archive{lone_path, file_type::FileType::ARCHIVE_RAR, ""};
+        ok &= expect(chosen && chosen->list(lone_archive).empty() && !chosen->empty(lone_archive),
+            "a truncated volume chain should be left to unrar");
+
+        // Headers with valid CRCs whose data sizes would wrap the walk back onto themselves.
+        auto le = [](std::vector<unsigned char>& out, uint64_t value, size_t bytes) {
+            for (size_t i = 0; i < bytes; ++i) out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+        };
+        std::vector<unsigned char> crafted5 = {'R', 'a', 'r', '!', 0x1A, 0x07, 0x01, 0x00};
+        std::vector<unsigned char> block = {12, 3, 0x02};
+        uint64_t huge = ~uint64_t{0} - 16;
+        for (; huge >= 0x80; huge >>= 7) block.push_back(static_cast<unsigned char>(huge | 0x80));
+        block.push_back(static_cast<unsigned char>(huge));
+        le(crafted5, checksum::crc32(0, block.data(), block.size()), 4);
+        crafted5.insert(crafted5.end(), block.begin(), block.end());
+
+        std::vector<unsigned char> crafted4 = {'R', 'a', 'r', '!', 0x1A, 0x07, 0x00};
+        std::vector<unsigned char> file = {0, 0, 0x74};
+        le(file, 0x8100, 2);
+        le(file, 41, 2);
+        le(file, 0xFFFFFFD7, 4);
+        file.resize(26, 0);
+        le(file, 1, 2);
+        le(file, 0, 4);
+        le(file, 0xFFFFFFFF, 4);
+        le(file, 0, 4);
+        file.push_back('x');
+        uint32_t crc = checksum::crc32(0, file.data() + 2, file.size() - 2);
+        file[0] = static_cast<unsigned char>(crc);
+        file[1] = static_cast<unsigned char>(crc >> 8);
+        crafted4.insert(crafted4.end(), file.begin(), file.end());
+
+        for (const std::vector<unsigned char>* crafted : {&crafted5, &crafted4}) {
+            std::string crafted_path = (tmp_root / "wrapping.rar").string();
+            write_fixture(crafted_path, crafted->data(), crafted->size());
+            auto walked = std::async(std::launch::async, [crafted_path]() { return rar::read_index(crafted_path); });
+            bool finished = walked.wait_for(std::chrono::seconds(10)) == std::future_status::ready;
+            ok &= expect(finished && !walked.get().valid, "a header whose data size overruns the volume should be rejected");
+            if (!finished) std::_Exit(1);
+        }
+        return ok;
+    }
+
+    // bsdtar --format xar (gzip) of dir/{a.txt,sub/big.txt,link -> a.txt}; big.txt is "line\n" x 2000.
+    const unsigned char kXarFixture[] = {
+            0x78, 0x61, 0x72, 0x21, 0x00, 0x1c, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xca,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0a, 0x8d, 0x00, 0x00, 0x00, 0x01, 0x78, 0x9c, 0xdd, 0x96,
+            0xcb, 0x92, 0xa2, 0x30, 0x14, 0x86, 0xf7, 0xf3, 0x14, 0x14, 0x7b, 0x9a, 0x5c, 0x08, 0x04, 0x2b,
+            0xd2, 0xbb, 0x79, 0x82, 0x9e, 0xcd, 0xec, 0x72, 0x43, 0x53, 0xad, 0x60, 0x01, 0x76, 0x69, 0x3f,
+            0xfd, 0x84, 0x08, 0x08, 0x28, 0xad, 0xd3, 0x9b, 0xa9, 0x1a, 0x37, 0x9c, 0x9c, 0x73, 0x12, 0xc2,
+            0xc7, 0xef, 0x1f, 0xd8, 0xeb, 0x69, 0xbf, 0xf3, 0x3e, 0x74, 0x55, 0x9b, 0xb2, 0x58, 0xfb, 0xf0,
+            0x05, 0xf8, 0x9e, 0x2e, 0x64, 0xa9, 0x4c, 0xb1, 0x59, 0xfb, 0xbf, 0xde, 0x7e, 0x06, 0xd4, 0x7f,
+            0xcd, 0x7e, 0xb0, 0x13, 0xaf, 0xb2, 0x1f, 0x1e, 0x6b, 0x4a, 0x69, 0x2f, 0x1e, 0x93, 0x95, 0xe6,
+            0x8d, 0x9d, 0x11, 0x34, 0x66, 0xaf, 0x33, 0x04, 0x50, 0x1c, 0x40, 0x10, 0x40, 0xfa, 0x06, 0xc1,
+            0x0a, 0xa1, 0x15, 0xa2, 0x2c, 0x9c, 0xb6, 0xb8, 0x49, 0x5b, 0x2d, 0xdf, 0xeb, 0xe3, 0xde, 0xab,
+            0x9b, 0xf3, 0x4e, 0xaf, 0xfd, 0x7a, 0xcb, 0xa1, 0xdf, 0x56, 0x3c, 0x56, 0xe6, 0x79, 0xad, 0x9b,
+            0x0c, 0xb0, 0xb0, 0x8b, 0x5c, 0xb6, 0x36, 0x9f, 0xed, 0xe2, 0x2c, 0x74, 0x41, 0xbb, 0x44, 0xd8,
+            0xaf, 0xe1, 0x46, 0xb9, 0xd9, 0x69, 0xcf, 0x28, 0xbb, 0xed, 0x6e, 0x99, 0x82, 0xdb, 0x5b, 0x29,
+            0x53, 0xb1, 0xd0, 0x45, 0x2e, 0xd7, 0x9c, 0x0f, 0x2e, 0xa7, 0x65, 0x53, 0x56, 0x67, 0x16, 0xba,
+            0xb1, 0xab, 0x98, 0xa2, 0x54, 0x3a, 0x83, 0x98, 0x44, 0x10, 0x53, 0x7b, 0x97, 0xcb, 0xd8, 0x95,
+            0x94, 0xfe, 0x30, 0x52, 0x17, 0x65, 0x16, 0x13, 0x80, 0x22, 0x16, 0x0e, 0x63, 0x57, 0xdd, 0xb7,
+            0x7d, 0x20, 0x21, 0x84, 0x85, 0xfb, 0x61, 0xca, 0xd1, 0xa8, 0x76, 0xff, 0xed, 0xe5, 0x32, 0xae,
+            0x75, 0x95, 0x55, 0x65, 0xd9, 0xd8, 0x5c, 0x1b, 0xba, 0xe4, 0xe6, 0xd2, 0xb4, 0xe9, 0x9b, 0x36,
+            0x55, 0x79, 0x3c, 0x74, 0x5d, 0x97, 0xd8, 0xa5, 0xe5, 0x12, 0xd6, 0xdf, 0x96, 0x40, 0xcf, 0xd3,
+            0xee, 0xe3, 0x8b, 0xb6, 0xfd, 0xb5, 0x8d, 0x7f, 0xd1, 0xc6, 0xaf, 0x6d, 0x03, 0x4d, 0x74, 0xa1,
+            0xd9, 0xe1, 0xdc, 0x99, 0xe2, 0x7d, 0xc4, 0xb3, 0x03, 0x5a, 0x9f, 0xf7, 0x97, 0xc2, 0x80, 0xd3,
+            0x63, 0x6d, 0xc2, 0x6b, 0xc7, 0x6b, 0x5f, 0x54, 0xe5, 0xbb, 0x2e, 0xfc, 0x8c, 0xbf, 0x34, 0x27,
+            0xfb, 0x68, 0x6d, 0xa5, 0x6b, 0x9a, 0x40, 0x8f, 0xc6, 0xd0, 0x1f, 0x50, 0x1f, 0xb0, 0x27, 0xc9,
+            0x08, 0xfb, 0x0d, 0xf7, 0xfb, 0xe0, 0x6f, 0xc8, 0x2f, 0xa1, 0x7f, 0x96, 0xfd, 0xb3, 0xf0, 0x9f,
+            0xa6, 0x1f, 0xb6, 0xf8, 0x67, 0x2f, 0x02, 0x4f, 0x5e, 0x44, 0x7d, 0x14, 0xb7, 0xef, 0xe1, 0x9e,
+            0xb0, 0x67, 0x90, 0xe1, 0x77, 0x20, 0x4f, 0xb4, 0xfd, 0xbf, 0x40, 0x1e, 0xa1, 0x25, 0x1d, 0xda,
+            0x8e, 0xad, 0x30, 0x9b, 0x8b, 0x52, 0xaf, 0x7c, 0x3b, 0xc0, 0xed, 0x8c, 0x31, 0xdb, 0x19, 0x5c,
+            0x3c, 0x81, 0xfb, 0x88, 0x6e, 0x8f, 0x37, 0x8e, 0xa2, 0x31, 0xde, 0x5b, 0xbe, 0x0b, 0x80, 0x6f,
+            0x09, 0x2f, 0x22, 0x7e, 0x9a, 0xf1, 0xd3, 0x90, 0x9f, 0xa6, 0x6c, 0x29, 0xf0, 0x86, 0x77, 0xb1,
+            0xb5, 0x05, 0x5d, 0x6c, 0x9a, 0x6d, 0x16, 0x59, 0x45, 0x75, 0x61, 0x5f, 0xe9, 0xbc, 0x1e, 0xd3,
+            0x89, 0xed, 0x0f, 0xce, 0x0f, 0x81, 0xfd, 0x5d, 0xcd, 0xdf, 0x15, 0xfa, 0xb3, 0xa9, 0x3f, 0x43,
+            0xf8, 0xe1, 0xb0, 0x33, 0xd2, 0x1d, 0x34, 0xe1, 0x29, 0xd8, 0x7c, 0x9a, 0x83, 0x1f, 0x0e, 0xcd,
+            0xbc, 0x92, 0x5b, 0xf3, 0xa1, 0x55, 0x70, 0xff, 0xe4, 0x11, 0x5a, 0x63, 0x9e, 0xe6, 0x42, 0xd3,
+            0x5c, 0x70, 0x82, 0x08, 0xa6, 0x3c, 0x95, 0x12, 0x48, 0x48, 0xac, 0xfe, 0x29, 0x50, 0x71, 0xc4,
+            0x93, 0x48, 0xa2, 0xd4, 0x3e, 0xdc, 0x7c, 0xa1, 0xeb, 0x7e, 0x4e, 0x4d, 0xc5, 0x65, 0xb3, 0x78,
+            0x0f, 0x29, 0xa4, 0xa4, 0x82, 0x6b, 0x2d, 0x08, 0xd6, 0x02, 0xd0, 0x84, 0xe8, 0x98, 0x88, 0x94,
+            0x93, 0x1c, 0x01, 0x1b, 0x2a, 0xc1, 0xad, 0xa1, 0xa5, 0x38, 0x67, 0xe1, 0xed, 0x4a, 0x3d, 0xcd,
+            0xf0, 0x8a, 0x73, 0x6c, 0x13, 0xf7, 0x1c, 0x23, 0x9a, 0x38, 0x06, 0x9f, 0x6b, 0xfa, 0xbe, 0xa4,
+            0xa7, 0x8a, 0x46, 0xdf, 0xb0, 0x8b, 0x99, 0x9e, 0xff, 0xbd, 0x5d, 0x44, 0x01, 0x80, 0x01, 0x40,
+            0x6f, 0x00, 0xaf, 0x40, 0xb4, 0x02, 0x64, 0xc9, 0x2e, 0xee, 0xf4, 0x8d, 0xed, 0x62, 0xa4, 0xe3,
+            0x5e, 0xc6, 0x90, 0xce, 0x64, 0xdc, 0xab, 0x18, 0x81, 0x99, 0x8a, 0x7b, 0x11, 0x4f, 0x14, 0xfc,
+            0x37, 0x02, 0x7e, 0xa4, 0x5f, 0x42, 0x29, 0x12, 0x29, 0x21, 0x89, 0xd2, 0x40, 0xa7, 0x51, 0x0a,
+            0x44, 0x0a, 0x14, 0x14, 0x38, 0x8f, 0x05, 0x57, 0x40, 0xe8, 0x08, 0xc4, 0x3c, 0x4d, 0x38, 0x59,
+            0xd6, 0xef, 0x43, 0xf9, 0xc6, 0x0a, 0x27, 0x50, 0x09, 0x1a, 0x13, 0x28, 0x95, 0xfd, 0x4f, 0x40,
+            0x89, 0x73, 0x85, 0xa0, 0x02, 0x2a, 0x11, 0x24, 0xe5, 0x54, 0x62, 0x8c, 0x51, 0x8c, 0xa3, 0x65,
+            0xf9, 0x8e, 0xd4, 0x7b, 0x55, 0xec, 0x10, 0x59, 0x19, 0xb6, 0x5f, 0x94, 0x2c, 0x74, 0xdf, 0x97,
+            0x7f, 0x00, 0x11, 0xc8, 0xfe, 0xe5, 0x13, 0x30, 0x3f, 0x1e, 0xb5, 0x54, 0x55, 0x72, 0x04, 0xda,
+            0x94, 0x3f, 0xbc, 0x79, 0x5a, 0x32, 0x84, 0xd1, 0xad, 0xe5, 0x78, 0x9c, 0xcb, 0x48, 0xcd, 0xc9,
+            0xc9, 0x57, 0xa8, 0x48, 0x2c, 0xe2, 0x02, 0x00, 0x15, 0x26, 0x03, 0x8a, 0x78, 0x9c, 0xed, 0xc4,
+            0xb1, 0x09, 0x00, 0x00, 0x08, 0x03, 0xb0, 0xdd, 0x3f, 0x1d, 0x84, 0xe2, 0xff, 0xa3, 0x77, 0x08,
+            0xc9, 0x90, 0xcc, 0x76, 0x45, 0x92, 0x24, 0x49, 0x92, 0x24, 0x49, 0x92, 0x24, 0x49, 0x92, 0x24,
+            0x49, 0x92, 0xa4, 0xdf, 0x1d, 0x2f, 0xc5, 0x3f, 0x64, 0x78, 0x9c, 0xdd, 0x96, 0xcb, 0x92, 0xa2,
+            0x30, 0x14, 0x86, 0xf7, 0xf3, 0x14, 0x14, 0x7b, 0x9a, 0x5c, 0x08, 0x04, 0x2b,
+    };
+
+    bool test_xar_reader(const fs::path& tmp_root) {
+        bool ok = true;
+        std::string path = (tmp_root / "fixture.xar").string();
+        {
+            std::ofstream output(path, std::ios::binary);
+            output.write(reinterpret_cast<const char*>(kXarFixture), sizeof(kXarFixture));
+        }
+        std::string big_text;
+        for (int i = 0; i < 2000; ++i) big_text += "line\n";
+
+        xar::Index index = xar::read_index(path);
+        ok &= expect(index.valid && index.members.size() == 5, "xar TOC should list every nested file");
+        backend::Archive archive{path, file_type::FileType::ARCHIVE_XAR, ""};
+        for (auto op : {backend::Operation::List, backend::Operation::ReadEntry, backend::Operation::Extract}) {
+            backend::ArchiveBackend* chosen = backend::registry().select(op, archive);
+            ok &= expect(chosen && chosen->name() == "native-xar", std::string("xar should be handled natively for ") + backend::operation_name(op));
+        }
+        auto entries = backend::registry().list(archive);
+        bool saw_big = false;
+        for (const auto& entry : entries) {
+            if (entry.path != "dir/sub/big.txt") continue;
+            saw_big = true;
+            ok &= expect(entry.size == big_text.size() && entry.compressed_size < entry.size && entry.method == "gzip" && !entry.modified.empty(),
+                "xar entry should carry its extracted and heap sizes");
+        }
+        ok &= expect(saw_big, "nested xar paths should be joined");
+
+        std::string read;
+        ok &= expect(backend::registry().read_entry(archive, "dir/sub/big.txt", [&](const char* data, size_t size) {
+            read.append(data, size);
+            return true;
+        }), "xar member should be decoded in-process");
+        ok &= expect(read == big_text, "decoded xar member should match");
+        char window[5] = {};
+        size_t copied = 0;
+        ok &= expect(backend::registry().read_at(archive, "dir/sub/big.txt", 5000, window, sizeof(window), copied) && copied == 5 &&
+            std::string(window, 5) == "line\n", "xar read_at should stream to the offset");
+
+        fs::path out = tmp_root / "xar_out";
+        archive::ArchiveReader(path).extract_all(out.string());
+        std::ifstream a_file(out / "dir" / "a.txt");
+        std::string a_text((std::istreambuf_iterator<char>(a_file)), std::istreambuf_iterator<char>());
+        ok &= expect_equal(a_text, "hello xar\n", "xar extraction should write members");
+        ok &= expect(fs::file_size(out / "dir" / "sub" / "big.txt") == big_text.size(), "xar extraction should create nested files");
+        ok &= expect(fs::is_symlink(out / "dir" / "link") && fs::read_symlink(out / "dir" / "link") == "a.txt", "xar symlinks should be restored");
+
+        std::string truncated_path = (tmp_root / "truncated.xar").string();
+        {
+            std::ofstream output(truncated_path, std::ios::binary);
+            output.write(reinterpret_cast<const char*>(kXarFixture), 200);
+        }
+        ok &= expect(!xar::read_index(truncated_path).valid, "a truncated xar TOC should not parse");
+
+        // xar listings carry no CRCs, so diff hashes the members; a damaged one must not pass for empty.
+        archive_diff::DiffResult same = archive_diff::diff(path, archive.format, path, archive.format, "", 2);
+        ok &= expect(same.changes.empty() && same.unchanged == 5 && same.used_content_hashes, "diffing a xar against itself should hash every member");
+        std::string damaged_path = (tmp_root / "damaged.xar").string();
+        fs::copy_file(path, damaged_path, fs::copy_options::overwrite_existing);
+        for (const xar::Member& member : index.members) {
+            if (member.path != "dir/sub/big.txt") continue;
+            std::fstream damaged(damaged_path, std::ios::in | std::ios::out | std::ios::binary);
+            damaged.seekp(static_cast<std::streamoff>(index.heap_offset + member.offset + 2));
+            damaged.write("\xff\xff\xff\xff", 4);
+        }
+        bool failed = false;
+        try {
+            archive_diff::diff(damaged_path, archive.format, damaged_path, archive.format, "", 2);
+        } catch (const std::exception&) {
+            failed = true;
+        }
+        ok &= expect(failed, "an unreadable member should fail the diff");
+        return ok;
+    }
+
+    // "hello " and "world\n" as two zstd frames, both with content sizes.
+    const unsigned char kZstdTwoFrames[] = {
+            0x28, 0xb5, 0x2f, 0xfd, 0x24, 0x06, 0x31, 0x00, 0x00, 0x68, 0x65, 0x6c, 0x6c, 0x6f, 0x20, 0xd2,
+            0x3b, 0xe1, 0xa9, 0x28, 0xb5, 0x2f, 0xfd, 0x24, 0x06, 0x31, 0x00, 0x00, 0x77, 0x6f, 0x72, 0x6c,
+            0x64, 0x0a, 0xaa, 0x6e, 0x56, 0x9f,
+    };
+    // lz4 --content-size of "hello ".
+    const unsigned char kLz4Sized[] = {
+            0x04, 0x22, 0x4d, 0x18, 0x6c, 0x40, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x89, 0x06,
+            0x00, 0x00, 0x80, 0x68, 0x65, 0x6c, 0x6c, 0x6f, 0x20, 0x00, 0x00, 0x00, 0x00, 0xba, 0x53, 0xad,
+            0x8f,
+    };
+    // lz4 of "hello " without a content size.
+    const unsigned char kLz4Unsized[] = {
+            0x04, 0x22, 0x4d, 0x18, 0x64, 0x40, 0xa7, 0x06, 0x00, 0x00, 0x80, 0x68, 0x65, 0x6c, 0x6c, 0x6f,
+            0x20, 0x00, 0x00, 0x00, 0x00, 0xba, 0x53, 0xad, 0x8f,
+    };
+    // gzip of "hello world\n" x 3.
+    const unsigned char kGzipMember[] = {
+            0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xcb, 0x48, 0xcd, 0xc9, 0xc9, 0x57,
+            0x28, 0xcf, 0x2f, 0xca, 0x49, 0xe1, 0xca, 0xc0, 0xc1, 0x06, 0x00, 0x8c, 0xf8, 0x09, 0xeb, 0x24,
+            0x00, 0x00, 0x00,
+    };
+    // Two concatenated xz streams ("hello ", "world\n") and stream padding.
+    const unsigned char kXzTwoStreams[] = {
+            0xfd, 0x37, 0x7a, 0x58, 0x5a, 0x00, 0x00, 0x04, 0xe6, 0xd6, 0xb4, 0x46, 0x02, 0x00, 0x21, 0x01,
+            0x16, 0x00, 0x00, 0x00, 0x74, 0x2f, 0xe5, 0xa3, 0x01, 0x00, 0x05, 0x68, 0x65, 0x6c, 0x6c, 0x6f,
+            0x20, 0x00, 0x00, 0x00, 0x0a, 0xb0, 0xaf, 0x04, 0xba, 0x05, 0xef, 0x18, 0x00, 0x01, 0x1e, 0x06,
+            0xc1, 0x2f, 0xa4, 0x1d, 0x1f, 0xb6, 0xf3, 0x7d, 0x01, 0x00, 0x00, 0x00, 0x00, 0x04, 0x59, 0x5a,
+            0xfd, 0x37, 0x7a, 0x58, 0x5a, 0x00, 0x00, 0x04, 0xe6, 0xd6, 0xb4, 0x46, 0x02, 0x00, 0x21, 0x01,
+            0x16, 0x00, 0x00, 0x00, 0x74, 0x2f, 0xe5, 0xa3, 0x01, 0x00, 0x05, 0x77, 0x6f, 0x72, 0x6c, 0x64,
+            0x0a, 0x00, 0x00, 0x00, 0x62, 0x5c, 0x62, 0xf9, 0xcf, 0x18, 0x61, 0xc0, 0x00, 0x01, 0x1e, 0x06,
+            0xc1, 0x2f, 0xa4, 0x1d, 0x1f, 0xb6, 0xf3, 0x7d, 0x01, 0x00, 0x00, 0x00, 0x00, 0x04, 0x59, 0x5a,
+            0x00, 0x00, 0x00, 0x00,
+    };
+
+    bool test_stream_probe(const fs::path& tmp_root) {
+        bool ok = true;
+        auto write_fixture = [&](const char* name, const unsigned char* data, size_t size) {
+            std::string path = (tmp_root / name).string();
+            std::ofstream output(path, std::ios::binary);
+            output.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+            return path;
+        };
+        std::string zst = write_fixture("probe.zst", kZstdTwoFrames, sizeof(kZstdTwoFrames));
+        stream_probe::Probe probe = stream_probe::probe(zst, file_type::FileType::ARCHIVE_ZSTD);
+        ok &= expect(probe.valid && probe.size_known && probe.content_size == 12 && probe.frames == 2, "zstd probe should sum every frame");
+        std::string cut = write_fixture("probe-cut.zst", kZstdTwoFrames, sizeof(kZstdTwoFrames) - 3);
+        ok &= expect(!stream_probe::zstd(cut).valid, "a truncated zstd frame should not probe");
+
+        probe = stream_probe::probe(write_fixture("probe.lz4", kLz4Sized, sizeof(kLz4Sized)), file_type::FileType::ARCHIVE_LZ4);
+        ok &= expect(probe.valid && probe.size_known && probe.content_size == 6, "lz4 probe should read the frame content size");
+        probe = stream_probe::lz4(write_fixture("probe-unsized.lz4", kLz4Unsized, sizeof(kLz4Unsized)));
+        ok &= expect(probe.valid && !probe.size_known, "lz4 frames without a content size should leave the size unknown");
+
+        probe = stream_probe::gzip(write_fixture("probe.gz", kGzipMember, sizeof(kGzipMember)));
+        ok &= expect(probe.valid && probe.size_known && probe.content_size == 36, "gzip probe should read ISIZE");
+        probe = stream_probe::xz(write_fixture("probe.xz", kXzTwoStreams, sizeof(kXzTwoStreams)));
+        ok &= expect(probe.valid && probe.size_known && probe.content_size == 12 && probe.frames == 2, "xz probe should sum the index of each stream");
+        ok &= expect(!stream_probe::probe(zst, file_type::FileType::ARCHIVE_ZIP).valid, "formats without a probe should report invalid");
+
+        // Previews stop decoding once the window is full.
+        std::string seven = write_fixture("probe.7z", kSevenZipFixture, sizeof(kSevenZipFixture));
+        auto window = tui::archive_ops::extract_text(seven, "dir/b.txt", file_type::FileType::ARCHIVE_7Z, "", 10);
+        ok &= expect(window.success && window.truncated && window.content == "abcabcabca", "extract_text should stop at its limit");
+        return ok;
+    }
+
+    // gzip and bzip2 of a one-member ustar archive holding s.txt.
+    const unsigned char kTarGzFixture[] = {
+            0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xed, 0xcd, 0x31, 0x0a, 0x02, 0x31,
+            0x14, 0x45, 0xd1, 0x5f, 0xbb, 0x8a, 0x59, 0x81, 0xfc, 0x19, 0xa2, 0x59, 0x8f, 0x85, 0x03, 0x16,
+            0x5a, 0x98, 0x08, 0x2e, 0xdf, 0x30, 0xa5, 0xbd, 0x82, 0x78, 0x4e, 0x73, 0xe1, 0x35, 0xaf, 0xed,
+            0xfb, 0xb3, 0xc7, 0x67, 0xe5, 0x70, 0x2c, 0x65, 0xeb, 0xf0, 0xde, 0xcc, 0x79, 0x8e, 0xb9, 0x1c,
+            0x96, 0x52, 0x6b, 0x96, 0x6d, 0xaf, 0x99, 0x4b, 0x4c, 0x19, 0x5f, 0xf0, 0x68, 0xfd, 0x74, 0x1f,
+            0x97, 0xf1, 0x9f, 0xda, 0xed, 0xb2, 0xae, 0xd3, 0xf5, 0xbc, 0x0b, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x7e, 0xc9, 0x0b, 0xad, 0x54, 0x5e, 0x03, 0x00, 0x28, 0x00, 0x00,
+    };
+    const unsigned char kTarBz2Fixture[] = {
+            0x42, 0x5a, 0x68, 0x39, 0x31, 0x41, 0x59, 0x26, 0x53, 0x59, 0xf0, 0x7a, 0xca, 0xfa, 0x00, 0x00,
+            0x75, 0xfb, 0x80, 0xca, 0x10, 0x00, 0x20, 0x40, 0x01, 0x77, 0x80, 0x00, 0x08, 0x63, 0x23, 0x1e,
+            0x40, 0x08, 0x08, 0x20, 0x00, 0x54, 0x42, 0x3d, 0x42, 0x18, 0x08, 0x68, 0x61, 0xa8, 0x24, 0xa6,
+            0xa6, 0x9a, 0x68, 0x34, 0x06, 0x83, 0x46, 0x95, 0xa5, 0xe3, 0x21, 0x04, 0x1e, 0x84, 0x23, 0x1f,
+            0x25, 0x12, 0xe9, 0x3a, 0x08, 0x10, 0xe5, 0x36, 0x39, 0xa6, 0x96, 0x89, 0xf1, 0x60, 0x26, 0x0e,
+            0xca, 0x0b, 0x57, 0x15, 0x60, 0xef, 0x65, 0xd9, 0xd4, 0x63, 0x9b, 0xb8, 0x05, 0xd5, 0xe7, 0x7c,
+            0x52, 0xb8, 0xf9, 0x34, 0x8d, 0xd2, 0x4a, 0x66, 0x66, 0x45, 0xf8, 0xbb, 0x92, 0x29, 0xc2, 0x84,
+            0x87, 0x83, 0xd6, 0x57, 0xd0,
+    };
+
+    bool test_header_sniffing(const fs::path& tmp_root) {
+        bool ok = true;
+        auto write_fixture = [&](const char* name, const unsigned char* data, size_t size) {
+            std::string path = (tmp_root / name).string();
+            std::ofstream output(path, std::ios::binary);
+            output.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+            return path;
+        };
+        using file_type::FileType;
+        using file_type::recognize_by_header;
+        ok &= expect(recognize_by_header(write_fixture("sniff-tgz", kTarGzFixture, sizeof(kTarGzFixture))) == FileType::ARCHIVE_TAR_GZ,
+                     "a gzip stream holding a tar header should be a tar.gz");
+        ok &= expect(recognize_by_header(write_fixture("sniff-tbz", kTarBz2Fixture, sizeof(kTarBz2Fixture))) == FileType::ARCHIVE_TAR_BZ2,
+                     "a bzip2 stream holding a tar header should be a tar.bz2");
+        ok &= expect(recognize_by_header(write_fixture("sniff-gz", kGzipMember, sizeof(kGzipMember))) == FileType::UNKNOWN,
+                     "gzip of plain text should not be a tarball");
+        ok &= expect(recognize_by_header(write_fixture("sniff-xz", kXzTwoStreams, sizeof(kXzTwoStreams))) == FileType::UNKNOWN,
+                     "xz of plain text should not be a tar.xz");
+        ok &= expect(recognize_by_header(write_fixture("sniff-xar", kXarFixture, sizeof(kXarFixture))) == FileType::ARCHIVE_XAR,
+                     "xar should be recognized by its signature");
+
+        std::string text(600, 'a');
+        ok &= expect(recognize_by_header(write_fixture("sniff-text", reinterpret_cast<const unsigned char*>(text.data()), text.size())) == FileType::UNKNOWN,
+                     "printable text without a valid tar checksum should not be a tar");
+        return ok;
+    }
+
+    bool test_identify(const fs::path& tmp_root) {
+        bool ok = true;
+        args::Options options = parse_args({"hitpag", "--identify=json", "uploads"});
+        ok &= expect(options.identify_mode && options.identify_json, "--identify=json should select JSON lines");
+        ok &= expect(options.source_paths.size() == 1 && options.target_path.empty(), "--identify should take its paths as sources only");
+
+        fs::path root = tmp_root / "identify";
+        std::error_code ec;
+        fs::create_directories(root, ec);
+        std::vector<std::string> paths;
+        for (int i = 0; i < 150; ++i) {
+            fs::path path = root / ("upload-" + std::to_string(i));
+            std::ofstream output(path, std::ios::binary);
+            if (i % 3 == 0) output.write(reinterpret_cast<const char*>(kTarGzFixture), sizeof(kTarGzFixture));
+            else if (i % 3 == 1) output.write(reinterpret_cast<const char*>(kXarFixture), sizeof(kXarFixture));
+            else output << "plain text " << i << "\n";
+            paths.push_back(path.string());
+        }
+        paths.push_back((root / "missing").string());
+        paths.push_back(root.string());
+
+        std::vector<archive_scan::IdentifyRecord> records = archive_scan::identify(paths, 2);
+        bool ordered = records.size() == paths.size();
+        bool formats = ordered;
+        for (size_t i = 0; ordered && i < 150; ++i) {
+            ordered &= records[i].path == paths[i];
+            file_type::FileType expected = i % 3 == 0 ? file_type::FileType::ARCHIVE_TAR_GZ
+                                         : i % 3 == 1 ? file_type::FileType::ARCHIVE_XAR : file_type::FileType::UNKNOWN;
+            formats &= records[i].readable && records[i].type == expected;
+        }
+        ok &= expect(ordered, "identify should keep input order across batches");
+        ok &= expect(formats, "identify should recognize every file by content");
+        ok &= expect_equal(archive_scan::identify_line(records[150], false), "error\t" + paths[150], "unreadable files should report error");
+        ok &= expect_equal(archive_scan::identify_line(records[151], true),
+            "{\"path\":" + util::json_quote(paths[151]) + ",\"format\":\"directory\"}", "identify should emit one JSON object per file");
+        return ok;
+    }
+
+    bool test_tar_writer(const fs::path& tmp_root) {
+        bool ok = true;
+        fs::path root = tmp_root / "twrite";
+        std::string long_name(120, 'n');
+        fs::create_directories(root / "tree" / "sub" / std::string(90, 'd'));
+        std::vector<ingest::File> files;
+        for (int i = 0; i < 300; ++i) {
+            fs::path path = root / "tree" / "sub" / ("f" + std::to_string(i));
+            std::string content(static_cast<size_t>(i) * 700, static_cast<char>('a' + i % 26));
+            ok &= expect(write_text_file(path, content), "should create tar writer input");
+            files.push_back({path.string(), content.size()});
+        }
+        files.push_back({(root / "missing").string(), 10});
+        ok &= expect(write_text_file(root / "tree" / "sub" / std::string(90, 'd') / long_name, "long\n"), "should create a long-named input");
+        fs::create_symlink("sub/f1", root / "tree" / "link");
+        fs::create_hard_link(root / "tree" / "sub" / "f2", root / "tree" / "hard");
+
+        for (ingest::Engine engine : {ingest::Engine::Sync, ingest::Engine::Uring}) {
+            std::vector<std::pair<size_t, uint64_t>> seen;
+            size_t failed = 0;
+            ingest::Sink sink{
+                [&](size_t index, const char*, size_t size) {
+                    if (seen.empty() || seen.back().first != index) seen.push_back({index, 0});
+                    seen.back().second += size;
+                    return true;
+                },
+                [&](size_t index, int error) {
+                    if (error != 0) failed = index;
+                    return true;
+                }};
+            ok &= expect(ingest::read_files(files, sink, engine), "ingest should read every file");
+            bool ordered = seen.size() == files.size() - 2;
+            for (size_t i = 0; ordered && i < seen.size(); ++i) ordered = seen[i].first == i + 1 && seen[i].second == files[i + 1].size;
+            ok &= expect(ordered, std::string("ingest should deliver files in order with ") + ingest::engine_name(engine));
+            ok &= expect(failed == files.size() - 1, "ingest should report the missing file");
+        }
+
+        std::string sync_path = (tmp_root / "written-sync.tar").string();
+        std::string ring_path = (tmp_root / "written-ring.tar").string();
+        tar_writer::Options options;
+        options.engine = ingest::Engine::Sync;
+        ok &= expect(tar_writer::write(sync_path, root.string(), {"tree"}, options) == 0, "native tar creation should succeed");
+        options.engine = ingest::Engine::Uring;
+        ok &= expect(tar_writer::write(ring_path, root.string(), {"tree"}, options) == 0, "native tar creation should succeed with io_uring");
+        std::ifstream sync_file(sync_path, std::ios::binary);
+        std::ifstream ring_file(ring_path, std::ios::binary);
+        std::string sync_bytes((std::istreambuf_iterator<char>(sync_file)), std::istreambuf_iterator<char>());
+        std::string ring_bytes((std::istreambuf_iterator<char>(ring_file)), std::istreambuf_iterator<char>());
+        ok &= expect(!sync_bytes.empty() && sync_bytes == ring_bytes, "both ingest engines should write identical archives");
+        ok &= expect(std::system(("tar -df " + sync_path + " -C " + root.string()).c_str()) == 0, "tar should find no difference from the sources");
+
+        backend::Archive tar{sync_path, file_type::FileType::ARCHIVE_TAR, ""};
+        auto native = backend::registry().list(tar);
+        auto tool = tui::archive_ops::parse_tar_listing(tui::archive_ops::run_command_capture({"tar", "-tf", sync_path}).stdout_output);
+        ok &= expect(native.size() == tool.size() && native.size() == 306, "written tar should list every member");
+        for (size_t i = 0; i < std::min(native.size(), tool.size()); ++i) {
+            ok &= expect_equal(native[i].path, tool[i].path, "written tar member should match tar -tf");
+        }
+        ok &= expect_equal(tui::archive_ops::extract_to_string(sync_path, "tree/sub/" + std::string(90, 'd') + "/" + long_name, tar.format), "long\n",
+            "long names should survive the pax header");
+
+        // The first name of a hard-linked file vanishes before it is read: the next name takes the data.
+        fs::path linked = root / "linked";
+        fs::create_directories(linked);
+        ok &= expect(write_text_file(linked / "a", "first file\n") && write_text_file(linked / "b", "shared\n"), "should create hard link inputs");
+        fs::create_hard_link(linked / "b", linked / "c");
+        fs::create_hard_link(linked / "b", linked / "d");
+        std::string linked_path = (tmp_root / "written-linked.tar").string();
+        tar_writer::Options vanishing;
+        vanishing.engine = ingest::Engine::Sync;
+        vanishing.advance = [&](uint64_t, uint64_t) { fs::remove(linked / "b"); };
+        ok &= expect(tar_writer::write(linked_path, root.string(), {"linked"}, vanishing) == 2, "a vanished file should be reported");
+        ok &= expect(std::system(("mkdir -p " + (tmp_root / "linked-out").string() + " && tar -xf " + linked_path + " -C " +
+                                  (tmp_root / "linked-out").string()).c_str()) == 0, "tar should extract the remaining hard links");
+        std::ifstream c_file(tmp_root / "linked-out" / "linked" / "c");
+        std::ifstream d_file(tmp_root / "linked-out" / "linked" / "d");
+        ok &= expect_equal(std::string((std::istreambuf_iterator<char>(c_file)), std::istreambuf_iterator<char>()), "shared\n",
+            "the next name should carry the data");
+        ok &= expect(fs::exists(tmp_root / "linked-out" / "linked" / "d") && fs::hard_link_count(tmp_root / "linked-out" / "linked" / "d") == 2,
+            "later names should link to the one that carries the data");
+
+        // An absolute item, as compressing the filesystem root from "/" produces, must not yield absolute members.
+        std::string absolute_path = (tmp_root / "written-absolute.tar").string();
+        ok &= expect(tar_writer::write(absolute_path, "/", {(linked / "a").string()}, options) == 0, "an absolute item should be archived");
+        auto absolute = tui::archive_ops::parse_tar_listing(tui::archive_ops::run_command_capture({"tar", "-tf", absolute_path}).stdout_output);
+        ok &= expect(absolute.size() == 1 && absolute.front().path == (linked / "a").relative_path().string(),
+            "member names should have their leading '/' stripped");
+        return ok;
+    }
+
+    bool test_parallel_zip_extraction(const fs::path& tmp_root) {
+        bool ok = true;
+        fs::path root = tmp_root / "pzip";
+        std::vector<std::string> names;
+        for (int i = 0; i < 40; ++i) {
+            std::string name = "tree/d" + std::to_string(i % 5) + "/f" + std::to_string(i) + ".txt";
+            fs::create_directories((root / name).parent_path());
+            std::string content;
+            for (int line = 0; line < 200 * (i + 1); ++line) content += std::to_string(i * line) + "\n";
+            ok &= expect(write_text_file(root / name, content), "should create zip extraction input");
+            names.push_back(name);
+        }
+        fs::create_directories(root / "tree" / "empty");
+        fs::create_symlink("d0/f0.txt", root / "tree" / "link");
+        std::string zip_path = (tmp_root / "parallel.zip").string();
+        std::string locked_path = (tmp_root / "locked.zip").string();
+        ok &= expect(std::system(("cd " + root.string() + " && zip -qry " + zip_path + " tree && zip -qr -P secret " + locked_path + " tree").c_str()) == 0,
+            "parallel extraction archives should be created");
+
+        backend::Archive zip{zip_path, file_type::FileType::ARCHIVE_ZIP, ""};
+        backend::ArchiveBackend* chosen = backend::registry().select(backend::Operation::Extract, zip);
+        ok &= expect(chosen && chosen->name() == "native-zip", "stored and deflated zips should be extracted natively");
+        backend::ArchiveBackend* locked = backend::registry().select(backend::Operation::Extract, {locked_path, zip.format, "secret"});
+        ok &= expect(locked && locked->name() != "native-zip", "encrypted zips should be left to the tools");
+
+        fs::path out = tmp_root / "pzip_out";
+        archive::ArchiveReader(zip_path).extract_all(out.string());
+        for (const auto& name : names) {
+            std::ifstream expected(root / name, std::ios::binary);
+            std::ifstream actual(out / name, std::ios::binary);
+            std::string expected_text((std::istreambuf_iterator<char>(expected)), std::istreambuf_iterator<char>());
+            std::string actual_text((std::istreambuf_iterator<char>(actual)), std::istreambuf_iterator<char>());
+            ok &= expect(actual_text == expected_text, "parallel zip extraction should reproduce " + name);
+        }
+        ok &= expect(fs::is_directory(out / "tree" / "empty"), "parallel zip extraction should create empty directories");
+        ok &= expect(fs::is_symlink(out / "tree" / "link") && fs::read_symlink(out / "tree" / "link") == "d0/f0.txt",
+            "parallel zip extraction should restore symlinks");
+        return ok;
+    }
+
+    bool test_simd_kernels() {
+        bool ok = true;
+        std::string data;
+        uint32_t seed = 12345;
+        for (size_t i = 0; i < 5000; ++i) {
+            seed = seed * 1103515245u + 12345u;
+            data += static_cast<char>(seed >> 24);
+        }
+        std::string text = "src/lib/Tui_Preview.CPP\nREADME.md\tdocs/Guide.txt\r\n";
+        while (text.size() < 300) text += text;
+        text += "needle";
+
+        simd::Level original = simd::active_level();
+        ok &= expect(simd::select(simd::Level::Scalar) == simd::Level::Scalar, "scalar kernels should always be selectable");
+        ok &= expect(simd::crc32(0, "123456789", 9) == 0xCBF43926u, "scalar CRC-32 should match the check value");
+        std::vector<uint32_t> crcs;
+        for (size_t length : {0, 1, 15, 63, 64, 65, 127, 128, 200, 4099, 5000}) crcs.push_back(simd::crc32(0x1234u, data.data(), length));
+        size_t controls = simd::count_control(data.data(), data.size());
+        size_t newline = simd::find_byte(text.data() + 1, text.size() - 1, '\n');
+        size_t missing = simd::find_byte(text.data(), text.size(), '\x01');
+        size_t found = simd::find_ascii_nocase(text.data(), text.size(), "needle", 6);
+        size_t guide = simd::find_ascii_nocase(text.data() + 40, text.size() - 40, "guide.txt", 9);
+
+        for (simd::Level level : {simd::Level::SSE42, simd::Level::AVX2, simd::Level::AVX512}) {
+            if (simd::select(level) != level) continue;
+            std::string name = simd::level_name(level);
+            size_t index = 0;
+            for (size_t length : {0, 1, 15, 63, 64, 65, 127, 128, 200, 4099, 5000}) {
+                ok &= expect(simd::crc32(0x1234u, data.data(), length) == crcs[index++], name + " CRC-32 should match scalar");
+            }
+            ok &= expect(simd::count_control(data.data(), data.size()) == controls, name + " classification should match scalar");
+            ok &= expect(simd::find_byte(text.data() + 1, text.size() - 1, '\n') == newline, name + " newline scan should match scalar");
+            ok &= expect(simd::find_byte(text.data(), text.size(), '\x01') == missing, name + " byte search should report absence");
+            ok &= expect(simd::find_ascii_nocase(text.data(), text.size(), "needle", 6) == found, name + " search should match scalar");
+            ok &= expect(simd::find_ascii_nocase(text.data() + 40, text.size() - 40, "guide.txt", 9) == guide,
+                name + " case-insensitive search should match scalar");
+        }
+        simd::select(original);
+        ok &= expect(found == text.size() - 6 && missing == text.size(), "scalar search results should be correct");
+        ok &= expect(simd::describe().find("crc32=") == 0, "kernel description should name the CRC kernel");
+        return ok;
+    }
+
+    bool test_executor() {
+        bool ok = true;
+        executor::Executor pool(1);
+        std::promise<void> release;
+        std::shared_future<void> gate = release.get_future().share();
+        std::string order;
+        {
+            executor::TaskGroup group(pool);
+            group.submit([gate]() { gate.wait(); });
+            while (pool.queue_depth() != 0) std::this_thread::yield();
+            group.submit([&]() { order += 'b'; }, executor::Priority::Background);
+            group.submit([&]() { order += 'n'; }, executor::Priority::Normal);
+            group.submit([&]() { order += 'i'; }, executor::Priority::Interactive);
+            ok &= expect(pool.queue_depth() == 3, "queue depth should count tasks waiting for a worker");
+            release.set_value();
+            group.wait();
+        }
+        ok &= expect_equal(order, "inb", "workers should run the most urgent queued task first");
+
+        std::atomic<size_t> sum{0};
+        pool.parallel_for(4, 0, [&](size_t outer) {
+            pool.parallel_for(8, 0, [&](size_t inner) { sum += outer * 8 + inner; });
+        });
+        ok &= expect(sum == 31 * 32 / 2, "nested parallel_for should run every iteration without deadlocking");
+
+        bool threw = false;
+        try {
+            pool.parallel_for(16, 0, [](size_t i) {
+                if (i == 5) throw std::runtime_error("boom");
+            });
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        ok &= expect(threw, "parallel_for should rethrow an iteration's exception");
+        executor::Stats stats = pool.stats();
+        ok &= expect(stats.workers == 1 && stats.peak_queue_depth >= 3 && stats.executed >= 4, "executor stats should be recorded");
+        ok &= expect(executor::available_parallelism() >= 1, "available parallelism should be at least one");
+        return ok;
+    }
+
+    bool test_service(const fs::path& tmp_root) {
+        bool ok = true;
+        fs::path root = tmp_root / "service";
+        fs::create_directories(root / "docs");
+        ok &= expect(write_text_file(root / "docs" / "notes.txt", "cached entry\n"), "should create service input");
+        std::string tar_path = (tmp_root / "service.tar").string();
+        ok &= expect(std::system(("cd " + root.string() + " && tar -cf " + tar_path + " docs").c_str()) == 0,
+            "service test archive should be created");
+
+        std::string socket_path = (tmp_root / "hitpag.sock").string();
+        service::Service cache;
+        service::Server server(socket_path, cache);
+        server.listen();
+        std::error_code socket_ec;
+        ok &= expect((fs::status(socket_path, socket_ec).permissions() & fs::perms::all) == (fs::perms::owner_read | fs::perms::owner_write),
+            "daemon socket should only be reachable by its owner");
+        std::thread runner([&]() { server.run(); });
+
+        service::Response response;
+        service::Request request;
+        request.archive = tar_path;
+        ok &= expect(service::call(socket_path, request, response), "daemon should answer list");
+        ok &= expect_equal(response.payload, "docs/\ndocs/notes.txt\n", "daemon should list every entry");
+
+        request.command = service::Command::Stat;
+        request.entry = "docs/notes.txt";
+        ok &= expect(service::call(socket_path, request, response), "daemon should answer stat");
+        ok &= expect(response.payload.find("size=13\n") != std::string::npos, "stat should report the entry size");
+
+        request.command = service::Command::Cat;
+        for (int i = 0; i < 2; ++i) {
+            ok &= expect(service::call(socket_path, request, response), "daemon should answer cat");
+            ok &= expect_equal(response.payload, "cached entry\n", "cat should return entry content");
+        }
+        ok &= expect(cache.cached_archives() == 1 && cache.cached_content_bytes() == 13, "daemon should cache the listing and content");
+
+        request.command = service::Command::Extract;
+        request.output_dir = (tmp_root / "service-out").string();
+        ok &= expect(service::call(socket_path, request, response) && response.code == error::ErrorCode::SUCCESS, "daemon should extract");
+        ok &= expect(fs::exists(tmp_root / "service-out" / "docs" / "notes.txt"), "extract should write the entry");
+
+        request.command = service::Command::Cat;
+        request.entry = "docs/missing.txt";
+        ok &= expect(service::call(socket_path, request, response) && response.code == error::ErrorCode::INVALID_SOURCE,
+            "unknown entries should be reported as errors");
+
+        if (operation::is_tool_available("zip") && operation::is_tool_available("unzip")) {
+            std::string locked_path = (tmp_root / "service-locked.zip").string();
+            ok &= expect(std::system(("cd " + root.string() + " && zip -qr -P secret " + locked_path + " docs").c_str()) == 0,
+                "encrypted service archive should be created");
+            service::Request locked;
+            locked.command = service::Command::Cat;
+            locked.archive = locked_path;
+            locked.entry = "docs/notes.txt";
+            locked.password = "secret";
+            ok &= expect_equal(cache.handle(locked).payload, "cached entry\n", "cat should decrypt with the right password");
+            for (const char* password : {"", "wrong"}) {
+                locked.password = password;
+                ok &= expect(cache.handle(locked).code != error::ErrorCode::SUCCESS,
+                    "content decrypted for one client should not be served without its password");
+            }
+        }
+
+        // A failed listing is not kept: once the archive reads, the same version lists.
+        std::string flaky_path = (tmp_root / "service-flaky.tar").string();
+        fs::copy_file(tar_path, flaky_path, fs::copy_options::overwrite_existing);
+        auto stamp = fs::last_write_time(flaky_path);
+        {
+            std::fstream flaky(flaky_path, std::ios::in | std::ios::out | std::ios::binary);
+            flaky.seekp(148);
+            flaky.write("9999999", 7);
+        }
+        fs::last_write_time(flaky_path, stamp);
+        service::Request flaky;
+        flaky.archive = flaky_path;
+        bool listed_damaged = cache.handle(flaky).code == error::ErrorCode::SUCCESS;
+        fs::copy_file(tar_path, flaky_path, fs::copy_options::overwrite_existing);
+        fs::last_write_time(flaky_path, stamp);
+        ok &= expect(!listed_damaged && cache.handle(flaky).payload == "docs/\ndocs/notes.txt\n", "a failed listing should be retried");
+
+        // Idle clients hold no executor worker, and a request split across writes is still read.
+        std::vector<int> idle;
+        for (size_t i = 0; i < executor::global().worker_count() + 2; ++i) {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            std::snprintf(address.sun_path, sizeof(address.sun_path), "%s", socket_path.c_str());
+            int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) idle.push_back(fd);
+            else if (fd >= 0) ::close(fd);
+        }
+        ok &= expect(!idle.empty() && ::send(idle.front(), "4:list,", 7, 0) == 7, "idle clients should connect");
+        request.command = service::Command::List;
+        request.entry.clear();
+        auto answered = std::async(std::launch::async, [&]() { return service::call(socket_path, request, response); });
+        ok &= expect(answered.wait_for(std::chrono::seconds(10)) == std::future_status::ready && answered.get(),
+            "a request should be answered while more clients than workers sit idle");
+        std::string rest = std::to_string(tar_path.size()) + ":" + tar_path + ",0:,0:,0:,";
+        ok &= expect(::send(idle.front(), rest.data(), rest.size(), 0) == static_cast<ssize_t>(rest.size()), "the rest of a split request should be sent");
+        char reply[64] = {};
+        ok &= expect(::recv(idle.front(), reply, sizeof(reply) - 1, 0) > 0 && std::string(reply).rfind("1:0,", 0) == 0,
+            "a request split across writes should be answered");
+
+        bool threw = false;
+        try {
+            service::Server second(socket_path, cache);
+            second.listen();
+        } catch (const error::HitpagException&) {
+            threw = true;
+        }
+        ok &= expect(threw, "a second daemon should not take over a live socket");
+
+        auto stopped = std::async(std::launch::async, [&]() {
+            server.stop();
+            runner.join();
+        });
+        ok &= expect(stopped.wait_for(std::chrono::seconds(10)) == std::future_status::ready, "stopping should not wait for idle clients");
+        stopped.wait();
+        for (int fd : idle) ::close(fd);
+        ok &= expect(!service::call(socket_path, request, response), "stopped daemon should not answer");
+        return ok;
+    }
 }
 
 int main() {
@@ -219,6 +1478,11 @@ int main() {
 
     ok &= test_tui_args();
     ok &= test_tui_i18n_keys();
+    ok &= test_benchmark_json();
+    ok &= test_live_progress_line();
+    ok &= test_crc32_zeros();
+    ok &= test_executor();
+    ok &= test_simd_kernels();
 
     ScopedTestDir tmp_root("/opt/hitpag/tmp/tui_smoke_test");
     if (!tmp_root.valid()) {
@@ -230,6 +1494,20 @@ int main() {
     ok &= expect(write_text_file(single_file, "hello from single-file archive\n"), "should create single-file input");
 
     ok &= test_tar_text_extraction(tmp_root.path());
+    ok &= test_archive_diff(tmp_root.path());
+    ok &= test_archive_scan(tmp_root.path());
+    ok &= test_archive_api(tmp_root.path());
+    ok &= test_archive_backends(tmp_root.path());
+    ok &= test_sevenzip_index(tmp_root.path());
+    ok &= test_rar_index(tmp_root.path());
+    ok &= test_xar_reader(tmp_root.path());
+    ok &= test_stream_probe(tmp_root.path());
+    ok &= test_header_sniffing(tmp_root.path());
+    ok &= test_identify(tmp_root.path());
+    ok &= test_tar_writer(tmp_root.path());
+    ok &= test_parallel_zip_extraction(tmp_root.path());
+    ok &= test_service(tmp_root.path());
+    ok &= test_trace_export(tmp_root.path());
     ok &= test_single_file_archive(
         tmp_root.path(),
         "lz4",